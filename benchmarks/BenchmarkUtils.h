@@ -0,0 +1,231 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef BENCHMARKS_BENCHMARKUTILS_H_
+#define BENCHMARKS_BENCHMARKUTILS_H_
+
+#include <VulkanEngine/GLFWWindow.h>
+#include <VulkanEngine/GraphicsPipeline.h>
+#include <VulkanEngine/IndexAttribute.h>
+#include <VulkanEngine/Mesh.h>
+#include <VulkanEngine/RenderPass.h>
+#include <VulkanEngine/Shader.h>
+#include <VulkanEngine/ShaderModule.h>
+#include <VulkanEngine/SingleUsageCommandBuffer.h>
+#include <VulkanEngine/UniformBuffer.h>
+#include <VulkanEngine/VertexAttribute.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <Eigen/Eigen>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace BenchmarkUtils {
+
+/// Size of the window the benchmarks render to.
+constexpr uint32_t kWindowWidth = 1280;
+constexpr uint32_t kWindowHeight = 800;
+
+/// \return The window shared by all benchmarks, set by main().
+inline std::shared_ptr<VulkanEngine::GLFWWindow>& getWindow() {
+  static std::shared_ptr<VulkanEngine::GLFWWindow> window;
+  return window;
+}
+
+/// Uniform buffer layout used by the benchmark shaders.
+struct MvpUbo {
+  Eigen::Matrix4f model;
+  Eigen::Matrix4f view;
+  Eigen::Matrix4f projection;
+};
+
+using TriangleMesh = VulkanEngine::Mesh<Eigen::Vector3f, uint32_t>;
+
+/// Everything needed to issue a draw, shared by all draws of a benchmark.
+struct DrawResources {
+  std::shared_ptr<TriangleMesh> mesh;
+  std::shared_ptr<VulkanEngine::Shader> shader;
+  std::shared_ptr<VulkanEngine::GraphicsPipeline> graphics_pipeline;
+  std::vector<std::shared_ptr<VulkanEngine::UniformBuffer<MvpUbo>>>
+      mvp_buffers;
+};
+
+/// Create a single triangle together with a minimal shader and pipeline.
+/// \return The created DrawResources.
+inline DrawResources createTriangleDrawResources() {
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  DrawResources resources;
+
+  const std::array<Eigen::Vector3f, 3> positions = {
+      Eigen::Vector3f{-0.5f, -0.5f, 0.0f},
+      Eigen::Vector3f{0.5f, -0.5f, 0.0f},
+      Eigen::Vector3f{0.0f, 0.5f, 0.0f},
+  };
+  const std::array<uint32_t, 3> indices = {0u, 1u, 2u};
+
+  resources.mesh = std::make_shared<TriangleMesh>();
+  resources.mesh->setPositions(
+      std::make_shared<VulkanEngine::VertexAttribute<Eigen::Vector3f>>(
+          positions.data(), positions.size(), 0,
+          vk::Format::eR32G32B32Sfloat));
+  resources.mesh->setIndices(
+      std::make_shared<VulkanEngine::IndexAttribute<uint32_t>>(
+          indices.data(), indices.size()));
+  resources.mesh->setBoundingBox(Eigen::Vector3f(0.5f, 0.5f, 0.0f),
+                                 Eigen::Vector3f(-0.5f, -0.5f, 0.0f));
+
+  VulkanEngine::SingleUsageCommandBuffer command_buffer;
+  command_buffer.beginSingleUsageCommandBuffer();
+  resources.mesh->transferBuffers(command_buffer.single_use_command_buffer);
+  command_buffer.endSingleUsageCommandBuffer();
+
+  const std::string vertex_shader_string =
+      "#version 450\n"
+      "layout(binding = 0) uniform UniformBufferObject {\n"
+      "  mat4 model;\n"
+      "  mat4 view;\n"
+      "  mat4 proj;\n"
+      "} ubo;\n"
+      "layout(location = 0) in vec3 inPosition;\n"
+      "void main() {\n"
+      "  gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, "
+      "1.0);\n"
+      "}\n";
+  const std::string fragment_shader_string =
+      "#version 450\n"
+      "layout(location = 0) out vec4 outFragColor;\n"
+      "void main() {\n"
+      "  outFragColor = vec4(1.0);\n"
+      "}\n";
+
+  auto vertex_shader = std::make_shared<VulkanEngine::ShaderModule>(
+      vertex_shader_string, false, vk::ShaderStageFlagBits::eVertex);
+  auto fragment_shader = std::make_shared<VulkanEngine::ShaderModule>(
+      fragment_shader_string, false, vk::ShaderStageFlagBits::eFragment);
+  resources.shader = std::make_shared<VulkanEngine::Shader>(
+      std::vector<std::shared_ptr<VulkanEngine::ShaderModule>>{
+          fragment_shader, vertex_shader});
+
+  std::vector<std::vector<std::shared_ptr<VulkanEngine::Descriptor>>>
+      descriptors;
+  for (size_t i = 0; i < vulkan_manager.getFramesInFlight(); ++i) {
+    resources.mvp_buffers.push_back(
+        std::make_shared<VulkanEngine::UniformBuffer<MvpUbo>>(0));
+    descriptors.push_back({resources.mvp_buffers.back()});
+  }
+  resources.shader->setDescriptors(descriptors);
+
+  resources.graphics_pipeline =
+      std::make_shared<VulkanEngine::GraphicsPipeline>();
+  resources.graphics_pipeline->setViewPort(
+      0, 0, static_cast<float>(kWindowWidth),
+      static_cast<float>(kWindowHeight), 0.0f, 1.0f);
+  resources.graphics_pipeline->setScissor(0, 0, kWindowWidth, kWindowHeight);
+  resources.graphics_pipeline->createGraphicsPipeline(resources.mesh,
+                                                      resources.shader);
+
+  return resources;
+}
+
+/// Write an OBJ file of wavy grids placed side by side, one shape each, so
+/// that benchmarks don't depend on external assets. Vertices have texture
+/// coordinates but no normals, so loading the file welds vertices and
+/// computes normals. The output only depends on the arguments, and a file
+/// written by an earlier run is reused.
+/// \param num_shapes The number of shapes.
+/// \param grid_size The number of quads along each side of a shape, each
+/// shape has 2 * grid_size * grid_size triangles.
+/// \return The path of the OBJ file, empty if it could not be written.
+inline std::filesystem::path createGridOBJ(size_t num_shapes,
+                                           size_t grid_size) {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         ("VulkanEngineGridBenchmark" +
+                          std::to_string(num_shapes) + "_" +
+                          std::to_string(grid_size));
+  const auto obj_path = directory / "grid.obj";
+  if (std::filesystem::exists(obj_path)) {
+    return obj_path;
+  }
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  std::ofstream obj_file(directory / "grid.obj.tmp");
+  if (error || !obj_file) {
+    return std::filesystem::path();
+  }
+
+  const size_t row_size = grid_size + 1;
+  const float step = 1.0f / static_cast<float>(grid_size);
+  for (size_t shape = 0; shape < num_shapes; ++shape) {
+    obj_file << "o grid" << shape << "\n";
+    for (size_t y = 0; y < row_size; ++y) {
+      for (size_t x = 0; x < row_size; ++x) {
+        const float u = static_cast<float>(x) * step;
+        const float v = static_cast<float>(y) * step;
+        const float height = 0.05f * std::sin(u * 12.0f + static_cast<float>(shape)) *
+                             std::cos(v * 12.0f);
+        obj_file << "v " << static_cast<float>(shape) * 1.1f + u << " " << v
+                 << " " << height << "\n"
+                 << "vt " << u << " " << v << "\n";
+      }
+    }
+
+    const size_t first = shape * row_size * row_size + 1;
+    for (size_t y = 0; y < grid_size; ++y) {
+      for (size_t x = 0; x < grid_size; ++x) {
+        const size_t corners[4] = {
+            first + y * row_size + x, first + y * row_size + x + 1,
+            first + (y + 1) * row_size + x + 1,
+            first + (y + 1) * row_size + x};
+        obj_file << "f";
+        for (const auto corner : corners) {
+          obj_file << " " << corner << "/" << corner;
+        }
+        obj_file << "\n";
+      }
+    }
+  }
+
+  // Only publish the model once everything has been written.
+  obj_file.close();
+  std::filesystem::rename(directory / "grid.obj.tmp", obj_path, error);
+  return error ? std::filesystem::path() : obj_path;
+}
+
+/// \return Begin info for the default render pass using the framebuffer of
+/// the current frame.
+inline vk::RenderPassBeginInfo getRenderPassBeginInfo() {
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  return vk::RenderPassBeginInfo()
+      .setRenderPass(vulkan_manager.getDefaultRenderPass()->getVkRenderPass())
+      .setFramebuffer(vulkan_manager.getCurrentSwapchainFramebuffer())
+      .setRenderArea(vk::Rect2D({0, 0}, {kWindowWidth, kWindowHeight}));
+}
+
+}  // namespace BenchmarkUtils
+
+#endif  // BENCHMARKS_BENCHMARKUTILS_H_
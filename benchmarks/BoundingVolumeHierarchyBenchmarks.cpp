@@ -0,0 +1,210 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/BoundingVolumeHierarchy.h>
+#include <VulkanEngine/Camera.h>
+#include <VulkanEngine/Frustum.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// Create randomly placed boxes of random size in a 200 unit cube.
+/// \param box_count The number of boxes.
+/// \param seed Seed of the random placement.
+/// \return The boxes.
+VulkanEngine::BoundingBoxArray createRandomBoxes(size_t box_count,
+                                                 uint32_t seed = 42) {
+  std::mt19937 random_engine(seed);
+  std::uniform_real_distribution<float> position_distribution(-100.0f,
+                                                              100.0f);
+  std::uniform_real_distribution<float> size_distribution(0.1f, 2.0f);
+  VulkanEngine::BoundingBoxArray bounding_boxes;
+  for (size_t i = 0; i < box_count; ++i) {
+    BoundingBox<Eigen::Vector3f> bounding_box;
+    bounding_box.min = {position_distribution(random_engine),
+                        position_distribution(random_engine),
+                        position_distribution(random_engine)};
+    bounding_box.max =
+        bounding_box.min + Eigen::Vector3f(size_distribution(random_engine),
+                                           size_distribution(random_engine),
+                                           size_distribution(random_engine));
+    bounding_boxes.push_back(bounding_box);
+  }
+  return bounding_boxes;
+}
+
+/// \return The frustum of a camera at the center of the boxes.
+VulkanEngine::Frustum createFrustum() {
+  VulkanEngine::Camera camera(Eigen::Vector3f(0.0f, 0.0f, 1.0f),
+                              Eigen::Vector3f(0.0f, 1.0f, 0.0f), 0.1f, 100.0f,
+                              45.0f, BenchmarkUtils::kWindowWidth,
+                              BenchmarkUtils::kWindowHeight);
+  return VulkanEngine::Frustum(camera.getPerspectiveProjectionMatrix() *
+                               camera.getViewMatrix());
+}
+
+/// Builds a hierarchy over random boxes. Arguments: number of boxes, number
+/// of threads (0 for all hardware threads).
+void BM_BVHBuild(benchmark::State& state) {
+  const auto box_count = static_cast<size_t>(state.range(0));
+  const auto num_threads = static_cast<size_t>(state.range(1));
+  const auto bounding_boxes = createRandomBoxes(box_count);
+
+  VulkanEngine::BoundingVolumeHierarchy hierarchy;
+  for (auto _ : state) {
+    hierarchy.build(bounding_boxes, num_threads);
+    benchmark::ClobberMemory();
+  }
+
+  state.counters["nodes"] = static_cast<double>(hierarchy.getNumNodes());
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(box_count));
+}
+
+BENCHMARK(BM_BVHBuild)
+    ->Args({100000, 1})
+    ->Args({100000, 0})
+    ->Unit(benchmark::kMillisecond);
+
+/// Moves every box and refits the whole hierarchy at once. Arguments: number
+/// of boxes.
+void BM_BVHRefit(benchmark::State& state) {
+  const auto box_count = static_cast<size_t>(state.range(0));
+  auto bounding_boxes = createRandomBoxes(box_count);
+
+  VulkanEngine::BoundingVolumeHierarchy hierarchy;
+  hierarchy.build(bounding_boxes);
+
+  float offset = 0.01f;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < box_count; ++i) {
+      bounding_boxes.min_x[i] += offset;
+      bounding_boxes.max_x[i] += offset;
+    }
+    offset = -offset;
+    state.ResumeTiming();
+
+    hierarchy.refit(bounding_boxes);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(box_count));
+}
+
+BENCHMARK(BM_BVHRefit)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/// Moves some of the boxes and refits the nodes above each of them, as done
+/// when SceneObject::setTransform() is called on a few children. Arguments:
+/// number of boxes, number of boxes moved per iteration.
+void BM_BVHIncrementalRefit(benchmark::State& state) {
+  const auto box_count = static_cast<size_t>(state.range(0));
+  const auto moved_count = static_cast<size_t>(state.range(1));
+  const auto bounding_boxes = createRandomBoxes(box_count);
+
+  VulkanEngine::BoundingVolumeHierarchy hierarchy;
+  hierarchy.build(bounding_boxes);
+
+  std::mt19937 random_engine(7);
+  std::uniform_int_distribution<size_t> index_distribution(0, box_count - 1);
+  std::uniform_real_distribution<float> offset_distribution(-0.5f, 0.5f);
+  for (auto _ : state) {
+    for (size_t i = 0; i < moved_count; ++i) {
+      const size_t index = index_distribution(random_engine);
+      auto bounding_box = bounding_boxes.get(index);
+      const Eigen::Vector3f offset(offset_distribution(random_engine),
+                                   offset_distribution(random_engine),
+                                   offset_distribution(random_engine));
+      bounding_box.min += offset;
+      bounding_box.max += offset;
+      hierarchy.setBoundingBox(index, bounding_box);
+    }
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(moved_count));
+}
+
+BENCHMARK(BM_BVHIncrementalRefit)
+    ->Args({100000, 1000})
+    ->Unit(benchmark::kMicrosecond);
+
+/// Finds the boxes inside of a view frustum through the hierarchy. Compare
+/// with BM_FrustumIntersectBoxes, which tests every box. Arguments: number
+/// of boxes.
+void BM_BVHIntersectFrustum(benchmark::State& state) {
+  const auto box_count = static_cast<size_t>(state.range(0));
+  VulkanEngine::BoundingVolumeHierarchy hierarchy;
+  hierarchy.build(createRandomBoxes(box_count));
+  const auto frustum = createFrustum();
+
+  std::vector<uint32_t> primitives;
+  for (auto _ : state) {
+    hierarchy.intersectFrustum(frustum, primitives);
+    benchmark::DoNotOptimize(primitives.data());
+  }
+
+  state.counters["visible"] = static_cast<double>(primitives.size());
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(box_count));
+}
+
+BENCHMARK(BM_BVHIntersectFrustum)
+    ->Arg(100000)
+    ->Unit(benchmark::kMicrosecond);
+
+/// Casts random rays from the center of the boxes through the hierarchy, as
+/// done when picking. Arguments: number of boxes.
+void BM_BVHIntersectRay(benchmark::State& state) {
+  const auto box_count = static_cast<size_t>(state.range(0));
+  VulkanEngine::BoundingVolumeHierarchy hierarchy;
+  hierarchy.build(createRandomBoxes(box_count));
+
+  std::mt19937 random_engine(11);
+  std::uniform_real_distribution<float> direction_distribution(-1.0f, 1.0f);
+  std::vector<Eigen::Vector3f> directions(256);
+  for (auto& direction : directions) {
+    direction = {direction_distribution(random_engine),
+                 direction_distribution(random_engine),
+                 direction_distribution(random_engine)};
+  }
+
+  std::vector<VulkanEngine::BoundingVolumeHierarchy::RayHit> hits;
+  size_t ray_index = 0;
+  for (auto _ : state) {
+    hierarchy.intersectRay(Eigen::Vector3f::Zero(),
+                           directions[ray_index++ % directions.size()],
+                           1000.0f, hits);
+    benchmark::DoNotOptimize(hits.data());
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_BVHIntersectRay)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
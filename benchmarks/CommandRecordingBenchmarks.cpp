@@ -0,0 +1,109 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/CommandPool.h>
+#include <VulkanEngine/ParallelCommandRecorder.h>
+#include <VulkanEngine/RenderQueue.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+/// Records a frame's worth of draws into a primary command buffer, either
+/// inline or through secondary command buffers recorded by worker threads.
+/// Nothing is submitted, so only the CPU cost of recording is measured.
+/// Arguments: recording threads (0 = inline), number of draws.
+void BM_RecordDraws(benchmark::State& state) {
+  const auto num_threads = static_cast<size_t>(state.range(0));
+  const auto draw_count = static_cast<size_t>(state.range(1));
+
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  auto device = vulkan_manager.getDevice();
+  auto resources = BenchmarkUtils::createTriangleDrawResources();
+
+  VulkanEngine::RenderQueue render_queue;
+  for (size_t i = 0; i < draw_count; ++i) {
+    render_queue.submit({resources.graphics_pipeline.get(),
+                         resources.shader.get(), resources.mesh.get(),
+                         static_cast<uint32_t>(
+                             i % vulkan_manager.getFramesInFlight())});
+  }
+
+  std::vector<std::shared_ptr<VulkanEngine::CommandPool>> command_pools;
+  for (size_t i = 0; i < vulkan_manager.getFramesInFlight(); ++i) {
+    command_pools.emplace_back(new VulkanEngine::CommandPool(
+        device->getVkDevice(), device->getGraphicsQueueFamilyIndex()));
+  }
+
+  std::unique_ptr<VulkanEngine::ParallelCommandRecorder> command_recorder;
+  if (num_threads > 0) {
+    command_recorder.reset(
+        new VulkanEngine::ParallelCommandRecorder(num_threads));
+  }
+
+  const auto render_pass_info = BenchmarkUtils::getRenderPassBeginInfo();
+  const auto inheritance_info =
+      vk::CommandBufferInheritanceInfo()
+          .setRenderPass(render_pass_info.renderPass)
+          .setSubpass(0)
+          .setFramebuffer(render_pass_info.framebuffer);
+
+  size_t frame_index = 0;
+  for (auto _ : state) {
+    auto& command_pool = command_pools[frame_index];
+    command_pool->reset();
+    auto command_buffer = command_pool->getCommandBuffer();
+    command_buffer.begin(vk::CommandBufferBeginInfo().setFlags(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+    if (command_recorder.get()) {
+      command_buffer.beginRenderPass(
+          render_pass_info, vk::SubpassContents::eSecondaryCommandBuffers);
+      auto secondary_command_buffers =
+          command_recorder->record(render_queue, inheritance_info, frame_index);
+      command_buffer.executeCommands(secondary_command_buffers);
+    } else {
+      command_buffer.beginRenderPass(render_pass_info,
+                                     vk::SubpassContents::eInline);
+      render_queue.record(command_buffer, 0, render_queue.size());
+    }
+
+    command_buffer.endRenderPass();
+    command_buffer.end();
+
+    frame_index = (frame_index + 1) % command_pools.size();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(draw_count));
+  state.counters["threads"] = static_cast<double>(num_threads);
+}
+
+BENCHMARK(BM_RecordDraws)
+    ->ArgNames({"threads", "draws"})
+    ->ArgsProduct({{0, 1, 2, 4, 8}, {1000, 10000, 50000}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,227 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/Frustum.h>
+#include <VulkanEngine/GPUCullingPass.h>
+#include <VulkanEngine/IndirectDrawBuffer.h>
+#include <VulkanEngine/OBJMesh.h>
+#include <VulkanEngine/RenderQueue.h>
+#include <VulkanEngine/Scene.h>
+#include <VulkanEngine/SingleUsageCommandBuffer.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// Tests random boxes against a view frustum, eight at a time when compiled
+/// with AVX2. Arguments: number of boxes.
+void BM_FrustumIntersectBoxes(benchmark::State& state) {
+  const auto box_count = static_cast<size_t>(state.range(0));
+
+  VulkanEngine::Camera camera(Eigen::Vector3f(0.0f, 0.0f, 1.0f),
+                              Eigen::Vector3f(0.0f, 1.0f, 0.0f), 0.1f, 100.0f,
+                              45.0f, BenchmarkUtils::kWindowWidth,
+                              BenchmarkUtils::kWindowHeight);
+  const VulkanEngine::Frustum frustum(camera.getPerspectiveProjectionMatrix() *
+                                      camera.getViewMatrix());
+
+  std::mt19937 random_engine(42);
+  std::uniform_real_distribution<float> position_distribution(-100.0f,
+                                                              100.0f);
+  VulkanEngine::BoundingBoxArray bounding_boxes;
+  for (size_t i = 0; i < box_count; ++i) {
+    BoundingBox<Eigen::Vector3f> bounding_box;
+    bounding_box.min = {position_distribution(random_engine),
+                        position_distribution(random_engine),
+                        position_distribution(random_engine)};
+    bounding_box.max = bounding_box.min + Eigen::Vector3f::Constant(1.0f);
+    bounding_boxes.push_back(bounding_box);
+  }
+
+  std::vector<uint8_t> visibility;
+  for (auto _ : state) {
+    frustum.intersects(bounding_boxes, visibility);
+    benchmark::DoNotOptimize(visibility.data());
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(box_count));
+}
+
+BENCHMARK(BM_FrustumIntersectBoxes)
+    ->Arg(1000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMicrosecond);
+
+/// Renders a field of bunnies scattered around the camera, most of which are
+/// outside of the view frustum. Every bunny is an instance of the same
+/// OBJMesh placed by its own parent SceneObject. Only the time spent in
+/// Scene::update(), which traverses the scene and records the frame, is
+/// measured. Arguments: frustum culling (0 or 1), number of bunnies.
+/// Reports the number of draws per frame.
+void BM_BunnyFieldTraversal(benchmark::State& state) {
+  const bool frustum_culling = state.range(0) != 0;
+  const auto bunny_count = static_cast<size_t>(state.range(1));
+
+  const std::filesystem::path bunny_path("./assets/bunny.obj");
+  if (!std::filesystem::exists(bunny_path)) {
+    state.SkipWithError("assets/bunny.obj not found, run from the repository "
+                        "root.");
+    return;
+  }
+
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  auto window = BenchmarkUtils::getWindow();
+
+  auto bunny = std::make_shared<VulkanEngine::OBJMesh>(bunny_path);
+  auto scene = std::make_shared<VulkanEngine::Scene>(
+      std::vector<std::shared_ptr<VulkanEngine::Window>>{window});
+  scene->setFrustumCullingEnabled(frustum_culling);
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 1.0f), Eigen::Vector3f(0.0f, 1.0f, 0.0f),
+      0.1f, 100.0f, 45.0f, window->getFramebufferWidth(),
+      window->getFramebufferHeight());
+  scene->addChildren({camera});
+
+  std::mt19937 random_engine(42);
+  std::uniform_real_distribution<float> position_distribution(-100.0f,
+                                                              100.0f);
+  std::vector<std::shared_ptr<VulkanEngine::SceneObject>> instances;
+  for (size_t i = 0; i < bunny_count; ++i) {
+    auto instance = std::make_shared<VulkanEngine::SceneObject>();
+    instance->setTransform(
+        (Eigen::Translation3f(position_distribution(random_engine),
+                              position_distribution(random_engine),
+                              position_distribution(random_engine)) *
+         Eigen::Scaling(5.0f))
+            .matrix());
+    instance->addChildren({bunny});
+    instances.push_back(instance);
+  }
+  scene->addChildren(instances);
+
+  for (auto _ : state) {
+    scene->update();
+    state.PauseTiming();
+    vulkan_manager.drawImage();
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(bunny_count));
+  state.counters["draws"] =
+      static_cast<double>(scene->getRenderStatistics().draws);
+}
+
+BENCHMARK(BM_BunnyFieldTraversal)
+    ->ArgNames({"culling", "bunnies"})
+    ->ArgsProduct({{0, 1}, {1000, 10000, 100000}})
+    ->Unit(benchmark::kMillisecond);
+
+/// Culls a field of triangles scattered around the camera on the GPU and
+/// waits for the result. Roughly a sixth of the field is inside the view
+/// frustum. Arguments: number of draws.
+/// Reports the fraction of draws which survived culling.
+void BM_GPUCulling(benchmark::State& state) {
+  const auto draw_count = static_cast<size_t>(state.range(0));
+
+  const auto resources = BenchmarkUtils::createTriangleDrawResources();
+
+  VulkanEngine::Camera camera(Eigen::Vector3f(0.0f, 0.0f, -1.0f),
+                              Eigen::Vector3f(0.0f, 1.0f, 0.0f), 0.1f, 100.0f,
+                              45.0f, BenchmarkUtils::kWindowWidth,
+                              BenchmarkUtils::kWindowHeight);
+  const Eigen::Matrix4f view_projection =
+      camera.getPerspectiveProjectionMatrix() * camera.getViewMatrix();
+
+  std::mt19937 random_engine(42);
+  std::uniform_real_distribution<float> position_distribution(-100.0f,
+                                                              100.0f);
+
+  VulkanEngine::RenderQueue render_queue;
+  for (size_t i = 0; i < draw_count; ++i) {
+    VulkanEngine::DrawPacket draw_packet = {
+        resources.graphics_pipeline.get(), resources.shader.get(),
+        resources.mesh.get(), 0, 0.0f, static_cast<uint32_t>(i)};
+    const Eigen::Vector3f center(position_distribution(random_engine),
+                                 position_distribution(random_engine),
+                                 position_distribution(random_engine));
+    draw_packet.bounds.min = center - Eigen::Vector3f::Constant(0.5f);
+    draw_packet.bounds.max = center + Eigen::Vector3f::Constant(0.5f);
+    draw_packet.has_bounds = true;
+    render_queue.submit(draw_packet);
+  }
+  render_queue.buildBatches();
+
+  VulkanEngine::IndirectDrawBuffer indirect_draw_buffer;
+  indirect_draw_buffer.reserve(draw_count);
+
+  VulkanEngine::GPUCullingPass culling_pass;
+  for (auto _ : state) {
+    VulkanEngine::SingleUsageCommandBuffer command_buffer;
+    command_buffer.beginSingleUsageCommandBuffer();
+    culling_pass.cull(command_buffer.single_use_command_buffer, render_queue,
+                      indirect_draw_buffer, view_projection, 0);
+    command_buffer.single_use_command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(),
+        vk::MemoryBarrier()
+            .setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+            .setDstAccessMask(vk::AccessFlagBits::eHostRead),
+        nullptr, nullptr);
+    command_buffer.endSingleUsageCommandBuffer();
+  }
+
+  // All draws share one batch, so with draw counts the visible draws are
+  // counted in the draw count of the first command.
+  size_t visible_draws = 0;
+  const auto commands = indirect_draw_buffer.getCommands();
+  if (indirect_draw_buffer.usesDrawCount()) {
+    const auto draw_counts = reinterpret_cast<const uint32_t*>(
+        reinterpret_cast<const uint8_t*>(commands) +
+        indirect_draw_buffer.getDrawCountOffset(0));
+    visible_draws = draw_counts[0];
+  } else {
+    for (size_t i = 0; i < draw_count; ++i) {
+      visible_draws += commands[i].instanceCount;
+    }
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(draw_count));
+  state.counters["visible_fraction"] =
+      static_cast<double>(visible_draws) / static_cast<double>(draw_count);
+}
+
+BENCHMARK(BM_GPUCulling)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,145 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/Camera.h>
+#include <VulkanEngine/OBJMesh.h>
+#include <VulkanEngine/Profiler.h>
+#include <VulkanEngine/Scene.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+/// Renders complete frames of a model of generated grids, see
+/// BenchmarkUtils::createGridOBJ(), measuring Scene::update() and
+/// VulkanManager::drawImage() so that both the CPU and GPU cost of a frame
+/// are included. Every shape is a separate draw. Reports the GPU time of a
+/// frame if the device supports timestamp queries, and the vertex and
+/// fragment shader invocations per frame, which show vertex reuse and
+/// overdraw, if it supports pipeline statistics queries. Run with a software
+/// driver such as lavapipe to get results which don't depend on the GPU.
+/// Arguments: number of shapes, quads along each side of a shape.
+void BM_RenderGridScene(benchmark::State& state) {
+  const auto num_shapes = static_cast<size_t>(state.range(0));
+  const auto grid_size = static_cast<size_t>(state.range(1));
+
+  const auto obj_path = BenchmarkUtils::createGridOBJ(num_shapes, grid_size);
+  if (obj_path.empty()) {
+    state.SkipWithError("Could not write the grid model.");
+    return;
+  }
+
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  auto window = BenchmarkUtils::getWindow();
+
+  auto obj_mesh = std::make_shared<VulkanEngine::OBJMesh>(obj_path);
+  auto scene = std::make_shared<VulkanEngine::Scene>(
+      std::vector<std::shared_ptr<VulkanEngine::Window>>{window});
+
+  // Look at the row of grids from far enough away to see all of them.
+  const float row_length = static_cast<float>(num_shapes) * 1.1f;
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(row_length * 0.5f, 0.5f, 0.0f),
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f), 0.1f, row_length * 2.0f + 10.0f,
+      45.0f, window->getFramebufferWidth(), window->getFramebufferHeight());
+  camera->setTransform(Eigen::Affine3f(Eigen::Translation3f(
+                                           row_length * 0.5f, 0.5f,
+                                           row_length + 2.0f))
+                           .matrix());
+  scene->addChildren({camera, obj_mesh});
+
+  // Upload the geometry and uniform buffers of every frame in flight before
+  // measuring.
+  for (size_t i = 0; i < vulkan_manager.getFramesInFlight(); ++i) {
+    scene->update();
+    vulkan_manager.drawImage();
+  }
+
+  auto& profiler = vulkan_manager.getProfiler();
+  const bool profiler_enabled = profiler.isEnabled();
+  const auto statistics_level = profiler.getPipelineStatisticsLevel();
+  profiler.setEnabled(true);
+  profiler.setPipelineStatisticsLevel(
+      VulkanEngine::Profiler::PipelineStatisticsLevel::eRenderPass);
+  const auto& frames = profiler.getFrames();
+  const uint64_t first_frame = frames.empty() ? 0 : frames.back().index + 1;
+
+  for (auto _ : state) {
+    scene->update();
+    vulkan_manager.drawImage();
+  }
+
+  vulkan_manager.getDevice()->waitIdle();
+  profiler.flush();
+  profiler.setEnabled(profiler_enabled);
+  profiler.setPipelineStatisticsLevel(statistics_level);
+
+  // The profiler only keeps the most recent frames.
+  double gpu_ms = 0.0;
+  double record_ms = 0.0;
+  VulkanEngine::Profiler::PipelineStatistics pipeline_statistics;
+  size_t num_frames = 0;
+  for (const auto& frame : frames) {
+    if (frame.index >= first_frame) {
+      gpu_ms += frame.getGPUTimeMs();
+      record_ms += frame.getScopeTimeMs("Scene::recordRenderQueue");
+      pipeline_statistics += frame.getPipelineStatistics("RenderPass");
+      ++num_frames;
+    }
+  }
+  if (num_frames > 0) {
+    const auto frame_count = static_cast<double>(num_frames);
+    state.counters["gpu_ms"] = gpu_ms / frame_count;
+    state.counters["record_ms"] = record_ms / frame_count;
+    if (pipeline_statistics.input_assembly_vertices > 0) {
+      state.counters["vs_invocations"] =
+          static_cast<double>(pipeline_statistics.vertex_shader_invocations) /
+          frame_count;
+      state.counters["fs_invocations"] =
+          static_cast<double>(
+              pipeline_statistics.fragment_shader_invocations) /
+          frame_count;
+    }
+  }
+
+  const auto triangle_count =
+      static_cast<int64_t>(num_shapes * grid_size * grid_size * 2);
+  state.counters["draws"] =
+      static_cast<double>(scene->getRenderStatistics().draws);
+  state.counters["triangles"] = static_cast<double>(triangle_count);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          triangle_count);
+}
+
+BENCHMARK(BM_RenderGridScene)
+    ->ArgNames({"shapes", "grid"})
+    ->Args({1, 16})
+    ->Args({1, 1024})
+    ->Args({1024, 16})
+    ->Args({16384, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
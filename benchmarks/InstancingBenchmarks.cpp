@@ -0,0 +1,118 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/Camera.h>
+#include <VulkanEngine/InstancedMesh.h>
+#include <VulkanEngine/OBJMesh.h>
+#include <VulkanEngine/Scene.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// Renders a field of bunnies in front of the camera, either as instances of
+/// an InstancedMesh or with every bunny placed by its own parent SceneObject
+/// sharing a single OBJMesh. Both Scene::update() and
+/// VulkanManager::drawImage() are measured so that the GPU cost of the draws
+/// is included. Arguments: instanced (0 or 1), number of bunnies.
+/// Reports the number of draws per frame.
+void BM_BunnyInstancing(benchmark::State& state) {
+  const bool instanced = state.range(0) != 0;
+  const auto bunny_count = static_cast<size_t>(state.range(1));
+
+  const std::filesystem::path bunny_path("./assets/bunny.obj");
+  if (!std::filesystem::exists(bunny_path)) {
+    state.SkipWithError("assets/bunny.obj not found, run from the repository "
+                        "root.");
+    return;
+  }
+
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  auto window = BenchmarkUtils::getWindow();
+
+  auto bunny = std::make_shared<VulkanEngine::OBJMesh>(bunny_path);
+  auto scene = std::make_shared<VulkanEngine::Scene>(
+      std::vector<std::shared_ptr<VulkanEngine::Window>>{window});
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 1.0f), Eigen::Vector3f(0.0f, 1.0f, 0.0f),
+      0.1f, 100.0f, 45.0f, window->getFramebufferWidth(),
+      window->getFramebufferHeight());
+  scene->addChildren({camera});
+
+  std::mt19937 random_engine(42);
+  std::uniform_real_distribution<float> position_distribution(-10.0f, 10.0f);
+  std::uniform_real_distribution<float> depth_distribution(5.0f, 50.0f);
+  std::vector<Eigen::Matrix4f> transforms(bunny_count);
+  for (auto& transform : transforms) {
+    transform = Eigen::Affine3f(Eigen::Translation3f(
+                                    position_distribution(random_engine),
+                                    position_distribution(random_engine),
+                                    depth_distribution(random_engine)))
+                    .matrix();
+  }
+
+  if (instanced) {
+    auto instanced_mesh = std::make_shared<VulkanEngine::InstancedMesh>(bunny);
+    for (const auto& transform : transforms) {
+      instanced_mesh->addInstance(transform);
+    }
+    scene->addChildren({instanced_mesh});
+  } else {
+    std::vector<std::shared_ptr<VulkanEngine::SceneObject>> instances;
+    for (const auto& transform : transforms) {
+      auto instance = std::make_shared<VulkanEngine::SceneObject>();
+      instance->setTransform(transform);
+      instance->addChildren({bunny});
+      instances.push_back(instance);
+    }
+    scene->addChildren(instances);
+  }
+
+  // Upload the instance buffers of every frame in flight before measuring.
+  for (size_t i = 0; i < vulkan_manager.getFramesInFlight(); ++i) {
+    scene->update();
+    vulkan_manager.drawImage();
+  }
+
+  for (auto _ : state) {
+    scene->update();
+    vulkan_manager.drawImage();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(bunny_count));
+  state.counters["draws"] =
+      static_cast<double>(scene->getRenderStatistics().draws);
+}
+
+BENCHMARK(BM_BunnyInstancing)
+    ->ArgNames({"instanced", "bunnies"})
+    ->ArgsProduct({{0, 1}, {10000}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
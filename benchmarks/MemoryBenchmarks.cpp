@@ -0,0 +1,83 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/Buffer.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// Creates vertex and index buffers of random sizes between 4 KiB and 1 MiB
+/// and destroys them in random order, like a scene which loads and unloads
+/// many meshes. Buffers are allocated from the geometry pool of MemoryPools
+/// or from VMA's default pools. Reports the number of VkDeviceMemory blocks
+/// allocated by VMA after the last iteration.
+/// Arguments: pools (0 or 1), number of buffers.
+void BM_CreateDestroyGeometryBuffers(benchmark::State& state) {
+  const bool use_pools = state.range(0) != 0;
+  const auto num_buffers = static_cast<size_t>(state.range(1));
+
+  auto device = VulkanEngine::VulkanManager::getInstance().getDevice();
+  auto& memory_pools = device->getMemoryPools();
+  const bool pools_enabled = memory_pools.isEnabled();
+  memory_pools.setEnabled(use_pools);
+
+  std::mt19937 random_engine(42);
+  std::uniform_int_distribution<size_t> size_distribution(4 << 10, 1 << 20);
+
+  std::vector<std::unique_ptr<VulkanEngine::Buffer>> buffers;
+  for (auto _ : state) {
+    for (size_t i = 0; i < num_buffers; ++i) {
+      buffers.emplace_back(new VulkanEngine::Buffer(
+          size_distribution(random_engine),
+          (i % 2 ? vk::BufferUsageFlagBits::eIndexBuffer
+                 : vk::BufferUsageFlagBits::eVertexBuffer) |
+              vk::BufferUsageFlagBits::eTransferDst,
+          vk::MemoryPropertyFlagBits::eDeviceLocal,
+          VMA_MEMORY_USAGE_GPU_ONLY));
+    }
+    std::shuffle(buffers.begin(), buffers.end(), random_engine);
+    buffers.clear();
+  }
+
+  size_t block_count = 0;
+  for (const auto& heap :
+       device->getMemoryTelemetry().getSnapshot().heaps) {
+    block_count += heap.block_count;
+  }
+  state.counters["blocks"] = static_cast<double>(block_count);
+
+  memory_pools.setEnabled(pools_enabled);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(num_buffers));
+}
+
+BENCHMARK(BM_CreateDestroyGeometryBuffers)
+    ->ArgNames({"pools", "buffers"})
+    ->ArgsProduct({{0, 1}, {1000}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
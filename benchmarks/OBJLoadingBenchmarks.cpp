@@ -0,0 +1,108 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/OBJMesh.h>
+#include <VulkanEngine/Profiler.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <memory>
+
+namespace {
+
+/// Loads an OBJ file of generated grids, see BenchmarkUtils::createGridOBJ(),
+/// waiting until its geometry has been uploaded. Besides the total time, the
+/// time spent in each stage is reported using the Profiler: parsing the file,
+/// welding vertices, computing normals and computing the bounding box. Welding
+/// and normals are processed by several threads, their times are summed over
+/// all threads. Arguments: number of shapes, quads along each side of a shape.
+void BM_LoadGridOBJ(benchmark::State& state) {
+  const auto num_shapes = static_cast<size_t>(state.range(0));
+  const auto grid_size = static_cast<size_t>(state.range(1));
+
+  const auto obj_path = BenchmarkUtils::createGridOBJ(num_shapes, grid_size);
+  if (obj_path.empty()) {
+    state.SkipWithError("Could not write the grid model.");
+    return;
+  }
+
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  auto& profiler = vulkan_manager.getProfiler();
+  const bool profiler_enabled = profiler.isEnabled();
+  profiler.setEnabled(true);
+  profiler.endFrame();
+
+  double parse_ms = 0.0;
+  double weld_ms = 0.0;
+  double normals_ms = 0.0;
+  double bounding_box_ms = 0.0;
+  for (auto _ : state) {
+    auto obj_mesh = std::make_shared<VulkanEngine::OBJMesh>(obj_path);
+
+    // Gather the scopes of the load into a frame of their own. Releasing the
+    // model isn't part of loading, so its memory is freed right away.
+    state.PauseTiming();
+    profiler.endFrame();
+    const auto& frame = profiler.getFrames().back();
+    const double compute_normals_ms =
+        frame.getScopeTimeMs("OBJMesh::computeNormals");
+    parse_ms += frame.getScopeTimeMs("OBJMesh::parse");
+    weld_ms += frame.getScopeTimeMs("OBJMesh::getShape") - compute_normals_ms;
+    normals_ms += compute_normals_ms;
+    bounding_box_ms += frame.getScopeTimeMs("OBJMesh::computeBoundingBox");
+    obj_mesh.reset();
+    vulkan_manager.getDevice()->waitIdle();
+    vulkan_manager.getDeletionQueue().flush();
+    state.ResumeTiming();
+  }
+
+  profiler.setEnabled(profiler_enabled);
+
+  const auto average = [](double value) {
+    return benchmark::Counter(value, benchmark::Counter::kAvgIterations);
+  };
+  state.counters["parse_ms"] = average(parse_ms);
+  state.counters["weld_ms"] = average(weld_ms);
+  state.counters["normals_ms"] = average(normals_ms);
+  state.counters["bbox_ms"] = average(bounding_box_ms);
+
+  const auto triangle_count =
+      static_cast<int64_t>(num_shapes * grid_size * grid_size * 2);
+  state.counters["triangles"] = static_cast<double>(triangle_count);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          triangle_count);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(
+                              std::filesystem::file_size(obj_path)));
+}
+
+BENCHMARK(BM_LoadGridOBJ)
+    ->ArgNames({"shapes", "grid"})
+    ->Args({1, 256})
+    ->Args({1, 1024})
+    ->Args({64, 64})
+    ->Args({4096, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,201 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/CommandPool.h>
+#include <VulkanEngine/IndirectDrawBuffer.h>
+#include <VulkanEngine/RenderQueue.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// Number of distinct pipeline and shader combinations in the scene.
+constexpr size_t kMaterialCount = 8;
+
+/// Submits draws which cycle through several pipelines and shaders, like a
+/// model with many shapes loaded in file order, then records them inline.
+/// Arguments: sort before recording (0 or 1), number of draws.
+/// Reports the number of binds recorded per frame.
+void BM_RecordRenderQueue(benchmark::State& state) {
+  const bool sort = state.range(0) != 0;
+  const auto draw_count = static_cast<size_t>(state.range(1));
+
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  auto device = vulkan_manager.getDevice();
+
+  std::vector<BenchmarkUtils::DrawResources> materials;
+  for (size_t i = 0; i < kMaterialCount; ++i) {
+    materials.push_back(BenchmarkUtils::createTriangleDrawResources());
+  }
+
+  std::mt19937 random_engine(42);
+  std::uniform_real_distribution<float> depth_distribution(0.1f, 100.0f);
+  std::vector<float> depths(draw_count);
+  for (auto& depth : depths) {
+    depth = depth_distribution(random_engine);
+  }
+
+  VulkanEngine::CommandPool command_pool(device->getVkDevice(),
+                                         device->getGraphicsQueueFamilyIndex());
+  const auto render_pass_info = BenchmarkUtils::getRenderPassBeginInfo();
+
+  VulkanEngine::RenderQueue render_queue;
+  VulkanEngine::RenderStatistics statistics;
+  for (auto _ : state) {
+    render_queue.clear();
+    for (size_t i = 0; i < draw_count; ++i) {
+      const auto& material = materials[i % kMaterialCount];
+      render_queue.submit({material.graphics_pipeline.get(),
+                           material.shader.get(), material.mesh.get(), 0,
+                           depths[i]});
+    }
+
+    if (sort) {
+      render_queue.sort();
+    }
+
+    command_pool.reset();
+    auto command_buffer = command_pool.getCommandBuffer();
+    command_buffer.begin(vk::CommandBufferBeginInfo().setFlags(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    command_buffer.beginRenderPass(render_pass_info,
+                                   vk::SubpassContents::eInline);
+    statistics = render_queue.record(command_buffer, 0, render_queue.size());
+    command_buffer.endRenderPass();
+    command_buffer.end();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(draw_count));
+  state.counters["pipeline_binds"] =
+      static_cast<double>(statistics.pipeline_binds);
+  state.counters["descriptor_set_binds"] =
+      static_cast<double>(statistics.descriptor_set_binds);
+  state.counters["binds"] = static_cast<double>(
+      statistics.pipeline_binds + statistics.descriptor_set_binds +
+      statistics.vertex_buffer_binds + statistics.index_buffer_binds);
+}
+
+BENCHMARK(BM_RecordRenderQueue)
+    ->ArgNames({"sorted", "draws"})
+    ->ArgsProduct({{0, 1}, {1000, 10000, 50000}})
+    ->Unit(benchmark::kMillisecond);
+
+/// Records draws of a single pipeline and shader which all share one set of
+/// geometry buffers, either as individual draws or merged into indirect draws.
+/// Arguments: use an IndirectDrawBuffer (0 or 1), number of draws.
+/// Reports the number of draw commands recorded per frame.
+void BM_RecordRenderQueueIndirect(benchmark::State& state) {
+  const bool indirect = state.range(0) != 0;
+  const auto draw_count = static_cast<size_t>(state.range(1));
+
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  auto device = vulkan_manager.getDevice();
+
+  const auto resources = BenchmarkUtils::createTriangleDrawResources();
+
+  VulkanEngine::IndirectDrawBuffer indirect_draw_buffer;
+  indirect_draw_buffer.reserve(draw_count);
+
+  VulkanEngine::CommandPool command_pool(device->getVkDevice(),
+                                         device->getGraphicsQueueFamilyIndex());
+  const auto render_pass_info = BenchmarkUtils::getRenderPassBeginInfo();
+
+  VulkanEngine::RenderQueue render_queue;
+  VulkanEngine::RenderStatistics statistics;
+  for (auto _ : state) {
+    render_queue.clear();
+    for (size_t i = 0; i < draw_count; ++i) {
+      render_queue.submit({resources.graphics_pipeline.get(),
+                           resources.shader.get(), resources.mesh.get(), 0,
+                           0.0f, static_cast<uint32_t>(i)});
+    }
+    if (indirect) {
+      render_queue.buildBatches();
+    }
+
+    command_pool.reset();
+    auto command_buffer = command_pool.getCommandBuffer();
+    command_buffer.begin(vk::CommandBufferBeginInfo().setFlags(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    command_buffer.beginRenderPass(render_pass_info,
+                                   vk::SubpassContents::eInline);
+    statistics =
+        render_queue.record(command_buffer, 0, render_queue.size(),
+                            indirect ? &indirect_draw_buffer : nullptr);
+    command_buffer.endRenderPass();
+    command_buffer.end();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(draw_count));
+  state.counters["draw_calls"] = static_cast<double>(statistics.draw_calls);
+}
+
+BENCHMARK(BM_RecordRenderQueueIndirect)
+    ->ArgNames({"indirect", "draws"})
+    ->ArgsProduct({{0, 1}, {1000, 10000, 50000}})
+    ->Unit(benchmark::kMillisecond);
+
+/// Radix sort of the render queue on its own.
+/// Arguments: number of draws.
+void BM_SortRenderQueue(benchmark::State& state) {
+  const auto draw_count = static_cast<size_t>(state.range(0));
+
+  std::vector<BenchmarkUtils::DrawResources> materials;
+  for (size_t i = 0; i < kMaterialCount; ++i) {
+    materials.push_back(BenchmarkUtils::createTriangleDrawResources());
+  }
+
+  std::mt19937 random_engine(42);
+  std::uniform_real_distribution<float> depth_distribution(0.1f, 100.0f);
+
+  VulkanEngine::RenderQueue unsorted_queue;
+  for (size_t i = 0; i < draw_count; ++i) {
+    const auto& material = materials[i % kMaterialCount];
+    unsorted_queue.submit({material.graphics_pipeline.get(),
+                           material.shader.get(), material.mesh.get(), 0,
+                           depth_distribution(random_engine)});
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto render_queue = unsorted_queue;
+    state.ResumeTiming();
+    render_queue.sort();
+    benchmark::DoNotOptimize(render_queue.getDrawPackets().data());
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(draw_count));
+}
+
+BENCHMARK(BM_SortRenderQueue)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
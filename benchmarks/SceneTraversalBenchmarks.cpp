@@ -0,0 +1,130 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/Scene.h>
+#include <VulkanEngine/SceneObject.h>
+#include <VulkanEngine/SceneState.h>
+#include <VulkanEngine/TransformHierarchy.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+/// The number of children of each inner node of the benchmarked trees.
+constexpr size_t kBranchingFactor = 8;
+
+/// A node which reads its world transform through the SceneState& hooks.
+class NativeNode : public VulkanEngine::SceneObject {
+ public:
+  NativeNode() { disableLegacyUpdate(); }
+
+ private:
+  void update(VulkanEngine::SceneState& scene_state) override {
+    benchmark::DoNotOptimize(scene_state.getTotalTransform().data());
+    VulkanEngine::SceneObject::update(scene_state);
+  }
+};
+
+/// A node which reads its world transform through the deprecated
+/// std::shared_ptr<SceneState> hooks.
+class LegacyNode : public VulkanEngine::SceneObject {
+ private:
+  void update(std::shared_ptr<VulkanEngine::SceneState> scene_state) override {
+    benchmark::DoNotOptimize(scene_state->getTotalTransform().data());
+    VulkanEngine::SceneObject::update(scene_state);
+  }
+};
+
+/// The root of a benchmarked tree, traverses its descendants the same way
+/// Scene::update() does, without recording any commands.
+class TraversalRoot : public VulkanEngine::SceneObject {
+ public:
+  explicit TraversalRoot(const VulkanEngine::Scene& scene)
+      : scene_state(std::make_shared<VulkanEngine::SceneState>(scene)) {
+    disableLegacyUpdate();
+  }
+
+  ~TraversalRoot() override { releaseTransformHierarchy(hierarchy, objects); }
+
+  /// Visit every node of the tree once.
+  void traverse() {
+    if (isTransformHierarchyDirty()) {
+      releaseTransformHierarchy(hierarchy, objects);
+      buildTransformHierarchy(hierarchy, objects);
+    }
+    hierarchy.update();
+    scene_state->setTransformHierarchy(&hierarchy);
+    scene_state->setTransformNode(0);
+    VulkanEngine::SceneObject::update(*scene_state);
+  }
+
+ private:
+  std::shared_ptr<VulkanEngine::SceneState> scene_state;
+  VulkanEngine::TransformHierarchy hierarchy;
+  std::vector<VulkanEngine::SceneObject*> objects;
+};
+
+/// Traverses a tree of NodeType objects and reports the time per node.
+/// Arguments: number of nodes, excluding the root.
+template <typename NodeType>
+void BM_SceneTraversal(benchmark::State& state) {
+  const auto node_count = static_cast<size_t>(state.range(0));
+
+  VulkanEngine::Scene scene({});
+  TraversalRoot root(scene);
+  std::vector<std::shared_ptr<VulkanEngine::SceneObject>> nodes(node_count);
+  for (size_t i = 0; i < node_count; ++i) {
+    nodes[i] = std::make_shared<NodeType>();
+    if (i < kBranchingFactor) {
+      root.addChildren({nodes[i]});
+    } else {
+      nodes[i / kBranchingFactor - 1]->addChildren({nodes[i]});
+    }
+  }
+  root.traverse();
+
+  for (auto _ : state) {
+    root.traverse();
+  }
+
+  state.counters["ns_per_node"] = benchmark::Counter(
+      static_cast<double>(node_count) * 1e-9,
+      benchmark::Counter::kIsIterationInvariantRate |
+          benchmark::Counter::kInvert);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(node_count));
+}
+
+BENCHMARK_TEMPLATE(BM_SceneTraversal, NativeNode)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_SceneTraversal, LegacyNode)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,394 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/AssetRegistry.h>
+#include <VulkanEngine/OBJMesh.h>
+#include <VulkanEngine/ShaderImage.h>
+#include <VulkanEngine/StagedBuffer.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Width and height of the generated textures.
+constexpr uint32_t kTextureSize = 4096;
+
+/// The formats the textures of generated models are stored in.
+enum class TextureFormat : uint8_t {
+  /// Run length encoded TGA, decoded to R8G8B8A8 by stb_image.
+  eTGA,
+
+  /// DDS with BC1 blocks and all mip levels.
+  eBC1,
+
+  /// DDS with BC7 blocks and all mip levels.
+  eBC7
+};
+
+/// Write a 32 bit run length encoded TGA image, which stb_image decodes.
+/// Pixels are written in runs of 128 so that the file stays small while
+/// decoding still touches every texel.
+/// \param path The path of the image.
+/// \param seed Varies the colors of the image.
+/// \return True if the image was written.
+bool writeTexture(const std::filesystem::path& path, uint32_t seed) {
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  // Image type 10 is run length encoded true color, descriptor 0x28 means 8
+  // bits of alpha and the first row at the top.
+  std::array<uint8_t, 18> header = {};
+  header[2] = 10;
+  header[12] = kTextureSize & 0xff;
+  header[13] = kTextureSize >> 8;
+  header[14] = kTextureSize & 0xff;
+  header[15] = kTextureSize >> 8;
+  header[16] = 32;
+  header[17] = 0x28;
+  file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+  constexpr uint32_t kRunLength = 128;
+  std::vector<uint8_t> row;
+  for (uint32_t y = 0; y < kTextureSize; ++y) {
+    row.clear();
+    for (uint32_t x = 0; x < kTextureSize; x += kRunLength) {
+      row.push_back(0x80 | (kRunLength - 1));
+      row.push_back(static_cast<uint8_t>(x + seed * 31));
+      row.push_back(static_cast<uint8_t>(y + seed * 17));
+      row.push_back(static_cast<uint8_t>(seed * 67));
+      row.push_back(0xff);
+    }
+    file.write(reinterpret_cast<const char*>(row.data()), row.size());
+  }
+  return static_cast<bool>(file);
+}
+
+/// Write a DDS file with BC1 or BC7 blocks of pseudo random data and all mip
+/// levels.
+/// \param path The path of the file.
+/// \param format eBC1 or eBC7.
+/// \param seed Varies the data of the texture.
+/// \return True if the file was written.
+bool writeCompressedTexture(const std::filesystem::path& path,
+                            TextureFormat format, uint32_t seed) {
+  std::ofstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  const bool bc1 = format == TextureFormat::eBC1;
+  const uint32_t block_size = bc1 ? 8 : 16;
+  uint32_t num_levels = 1;
+  while ((kTextureSize >> num_levels) > 0) {
+    ++num_levels;
+  }
+
+  std::vector<uint8_t> header;
+  const auto append = [&header](uint32_t value) {
+    for (size_t i = 0; i < 4; ++i) {
+      header.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+  };
+  const auto fourCC = [](const char* code) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      value |= static_cast<uint32_t>(code[i]) << (8 * i);
+    }
+    return value;
+  };
+  append(fourCC("DDS "));
+  append(124);      // dwSize
+  append(0xA1007);  // dwFlags, with mip map count and linear size
+  append(kTextureSize);
+  append(kTextureSize);
+  append(kTextureSize / 4 * kTextureSize / 4 * block_size);
+  append(0);  // dwDepth
+  append(num_levels);
+  header.resize(76, 0);
+  append(32);   // ddspf.dwSize
+  append(0x4);  // ddspf.dwFlags, DDPF_FOURCC
+  append(fourCC(bc1 ? "DXT1" : "DX10"));
+  header.resize(108, 0);
+  append(0x401008);  // dwCaps, a texture with mip levels
+  header.resize(128, 0);
+  if (!bc1) {
+    append(98);  // DXGI_FORMAT_BC7_UNORM
+    append(3);   // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+    append(0);   // miscFlag
+    append(1);   // arraySize
+    append(0);   // miscFlags2
+  }
+  file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+  // Xorshift, so that the blocks of every texture differ.
+  uint32_t state = seed * 2654435761u + 1;
+  std::vector<uint8_t> row;
+  for (uint32_t level = 0; level < num_levels; ++level) {
+    const uint32_t num_blocks = std::max((kTextureSize >> level) / 4, 1u);
+    for (uint32_t y = 0; y < num_blocks; ++y) {
+      row.resize(static_cast<size_t>(num_blocks) * block_size);
+      for (size_t i = 0; i < row.size(); i += 4) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        std::memcpy(row.data() + i, &state, 4);
+      }
+      if (!bc1) {
+        // Use BC7 mode 6 for every block.
+        for (size_t i = 0; i < row.size(); i += block_size) {
+          row[i] = 0x40 | (row[i] & 0x80);
+        }
+      }
+      file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+  }
+  return static_cast<bool>(file);
+}
+
+/// Write an OBJ file of quads side by side, each with its own material and
+/// kTextureSize squared texture, unless it was written by an earlier run.
+/// \param num_textures The number of quads and textures.
+/// \param format The format to store the textures in.
+/// \return The path of the OBJ file, empty if it could not be written.
+std::filesystem::path createTexturedModel(
+    size_t num_textures, TextureFormat format = TextureFormat::eTGA) {
+  const auto directory = std::filesystem::temp_directory_path() /
+                         ("VulkanEngineTextureBenchmark" +
+                          std::to_string(num_textures) + "_" +
+                          std::to_string(static_cast<int>(format)));
+  const auto obj_path = directory / "quads.obj";
+  if (std::filesystem::exists(obj_path)) {
+    return obj_path;
+  }
+
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  std::ofstream mtl_file(directory / "quads.mtl");
+  std::ofstream obj_file(directory / "quads.obj.tmp");
+  if (error || !mtl_file || !obj_file) {
+    return std::filesystem::path();
+  }
+
+  obj_file << "mtllib quads.mtl\n";
+  for (size_t i = 0; i < num_textures; ++i) {
+    const auto seed = static_cast<uint32_t>(i);
+    const std::string texture_name =
+        "texture" + std::to_string(i) +
+        (format == TextureFormat::eTGA ? ".tga" : ".dds");
+    if (format == TextureFormat::eTGA
+            ? !writeTexture(directory / texture_name, seed)
+            : !writeCompressedTexture(directory / texture_name, format,
+                                      seed)) {
+      return std::filesystem::path();
+    }
+
+    mtl_file << "newmtl material" << i << "\n"
+             << "Kd 1.0 1.0 1.0\n"
+             << "map_Kd " << texture_name << "\n";
+
+    const float x = static_cast<float>(i);
+    obj_file << "o quad" << i << "\n"
+             << "v " << x << " 0 0\n"
+             << "v " << x + 1.0f << " 0 0\n"
+             << "v " << x + 1.0f << " 1 0\n"
+             << "v " << x << " 1 0\n"
+             << "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+             << "usemtl material" << i << "\n";
+    const size_t first = i * 4 + 1;
+    obj_file << "f " << first << "/" << first << " " << first + 1 << "/"
+             << first + 1 << " " << first + 2 << "/" << first + 2 << " "
+             << first + 3 << "/" << first + 3 << "\n";
+  }
+
+  // Only publish the model once everything has been written.
+  obj_file.close();
+  std::filesystem::rename(directory / "quads.obj.tmp", obj_path, error);
+  return error ? std::filesystem::path() : obj_path;
+}
+
+/// Loads an OBJ file of quads with a distinct 4K texture each, waiting until
+/// everything has been decoded and uploaded. Textures are decoded by the
+/// worker threads of the AssetRegistry and uploaded in a single submission.
+/// Arguments: number of decoding threads (0 for one per hardware thread),
+/// number of textures.
+void BM_LoadTexturedOBJ(benchmark::State& state) {
+  const auto num_threads = static_cast<size_t>(state.range(0));
+  const auto num_textures = static_cast<size_t>(state.range(1));
+
+  const auto obj_path = createTexturedModel(num_textures);
+  if (obj_path.empty()) {
+    state.SkipWithError("Could not write the textured model.");
+    return;
+  }
+
+  auto& asset_registry =
+      VulkanEngine::VulkanManager::getInstance().getAssetRegistry();
+  asset_registry.setNumBackgroundThreads(num_threads);
+
+  for (auto _ : state) {
+    auto obj_mesh = std::make_shared<VulkanEngine::OBJMesh>(obj_path);
+
+    // Releasing the model frees its textures, which isn't part of loading.
+    state.PauseTiming();
+    obj_mesh.reset();
+    state.ResumeTiming();
+  }
+
+  state.counters["threads"] =
+      static_cast<double>(asset_registry.getNumBackgroundThreads());
+  asset_registry.setNumBackgroundThreads(0);
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(num_textures));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(num_textures) * kTextureSize *
+                          kTextureSize * 4);
+}
+
+BENCHMARK(BM_LoadTexturedOBJ)
+    ->ArgNames({"threads", "textures"})
+    ->ArgsProduct({{1, 0}, {32}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/// Loads an OBJ file of quads with a distinct 4K texture each, stored either
+/// as TGA images which are decoded to R8G8B8A8 and have their mip levels
+/// generated on the GPU, or as DDS files with precomputed mip levels which
+/// are uploaded compressed, or transcoded if the device can't sample them.
+/// Reports the device memory used by the textures.
+/// Arguments: texture format (0 TGA, 1 BC1, 2 BC7), number of textures.
+void BM_LoadTextureFormat(benchmark::State& state) {
+  const auto format = static_cast<TextureFormat>(state.range(0));
+  const auto num_textures = static_cast<size_t>(state.range(1));
+
+  const auto obj_path = createTexturedModel(num_textures, format);
+  if (obj_path.empty()) {
+    state.SkipWithError("Could not write the textured model.");
+    return;
+  }
+
+  size_t texture_memory_size = 0;
+  for (auto _ : state) {
+    auto obj_mesh = std::make_shared<VulkanEngine::OBJMesh>(obj_path);
+
+    state.PauseTiming();
+    texture_memory_size = obj_mesh->getTextureMemorySize();
+    obj_mesh.reset();
+    state.ResumeTiming();
+  }
+
+  state.counters["texture_memory_mb"] =
+      static_cast<double>(texture_memory_size) / (1 << 20);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(num_textures));
+}
+
+BENCHMARK(BM_LoadTextureFormat)
+    ->ArgNames({"format", "textures"})
+    ->ArgsProduct({{0, 1, 2}, {8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+/// Uploads 2K sRGB textures and generates their mip levels, either with one
+/// blit and barrier per level or with a single compute dispatch per texture.
+/// Images are created outside of the timed region, the timed region records
+/// the uploads into one command buffer and waits for it to execute.
+/// Arguments: mipmap mode (0 blit, 1 compute), number of textures.
+void BM_GenerateMipmaps(benchmark::State& state) {
+  using SRGBTexture2D = VulkanEngine::StagedBuffer<VulkanEngine::ShaderImage<
+      vk::Format::eR8G8B8A8Srgb, vk::ImageType::e2D, vk::ImageTiling::eOptimal,
+      vk::SampleCountFlagBits::e1>>;
+  constexpr uint32_t kSize = 2048;
+
+  const auto mipmap_mode =
+      static_cast<VulkanEngine::MipmapMode>(state.range(0));
+  const auto num_textures = static_cast<size_t>(state.range(1));
+
+  std::vector<uint8_t> pixels(static_cast<size_t>(kSize) * kSize * 4);
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    pixels[i] = static_cast<uint8_t>(i * 7 + i / (kSize * 4) * 13);
+  }
+
+  const auto create_textures = [&]() {
+    std::vector<std::shared_ptr<SRGBTexture2D>> textures;
+    for (size_t i = 0; i < num_textures; ++i) {
+      auto texture = std::make_shared<SRGBTexture2D>(
+          vk::ImageLayout::eUndefined,
+          vk::ImageUsageFlagBits::eTransferDst |
+              vk::ImageUsageFlagBits::eTransferSrc |
+              vk::ImageUsageFlagBits::eSampled,
+          VMA_MEMORY_USAGE_GPU_ONLY, kSize, kSize, 1, 4, 1, 1,
+          vk::DescriptorType::eCombinedImageSampler,
+          vk::ShaderStageFlagBits::eFragment, mipmap_mode);
+      texture->setImageData(pixels.data());
+      textures.push_back(texture);
+    }
+    return textures;
+  };
+
+  const auto generate = [](const auto& textures) {
+    VulkanEngine::SingleUsageCommandBuffer command_buffer;
+    command_buffer.beginSingleUsageCommandBuffer();
+    for (const auto& texture : textures) {
+      texture->transferBuffer(command_buffer.single_use_command_buffer);
+    }
+    command_buffer.endSingleUsageCommandBuffer();
+  };
+
+  // Compiles the compute shader before timing.
+  auto textures = create_textures();
+  if (textures.front()->getMipmapMode() != mipmap_mode) {
+    state.SkipWithError("Compute mipmap generation isn't supported.");
+    return;
+  }
+  generate(textures);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    textures = create_textures();
+    state.ResumeTiming();
+
+    generate(textures);
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(num_textures));
+}
+
+BENCHMARK(BM_GenerateMipmaps)
+    ->ArgNames({"mode", "textures"})
+    ->ArgsProduct({{0, 1}, {8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
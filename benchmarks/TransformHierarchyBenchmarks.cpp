@@ -0,0 +1,146 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/TransformHierarchy.h>
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+/// The number of children of each inner node of the benchmarked trees.
+constexpr size_t kBranchingFactor = 8;
+
+/// \return A random rigid transform.
+/// \param random_engine The random engine to use.
+Eigen::Matrix4f createRandomTransform(std::mt19937& random_engine) {
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  const Eigen::Affine3f transform(
+      Eigen::Translation3f(distribution(random_engine),
+                           distribution(random_engine),
+                           distribution(random_engine)) *
+      Eigen::AngleAxisf(distribution(random_engine),
+                        Eigen::Vector3f::UnitY()));
+  return transform.matrix();
+}
+
+/// Updates the world transforms of a tree in which a percentage of the nodes
+/// moved since the last update. Arguments: number of nodes, percentage of
+/// nodes moved per iteration.
+void BM_TransformHierarchyUpdate(benchmark::State& state) {
+  const auto node_count = static_cast<size_t>(state.range(0));
+  const auto moved_percentage = static_cast<size_t>(state.range(1));
+
+  std::mt19937 random_engine(42);
+  VulkanEngine::TransformHierarchy hierarchy;
+  hierarchy.reserve(node_count);
+  for (size_t i = 0; i < node_count; ++i) {
+    hierarchy.addNode(
+        i == 0 ? VulkanEngine::TransformHierarchy::kNoParent
+               : static_cast<uint32_t>((i - 1) / kBranchingFactor),
+        createRandomTransform(random_engine));
+  }
+  hierarchy.update();
+
+  const size_t moved_count = node_count * moved_percentage / 100;
+  std::uniform_int_distribution<uint32_t> node_distribution(
+      0, static_cast<uint32_t>(node_count - 1));
+  const Eigen::Matrix4f moved_transform = createRandomTransform(random_engine);
+
+  size_t updated_nodes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < moved_count; ++i) {
+      hierarchy.setLocalTransform(node_distribution(random_engine),
+                                  moved_transform);
+    }
+    state.ResumeTiming();
+
+    hierarchy.update();
+    updated_nodes += hierarchy.getNumUpdatedNodes();
+    benchmark::ClobberMemory();
+  }
+
+  state.counters["updated_nodes"] = benchmark::Counter(
+      static_cast<double>(updated_nodes), benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(node_count));
+}
+
+BENCHMARK(BM_TransformHierarchyUpdate)
+    ->ArgsProduct({{10000, 100000, 1000000}, {1, 100}})
+    ->Unit(benchmark::kMicrosecond);
+
+/// A node of a tree traversed recursively, as the scene graph was before
+/// world transforms were flattened.
+struct RecursiveNode {
+  Eigen::Matrix4f transform;
+  std::vector<std::shared_ptr<RecursiveNode>> children;
+};
+
+/// Visit a node by multiplying the running transform on the way down and by
+/// the inverse on the way back up.
+/// \param node The node to visit.
+/// \param total_transform The running transform.
+void traverse(const std::shared_ptr<RecursiveNode> node,
+              Eigen::Matrix4f& total_transform) {
+  total_transform = total_transform * node->transform;
+  benchmark::DoNotOptimize(total_transform.data());
+  for (const auto& child : node->children) {
+    traverse(child, total_transform);
+  }
+  total_transform = total_transform * node->transform.inverse();
+}
+
+/// Computes the world transform of every node of the same tree as
+/// BM_TransformHierarchyUpdate by recursive traversal. Arguments: number of
+/// nodes.
+void BM_RecursiveTransformTraversal(benchmark::State& state) {
+  const auto node_count = static_cast<size_t>(state.range(0));
+
+  std::mt19937 random_engine(42);
+  std::vector<std::shared_ptr<RecursiveNode>> nodes(node_count);
+  for (size_t i = 0; i < node_count; ++i) {
+    nodes[i] = std::make_shared<RecursiveNode>();
+    nodes[i]->transform = createRandomTransform(random_engine);
+    if (i > 0) {
+      nodes[(i - 1) / kBranchingFactor]->children.push_back(nodes[i]);
+    }
+  }
+
+  for (auto _ : state) {
+    Eigen::Matrix4f total_transform = Eigen::Matrix4f::Identity();
+    traverse(nodes.front(), total_transform);
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(node_count));
+}
+
+BENCHMARK(BM_RecursiveTransformTraversal)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
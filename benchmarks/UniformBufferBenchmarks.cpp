@@ -0,0 +1,74 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/UniformBuffer.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <Eigen/Eigen>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+/// Writes a new model view projection matrix set into every one of a number
+/// of uniform buffers, the way each mesh of a scene updates the buffer of the
+/// current frame in flight before it is drawn. Arguments: number of buffers.
+/// Reports the throughput in bytes and buffers per second.
+void BM_UpdateUniformBuffers(benchmark::State& state) {
+  const auto buffer_count = static_cast<size_t>(state.range(0));
+
+  std::vector<std::shared_ptr<VulkanEngine::UniformBuffer<
+      BenchmarkUtils::MvpUbo>>>
+      uniform_buffers;
+  for (size_t i = 0; i < buffer_count; ++i) {
+    uniform_buffers.push_back(
+        std::make_shared<VulkanEngine::UniformBuffer<BenchmarkUtils::MvpUbo>>(
+            0));
+  }
+
+  BenchmarkUtils::MvpUbo ubo;
+  ubo.view = Eigen::Matrix4f::Identity();
+  ubo.projection = Eigen::Matrix4f::Identity();
+  float offset = 0.0f;
+  for (auto _ : state) {
+    for (const auto& uniform_buffer : uniform_buffers) {
+      ubo.model =
+          Eigen::Affine3f(Eigen::Translation3f(offset, 0.0f, 0.0f)).matrix();
+      uniform_buffer->updateBuffer(&ubo, sizeof(ubo));
+      offset += 1.0f;
+    }
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(buffer_count));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(buffer_count * sizeof(ubo)));
+}
+
+BENCHMARK(BM_UpdateUniformBuffers)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,67 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <BenchmarkUtils.h>
+#include <VulkanEngine/GLFWWindow.h>
+#include <VulkanEngine/VulkanManager.h>
+#include <benchmark/benchmark.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  // All benchmarks share a single invisible window and engine instance.
+  auto window = std::make_shared<VulkanEngine::GLFWWindow>(
+      BenchmarkUtils::kWindowWidth, BenchmarkUtils::kWindowHeight,
+      "VulkanEngineBenchmarks", false);
+  if (!window->initialize(true)) {
+    std::cerr << "Could not create window for benchmarks." << std::endl;
+    return 1;
+  }
+
+  auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
+  if (!vulkan_manager.initialize(window)) {
+    return 1;
+  }
+  BenchmarkUtils::getWindow() = window;
+
+  // Results are only comparable between runs on the same device.
+  const auto device = vulkan_manager.getDevice();
+  const auto api_version = device->getApiVersion();
+  benchmark::AddCustomContext("vulkan_device", device->getName());
+  benchmark::AddCustomContext(
+      "vulkan_api_version",
+      std::to_string(VK_API_VERSION_MAJOR(api_version)) + "." +
+          std::to_string(VK_API_VERSION_MINOR(api_version)) + "." +
+          std::to_string(VK_API_VERSION_PATCH(api_version)));
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  BenchmarkUtils::getWindow().reset();
+  VulkanEngine::VulkanManager::resetInstance();
+  return 0;
+}
@@ -44,7 +44,23 @@ cxxopts::ParseResult setupProgramOptions(int argc, char** argv) {
       "m,mtl", "Path where associated mtl file is",
       cxxopts::value<std::string>())("w,width", "Window width in pixels",
                                      cxxopts::value<unsigned>())(
-      "h,height", "Window height in pixels", cxxopts::value<unsigned>());
+      "h,height", "Window height in pixels", cxxopts::value<unsigned>())(
+      "stream-textures", "Stream texture mip levels",
+      cxxopts::value<bool>())(
+      "texture-budget",
+      "Device memory streamed textures may use in MiB, derived from the "
+      "device's memory budget by default",
+      cxxopts::value<unsigned>())(
+      "memory-report",
+      "Write a JSON snapshot of the engine's memory usage to this path on "
+      "exit",
+      cxxopts::value<std::string>())(
+      "defragment", "Compact device memory during idle frames",
+      cxxopts::value<bool>())(
+      "profile",
+      "Profile the CPU and GPU time of each frame and write the most recent "
+      "frames as a Chrome trace to this path on exit",
+      cxxopts::value<std::string>());
 
   return options.parse(argc, argv);
 }
@@ -76,6 +92,23 @@ int main(int argc, char** argv) {
     return 1;
   }
 
+  // Textures must be streamed before any are loaded.
+  auto& texture_streamer = vulkan_manager.getTextureStreamer();
+  if (option_result.count("stream-textures")) {
+    texture_streamer.setEnabled(option_result["stream-textures"].as<bool>());
+  }
+  if (option_result.count("texture-budget")) {
+    texture_streamer.setMemoryBudget(
+        static_cast<size_t>(option_result["texture-budget"].as<unsigned>())
+        << 20);
+  }
+  if (option_result.count("defragment")) {
+    vulkan_manager.getMemoryDefragmenter().setEnabled(
+        option_result["defragment"].as<bool>());
+  }
+  auto& profiler = vulkan_manager.getProfiler();
+  profiler.setEnabled(option_result.count("profile") > 0);
+
   // Create a new scene.
   auto windows = std::vector<std::shared_ptr<VulkanEngine::Window>>({window});
   auto scene = std::make_shared<VulkanEngine::Scene>(windows);
@@ -105,10 +138,14 @@ int main(int argc, char** argv) {
     mtl_path = option_result["mtl"].as<std::string>();
   }
 
+  // The mesh is loaded in the background and shapes appear as they are
+  // uploaded, so the window stays responsive while loading large files.
   try {
     auto obj_file_system_path = std::filesystem::path(obj_path);
-    obj_mesh.reset(new VulkanEngine::OBJMesh(obj_file_system_path,
-                                             std::filesystem::path(mtl_path)));
+    obj_mesh.reset(new VulkanEngine::OBJMesh(
+        obj_file_system_path, std::filesystem::path(mtl_path),
+        std::shared_ptr<VulkanEngine::Shader>(),
+        VulkanEngine::OBJMesh::LoadMode::eAsynchronous));
     title += " (" + obj_file_system_path.filename().string() + ")";
   } catch (const std::exception& e) {
     std::cerr << "Failed to load obj mesh: " << e.what() << std::endl;
@@ -119,15 +156,8 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  // Set initial transform at center and scale based on bounding box.
-  auto transform = Eigen::Affine3f::Identity();
-  auto bounding_box = obj_mesh->getBoundingBox();
-  auto bbox_size = bounding_box.max - bounding_box.min;
-  auto center = (bounding_box.max + bounding_box.min) * 0.5f;
-  auto mesh_scale = 1.5 / std::max({bbox_size(0), bbox_size(1), bbox_size(2)});
-  transform.scale(mesh_scale);
-  transform.translation() -= center * mesh_scale;
-  obj_mesh->setTransform(transform.matrix());
+  // The initial transform is set once the bounds of the mesh are known.
+  bool obj_mesh_placed = false;
 
   // Add the Camera and OBJMesh to the scene.
   scene->addChildren({camera, obj_mesh});
@@ -157,9 +187,35 @@ int main(int argc, char** argv) {
         if (frame_rate_elapsed_time >= std::chrono::seconds(1)) {
           double frame_rate = static_cast<double>(frame_count) /
                               frame_rate_elapsed_time.count();
+          std::string loading;
+          if (!obj_mesh->isLoaded()) {
+            loading = " loading " +
+                      std::to_string(static_cast<int>(
+                          obj_mesh->getLoadProgress() * 100.0f)) +
+                      "%";
+          }
+          const auto memory_snapshot = vulkan_manager.getDevice()
+                                           ->getMemoryTelemetry()
+                                           .getSnapshot();
+          const std::string memory =
+              " " + std::to_string(memory_snapshot.bytes >> 20) + " MiB (" +
+              std::to_string(memory_snapshot.peak_bytes >> 20) + " MiB peak)";
+          std::string statistics;
+#ifdef ENABLE_FRAME_STATISTICS
+          using Counter = VulkanEngine::FrameStatistics::Counter;
+          const auto& frame_statistics = vulkan_manager.getFrameStatistics();
+          statistics =
+              " " +
+              std::to_string(static_cast<int>(
+                  frame_statistics.getAverage(Counter::eDrawCalls))) +
+              " draws " +
+              std::to_string(static_cast<int>(
+                  frame_statistics.getAverage(Counter::eTriangles))) +
+              " triangles";
+#endif
           window->setTitle(title + " " +
                            std::to_string(static_cast<int>(frame_rate)) +
-                           " fps");
+                           " fps" + memory + statistics + loading);
           frame_count = 0;
           frame_rate_start_time = std::chrono::steady_clock::now();
         }
@@ -202,10 +258,42 @@ int main(int argc, char** argv) {
       }
     }
 
+    // Set initial transform at center and scale based on bounding box.
+    BoundingBox<Eigen::Vector3f> bounding_box;
+    if (!obj_mesh_placed && obj_mesh->getLocalBoundingBox(bounding_box)) {
+      auto transform = Eigen::Affine3f::Identity();
+      auto bbox_size = bounding_box.max - bounding_box.min;
+      auto center = (bounding_box.max + bounding_box.min) * 0.5f;
+      auto mesh_scale =
+          1.5 / std::max({bbox_size(0), bbox_size(1), bbox_size(2)});
+      transform.scale(mesh_scale);
+      transform.translation() -= center * mesh_scale;
+      obj_mesh->setTransform(transform.matrix());
+      obj_mesh_placed = true;
+    }
+
     scene->update();
     vulkan_manager.drawImage();
     ++frame_count;
   }
 
+  if (option_result.count("profile")) {
+    const auto path = option_result["profile"].as<std::string>();
+    vulkan_manager.getDevice()->waitIdle();
+    profiler.flush();
+    if (!profiler.writeChromeTrace(path)) {
+      std::cerr << "Could not write profile to " << path << std::endl;
+      return 1;
+    }
+  }
+
+  if (option_result.count("memory-report")) {
+    const auto path = option_result["memory-report"].as<std::string>();
+    if (!vulkan_manager.getDevice()->getMemoryTelemetry().writeJSON(path)) {
+      std::cerr << "Could not write memory report to " << path << std::endl;
+      return 1;
+    }
+  }
+
   return 0;
 }
@@ -24,6 +24,7 @@
 #include <VulkanEngine/GraphicsPipeline.h>
 #include <VulkanEngine/IndexAttribute.h>
 #include <VulkanEngine/Mesh.h>
+#include <VulkanEngine/RenderQueue.h>
 #include <VulkanEngine/Scene.h>
 #include <VulkanEngine/Shader.h>
 #include <VulkanEngine/ShaderModule.h>
@@ -98,7 +99,7 @@ std::string getFragmentShaderString() {
 
 class TriangleObject : public VulkanEngine::SceneObject {
  public:
-  TriangleObject() = default;
+  TriangleObject() { disableLegacyUpdate(); }
 
   void initialize() {
     auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
@@ -185,18 +186,18 @@ class TriangleObject : public VulkanEngine::SceneObject {
   }
 
  private:
-  void update(std::shared_ptr<VulkanEngine::SceneState> scene_state) override {
+  void update(VulkanEngine::SceneState& scene_state) override {
     MvpUbo ubo_data;
-    ubo_data.projection = scene_state->getProjectionMatrix();
-    ubo_data.view = scene_state->getViewMatrix();
-    ubo_data.model = scene_state->getTotalTransform();
+    ubo_data.projection = scene_state.getProjectionMatrix();
+    ubo_data.view = scene_state.getViewMatrix();
+    ubo_data.model = scene_state.getTotalTransform();
 
     for (auto& ub : mvp_buffers) {
       ub->updateBuffer(&ubo_data, sizeof(ubo_data));
     }
 
     auto& vulkan_manager = VulkanEngine::VulkanManager::getInstance();
-    const auto window = scene_state->getScene().getActiveWindow();
+    const auto window = scene_state.getScene().getActiveWindow();
 
     if (graphics_pipeline_updated) {
       graphics_pipeline_updated = !window->sizeHasChanged();
@@ -216,15 +217,11 @@ class TriangleObject : public VulkanEngine::SceneObject {
       graphics_pipeline->createGraphicsPipeline(mesh, shader);
     }
 
-    graphics_pipeline->bindPipeline();
-
-    auto current_command_buffer = vulkan_manager.getCurrentCommandBuffer();
-    mesh->bindVertexBuffers(current_command_buffer);
-    mesh->bindIndexBuffer(current_command_buffer);
-    shader->bindDescriptorSet(
-        current_command_buffer,
-        static_cast<uint32_t>(vulkan_manager.getCurrentFrame()));
-    mesh->draw(current_command_buffer);
+    // Draws are recorded by the scene once traversal is done.
+    VulkanEngine::DrawPacket draw_packet = {
+        graphics_pipeline.get(), shader.get(), mesh.get(),
+        static_cast<uint32_t>(vulkan_manager.getCurrentFrame())};
+    scene_state.getRenderQueue().submit(draw_packet);
 
     graphics_pipeline_updated = true;
     VulkanEngine::SceneObject::update(scene_state);
@@ -0,0 +1,196 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_ASSETREGISTRY_H_
+#define INCLUDE_VULKANENGINE_ASSETREGISTRY_H_
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace VulkanEngine {
+
+/// Shares loaded assets such as meshes and textures so that each is only
+/// loaded once. Assets are identified by their type and a key, usually made
+/// from the canonical path of the file they were loaded from. The registry
+/// only keeps weak references, an asset is destroyed as soon as the last
+/// object using it lets go of it and is loaded again when requested next.
+/// Concurrent requests for an asset which is being loaded wait for that load
+/// instead of starting their own. Assets can also be loaded in the
+/// background by a fixed set of worker threads, see loadAsync(). All methods
+/// are thread safe.
+class AssetRegistry {
+ public:
+  /// Constructor.
+  AssetRegistry();
+
+  /// Destructor. Waits for background loads and joins the worker threads.
+  ~AssetRegistry();
+
+  /// Delete copy constructor, the registry owns threads.
+  AssetRegistry(const AssetRegistry&) = delete;
+
+  /// Delete assignment operator, the registry owns threads.
+  void operator=(const AssetRegistry&) = delete;
+
+  /// Get an asset, loading it if it isn't alive. If another thread is loading
+  /// the same asset, waits for it and returns its result. The loader is
+  /// called without holding any lock, so it may load other assets.
+  /// \tparam T The type of the asset.
+  /// \param key The key identifying the asset, see getKey().
+  /// \param loader Loads the asset. May return null or throw if the asset
+  /// can't be loaded, in which case nothing is registered and the result is
+  /// passed on to every waiting request.
+  /// \return The asset, null if the loader returned null.
+  template <typename T>
+  std::shared_ptr<T> load(const std::string& key,
+                          const std::function<std::shared_ptr<T>()>& loader) {
+    return std::static_pointer_cast<T>(
+        loadAsset(std::type_index(typeid(T)), key,
+                  [&loader]() -> std::shared_ptr<void> { return loader(); }));
+  }
+
+  /// Get an asset without blocking. If the asset isn't alive, it is loaded by
+  /// one of the worker threads of the registry, see load(). Background loads
+  /// run in the order they were requested.
+  /// \tparam T The type of the asset.
+  /// \param key The key identifying the asset, see getKey().
+  /// \param loader Loads the asset. Called from a worker thread, so it must
+  /// not reference anything which may be destroyed before it runs.
+  /// \return A future holding the asset, or the exception thrown by loader.
+  template <typename T>
+  std::shared_future<std::shared_ptr<T>> loadAsync(
+      const std::string& key,
+      const std::function<std::shared_ptr<T>()>& loader) {
+    if (auto asset = find<T>(key)) {
+      std::promise<std::shared_ptr<T>> loaded;
+      loaded.set_value(asset);
+      return loaded.get_future().share();
+    }
+
+    auto task = std::make_shared<std::packaged_task<std::shared_ptr<T>()>>(
+        [this, key, loader]() { return load<T>(key, loader); });
+    auto result = task->get_future().share();
+    startBackgroundLoad([task]() { (*task)(); });
+    return result;
+  }
+
+  /// Wait until all background loads have finished, including loads started
+  /// while waiting.
+  void waitForBackgroundLoads();
+
+  /// Set the number of worker threads used by loadAsync(). Waits for
+  /// background loads to finish if the workers are running, so it must not
+  /// be called while other threads may start background loads.
+  /// \param num_threads The number of threads, 0 to use one per hardware
+  /// thread.
+  void setNumBackgroundThreads(size_t num_threads);
+
+  /// \return The number of worker threads used by loadAsync().
+  size_t getNumBackgroundThreads() const;
+
+  /// \return An asset if it is alive, null otherwise. Doesn't wait for
+  /// assets which are being loaded.
+  /// \tparam T The type of the asset.
+  /// \param key The key identifying the asset.
+  template <typename T>
+  std::shared_ptr<T> find(const std::string& key) {
+    return std::static_pointer_cast<T>(
+        findAsset(std::type_index(typeid(T)), key));
+  }
+
+  /// Remove the entries of assets which have been destroyed.
+  void prune();
+
+  /// \return The number of assets which are alive. Prunes the registry.
+  size_t getNumAssets();
+
+  /// \return A key identifying a file, the canonical form of its path. Paths
+  /// which refer to the same file yield the same key, as long as the file
+  /// exists.
+  /// \param path The path of the file.
+  static std::string getKey(const std::filesystem::path& path);
+
+ private:
+  /// Identifies an asset by its type and key.
+  using AssetId = std::pair<std::type_index, std::string>;
+
+  /// Hashes an AssetId.
+  struct AssetIdHash {
+    size_t operator()(const AssetId& asset_id) const;
+  };
+
+  /// The state of a registered asset.
+  struct Entry {
+    /// The asset, expired once every user let go of it.
+    std::weak_ptr<void> asset;
+
+    /// Valid while the asset is being loaded.
+    std::shared_future<std::shared_ptr<void>> pending_load;
+  };
+
+  /// Type erased implementation of load().
+  std::shared_ptr<void> loadAsset(
+      const std::type_index& type, const std::string& key,
+      const std::function<std::shared_ptr<void>()>& loader);
+
+  /// Type erased implementation of find().
+  std::shared_ptr<void> findAsset(const std::type_index& type,
+                                  const std::string& key);
+
+  /// Queue a task for the worker threads, starting them if necessary.
+  /// \param task The task to run. Must not throw.
+  void startBackgroundLoad(const std::function<void()>& task);
+
+  /// Main loop of a worker thread.
+  void workerLoop();
+
+  /// Stop and join the worker threads. There must be no background loads.
+  void stopWorkers();
+
+  /// Protects entries.
+  std::mutex mutex;
+
+  /// The registered assets.
+  std::unordered_map<AssetId, Entry, AssetIdHash> entries;
+
+  /// Protects the background load state below.
+  mutable std::mutex background_mutex;
+
+  /// Signalled when a task is queued or the registry is destroyed.
+  std::condition_variable background_task_available;
+
+  /// Signalled when the last background task finishes.
+  std::condition_variable background_tasks_done;
+
+  /// Background tasks which haven't started yet.
+  std::deque<std::function<void()>> background_tasks;
+
+  /// Number of background tasks which are running.
+  size_t num_running_background_tasks;
+
+  /// Set when the worker threads should exit.
+  bool stopping;
+
+  /// The number of worker threads, 0 for one per hardware thread.
+  size_t num_background_threads;
+
+  /// The worker threads, started by the first background load.
+  std::vector<std::thread> workers;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_ASSETREGISTRY_H_
@@ -0,0 +1,168 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_BOUNDINGVOLUMEHIERARCHY_H_
+#define INCLUDE_VULKANENGINE_BOUNDINGVOLUMEHIERARCHY_H_
+
+#include <VulkanEngine/BoundingBox.h>
+#include <VulkanEngine/Frustum.h>
+
+#include <Eigen/Eigen>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine {
+
+/// A binary tree of axis aligned boxes over a set of primitives, each given
+/// by its bounding box. Used to find the primitives inside of a view frustum
+/// or hit by a ray without testing all of them. The tree is built top down
+/// with a binned surface area heuristic, with large subtrees built in
+/// parallel. When primitives move, the boxes of the tree can be refit
+/// without rebuilding it. Queries reuse internal scratch memory, so a
+/// hierarchy must not be queried from several threads at once.
+class BoundingVolumeHierarchy {
+ public:
+  /// A primitive hit by a ray.
+  struct RayHit {
+    /// The distance along the ray at which it enters the primitive's box, in
+    /// multiples of the ray direction.
+    float distance;
+
+    /// The index of the primitive.
+    uint32_t primitive;
+  };
+
+  /// Constructor. Creates an empty hierarchy.
+  BoundingVolumeHierarchy();
+
+  /// Destructor.
+  ~BoundingVolumeHierarchy();
+
+  /// Build the hierarchy, replacing any previous one.
+  /// \param bounding_boxes The box of each primitive. Primitive i is
+  /// identified by index i in all queries.
+  /// \param num_threads The maximum number of threads to build with. If 0,
+  /// std::thread::hardware_concurrency() is used.
+  void build(const BoundingBoxArray& bounding_boxes, size_t num_threads = 0);
+
+  /// Remove all primitives and nodes.
+  void clear();
+
+  /// \return The number of primitives.
+  size_t size() const;
+
+  /// \return The number of nodes of the tree.
+  size_t getNumNodes() const;
+
+  /// \return The box enclosing all primitives. Requires size() > 0.
+  const BoundingBox<Eigen::Vector3f>& getRootBoundingBox() const;
+
+  /// Change the box of a primitive and refit the boxes of the nodes
+  /// containing it. Cost is proportional to the depth of the tree. The
+  /// quality of the tree degrades if primitives move far, in which case it
+  /// should be rebuilt.
+  /// \param primitive The index of the primitive.
+  /// \param bounding_box The new box of the primitive.
+  void setBoundingBox(size_t primitive,
+                      const BoundingBox<Eigen::Vector3f>& bounding_box);
+
+  /// Replace the boxes of all primitives and refit the whole tree bottom up.
+  /// Faster than setBoundingBox() when most primitives moved.
+  /// \param bounding_boxes The new box of each primitive. Must contain
+  /// size() boxes.
+  void refit(const BoundingBoxArray& bounding_boxes);
+
+  /// Find the primitives whose boxes intersect a frustum.
+  /// \param frustum The frustum, in the same space as the boxes.
+  /// \param [out] primitives Cleared and filled with the intersecting
+  /// primitives, in no particular order.
+  void intersectFrustum(const Frustum& frustum,
+                        std::vector<uint32_t>& primitives) const;
+
+  /// Find the primitives whose boxes are hit by a ray.
+  /// \param origin The origin of the ray.
+  /// \param direction The direction of the ray, need not be normalized.
+  /// \param max_distance Only hits closer than this distance, in multiples
+  /// of direction, are reported.
+  /// \param [out] hits Cleared and filled with the hits sorted from nearest
+  /// to furthest.
+  void intersectRay(const Eigen::Vector3f& origin,
+                    const Eigen::Vector3f& direction, float max_distance,
+                    std::vector<RayHit>& hits) const;
+
+  /// Intersect a ray with a box using the slab test.
+  /// \param bounding_box The box to test.
+  /// \param origin The origin of the ray.
+  /// \param inverse_direction The component wise inverse of the ray
+  /// direction.
+  /// \param max_distance Hits further than this are ignored.
+  /// \param [out] distance Set to the distance at which the ray enters the
+  /// box, or 0 if the origin is inside.
+  /// \return True if the box is hit.
+  static bool intersectRay(const BoundingBox<Eigen::Vector3f>& bounding_box,
+                           const Eigen::Vector3f& origin,
+                           const Eigen::Vector3f& inverse_direction,
+                           float max_distance, float& distance);
+
+ private:
+  /// A node of the tree.
+  struct Node {
+    /// The box enclosing all primitives below the node.
+    BoundingBox<Eigen::Vector3f> bounding_box;
+
+    /// For leaves the index of the first primitive in primitive_indices,
+    /// otherwise the index of the left child. The right child follows it.
+    uint32_t first;
+
+    /// The number of primitives of a leaf, 0 for inner nodes.
+    uint32_t count;
+  };
+
+  /// Build the subtree of a node over a range of primitive_indices.
+  /// \param node_index The node to build.
+  /// \param begin The first entry of primitive_indices of the node.
+  /// \param end One past the last entry of primitive_indices of the node.
+  /// \param parallel_depth Subtrees are built on separate threads until
+  /// this reaches 0.
+  void buildNode(uint32_t node_index, uint32_t begin, uint32_t end,
+                 size_t parallel_depth);
+
+  /// Recompute the box of a node from its primitives or children.
+  /// \param node_index The node to update.
+  /// \return True if the box changed.
+  bool refitNode(uint32_t node_index);
+
+  /// The nodes of the tree, the root is at index 0. Children always have a
+  /// higher index than their parent.
+  std::vector<Node> nodes;
+
+  /// The parent of each node. The root is its own parent.
+  std::vector<uint32_t> parents;
+
+  /// Primitive indices, ordered so that each leaf references a contiguous
+  /// range.
+  std::vector<uint32_t> primitive_indices;
+
+  /// The leaf containing each primitive.
+  std::vector<uint32_t> primitive_leaves;
+
+  /// The box of each primitive.
+  std::vector<BoundingBox<Eigen::Vector3f>> primitive_bounding_boxes;
+
+  /// The centroid of each primitive's box, used while building.
+  std::vector<Eigen::Vector3f> primitive_centroids;
+
+  /// The number of nodes allocated while building.
+  std::atomic<uint32_t> num_nodes;
+
+  /// Stack used while querying, kept to avoid allocations.
+  mutable std::vector<uint32_t> node_stack;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_BOUNDINGVOLUMEHIERARCHY_H_
@@ -30,9 +30,11 @@ class Buffer : public StagedBufferDestination {
   /// \param usage_flags vk::BufferUsageFlags for this buffer.
   /// \param memory_property_flags vk::MemoryPropertyFlags for this buffer.
   /// \param vma_memory_usage VmaMemoryUsage flags to use when allocating.
+  /// \param transient True if the buffer is destroyed within a few frames,
+  /// e.g. the staging buffer of a single upload. See MemoryPools.
   Buffer(size_t _data_size, vk::BufferUsageFlags usage_flags,
          vk::MemoryPropertyFlags memory_property_flags,
-         VmaMemoryUsage vma_memory_usage);
+         VmaMemoryUsage vma_memory_usage, bool transient = false);
 
   /// Destructor
   ~Buffer();
@@ -56,13 +58,34 @@ class Buffer : public StagedBufferDestination {
   /// \param usage_flags vk::BufferUsageFlags for this buffer.
   /// \param memory_property_flags vk::MemoryPropertyFlags for this buffer.
   /// \param vma_memory_usage VmaMemoryUsage flags to use when allocating.
+  /// \param transient See Buffer().
   void createBuffer(vk::BufferUsageFlags usage_flags,
                     vk::MemoryPropertyFlags memory_property_flags,
-                    VmaMemoryUsage vma_memory_usage);
+                    VmaMemoryUsage vma_memory_usage, bool transient);
+
+  /// Overridden to create a copy of the buffer for the MemoryDefragmenter.
+  /// \param command_buffer The command buffer to insert the copy into.
+  /// \param destination The allocation to bind the copy to.
+  /// \return True if the copy was created.
+  bool beginMove(const vk::CommandBuffer& command_buffer,
+                 VmaAllocation destination) override;
+
+  /// Overridden to replace the buffer with the copy.
+  void endMove() override;
 
   /// vk::Buffer instance which represents this buffer.
   vk::Buffer vk_buffer;
 
+  /// The create info of vk_buffer, used to create copies of it.
+  vk::BufferCreateInfo buffer_create_info;
+
+  /// The copy created by beginMove(), null if not moving.
+  vk::Buffer moved_vk_buffer;
+
+  /// True if the MemoryDefragmenter may move the buffer. Set for device local
+  /// vertex and index buffers, which are only referenced while recording.
+  bool movable;
+
  protected:
   /// The size of the data.
   size_t data_size;
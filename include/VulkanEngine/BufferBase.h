@@ -15,6 +15,8 @@
 #pragma clang diagnostic pop
 #endif
 
+#include <vulkan/vulkan.hpp>
+
 namespace VulkanEngine {
 
 /// Base class for various classes which represent data buffers on the GPU/CPU.
@@ -25,10 +27,43 @@ class BufferBase {
   /// \param data_size The size of the data in bytes.
   virtual void updateBuffer(const void* _data, size_t _data_size);
 
+  /// Map the buffer's memory into the application's address space. The memory
+  /// stays mapped until unmapMemory() is called, which allows writing to it
+  /// repeatedly without remapping. Calls may be nested.
+  /// \return Pointer to the start of the buffer's memory.
+  void* mapMemory();
+
+  /// Unmap memory previously mapped with mapMemory().
+  void unmapMemory();
+
+  /// \return The size in bytes of the memory allocated for the buffer or
+  /// image, which may be larger than the size of its data.
+  size_t getAllocationSize() const;
+
  protected:
+  friend class MemoryDefragmenter;
+
+  /// Create a copy of the buffer or image bound to another allocation and
+  /// insert the commands copying the data into it. Called by the
+  /// MemoryDefragmenter for registered resources whose allocation is moved.
+  /// \param command_buffer The command buffer to insert the commands into.
+  /// \param destination The allocation to bind the copy to.
+  /// \return True if the copy was created, false if the resource can't be
+  /// moved, which is the default.
+  virtual bool beginMove(const vk::CommandBuffer& command_buffer,
+                         VmaAllocation destination);
+
+  /// Replace the buffer or image with the copy created by beginMove() and
+  /// destroy it. Called once the copy has completed.
+  virtual void endMove();
+
   /// VmaAllocation used to handle allocation with Vulkan Memory Allocator
   /// library.
   VmaAllocation vma_allocation;
+
+  /// True if the buffer holds uniform data, updates are then counted as
+  /// FrameStatistics::Counter::eUniformUpdates.
+  bool uniform_buffer = false;
 };
 
 }  // namespace VulkanEngine
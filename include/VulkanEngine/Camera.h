@@ -33,6 +33,10 @@ class Camera : public SceneObject {
   /// Destructor.
   virtual ~Camera();
 
+  /// \return False, the Camera sets the view of the scene and must always be
+  /// updated.
+  bool isCullable() const override;
+
   /// Set the look at vector of the camera.
   /// \param _look_at The look at vector to use.
   void setLookAt(const Eigen::Vector3f& _look_at);
@@ -64,11 +68,18 @@ class Camera : public SceneObject {
   /// \return The height of the camera.
   float getHeight() const;
 
+  /// Set the view and projection matrices of a SceneState to the camera's.
+  /// Called by Scene before traversal, so that objects are culled with the
+  /// current view even if they are traversed before the camera.
+  /// \param scene_state The state of the scene, its transform node must be
+  /// the camera's node.
+  void updateView(SceneState& scene_state);
+
  private:
   /// Update the camera. Updates the projection and view matrix in \c
   /// scene_state with the camera's values. \param scene_state Represents the
   /// current state of the scene.
-  void update(std::shared_ptr<SceneState> scene_state) override;
+  void update(SceneState& scene_state) override;
 
   /// What position the Camera is oriented towards.
   Eigen::Vector3f look_at;
@@ -0,0 +1,89 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_COMMANDPOOL_H_
+#define INCLUDE_VULKANENGINE_COMMANDPOOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// Wraps a vk::CommandPool and hands out command buffers which are recycled
+/// when the pool is reset. Command buffers retrieved with getCommandBuffer()
+/// are never freed individually. Instead the whole pool is reset with reset(),
+/// which keeps allocation cost and pool fragmentation constant no matter how
+/// many frames have been recorded.
+class CommandPool {
+ public:
+  /// Constructor.
+  /// \param _vk_device The vk::Device to create the pool on.
+  /// \param queue_family_index The queue family which command buffers
+  /// allocated from the pool will be submitted to.
+  /// \param flags vk::CommandPoolCreateFlags used to create the pool.
+  CommandPool(const vk::Device& _vk_device, uint32_t queue_family_index,
+              vk::CommandPoolCreateFlags flags = vk::CommandPoolCreateFlags());
+
+  /// Destructor.
+  ~CommandPool();
+
+  /// Delete copy constructor, the pool owns Vulkan handles.
+  CommandPool(const CommandPool&) = delete;
+
+  /// Delete assignment operator, the pool owns Vulkan handles.
+  void operator=(const CommandPool&) = delete;
+
+  /// Get a command buffer which stays valid until the next call to reset().
+  /// Previously allocated command buffers are reused when available.
+  /// \param level The vk::CommandBufferLevel of the command buffer.
+  /// \return A command buffer in the initial state.
+  vk::CommandBuffer getCommandBuffer(
+      vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary);
+
+  /// Reset the pool. All command buffers handed out by getCommandBuffer() are
+  /// returned to the initial state and will be handed out again.
+  /// The caller must ensure none of them are still in use by the GPU.
+  void reset();
+
+  /// Allocate a command buffer which is owned by the caller. It must be
+  /// returned with freeCommandBuffer(). Useful for one time submissions from a
+  /// pool created with vk::CommandPoolCreateFlagBits::eTransient.
+  /// \param level The vk::CommandBufferLevel of the command buffer.
+  /// \return The allocated command buffer.
+  vk::CommandBuffer allocateCommandBuffer(
+      vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary);
+
+  /// Free a command buffer allocated with allocateCommandBuffer().
+  /// \param command_buffer The command buffer to free.
+  void freeCommandBuffer(const vk::CommandBuffer& command_buffer);
+
+  /// \return The internal vk::CommandPool.
+  const vk::CommandPool& getVkCommandPool() const;
+
+ private:
+  /// The device the pool was created on.
+  vk::Device vk_device;
+
+  /// The internal vk::CommandPool.
+  vk::CommandPool vk_command_pool;
+
+  /// Primary command buffers allocated by getCommandBuffer().
+  std::vector<vk::CommandBuffer> primary_command_buffers;
+
+  /// Number of primary command buffers handed out since the last reset().
+  size_t primary_command_buffers_in_use;
+
+  /// Secondary command buffers allocated by getCommandBuffer().
+  std::vector<vk::CommandBuffer> secondary_command_buffers;
+
+  /// Number of secondary command buffers handed out since the last reset().
+  size_t secondary_command_buffers_in_use;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_COMMANDPOOL_H_
@@ -0,0 +1,61 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_COMPUTEPIPELINE_H_
+#define INCLUDE_VULKANENGINE_COMPUTEPIPELINE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+class Shader;
+
+/// Wraps a compute vk::Pipeline created from a Shader with a single compute
+/// ShaderModule. Descriptor sets are bound through the Shader using
+/// vk::PipelineBindPoint::eCompute.
+class ComputePipeline {
+ public:
+  /// Constructor.
+  ComputePipeline();
+
+  /// Destructor.
+  ~ComputePipeline();
+
+  /// Create the compute pipeline.
+  /// \param shader The shader to create the pipeline from. Its descriptors
+  /// must have been set since they define the pipeline layout.
+  void createComputePipeline(const std::shared_ptr<Shader> shader);
+
+  /// Bind the compute pipeline to a command buffer.
+  /// \param command_buffer The vk::CommandBuffer to insert the commands into.
+  void bindPipeline(const vk::CommandBuffer& command_buffer);
+
+  /// Insert a dispatch command. The pipeline and its descriptor sets must be
+  /// bound.
+  /// \param command_buffer The vk::CommandBuffer to insert the commands into.
+  /// \param group_count_x The number of work groups along x.
+  /// \param group_count_y The number of work groups along y.
+  /// \param group_count_z The number of work groups along z.
+  void dispatch(const vk::CommandBuffer& command_buffer,
+                uint32_t group_count_x, uint32_t group_count_y = 1,
+                uint32_t group_count_z = 1);
+
+  /// \return The Shader the pipeline was created from.
+  const std::shared_ptr<Shader>& getShader() const;
+
+ private:
+  /// The shader the pipeline was created from. Kept alive since it owns the
+  /// pipeline layout.
+  std::shared_ptr<Shader> shader;
+
+  /// Internal vulkan instance of the compute pipeline.
+  vk::Pipeline vk_compute_pipeline;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_COMPUTEPIPELINE_H_
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_DELETIONQUEUE_H_
+#define INCLUDE_VULKANENGINE_DELETIONQUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace VulkanEngine {
+
+/// Defers destroying Vulkan objects until the frames which may use them have
+/// completed. Buffers, images, shaders and pipelines queue the destruction
+/// of their handles when they are destroyed, so that objects can be removed
+/// from a scene without waiting for the device to be idle.
+/// A destruction queued while frame N is recorded runs once frame N +
+/// VulkanManager::getFramesInFlight() begins, at which point the fence of
+/// frame N has been waited on. Destructions queued while no frame has been
+/// begun since the device was last idle run immediately.
+class DeletionQueue {
+ public:
+  /// Constructor.
+  DeletionQueue();
+
+  /// Destructor.
+  ~DeletionQueue();
+
+  /// Delete copy constructor, queued destructions own Vulkan handles.
+  DeletionQueue(const DeletionQueue&) = delete;
+
+  /// Delete assignment operator, queued destructions own Vulkan handles.
+  void operator=(const DeletionQueue&) = delete;
+
+  /// Queue the destruction of Vulkan objects. Thread safe.
+  /// \param destroy Destroys the objects. Must not use the object which
+  /// queued it, which has already been destroyed.
+  void enqueue(std::function<void()> destroy);
+
+  /// Run the destructions whose frames have completed. Called by
+  /// VulkanManager::beginFrame() after waiting for the fence of the frame.
+  void beginFrame();
+
+  /// Run all queued destructions. The device must be idle.
+  void flush();
+
+  /// \return The number of queued destructions. Thread safe.
+  size_t getNumPending() const;
+
+ private:
+  /// A queued destruction.
+  struct Deletion {
+    /// Destroys the objects.
+    std::function<void()> destroy;
+
+    /// The frame being recorded when the destruction was queued.
+    uint64_t frame;
+  };
+
+  /// Run and remove queued destructions. Called by the thread recording
+  /// frames.
+  /// \param before_frame Destructions queued before this frame are run.
+  void run(uint64_t before_frame);
+
+  /// Protects the members below.
+  mutable std::mutex mutex;
+
+  /// The queued destructions, in order.
+  std::vector<Deletion> deletions;
+
+  /// The destructions being run, kept to avoid allocations.
+  std::vector<Deletion> deletions_scratch;
+
+  /// The number of calls to beginFrame().
+  uint64_t frame;
+
+  /// The value of frame when the device was last idle.
+  uint64_t idle_frame;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_DELETIONQUEUE_H_
@@ -6,6 +6,7 @@
 #ifndef INCLUDE_VULKANENGINE_DESCRIPTOR_H_
 #define INCLUDE_VULKANENGINE_DESCRIPTOR_H_
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -44,6 +45,13 @@ class Descriptor {
       std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
       const vk::DescriptorSet& destination_set) = 0;
 
+  /// \return A number which changes whenever the resources written by
+  /// appendVkDescriptorSets() change, such as when a texture is replaced by
+  /// one with more mip levels. Descriptor sets referencing the descriptor
+  /// must then be written again, see Shader::updateDescriptorSet(). 0 for
+  /// descriptors whose resources never change.
+  virtual uint64_t getVersion() const;
+
  protected:
   /// The binding index
   uint32_t binding;
@@ -6,6 +6,12 @@
 #ifndef INCLUDE_VULKANENGINE_DEVICE_H_
 #define INCLUDE_VULKANENGINE_DEVICE_H_
 
+#include <VulkanEngine/CommandPool.h>
+#include <VulkanEngine/MemoryPools.h>
+#include <VulkanEngine/MemoryTelemetry.h>
+
+#include <memory>
+#include <string>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 
@@ -37,30 +43,143 @@ class Device {
 
   const vk::Device& getVkDevice() const;
 
+  /// Destroy all command pools and the command buffers allocated from them.
   void destroyCommandBuffers();
 
   void waitIdle();
 
+  /// Reset the command pool of a frame and prepare its primary command buffer
+  /// for recording. Must only be called once the GPU has finished executing
+  /// the commands previously recorded for the frame.
+  /// \param frame_index The index of the frame in flight.
+  void beginFrame(size_t frame_index);
+
+  /// \return The primary command buffer of the given frame in flight.
+  /// \param index The index of the frame in flight.
   vk::CommandBuffer getCommandBuffer(size_t index);
 
+  /// \return The command pool belonging to the given frame in flight. Command
+  /// buffers retrieved from it are valid until the frame is begun again.
+  /// \param index The index of the frame in flight.
+  std::shared_ptr<CommandPool> getFrameCommandPool(size_t index);
+
+  /// \return The transient command pool used for one time submissions.
+  std::shared_ptr<CommandPool> getTransientCommandPool();
+
   const VmaAllocator& getVmaAllocator();
 
-  vk::CommandPool getVkCommandPool();
+  /// \return The telemetry tracking the memory allocated with the
+  /// VmaAllocator.
+  MemoryTelemetry& getMemoryTelemetry();
+
+  /// \return The pools buffers and images are allocated from, configured
+  /// with VulkanManager::setMemoryPoolSettings().
+  MemoryPools& getMemoryPools();
 
   vk::Queue getVkGraphicsQueue();
 
+  /// \return The index of the queue family used for graphics.
+  uint32_t getGraphicsQueueFamilyIndex() const;
+
+  /// \return The features which were enabled when creating the device.
+  const vk::PhysicalDeviceFeatures& getEnabledFeatures() const;
+
+  /// \return True if images of the given format can be sampled with linear
+  /// filtering and uploaded with transfers, using optimal tiling.
+  /// \param format The vk::Format to check.
+  bool supportsSampledImageFormat(vk::Format format) const;
+
+  /// \return True if images of the given format can be used as storage images
+  /// with optimal tiling.
+  /// \param format The vk::Format to check.
+  bool supportsStorageImageFormat(vk::Format format) const;
+
+  /// \return The Vulkan version supported by the physical device.
+  uint32_t getApiVersion() const;
+
+  /// \return The name of the physical device.
+  const std::string& getName() const;
+
+  /// \return The nanoseconds per tick of timestamp queries, 0 if the graphics
+  /// queue doesn't support timestamps.
+  float getTimestampPeriod() const;
+
+  /// \return The number of valid bits of timestamps written by the graphics
+  /// queue.
+  uint32_t getTimestampValidBits() const;
+
+  /// \return True if shaders can read gl_BaseInstanceARB and the other
+  /// variables of GL_ARB_shader_draw_parameters.
+  bool supportsShaderDrawParameters() const;
+
+  /// \return True if VK_KHR_draw_indirect_count is available, in which case
+  /// drawIndexedIndirectCount() can be used.
+  bool supportsDrawIndirectCount() const;
+
+  /// Insert a vkCmdDrawIndexedIndirectCountKHR command, which reads the number
+  /// of draws from a buffer. Requires supportsDrawIndirectCount().
+  /// \param command_buffer The vk::CommandBuffer to insert the command into.
+  /// \param buffer The buffer containing the vk::DrawIndexedIndirectCommand
+  /// structures.
+  /// \param offset The byte offset of the first command in buffer.
+  /// \param count_buffer The buffer containing the number of draws.
+  /// \param count_buffer_offset The byte offset of the draw count.
+  /// \param max_draw_count The maximum number of draws executed.
+  /// \param stride The byte stride between successive commands.
+  void drawIndexedIndirectCount(const vk::CommandBuffer& command_buffer,
+                                const vk::Buffer& buffer, vk::DeviceSize offset,
+                                const vk::Buffer& count_buffer,
+                                vk::DeviceSize count_buffer_offset,
+                                uint32_t max_draw_count, uint32_t stride) const;
+
   void beginSingleUsageCommandBuffer();
 
   void endSingleUsageCommandBuffer();
 
  private:
   int graphics_queue_family_index;
+
+  /// The Vulkan version supported by the physical device.
+  uint32_t api_version;
+
+  /// See supportsShaderDrawParameters().
+  bool shader_draw_parameters;
+
+  /// The name of the physical device.
+  std::string name;
+
+  /// See getTimestampPeriod() and getTimestampValidBits().
+  float timestamp_period;
+  uint32_t timestamp_valid_bits;
+
+  vk::PhysicalDevice vk_physical_device;
   vk::Device vk_device;
   VmaAllocator vma_allocator;
   vk::Queue vk_graphics_queue;
-  vk::CommandPool vk_command_pool;
-  std::vector<vk::CommandBuffer> vk_command_buffers;
+
+  /// Tracks the memory allocated with vma_allocator.
+  std::shared_ptr<MemoryTelemetry> memory_telemetry;
+
+  /// The pools allocations are made from.
+  std::shared_ptr<MemoryPools> memory_pools;
+
+  /// One command pool per frame in flight, reset wholesale in beginFrame().
+  std::vector<std::shared_ptr<CommandPool>> frame_command_pools;
+
+  /// The primary command buffer of each frame in flight.
+  std::vector<vk::CommandBuffer> frame_command_buffers;
+
+  /// Command pool for short lived command buffers, e.g. buffer transfers.
+  std::shared_ptr<CommandPool> transient_command_pool;
+
   vk::CommandBuffer single_use_command_buffer;
+
+  /// The features enabled on the device.
+  vk::PhysicalDeviceFeatures enabled_features;
+
+  /// Entry point of vkCmdDrawIndexedIndirectCountKHR. Null if the extension is
+  /// not available.
+  PFN_vkCmdDrawIndexedIndirectCountKHR vk_cmd_draw_indexed_indirect_count;
   VULKAN_HPP_DEFAULT_DISPATCHER_TYPE vk_dispatch_loader_dynamic;
 
 #ifdef ENABLE_VULKAN_VALIDATION
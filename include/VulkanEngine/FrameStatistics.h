@@ -0,0 +1,178 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_FRAMESTATISTICS_H_
+#define INCLUDE_VULKANENGINE_FRAMESTATISTICS_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef ENABLE_FRAME_STATISTICS
+/// Add to a counter of the current frame, see FrameStatistics. Compiles to
+/// nothing, without evaluating value, unless ENABLE_FRAME_STATISTICS is
+/// defined.
+/// \param counter The name of a FrameStatistics::Counter value.
+/// \param value The amount to add.
+#define VULKANENGINE_COUNT_STATISTIC(counter, value)   \
+  ::VulkanEngine::countFrameStatistic(                 \
+      ::VulkanEngine::FrameStatistics::Counter::counter, \
+      static_cast<uint64_t>(value))
+#else
+#define VULKANENGINE_COUNT_STATISTIC(counter, value) static_cast<void>(0)
+#endif
+
+namespace VulkanEngine {
+
+/// Counts the work issued by each frame: draw calls, binds, triangles and
+/// uploads. Every thread adds to counters of its own, so recording threads
+/// never contend, and endFrame() sums them into a Snapshot of the frame.
+/// The counters are fed by VULKANENGINE_COUNT_STATISTIC(), which is compiled
+/// out unless the engine is built with ENABLE_FRAME_STATISTICS, otherwise all
+/// snapshots are 0. Apart from counting, the statistics must only be used
+/// from the thread which renders.
+class FrameStatistics {
+ public:
+  /// The counted values.
+  enum class Counter : uint8_t {
+    /// Draw commands inserted into command buffers, an indirect draw counts
+    /// once however many draws it executes.
+    eDrawCalls,
+
+    /// Calls to GraphicsPipeline::bindPipeline().
+    ePipelineBinds,
+
+    /// Calls to Shader::bindDescriptorSet().
+    eDescriptorSetBinds,
+
+    /// Triangles drawn, assuming triangle lists, before any GPU culling.
+    eTriangles,
+
+    /// Bytes copied from staging buffers by StagedBuffer::transferBuffer().
+    eBytesUploaded,
+
+    /// Writes to uniform buffers with BufferBase::updateBuffer().
+    eUniformUpdates
+  };
+
+  /// The number of values of Counter.
+  static constexpr size_t kNumCounters = 6;
+
+  /// The counters of one frame.
+  struct Snapshot {
+    /// The number of the frame among all frames counted.
+    uint64_t index = 0;
+
+    /// The counters indexed by Counter.
+    std::array<uint64_t, kNumCounters> counters = {};
+
+    /// \return The value of a counter.
+    /// \param counter The counter to return.
+    uint64_t get(Counter counter) const {
+      return counters[static_cast<size_t>(counter)];
+    }
+  };
+
+  /// Constructor.
+  FrameStatistics();
+
+  /// Destructor.
+  ~FrameStatistics();
+
+  /// Delete copy constructor, thread counters refer to the statistics.
+  FrameStatistics(const FrameStatistics&) = delete;
+
+  /// Delete assignment operator, thread counters refer to the statistics.
+  void operator=(const FrameStatistics&) = delete;
+
+  /// Add to a counter of the current frame. May be called from any thread.
+  /// \param counter The counter to add to.
+  /// \param value The amount to add.
+  void count(Counter counter, uint64_t value);
+
+  /// Sum the counters of all threads into a Snapshot of the frame which
+  /// ended. Called by VulkanManager::drawImage().
+  void endFrame();
+
+  /// Set the number of frames averaged by getAverage(), older snapshots are
+  /// discarded.
+  /// \param _window_size The number of frames to keep, at least 1.
+  void setWindowSize(size_t _window_size);
+
+  /// \return The number of frames averaged by getAverage().
+  size_t getWindowSize() const;
+
+  /// \return The counters of the last frame which ended, 0 before the first.
+  const Snapshot& getLastFrame() const;
+
+  /// \return The snapshots of the most recent frames, oldest first.
+  const std::deque<Snapshot>& getFrames() const;
+
+  /// \return The average of a counter over the most recent frames, 0 before
+  /// the first frame.
+  /// \param counter The counter to average.
+  double getAverage(Counter counter) const;
+
+  /// Discard all snapshots. Counts added since the last frame ended are kept
+  /// for the next one.
+  void clear();
+
+  /// \return The name of a counter, e.g. "draw_calls".
+  /// \param counter The counter to name.
+  static const char* getCounterName(Counter counter);
+
+ private:
+  /// The totals counted by one thread. The thread is the only writer and
+  /// endFrame() the only reader, so no lock is needed.
+  struct ThreadCounters {
+    std::array<std::atomic<uint64_t>, kNumCounters> totals;
+  };
+
+  /// \return The counters of the calling thread, created on first use.
+  ThreadCounters& getThreadCounters();
+
+  /// Identifies the statistics in thread local storage, never reused.
+  const uint64_t id;
+
+  /// See setWindowSize().
+  size_t window_size;
+
+  /// Protects thread_counters.
+  std::mutex mutex;
+
+  /// The counters of all threads which have counted. Counters of threads
+  /// which have exited are folded into exited_totals.
+  std::vector<std::shared_ptr<ThreadCounters>> thread_counters;
+
+  /// The totals of threads which have exited.
+  std::array<uint64_t, kNumCounters> exited_totals;
+
+  /// The totals of all threads when the last frame ended.
+  std::array<uint64_t, kNumCounters> frame_totals;
+
+  /// The number of frames counted so far.
+  uint64_t frame_count;
+
+  /// The snapshots of the most recent frames, see getFrames().
+  std::deque<Snapshot> frames;
+
+  /// Returned by getLastFrame() before the first frame.
+  Snapshot empty_frame;
+};
+
+/// Add to a counter of the current frame of the VulkanManager, used by
+/// VULKANENGINE_COUNT_STATISTIC().
+/// \param counter The counter to add to.
+/// \param value The amount to add.
+void countFrameStatistic(FrameStatistics::Counter counter, uint64_t value);
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_FRAMESTATISTICS_H_
@@ -0,0 +1,104 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_FRUSTUM_H_
+#define INCLUDE_VULKANENGINE_FRUSTUM_H_
+
+#include <VulkanEngine/BoundingBox.h>
+
+#include <Eigen/Eigen>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine {
+
+/// Stores axis aligned boxes with one array per component, so that several
+/// boxes can be tested against a Frustum at once.
+struct BoundingBoxArray {
+  /// The minimum extent of each box.
+  std::vector<float> min_x;
+  std::vector<float> min_y;
+  std::vector<float> min_z;
+
+  /// The maximum extent of each box.
+  std::vector<float> max_x;
+  std::vector<float> max_y;
+  std::vector<float> max_z;
+
+  /// Remove all boxes. Capacity is kept.
+  void clear();
+
+  /// Append a box.
+  /// \param bounding_box The box to append.
+  void push_back(const BoundingBox<Eigen::Vector3f>& bounding_box);
+
+  /// \return The box at an index.
+  /// \param index The index of the box.
+  BoundingBox<Eigen::Vector3f> get(size_t index) const;
+
+  /// Replace the box at an index.
+  /// \param index The index of the box.
+  /// \param bounding_box The new box.
+  void set(size_t index, const BoundingBox<Eigen::Vector3f>& bounding_box);
+
+  /// \return The number of boxes.
+  size_t size() const;
+};
+
+/// A view frustum given by six planes, used to skip objects which can't be
+/// seen by the camera.
+class Frustum {
+ public:
+  /// Constructor. Creates a frustum which contains everything.
+  Frustum();
+
+  /// Constructor.
+  /// \param view_projection The view projection matrix the frustum is
+  /// extracted from. Boxes tested against the frustum must be in the space
+  /// the matrix transforms from, usually world space.
+  explicit Frustum(const Eigen::Matrix4f& view_projection);
+
+  /// \return The left, right, bottom, top, near and far planes. A point p is
+  /// inside of a plane if plane.head<3>().dot(p) + plane.w() >= 0.
+  const std::array<Eigen::Vector4f, 6>& getPlanes() const;
+
+  /// Test whether a box intersects the frustum. The test is conservative,
+  /// boxes close to the corners of the frustum may be reported as
+  /// intersecting even if they are outside.
+  /// \param bounding_box The box to test.
+  /// \return True if the box may be visible.
+  bool intersects(const BoundingBox<Eigen::Vector3f>& bounding_box) const;
+
+  /// Test whether a box is entirely inside of the frustum.
+  /// \param bounding_box The box to test.
+  /// \return True if no part of the box is outside.
+  bool contains(const BoundingBox<Eigen::Vector3f>& bounding_box) const;
+
+  /// Test several boxes against the frustum. When compiled with AVX2, eight
+  /// boxes are tested per iteration.
+  /// \param bounding_boxes The boxes to test.
+  /// \param [out] visibility Resized to the number of boxes. Set to 1 for
+  /// each box which may be visible and 0 otherwise.
+  void intersects(const BoundingBoxArray& bounding_boxes,
+                  std::vector<uint8_t>& visibility) const;
+
+  /// Compute the axis aligned box enclosing a transformed box.
+  /// \param transform The affine transform to apply.
+  /// \param bounding_box The box to transform.
+  /// \return The enclosing box.
+  static BoundingBox<Eigen::Vector3f> transformBoundingBox(
+      const Eigen::Matrix4f& transform,
+      const BoundingBox<Eigen::Vector3f>& bounding_box);
+
+ private:
+  /// The planes of the frustum, normalized.
+  std::array<Eigen::Vector4f, 6> planes;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_FRUSTUM_H_
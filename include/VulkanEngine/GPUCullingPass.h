@@ -0,0 +1,180 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_GPUCULLINGPASS_H_
+#define INCLUDE_VULKANENGINE_GPUCULLINGPASS_H_
+
+#include <VulkanEngine/ComputePipeline.h>
+#include <VulkanEngine/Descriptor.h>
+#include <VulkanEngine/IndirectDrawBuffer.h>
+#include <VulkanEngine/RenderQueue.h>
+#include <VulkanEngine/Shader.h>
+#include <VulkanEngine/StorageBuffer.h>
+#include <VulkanEngine/UniformBuffer.h>
+
+#include <Eigen/Eigen>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// Culls the draws of a RenderQueue on the GPU. A compute shader tests the
+/// world space bounds of every draw against the view frustum, and optionally
+/// against a depth pyramid, and writes the surviving draws into the
+/// IndirectDrawBuffer the queue is recorded with. If the device supports
+/// reading draw counts from a buffer, the visible draws of each batch are
+/// compacted to the front of the batch and counted. Otherwise culled draws
+/// are written with an instance count of 0. Instanced draws are culled as a
+/// whole using bounds which enclose all of their instances.
+/// The commands must be recorded outside of a render pass, after
+/// RenderQueue::buildBatches() and before the draws are executed.
+class GPUCullingPass {
+ public:
+  /// The binding of the depth pyramid in the culling shader.
+  static constexpr uint32_t kDepthPyramidBinding = 3;
+
+  /// Constructor.
+  GPUCullingPass();
+
+  /// Destructor.
+  ~GPUCullingPass();
+
+  /// Delete copy constructor, the pass owns per frame buffers.
+  GPUCullingPass(const GPUCullingPass&) = delete;
+
+  /// Delete assignment operator, the pass owns per frame buffers.
+  void operator=(const GPUCullingPass&) = delete;
+
+  /// Set a depth pyramid to use for occlusion culling. Each texel of a level
+  /// must hold the maximum depth of the 2x2 texels it covers in the level
+  /// below, level 0 being the depth buffer of the previous frame. The
+  /// descriptor must be a combined image sampler at kDepthPyramidBinding
+  /// accessible from the compute stage, sampled with nearest filtering.
+  /// \param depth_pyramid The depth pyramid, or null to only cull against the
+  /// view frustum.
+  /// \param width The width of level 0 of the pyramid.
+  /// \param height The height of level 0 of the pyramid.
+  /// \param mip_levels The number of levels of the pyramid.
+  void setDepthPyramid(const std::shared_ptr<Descriptor> depth_pyramid,
+                       uint32_t width, uint32_t height, uint32_t mip_levels);
+
+  /// Insert the commands which cull the draws of a RenderQueue into an
+  /// IndirectDrawBuffer. Overwrites the commands and draw counts of the
+  /// first RenderQueue::size() commands of the buffer. Draws which aren't
+  /// indexed or have no bounds are never culled.
+  /// \param command_buffer The vk::CommandBuffer to insert the commands into.
+  /// \param render_queue The RenderQueue to cull. Must have batches built.
+  /// \param indirect_draw_buffer The buffer the queue is recorded with. Must
+  /// have a capacity of at least render_queue.size() commands.
+  /// \param view_projection The view projection matrix to cull with.
+  /// \param frame_index The index of the current frame in flight.
+  void cull(const vk::CommandBuffer& command_buffer,
+            const RenderQueue& render_queue,
+            const IndirectDrawBuffer& indirect_draw_buffer,
+            const Eigen::Matrix4f& view_projection, size_t frame_index);
+
+  /// \return The number of draws with bounds tested by the last call to
+  /// cull().
+  size_t getNumTestedDraws() const;
+
+  /// Extract the planes of a view frustum in Vulkan clip space, see
+  /// Frustum::getPlanes().
+  /// \param view_projection The view projection matrix.
+  /// \return The left, right, bottom, top, near and far planes, normalized.
+  static std::array<Eigen::Vector4f, 6> extractFrustumPlanes(
+      const Eigen::Matrix4f& view_projection);
+
+ private:
+#pragma pack(push, 1)
+  /// Per draw input of the culling shader, matches DrawInput in the shader.
+  struct DrawInput {
+    uint32_t index_count;
+    uint32_t first_index;
+    int32_t vertex_offset;
+    uint32_t first_instance;
+    uint32_t batch_first;
+    uint32_t flags;
+    uint32_t instance_count;
+    uint32_t padding;
+    float bounds_min[4];
+    float bounds_max[4];
+  };
+
+  /// Uniform parameters of the culling shader, laid out with std140.
+  struct CullParameters {
+    Eigen::Matrix4f view_projection;
+    float planes[6][4];
+    uint32_t draw_count;
+    uint32_t compact;
+    uint32_t draw_counts_offset;
+    uint32_t padding;
+    float depth_pyramid_size[2];
+    float depth_pyramid_levels;
+    float padding2;
+  };
+#pragma pack(pop)
+
+  /// The buffers and descriptor sets used to cull one frame in flight.
+  struct FrameResources {
+    /// The draws to cull.
+    std::shared_ptr<StorageBuffer<DrawInput>> draw_inputs;
+
+    /// The parameters of the frame.
+    std::shared_ptr<UniformBuffer<CullParameters>> parameters;
+
+    /// The IndirectDrawBuffer the descriptor set was written for.
+    vk::Buffer indirect_draw_buffer;
+
+    /// Owns the descriptor set binding the buffers above.
+    std::shared_ptr<Shader> shader;
+  };
+
+  /// Make sure the resources of a frame can cull the given number of draws
+  /// into the given buffer, recreating them if necessary.
+  /// \param frame_index The index of the frame in flight.
+  /// \param num_draws The number of draws to cull.
+  /// \param indirect_draw_buffer The buffer to cull into.
+  /// \return The resources of the frame.
+  FrameResources& prepareFrame(size_t frame_index, size_t num_draws,
+                               const IndirectDrawBuffer& indirect_draw_buffer);
+
+  /// \return The GLSL source of the culling shader.
+  /// \param use_depth_pyramid Include the occlusion test.
+  static const std::string getComputeShaderString(bool use_depth_pyramid);
+
+  /// The resources of each frame in flight.
+  std::vector<FrameResources> frames;
+
+  /// The compute shader module, compiled on first use.
+  std::shared_ptr<ShaderModule> shader_module;
+
+  /// The culling pipeline, created from the shader of the first frame.
+  std::shared_ptr<ComputePipeline> compute_pipeline;
+
+  /// The depth pyramid, null if disabled.
+  std::shared_ptr<Descriptor> depth_pyramid;
+
+  /// The size of level 0 of the depth pyramid.
+  uint32_t depth_pyramid_width;
+  uint32_t depth_pyramid_height;
+
+  /// The number of levels of the depth pyramid.
+  uint32_t depth_pyramid_levels;
+
+  /// CPU copy of the draw inputs, kept to avoid allocations.
+  std::vector<DrawInput> draw_inputs_scratch;
+
+  /// The number of draws with bounds tested by the last call to cull().
+  size_t num_tested_draws;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_GPUCULLINGPASS_H_
@@ -6,6 +6,7 @@
 #ifndef INCLUDE_VULKANENGINE_GRAPHICSPIPELINE_H_
 #define INCLUDE_VULKANENGINE_GRAPHICSPIPELINE_H_
 
+#include <cstdint>
 #include <memory>
 #include <vulkan/vulkan.hpp>
 
@@ -27,6 +28,10 @@ class GraphicsPipeline {
   /// Bind the graphics pipeline to the current command buffer.
   void bindPipeline();
 
+  /// Bind the graphics pipeline to a command buffer.
+  /// \param command_buffer The vk::CommandBuffer to insert the commands into.
+  void bindPipeline(const vk::CommandBuffer& command_buffer);
+
   /// Set the viewport for rendering. Defines how normalized device coordinates
   /// are converted to pixels in the framebuffer.
   /// \param x The x position of the viewport.
@@ -56,7 +61,13 @@ class GraphicsPipeline {
   void createGraphicsPipeline(const std::shared_ptr<MeshBase> mesh,
                               const std::shared_ptr<Shader> shader);
 
+  /// \return An id which is unique to this GraphicsPipeline instance.
+  uint32_t getId() const;
+
  private:
+  /// Unique id of this GraphicsPipeline.
+  const uint32_t id;
+
   /// Internal vulkan instance of the graphics pipeline.
   vk::Pipeline vk_graphics_pipeline;
 
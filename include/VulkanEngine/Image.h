@@ -7,8 +7,11 @@
 #define INCLUDE_VULKANENGINE_IMAGE_H_
 
 #include <VulkanEngine/ImageBase.h>
+#include <VulkanEngine/MipmapGenerator.h>
 #include <VulkanEngine/StagedBufferDestination.h>
 
+#include <memory>
+
 #ifdef __clang__
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wnullability-completeness"
@@ -39,9 +42,12 @@ class Image : public StagedBufferDestination, public ImageBase {
   /// width of the image. \param _height The height of the image. \param _depth
   /// The depth of the image. \param pixel_size The data size of a single pixel
   /// in the image.
+  /// \param _mipmap_mode How mip levels are generated. Falls back to
+  /// MipmapMode::eBlit if the MipmapGenerator doesn't support the image.
   Image(vk::ImageLayout initial_layout, vk::ImageUsageFlags usage_flags,
         VmaMemoryUsage vma_memory_usage, uint32_t _width, uint32_t _height,
-        uint32_t _depth, size_t pixel_size, bool generate_mip_maps);
+        uint32_t _depth, size_t pixel_size, bool generate_mip_maps,
+        MipmapMode _mipmap_mode = MipmapMode::eBlit);
 
   /// Destructor.
   virtual ~Image();
@@ -70,6 +76,9 @@ class Image : public StagedBufferDestination, public ImageBase {
   /// Get vk::SampleCountFlagBits.
   const vk::SampleCountFlagBits getVkSampleCountFlags() const;
 
+  /// \return How the mip levels of the image are generated.
+  MipmapMode getMipmapMode() const;
+
   /// Get the interal vulkan image.
   virtual vk::Image getVkImage() const;
 
@@ -98,6 +107,18 @@ class Image : public StagedBufferDestination, public ImageBase {
   /// mipmaps.
   void generateMipmaps(const vk::CommandBuffer& command_buffer);
 
+  /// Overridden to create a copy of the image for the MemoryDefragmenter.
+  /// Only images which have been uploaded and can be used as transfer source
+  /// are moved.
+  /// \param command_buffer The command buffer to insert the copy into.
+  /// \param destination The allocation to bind the copy to.
+  /// \return True if the copy was created.
+  bool beginMove(const vk::CommandBuffer& command_buffer,
+                 VmaAllocation destination) override;
+
+  /// Overridden to replace the image with the copy and recreate the view.
+  void endMove() override;
+
  protected:
   /// The width of the Image.
   uint32_t width;
@@ -114,6 +135,13 @@ class Image : public StagedBufferDestination, public ImageBase {
   /// The number of mipmap images to generate.
   uint32_t mipmap_levels;
 
+  /// How the mip levels are generated.
+  MipmapMode mipmap_mode;
+
+  /// Resources used by the MipmapGenerator if mipmap_mode is
+  /// MipmapMode::eCompute.
+  std::shared_ptr<MipmapGenerator::ImageResources> mipmap_resources;
+
   /// The current vk::ImageLayout. \see transitionImageLayout().
   vk::ImageLayout vk_image_layout;
 
@@ -123,6 +151,16 @@ class Image : public StagedBufferDestination, public ImageBase {
   /// The vk::ImageView created in createImageView().
   vk::ImageView vk_image_view;
 
+  /// The arguments of the last call to createImageView().
+  vk::ImageViewType vk_image_view_type;
+  vk::ImageAspectFlags vk_image_aspect_flags;
+
+  /// The copy created by beginMove(), null if not moving.
+  vk::Image moved_vk_image;
+
+  /// The number of times the MemoryDefragmenter has moved the image.
+  uint64_t num_moves;
+
   /// VkImageCreateInfo.
   VkImageCreateInfo image_create_info;
 };
@@ -0,0 +1,99 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_INDIRECTDRAWBUFFER_H_
+#define INCLUDE_VULKANENGINE_INDIRECTDRAWBUFFER_H_
+
+#include <VulkanEngine/Buffer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// A persistently mapped, host visible buffer of
+/// vk::DrawIndexedIndirectCommand structures followed by one draw count per
+/// command. Commands are written directly into the mapped memory and
+/// contiguous runs of them are drawn with a single
+/// vkCmdDrawIndexedIndirectCountKHR or vk::CommandBuffer::drawIndexedIndirect()
+/// call, depending on what the device supports. Since the buffer is read by
+/// the GPU when the frame executes, one instance is needed per frame in
+/// flight.
+class IndirectDrawBuffer {
+ public:
+  /// Constructor. Creates an empty buffer.
+  IndirectDrawBuffer();
+
+  /// Destructor.
+  ~IndirectDrawBuffer();
+
+  /// Delete copy constructor, the buffer owns mapped memory.
+  IndirectDrawBuffer(const IndirectDrawBuffer&) = delete;
+
+  /// Delete assignment operator, the buffer owns mapped memory.
+  void operator=(const IndirectDrawBuffer&) = delete;
+
+  /// Make sure the buffer can hold at least the given number of commands.
+  /// If it has to grow, the buffer is recreated and previously written
+  /// commands are lost, so the GPU must not be using it anymore.
+  /// \param num_commands The number of commands required.
+  void reserve(size_t num_commands);
+
+  /// \return The number of commands the buffer can hold.
+  size_t getCapacity() const;
+
+  /// \return Pointer to the mapped commands. Different threads may write to
+  /// different commands concurrently.
+  vk::DrawIndexedIndirectCommand* getCommands() const;
+
+  /// Insert the commands needed to execute a contiguous run of commands
+  /// previously written to getCommands().
+  /// \param command_buffer The vk::CommandBuffer to insert the commands into.
+  /// \param first_command Index of the first command to draw.
+  /// \param num_commands The number of commands to draw.
+  /// \return The number of draw calls inserted.
+  size_t draw(const vk::CommandBuffer& command_buffer, size_t first_command,
+              size_t num_commands) const;
+
+  /// \return The internal vk::Buffer. It can also be bound as a storage
+  /// buffer and filled with transfer commands, which allows the GPU to write
+  /// the commands and draw counts, e.g. when culling.
+  const vk::Buffer getVkBuffer() const;
+
+  /// \return The byte offset of a command.
+  /// \param index The index of the command.
+  vk::DeviceSize getCommandOffset(size_t index) const;
+
+  /// \return The byte offset of a draw count. draw() reads the count of a run
+  /// of commands from the draw count of its first command.
+  /// \param index The index of the command the draw count belongs to.
+  vk::DeviceSize getDrawCountOffset(size_t index) const;
+
+  /// \return True if draw() reads the number of draws from the buffer. If
+  /// false, the number of draws is fixed when recording.
+  bool usesDrawCount() const;
+
+ private:
+  /// The buffer holding the commands and draw counts.
+  std::shared_ptr<Buffer> buffer;
+
+  /// The number of commands the buffer can hold.
+  size_t capacity;
+
+  /// Start of the mapped memory of buffer.
+  void* mapped_memory;
+
+  /// True if the device supports drawing several commands in one call.
+  bool multi_draw_indirect;
+
+  /// True if the device supports reading the draw count from a buffer.
+  bool draw_indirect_count;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_INDIRECTDRAWBUFFER_H_
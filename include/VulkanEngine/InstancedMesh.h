@@ -0,0 +1,143 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+
+#ifndef INCLUDE_VULKANENGINE_INSTANCEDMESH_H_
+#define INCLUDE_VULKANENGINE_INSTANCEDMESH_H_
+
+#include <VulkanEngine/BoundingBox.h>
+#include <VulkanEngine/GraphicsPipeline.h>
+#include <VulkanEngine/OBJMesh.h>
+#include <VulkanEngine/SceneObject.h>
+#include <VulkanEngine/Shader.h>
+#include <VulkanEngine/UniformBuffer.h>
+#include <VulkanEngine/VertexAttribute.h>
+
+#include <Eigen/Eigen>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace VulkanEngine {
+
+/// A SceneObject which draws the geometry of an OBJMesh many times using
+/// hardware instancing. Each shape of the OBJMesh is drawn with a single draw
+/// covering all instances, the transform of each instance is read from a
+/// vertex buffer which advances per instance. The OBJMesh only provides the
+/// geometry, textures and materials and doesn't need to be part of the scene.
+class InstancedMesh : public SceneObject {
+ public:
+  /// Constructor.
+  /// \param _obj_mesh The OBJMesh to draw instances of. Waits for it to be
+  /// loaded if it is loaded asynchronously. Throws if the device doesn't
+  /// support Device::supportsShaderDrawParameters().
+  explicit InstancedMesh(const std::shared_ptr<OBJMesh> _obj_mesh);
+
+  /// Destructor.
+  virtual ~InstancedMesh();
+
+  /// Delete copy constructor, the InstancedMesh owns per frame buffers.
+  InstancedMesh(const InstancedMesh&) = delete;
+
+  /// Delete assignment operator, the InstancedMesh owns per frame buffers.
+  void operator=(const InstancedMesh&) = delete;
+
+  /// Add an instance.
+  /// \param instance_transform The transform of the instance, applied before
+  /// the transform of the InstancedMesh.
+  /// \return The index of the instance.
+  size_t addInstance(const Eigen::Matrix4f& instance_transform);
+
+  /// Set the transform of an instance.
+  /// \param index The index of the instance.
+  /// \param instance_transform The transform of the instance.
+  void setInstanceTransform(size_t index,
+                            const Eigen::Matrix4f& instance_transform);
+
+  /// \return The transform of an instance.
+  /// \param index The index of the instance.
+  const Eigen::Matrix4f& getInstanceTransform(size_t index) const;
+
+  /// \return The number of instances.
+  size_t getNumInstances() const;
+
+  /// Remove all instances.
+  void clearInstances();
+
+  bool getLocalBoundingBox(
+      BoundingBox<Eigen::Vector3f>& _bounding_box) const override;
+
+ private:
+  /// Draws one shape of the OBJMesh for every instance.
+  class Shape;
+
+  /// \param scene_state Contains information about the current state of the
+  /// scene.
+  void update(SceneState& scene_state) override;
+
+  /// Upload the instance transforms to the buffer of a frame in flight if
+  /// they changed since it was last uploaded.
+  /// \param frame_index The index of the frame in flight.
+  /// \param command_buffer The command buffer of the frame to record the
+  /// upload into. Must be outside of a render pass.
+  void updateInstanceBuffer(size_t frame_index,
+                            const vk::CommandBuffer& command_buffer);
+
+  /// Called when the instances change.
+  void onInstancesChanged();
+
+  /// The OBJMesh providing the geometry, textures and materials.
+  std::shared_ptr<OBJMesh> obj_mesh;
+
+  /// One Shape per shape of the OBJMesh.
+  std::vector<std::shared_ptr<Shape>> shapes;
+
+  /// One shader per shader of the OBJMesh, binding the same texture and
+  /// materials but the uniform buffers of this InstancedMesh.
+  std::vector<std::shared_ptr<Shader>> shaders;
+
+  /// One pipeline per shader variant, see OBJMesh::graphics_pipelines.
+  std::vector<std::shared_ptr<GraphicsPipeline>> graphics_pipelines;
+
+  /// Model view projection uniform buffers for each frame in flight.
+  std::vector<std::shared_ptr<UniformBuffer<OBJMesh::MvpUbo>>> mvp_buffers;
+
+  /// The number of transforms in front of the instance transforms in
+  /// instance_data. Shape i is drawn with i as its first instance, so that
+  /// the shader can find its material, and its instance buffer is bound
+  /// num_padding_instances - i transforms into the buffer.
+  size_t num_padding_instances;
+
+  /// The padding transforms followed by the transform of each instance.
+  std::vector<Eigen::Matrix4f> instance_data;
+
+  /// The instance buffer of each frame in flight.
+  std::vector<std::shared_ptr<VertexAttribute<Eigen::Matrix4f>>>
+      instance_attributes;
+
+  /// The value of instance_version when each instance buffer was uploaded.
+  std::vector<uint64_t> instance_attribute_versions;
+
+  /// Incremented whenever the instances change.
+  uint64_t instance_version;
+
+  /// True if the graphics pipelines have been updated.
+  bool graphics_pipeline_updated;
+
+  /// The framebuffer size the graphics pipelines were created for.
+  uint32_t graphics_pipeline_width;
+  uint32_t graphics_pipeline_height;
+
+  /// The bounds of all instances, recomputed when they change.
+  mutable BoundingBox<Eigen::Vector3f> bounding_box;
+
+  /// True if bounding_box is out of date.
+  mutable bool bounding_box_dirty;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_INSTANCEDMESH_H_
@@ -0,0 +1,166 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_MEMORYDEFRAGMENTER_H_
+#define INCLUDE_VULKANENGINE_MEMORYDEFRAGMENTER_H_
+
+#include <VulkanEngine/SingleUsageCommandBuffer.h>
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wnullability-completeness"
+#endif
+#include <vk_mem_alloc.h>
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+class BufferBase;
+
+/// Compacts device memory which has fragmented after many resources were
+/// created and destroyed, using the incremental defragmentation of VMA.
+/// Each pass moves a limited number of allocations into the holes of other
+/// blocks, so that emptied blocks can be freed. Only resources registered
+/// with registerResource() are moved. These create a copy of their buffer or
+/// image bound to the new allocation, see BufferBase::beginMove(), and
+/// switch to it once the copy has completed. Images update the version of
+/// their descriptor so that shaders rewrite their descriptor sets, see
+/// Descriptor::getVersion().
+/// Passes wait for the device to be idle since the moved resources may be
+/// used by the frames in flight, so update() only runs them on frames
+/// without pending uploads. Disabled by default.
+class MemoryDefragmenter : private SingleUsageCommandBuffer {
+ public:
+  /// The maximum number of allocations moved by a single pass.
+  static constexpr uint32_t kMaxAllocationsPerPass = 64;
+
+  /// Constructor.
+  MemoryDefragmenter();
+
+  /// Destructor.
+  ~MemoryDefragmenter();
+
+  /// Delete copy constructor, the class holds a defragmentation context.
+  MemoryDefragmenter(const MemoryDefragmenter&) = delete;
+
+  /// Delete assignment operator, the class holds a defragmentation context.
+  void operator=(const MemoryDefragmenter&) = delete;
+
+  /// Allow a resource to be moved. Thread safe. Registering an allocation
+  /// again replaces its resource.
+  /// \param vma_allocation The allocation of the resource.
+  /// \param resource The resource owning the allocation.
+  void registerResource(VmaAllocation vma_allocation, BufferBase* resource);
+
+  /// Stop moving a resource. Must be called by all Buffer and Image
+  /// instances before their allocation is freed, which also keeps
+  /// allocations from being freed while a pass is running. Thread safe.
+  /// \param vma_allocation The allocation of the resource.
+  void unregisterResource(VmaAllocation vma_allocation);
+
+  /// Run a pass if enabled, the pass interval has elapsed and nothing is
+  /// being uploaded. Called by Scene::update() at the start of every frame,
+  /// before the frame is begun.
+  void update();
+
+  /// Run a single pass, starting a new defragmentation if none is in
+  /// progress. Defragmentations alternate between the default pools of VMA
+  /// and the geometry pool of MemoryPools. Waits for the device to be idle
+  /// if allocations are moved. Must be called by the thread recording
+  /// frames, outside of a frame.
+  /// \return True if allocations were moved.
+  bool runPass();
+
+  /// Set whether update() runs passes.
+  /// \param _enabled True to defragment during idle frames.
+  void setEnabled(bool _enabled);
+
+  /// \return True if update() runs passes.
+  bool isEnabled() const;
+
+  /// Set the number of frames between passes run by update().
+  /// \param _pass_interval The number of frames, at least 1.
+  void setPassInterval(uint32_t _pass_interval);
+
+  /// \return The number of frames between passes run by update().
+  uint32_t getPassInterval() const;
+
+  /// Set the maximum number of bytes moved by a single pass. Takes effect
+  /// for the next defragmentation.
+  /// \param _max_bytes_per_pass The number of bytes, 0 for no limit.
+  void setMaxBytesPerPass(vk::DeviceSize _max_bytes_per_pass);
+
+  /// \return The maximum number of bytes moved by a single pass.
+  vk::DeviceSize getMaxBytesPerPass() const;
+
+  /// \return The number of registered resources.
+  size_t getNumResources() const;
+
+  /// \return The number of allocations moved since the defragmenter was
+  /// created.
+  size_t getNumMovedAllocations() const;
+
+  /// \return The number of bytes moved since the defragmenter was created.
+  vk::DeviceSize getMovedBytes() const;
+
+  /// End the defragmentation in progress and forget all resources. The
+  /// device must be idle.
+  void clear();
+
+ private:
+  /// Start a defragmentation of the next pool.
+  /// \return True if the defragmentation was started.
+  bool beginDefragmentation();
+
+  /// End the defragmentation in progress.
+  void endDefragmentation();
+
+  /// Protects resources and serializes passes with frees.
+  mutable std::mutex mutex;
+
+  /// The registered resources by allocation.
+  std::unordered_map<VmaAllocation, BufferBase*> resources;
+
+  /// The defragmentation in progress, null if none.
+  VmaDefragmentationContext context;
+
+  /// Selects the pool of the next defragmentation.
+  size_t next_pool;
+
+  /// The resources moved by the current pass, kept to avoid allocations.
+  std::vector<BufferBase*> moved_resources;
+
+  /// See setEnabled().
+  std::atomic<bool> enabled;
+
+  /// See setPassInterval().
+  uint32_t pass_interval;
+
+  /// The number of calls to update() since the last pass.
+  uint64_t frames_since_pass;
+
+  /// See setMaxBytesPerPass().
+  vk::DeviceSize max_bytes_per_pass;
+
+  /// See getNumMovedAllocations().
+  size_t num_moved_allocations;
+
+  /// See getMovedBytes().
+  vk::DeviceSize moved_bytes;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_MEMORYDEFRAGMENTER_H_
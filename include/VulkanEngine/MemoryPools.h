@@ -0,0 +1,195 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_MEMORYPOOLS_H_
+#define INCLUDE_VULKANENGINE_MEMORYPOOLS_H_
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wnullability-completeness"
+#endif
+#include <vk_mem_alloc.h>
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// Configures the MemoryPools of a Device. Set with
+/// VulkanManager::setMemoryPoolSettings() before the VulkanManager is
+/// initialized.
+struct MemoryPoolSettings {
+  /// Allocate from the pools below. If false, all allocations use the
+  /// default pools of VMA.
+  bool enabled = true;
+
+  /// The size of the blocks of the pool for device local vertex and index
+  /// buffers. 0 disables the pool.
+  vk::DeviceSize geometry_block_size = 256ull << 20;
+
+  /// The size of the blocks of the pool for small host visible uniform and
+  /// staging buffers. 0 disables the pool.
+  vk::DeviceSize host_visible_block_size = 16ull << 20;
+
+  /// Buffers larger than this are never allocated from the host visible
+  /// pool, so that large uploads don't fragment it.
+  vk::DeviceSize host_visible_max_allocation_size = 1ull << 20;
+
+  /// The size of the single block of the linear pool for transient buffers,
+  /// which are freed within a few frames of being created. 0 disables the
+  /// pool.
+  vk::DeviceSize transient_pool_size = 32ull << 20;
+
+  /// Buffers larger than this are never allocated from the transient pool,
+  /// so that large uploads don't exhaust it.
+  vk::DeviceSize transient_max_allocation_size = 1ull << 20;
+
+  /// Give color and depth attachments their own VkDeviceMemory.
+  bool dedicated_attachments = true;
+};
+
+/// Chooses where Buffer and Image allocations come from. By default VMA
+/// sizes its blocks for a mix of allocations and places everything of a
+/// memory type in the same blocks. Instead:
+/// - Device local vertex and index buffers come from a pool with large
+///   blocks, so that loading and unloading meshes doesn't fragment the
+///   blocks used by other resources.
+/// - Small host visible uniform and staging buffers, which mostly live as
+///   long as the objects owning them, come from a pool of their own.
+/// - Host visible buffers created as transient, such as the staging buffers
+///   of per frame uploads, come from a pool with a single block and VMA's
+///   linear algorithm. Allocating is a pointer bump, and since the
+///   DeletionQueue frees them in the order of their frames the block is
+///   cycled through like a ring buffer.
+/// - Color and depth attachments get dedicated allocations, which drivers
+///   may place and compress better.
+/// Allocations which don't fit into their pool fall back to VMA's default
+/// pools.
+class MemoryPools {
+ public:
+  /// The custom pools.
+  enum class Pool : uint8_t { eGeometry, eHostVisible, eTransient };
+
+  /// Constructor. Creates the pools.
+  /// \param _vma_allocator The allocator to create the pools with.
+  /// \param _settings The sizes of the pools.
+  MemoryPools(VmaAllocator _vma_allocator,
+              const MemoryPoolSettings& _settings);
+
+  /// Destructor. Destroys the pools, which must not have allocations left.
+  ~MemoryPools();
+
+  /// Delete copy constructor, the class owns VMA pools.
+  MemoryPools(const MemoryPools&) = delete;
+
+  /// Delete assignment operator, the class owns VMA pools.
+  void operator=(const MemoryPools&) = delete;
+
+  /// Create a buffer and allocate its memory. Thread safe.
+  /// \param buffer_create_info Describes the buffer.
+  /// \param allocation_create_info Describes the allocation. The pool and
+  /// flags are chosen by this function.
+  /// \param vk_buffer Set to the created buffer.
+  /// \param vma_allocation Set to the allocation of the buffer.
+  /// \param transient True if the buffer is freed within a few frames, in
+  /// which case it may come from the transient pool.
+  /// \return The result of vmaCreateBuffer().
+  VkResult createBuffer(const VkBufferCreateInfo& buffer_create_info,
+                        VmaAllocationCreateInfo allocation_create_info,
+                        VkBuffer* vk_buffer, VmaAllocation* vma_allocation,
+                        bool transient = false);
+
+  /// Create an image and allocate its memory. Thread safe.
+  /// \param image_create_info Describes the image.
+  /// \param allocation_create_info Describes the allocation. The pool and
+  /// flags are chosen by this function.
+  /// \param vk_image Set to the created image.
+  /// \param vma_allocation Set to the allocation of the image.
+  /// \return The result of vmaCreateImage().
+  VkResult createImage(const VkImageCreateInfo& image_create_info,
+                       VmaAllocationCreateInfo allocation_create_info,
+                       VkImage* vk_image, VmaAllocation* vma_allocation);
+
+  /// Enable or disable the pools for new allocations. Existing allocations
+  /// are not moved.
+  /// \param enabled True to allocate from the pools.
+  void setEnabled(bool enabled);
+
+  /// \return True if new allocations are made from the pools.
+  bool isEnabled() const;
+
+  /// \return The bytes currently allocated from a pool.
+  /// \param pool The pool.
+  vk::DeviceSize getAllocatedBytes(Pool pool) const;
+
+  /// \return The number of allocations which didn't fit into their pool and
+  /// were made from VMA's default pools instead.
+  size_t getNumFallbacks() const;
+
+  /// \return The VmaPool of a pool, null if it is disabled.
+  /// \param pool The pool.
+  VmaPool getVmaPool(Pool pool) const;
+
+ private:
+  /// Create a pool for buffers.
+  /// \param buffer_usage_flags The usage of the buffers of the pool.
+  /// \param vma_memory_usage The VmaMemoryUsage of the buffers of the pool.
+  /// \param required_flags The memory properties the buffers need.
+  /// \param flags VmaPoolCreateFlags of the pool.
+  /// \param block_size The size of the blocks of the pool.
+  /// \param max_block_count The maximum number of blocks, 0 for no limit.
+  /// \param memory_property_flags Set to the properties of the memory type
+  /// of the pool.
+  /// \return The pool, or null if it could not be created.
+  VmaPool createPool(vk::BufferUsageFlags buffer_usage_flags,
+                     VmaMemoryUsage vma_memory_usage,
+                     VkMemoryPropertyFlags required_flags,
+                     VmaPoolCreateFlags flags, vk::DeviceSize block_size,
+                     size_t max_block_count,
+                     VkMemoryPropertyFlags& memory_property_flags);
+
+  /// \return The pool a buffer should be allocated from, or null.
+  /// \param buffer_create_info Describes the buffer.
+  /// \param allocation_create_info Describes the allocation.
+  /// \param transient See createBuffer().
+  VmaPool choosePool(const VkBufferCreateInfo& buffer_create_info,
+                     const VmaAllocationCreateInfo& allocation_create_info,
+                     bool transient) const;
+
+  /// The allocator the pools belong to.
+  VmaAllocator vma_allocator;
+
+  /// The settings the pools were created with.
+  MemoryPoolSettings settings;
+
+  /// Large block pool for device local vertex and index buffers.
+  VmaPool geometry_pool;
+
+  /// Pool for small host visible uniform and staging buffers.
+  VmaPool host_visible_pool;
+
+  /// Linear pool for small host visible transient buffers.
+  VmaPool transient_pool;
+
+  /// The properties of the memory type of host_visible_pool and
+  /// transient_pool. Requested memory properties are ignored when allocating
+  /// from a pool, so they are checked against these before choosing it.
+  VkMemoryPropertyFlags host_visible_memory_property_flags;
+
+  /// True if new allocations are made from the pools.
+  std::atomic<bool> enabled;
+
+  /// The number of allocations which fell back to the default pools.
+  std::atomic<size_t> num_fallbacks;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_MEMORYPOOLS_H_
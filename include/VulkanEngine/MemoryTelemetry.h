@@ -0,0 +1,185 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_MEMORYTELEMETRY_H_
+#define INCLUDE_VULKANENGINE_MEMORYTELEMETRY_H_
+
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wnullability-completeness"
+#endif
+#include <vk_mem_alloc.h>
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// Tracks the memory allocated through VMA by Buffer and Image instances,
+/// grouped by what the memory is used for, together with the usage and
+/// budget of each memory heap as reported by VMA. Heap budgets come from
+/// VK_EXT_memory_budget if the device supports it, otherwise VMA estimates
+/// them. Snapshots can be written as JSON to compare runs of different
+/// builds.
+class MemoryTelemetry {
+ public:
+  /// What an allocation is used for.
+  enum class Category : uint8_t {
+    eVertex,
+    eIndex,
+    eUniform,
+    eStaging,
+    eTexture,
+    eAttachment,
+    eOther
+  };
+
+  /// The number of values of Category.
+  static constexpr size_t kNumCategories = 7;
+
+  /// The allocations of one Category.
+  struct CategoryStatistics {
+    /// The number of live allocations.
+    size_t allocation_count = 0;
+
+    /// The bytes of all live allocations.
+    vk::DeviceSize bytes = 0;
+
+    /// The largest value bytes has had.
+    vk::DeviceSize peak_bytes = 0;
+  };
+
+  /// The usage of one memory heap.
+  struct HeapStatistics {
+    /// True if the heap is device local.
+    bool device_local = false;
+
+    /// The bytes used by the process, including memory not allocated by VMA.
+    vk::DeviceSize usage = 0;
+
+    /// The bytes the process can probably use without problems.
+    vk::DeviceSize budget = 0;
+
+    /// The bytes of all VkDeviceMemory blocks allocated by VMA.
+    vk::DeviceSize block_bytes = 0;
+
+    /// The bytes of all allocations made from those blocks.
+    vk::DeviceSize allocation_bytes = 0;
+
+    /// The number of VkDeviceMemory blocks allocated by VMA.
+    uint32_t block_count = 0;
+
+    /// The number of allocations made by VMA.
+    uint32_t allocation_count = 0;
+  };
+
+  /// The state of all tracked memory at one point in time.
+  struct Snapshot {
+    /// Statistics indexed by Category.
+    std::array<CategoryStatistics, kNumCategories> categories;
+
+    /// Statistics indexed by memory heap.
+    std::vector<HeapStatistics> heaps;
+
+    /// The number of live tracked allocations.
+    size_t allocation_count = 0;
+
+    /// The bytes of all live tracked allocations.
+    vk::DeviceSize bytes = 0;
+
+    /// The largest value bytes has had.
+    vk::DeviceSize peak_bytes = 0;
+
+    /// \return The snapshot formatted as a JSON object.
+    std::string toJSON() const;
+  };
+
+  /// Constructor.
+  /// \param _vma_allocator The allocator to report heap statistics of.
+  explicit MemoryTelemetry(VmaAllocator _vma_allocator);
+
+  /// Destructor.
+  ~MemoryTelemetry();
+
+  /// Delete copy constructor, allocations are tracked by a single instance.
+  MemoryTelemetry(const MemoryTelemetry&) = delete;
+
+  /// Delete assignment operator, allocations are tracked by a single
+  /// instance.
+  void operator=(const MemoryTelemetry&) = delete;
+
+  /// Start tracking an allocation. Thread safe.
+  /// \param vma_allocation The allocation.
+  /// \param category What the allocation is used for.
+  void recordAllocation(VmaAllocation vma_allocation, Category category);
+
+  /// Stop tracking an allocation before it is freed. Thread safe.
+  /// \param vma_allocation The allocation passed to recordAllocation().
+  void recordFree(VmaAllocation vma_allocation);
+
+  /// \return The current state of all tracked memory. Thread safe.
+  Snapshot getSnapshot() const;
+
+  /// Write getSnapshot() as JSON to a file.
+  /// \param path The path of the file.
+  /// \return True if the file was written.
+  bool writeJSON(const std::filesystem::path& path) const;
+
+  /// Reset the peak usage of all categories to the current usage.
+  void resetPeaks();
+
+  /// \return The Category of a buffer.
+  /// \param usage_flags The vk::BufferUsageFlags of the buffer.
+  /// \param vma_memory_usage The VmaMemoryUsage the buffer is allocated with.
+  static Category getBufferCategory(vk::BufferUsageFlags usage_flags,
+                                    VmaMemoryUsage vma_memory_usage);
+
+  /// \return The Category of an image.
+  /// \param usage_flags The vk::ImageUsageFlags of the image.
+  static Category getImageCategory(vk::ImageUsageFlags usage_flags);
+
+  /// \return The name of a Category as used in JSON snapshots.
+  /// \param category The Category.
+  static const char* getCategoryName(Category category);
+
+ private:
+  /// A tracked allocation.
+  struct Allocation {
+    Category category;
+    vk::DeviceSize size;
+  };
+
+  /// The allocator to report heap statistics of.
+  VmaAllocator vma_allocator;
+
+  /// Protects the members below, buffers are created on loader threads.
+  mutable std::mutex mutex;
+
+  /// The live tracked allocations.
+  std::unordered_map<VmaAllocation, Allocation> allocations;
+
+  /// Statistics indexed by Category.
+  std::array<CategoryStatistics, kNumCategories> categories;
+
+  /// The bytes of all live tracked allocations.
+  vk::DeviceSize bytes;
+
+  /// The largest value bytes has had.
+  vk::DeviceSize peak_bytes;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_MEMORYTELEMETRY_H_
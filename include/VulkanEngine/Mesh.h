@@ -84,6 +84,16 @@ class Mesh : public MeshBase {
   /// \param min The minimum position of the bounding box.
   void setBoundingBox(const PositionType& max, const PositionType& min);
 
+  /// Restrict drawing to a range of the index buffer. Allows several Mesh
+  /// instances to share the same VertexAttribute and IndexAttribute instances,
+  /// each drawing its own part. By default all indices are drawn.
+  /// \param _first_index The first index to draw.
+  /// \param _index_count The number of indices to draw.
+  /// \param _vertex_offset Value added to each index before indexing into the
+  /// vertex buffers.
+  void setDrawRange(uint32_t _first_index, uint32_t _index_count,
+                    int32_t _vertex_offset);
+
   /// \return The vk::PipelineVertexInputStateCreateInfo instance describing the
   /// attributes that constitute the Mesh.
   virtual const vk::PipelineVertexInputStateCreateInfo&
@@ -114,6 +124,19 @@ class Mesh : public MeshBase {
   /// \param command_buffer The vk::CommandBuffer to insert the commands into.
   virtual void draw(const vk::CommandBuffer& command_buffer);
 
+  /// \return True if the Mesh has indices.
+  virtual bool isIndexed() const;
+
+  /// \return The parameters draw() passes to vk::CommandBuffer::drawIndexed().
+  virtual vk::DrawIndexedIndirectCommand getDrawIndexedIndirectCommand() const;
+
+  /// \return The parameters draw() passes to vk::CommandBuffer::draw().
+  virtual vk::DrawIndirectCommand getDrawIndirectCommand() const;
+
+  /// \return The positions VertexAttribute. Meshes sharing their positions
+  /// are expected to share all of their buffers.
+  virtual const void* getGeometryId() const;
+
  private:
   /// The positions defining the Mesh.
   std::shared_ptr<VertexAttribute<PositionType>> positions;
@@ -135,6 +158,18 @@ class Mesh : public MeshBase {
   vk::PipelineInputAssemblyStateCreateInfo pipeline_input_assembly_state_info;
 
   bool pipeline_input_state_info_initialized;
+
+  /// True if setDrawRange() has been called. Otherwise all indices are drawn.
+  bool has_draw_range;
+
+  /// The first index to draw.
+  uint32_t first_index;
+
+  /// The number of indices to draw.
+  uint32_t index_count;
+
+  /// Value added to each index before indexing into the vertex buffers.
+  int32_t vertex_offset;
 };
 
 }  // namespace VulkanEngine
@@ -52,6 +52,23 @@ class MeshBase {
   /// \param command_buffer The vk::CommandBuffer to insert the commands into.
   virtual void draw(const vk::CommandBuffer& command_buffer) = 0;
 
+  /// \return True if the Mesh is drawn using an index buffer.
+  virtual bool isIndexed() const = 0;
+
+  /// \return The parameters draw() passes to vk::CommandBuffer::drawIndexed(),
+  /// for writing them into an indirect draw buffer. Only valid if isIndexed().
+  virtual vk::DrawIndexedIndirectCommand getDrawIndexedIndirectCommand()
+      const = 0;
+
+  /// \return The parameters draw() passes to vk::CommandBuffer::draw(). Only
+  /// valid if the Mesh is not indexed.
+  virtual vk::DrawIndirectCommand getDrawIndirectCommand() const = 0;
+
+  /// \return A value identifying the buffers bound by bindVertexBuffers() and
+  /// bindIndexBuffer(). Meshes returning the same value can be drawn one after
+  /// the other without binding buffers again.
+  virtual const void* getGeometryId() const = 0;
+
   template <typename PositionType>
   const BoundingBox<PositionType>& getBoundingBox() const {
     return *static_cast<const BoundingBox<PositionType>*>(bounding_box.get());
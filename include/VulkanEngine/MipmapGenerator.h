@@ -0,0 +1,153 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_MIPMAPGENERATOR_H_
+#define INCLUDE_VULKANENGINE_MIPMAPGENERATOR_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+class ComputePipeline;
+class Shader;
+class ShaderModule;
+
+template <typename T>
+class StorageBuffer;
+
+/// How the mip levels of an Image are generated from level 0.
+enum class MipmapMode : uint8_t {
+  /// Blit each level from the level above it, with barriers in between.
+  eBlit,
+  /// Write all levels with a single compute dispatch, see MipmapGenerator.
+  /// Images which the generator doesn't support fall back to eBlit.
+  eCompute
+};
+
+/// Generates all mip levels of an image with a single compute dispatch
+/// instead of one blit and barrier per level. Each work group reduces a 64x64
+/// tile of level 0 to levels 1 to 6, keeping intermediate levels in shared
+/// memory. The last work group to finish, found with an atomic counter,
+/// reduces level 6 to the remaining levels.
+/// Levels are computed with a 2x2 box filter in linear space. sRGB images are
+/// written through views with the matching UNORM format, since sRGB formats
+/// can rarely be used as storage images, and the shader converts texels to
+/// and from sRGB itself.
+class MipmapGenerator {
+ public:
+  /// The largest supported width or height. Level 6 of such an image is
+  /// reduced by a single work group.
+  static constexpr uint32_t kMaxSize = 4096;
+
+  /// The views and descriptor set used to generate the levels of one image.
+  /// Owned by the image, since they are referenced by recorded commands.
+  struct ImageResources {
+    /// Destructor. Destroys the level views.
+    ~ImageResources();
+
+    /// One view with the storage format per level.
+    std::vector<vk::ImageView> level_views;
+
+    /// The work group counter, reset by the last work group.
+    std::shared_ptr<StorageBuffer<uint32_t>> counter;
+
+    /// Owns the descriptor set binding the views and the counter.
+    std::shared_ptr<Shader> shader;
+
+    /// The pipeline to generate the levels with, shared between images.
+    std::shared_ptr<ComputePipeline> compute_pipeline;
+  };
+
+  /// Constructor.
+  MipmapGenerator();
+
+  /// Destructor.
+  ~MipmapGenerator();
+
+  /// Delete copy constructor, the generator owns pipelines.
+  MipmapGenerator(const MipmapGenerator&) = delete;
+
+  /// Delete assignment operator, the generator owns pipelines.
+  void operator=(const MipmapGenerator&) = delete;
+
+  /// \return True if the levels of an image can be generated.
+  /// \param format The vk::Format of the image.
+  /// \param width The width of level 0.
+  /// \param height The height of level 0.
+  bool supports(vk::Format format, uint32_t width, uint32_t height) const;
+
+  /// \return The vk::ImageCreateFlags an image of the given format must be
+  /// created with, in addition to vk::ImageUsageFlagBits::eStorage usage.
+  /// \param format The vk::Format of the image.
+  static vk::ImageCreateFlags getImageCreateFlags(vk::Format format);
+
+  /// Insert the commands which generate levels 1 and above of an image from
+  /// level 0, and transition all levels to eShaderReadOnlyOptimal.
+  /// \param command_buffer The vk::CommandBuffer to insert the commands into.
+  /// \param image The image. All levels must be in eTransferDstOptimal layout
+  /// and level 0 must have been written with a transfer.
+  /// \param format The vk::Format of the image. Must be supported.
+  /// \param width The width of level 0.
+  /// \param height The height of level 0.
+  /// \param mip_levels The number of levels of the image.
+  /// \param resources The resources of the image, created on first use. Must
+  /// be kept alive until the commands have executed.
+  void generate(const vk::CommandBuffer& command_buffer, vk::Image image,
+                vk::Format format, uint32_t width, uint32_t height,
+                uint32_t mip_levels,
+                std::shared_ptr<ImageResources>& resources);
+
+  /// Destroy all pipelines. The device must be idle.
+  void clear();
+
+ private:
+  /// The format the levels of an image are written with.
+  struct FormatInfo {
+    /// The format of the storage views.
+    vk::Format storage_format;
+
+    /// The matching GLSL image format qualifier.
+    const char* glsl_format;
+
+    /// True if texels are stored in sRGB.
+    bool srgb;
+  };
+
+  /// A compiled variant of the shader, shared by images with the same format
+  /// and number of levels.
+  struct Variant {
+    std::shared_ptr<ShaderModule> shader_module;
+    std::shared_ptr<ComputePipeline> compute_pipeline;
+  };
+
+  /// Look up how an image format is written.
+  /// \param format The vk::Format of the image.
+  /// \param format_info Set to the info of the format if it is supported.
+  /// \return False if the format isn't supported.
+  static bool getFormatInfo(vk::Format format, FormatInfo& format_info);
+
+  /// \return The GLSL source of the downsampling shader.
+  /// \param format_info The format the levels are written with.
+  /// \param mip_levels The number of levels of the image.
+  static const std::string getComputeShaderString(const FormatInfo& format_info,
+                                                  uint32_t mip_levels);
+
+  /// Protects variants, images may be created on loader threads.
+  std::mutex mutex;
+
+  /// Variants keyed by image format and number of levels.
+  std::map<std::pair<vk::Format, uint32_t>, Variant> variants;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_MIPMAPGENERATOR_H_
@@ -10,10 +10,15 @@
 #include <VulkanEngine/GraphicsPipeline.h>
 #include <VulkanEngine/MeshBase.h>
 #include <VulkanEngine/SceneObject.h>
+#include <VulkanEngine/StorageBuffer.h>
+#include <VulkanEngine/StreamedTexture.h>
 #include <VulkanEngine/UniformBuffer.h>
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>  // NOLINT(build/c++17)
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -23,21 +28,66 @@
 
 namespace VulkanEngine {
 
+class InstancedMesh;
+
 /// A SceneObject which represents an OBJMesh.
+/// The geometry, materials and textures of an OBJ file are loaded through the
+/// AssetRegistry of the VulkanManager, so OBJMesh instances of the same file
+/// share them and textures used by several files are only loaded once.
+/// Loading can happen in the background, in which case shapes are drawn as
+/// soon as their geometry and texture have been uploaded. If the
+/// TextureStreamer is enabled, the mip levels of textures are streamed
+/// according to the size of the shapes using them on screen.
 class OBJMesh : public SceneObject {
+  /// Draws the geometry, textures and materials of an OBJMesh many times.
+  friend class InstancedMesh;
+
  public:
+  /// How the constructor loads the OBJ file.
+  enum class LoadMode : uint8_t {
+    /// Load and upload everything before the constructor returns. Errors are
+    /// thrown from the constructor.
+    eBlocking,
+
+    /// Return immediately. Parsing and texture decoding run on the worker
+    /// threads of the AssetRegistry and uploads are recorded by
+    /// Scene::update(), so shapes appear over the following frames. Errors
+    /// are written to std::cerr.
+    eAsynchronous
+  };
+
   /// Constructor.
   /// \param obj_file Path to obj file.
   /// \param mtl_file Path to mtl file location.
+  /// \param load_mode Whether to wait for the file to be loaded.
   OBJMesh(std::filesystem::path obj_file, std::filesystem::path mtl_path = "",
-          const std::shared_ptr<Shader> _shader = std::shared_ptr<Shader>());
+          const std::shared_ptr<Shader> _shader = std::shared_ptr<Shader>(),
+          LoadMode load_mode = LoadMode::eBlocking);
 
   /// Destructor.
   virtual ~OBJMesh();
 
+  /// \return True once every shape can be drawn.
+  bool isLoaded() const;
+
+  /// \return The fraction of shapes which can be drawn, between 0 and 1.
+  float getLoadProgress() const;
+
+  /// \return The size in bytes of the device memory used by the textures of
+  /// the shapes which can be drawn. Textures used by several shapes are
+  /// counted once, streamed textures with their currently resident levels.
+  size_t getTextureMemorySize() const;
+
+  /// Block until every shape can be drawn, uploading whatever is still
+  /// queued right away. Must be called by the thread recording frames.
+  void waitUntilLoaded();
+
   /// \return The OBJMesh's bounding box.
   const BoundingBox<Eigen::Vector3f>& getBoundingBox() const;
 
+  bool getLocalBoundingBox(
+      BoundingBox<Eigen::Vector3f>& _bounding_box) const override;
+
  private:
 #pragma pack(push, 1)
   struct MvpUbo {
@@ -53,43 +103,198 @@ class OBJMesh : public SceneObject {
   };
 #pragma pack(pop)
 
+  /// A texture loaded for a material, shared by every OBJ file using it.
+  struct Texture {
+    /// The texture.
+    std::shared_ptr<Descriptor> descriptor;
+
+    /// The TransferQueue transfer uploading the texture.
+    uint64_t transfer;
+
+    /// The size in bytes of the device memory used by the texture.
+    size_t size;
+
+    /// The same texture if its levels are streamed, null otherwise.
+    std::shared_ptr<StreamedTexture> streamed_texture;
+  };
+
+  /// The data loaded from an OBJ file, shared by every OBJMesh of the file.
+  struct Model {
+    /// One mesh per shape, see OBJMesh::meshes.
+    std::vector<std::shared_ptr<MeshBase>> meshes;
+
+    /// The diffuse texture of each shape, loaded in the background. Invalid
+    /// if the shape has none, null if it couldn't be loaded.
+    std::vector<std::shared_future<std::shared_ptr<Texture>>> shape_textures;
+
+    /// The material of each shape.
+    std::shared_ptr<StorageBuffer<Material>> material_buffer;
+
+    /// The bounds of all shapes.
+    BoundingBox<Eigen::Vector3f> bounding_box;
+
+    /// The TransferQueue transfer uploading the geometry.
+    uint64_t transfer;
+  };
+
   /// \param scene_state Contains information about the current state of the
   /// scene.
-  void update(std::shared_ptr<SceneState> scene_state) override;
+  void update(SceneState& scene_state) override;
 
-  /// Load an obj file from the given path
+  /// Load an obj file from the given path and queue its upload. Textures are
+  /// loaded in the background.
   /// \param obj_path Path to the obj file.
   /// \param mtl_path Optional path to the mtl file.
-  void loadOBJ(const char* obj_path, const char* mtl_path);
+  /// \return The loaded Model.
+  static std::shared_ptr<Model> loadModel(const std::string& obj_path,
+                                          const std::string& mtl_path);
+
+  /// Decode a texture and queue its upload. KTX2 and DDS files are loaded
+  /// with loadTextureFile(), other images with loadImage(). If an image has a
+  /// KTX2 file with the same name next to it which is at least as new, as
+  /// written by TextureBaker, that file is loaded instead.
+  /// \param texture_path The path of the image file.
+  /// \return The texture, or null if the image could not be loaded.
+  static std::shared_ptr<Texture> loadTexture(
+      const std::filesystem::path& texture_path);
+
+  /// Load a KTX2 or DDS file and queue the upload of all of its mip levels.
+  /// The levels are uploaded in the format of the file if the device can
+  /// sample it, otherwise they are transcoded to R8G8B8A8 first.
+  /// \param texture_path The path of the KTX2 or DDS file.
+  /// \return The texture, or null if the file could not be loaded.
+  static std::shared_ptr<Texture> loadTextureFile(
+      const std::filesystem::path& texture_path);
+
+  /// Decode an image to R8G8B8A8 using stb_image and queue its upload. Mip
+  /// levels are generated on the GPU, or on the CPU if the texture is
+  /// streamed.
+  /// \param texture_path The path of the image file.
+  /// \return The texture, or null if the image could not be loaded.
+  static std::shared_ptr<Texture> loadImage(
+      const std::filesystem::path& texture_path);
+
+  /// Stream the levels of a texture with the TextureStreamer.
+  /// \param texture_file The texture with all of its levels.
+  /// \return The texture, with its first levels queued for upload.
+  static std::shared_ptr<Texture> createStreamedTexture(
+      std::shared_ptr<const TextureFile> texture_file);
+
+  /// Estimate the size of a texture on screen, assuming that it covers an
+  /// object once.
+  /// \param projection The projection matrix.
+  /// \param framebuffer_height The height of the framebuffer in pixels.
+  /// \param radius The radius of the bounding sphere of the object.
+  /// \param depth The distance of the object's center along the view
+  /// direction.
+  /// \return The number of pixels covered by the diameter of the object.
+  static float getScreenSize(const Eigen::Matrix4f& projection,
+                             float framebuffer_height, float radius,
+                             float depth);
+
+  /// Take the model once it is loaded and prepare the shapes which have
+  /// become available for drawing. Called every update while loading.
+  void updateLoading();
+
+  /// Create the uniform buffers and vertex shader used to draw the model.
+  void createShaders();
+
+  /// Create or share the shader and pipeline of a shape, after which it is
+  /// drawn.
+  /// \param index The index of the shape.
+  /// \param texture The diffuse texture of the shape, may be null.
+  void addShape(size_t index, const std::shared_ptr<Descriptor>& texture);
 
   /// \return Auto generated vertex shader for this OBJMesh.
-  /// \param has_tex_coords Set to true if the obj has texture coordinates.
-  const std::string getVertexShaderString() const;
+  /// \param instanced Set to true to apply a per instance transform read from
+  /// locations 3 to 6 after the model matrix. The draw index is then read from
+  /// gl_BaseInstanceARB, which requires Device::supportsShaderDrawParameters().
+  const std::string getVertexShaderString(bool instanced = false) const;
 
   /// \return Auto generated fragment shader for this OBJMesh.
   /// \param has_tex_coords Set to true if the obj has texture coordinates.
   const std::string getFragmentShaderString(bool has_texture) const;
 
-  /// Meshes composing this OBJMesh.
+  /// The Model drawn by this OBJMesh, null until loaded or if loading
+  /// failed.
+  std::shared_ptr<Model> model;
+
+  /// Valid until the model has been taken by updateLoading().
+  std::shared_future<std::shared_ptr<Model>> pending_model;
+
+  /// 1 for each shape which is drawn.
+  std::vector<uint8_t> shape_resident;
+
+  /// The number of shapes which are drawn.
+  size_t num_resident_shapes;
+
+  /// See getTextureMemorySize(). Excludes streamed textures.
+  size_t texture_memory_size;
+
+  /// The streamed texture of each shape, null if it has none.
+  std::vector<std::shared_ptr<StreamedTexture>> shape_streamed_textures;
+
+  /// The streamed textures used by drawn shapes, each listed once.
+  std::vector<std::shared_ptr<StreamedTexture>> streamed_textures;
+
+  /// Meshes composing this OBJMesh, one per shape. They share the same
+  /// vertex and index buffers and each draw a range of them.
   std::vector<std::shared_ptr<MeshBase>> meshes;
 
-  /// The shader to use for rendering the OBJMesh.
+  /// The shaders used for rendering the OBJMesh. One per texture, plus one
+  /// for all untextured shapes.
   std::vector<std::shared_ptr<Shader>> shaders;
 
+  /// Index into shaders for each shape.
+  std::vector<size_t> shader_indices;
+
+  /// The texture bound by each shader, null for the untextured shader.
+  std::vector<std::shared_ptr<Descriptor>> shader_textures;
+
+  /// Index into shaders for each texture.
+  std::unordered_map<const Descriptor*, size_t> texture_shader_indices;
+
+  /// The vertex shader shared by all shaders.
+  std::shared_ptr<ShaderModule> vertex_shader;
+
+  /// The fragment shader of each variant, null until used.
+  std::array<std::shared_ptr<ShaderModule>, 2> fragment_shaders;
+
+  /// One pipeline per shader variant, shared by all shapes using it. Shapes
+  /// of the same variant have identically defined descriptor set layouts so
+  /// their descriptor sets can be bound with the shared pipeline.
   std::vector<std::shared_ptr<GraphicsPipeline>> graphics_pipelines;
 
+  /// Index into graphics_pipelines for each shape.
+  std::vector<size_t> pipeline_indices;
+
+  /// Marks a variant without drawn shapes in pipeline_shapes.
+  static constexpr size_t kNoShape = static_cast<size_t>(-1);
+
+  /// The first drawn shape of each variant, which its pipeline is created
+  /// from. kNoShape if no shape of the variant is drawn yet.
+  std::array<size_t, 2> pipeline_shapes;
+
   /// Model view projection uniform buffers for each frame in flight.
   std::vector<std::shared_ptr<UniformBuffer<MvpUbo>>> mvp_buffers;
 
-  std::vector<std::vector<std::shared_ptr<UniformBuffer<Material>>>>
-      material_buffers;
-
-  /// Textures belonging to this mesh.
-  std::unordered_map<std::string, std::shared_ptr<Descriptor>> textures;
+  /// The material of each shape, indexed by the shape index which is passed
+  /// to the shader as the instance index.
+  std::shared_ptr<StorageBuffer<Material>> material_buffer;
 
   /// True if the graphics pipeline has been updated.
   bool graphics_pipeline_updated;
 
+  /// The framebuffer size the graphics pipelines were created for.
+  uint32_t graphics_pipeline_width;
+  uint32_t graphics_pipeline_height;
+
+  /// World space bounds of each shape in the current frame.
+  BoundingBoxArray shape_bounding_boxes;
+
+  /// 1 for each shape inside of the view frustum in the current frame.
+  std::vector<uint8_t> shape_visibility;
+
   /// The OBJMesh's bounding box.
   BoundingBox<Eigen::Vector3f> bounding_box;
 };
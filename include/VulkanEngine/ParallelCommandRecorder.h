@@ -0,0 +1,138 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_PARALLELCOMMANDRECORDER_H_
+#define INCLUDE_VULKANENGINE_PARALLELCOMMANDRECORDER_H_
+
+#include <VulkanEngine/CommandPool.h>
+#include <VulkanEngine/IndirectDrawBuffer.h>
+#include <VulkanEngine/RenderQueue.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// Records a RenderQueue into secondary command buffers using a fixed set of
+/// threads. The queue is split into one contiguous range per thread and each
+/// thread records into a command buffer from its own CommandPool, so no
+/// synchronization is needed while recording. The calling thread records the
+/// first range itself, the remaining ranges are handled by persistent worker
+/// threads.
+class ParallelCommandRecorder {
+ public:
+  /// Constructor.
+  /// \param _num_threads The number of threads to record with, including the
+  /// calling thread. Must be at least 1.
+  explicit ParallelCommandRecorder(size_t _num_threads);
+
+  /// Destructor. Joins all worker threads and queues the command pools for
+  /// destruction with the DeletionQueue.
+  ~ParallelCommandRecorder();
+
+  /// Delete copy constructor, the recorder owns threads and command pools.
+  ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+
+  /// Delete assignment operator, the recorder owns threads and command pools.
+  void operator=(const ParallelCommandRecorder&) = delete;
+
+  /// Record all draws of a RenderQueue into secondary command buffers.
+  /// Resets the command pools belonging to frame_index, so the GPU must have
+  /// finished executing the command buffers previously returned for it.
+  /// \param render_queue The RenderQueue to record.
+  /// \param inheritance_info Describes the render pass, subpass and
+  /// framebuffer the secondary command buffers will be executed in.
+  /// \param frame_index The index of the current frame in flight.
+  /// \param indirect_draw_buffer Optional buffer to write indirect draws to,
+  /// see RenderQueue::record(). Each thread writes the commands of its own
+  /// range, ranges are aligned to the batches built with
+  /// RenderQueue::buildBatches().
+  /// \return The recorded secondary command buffers in queue order, ready to
+  /// be passed to vk::CommandBuffer::executeCommands().
+  std::vector<vk::CommandBuffer> record(
+      const RenderQueue& render_queue,
+      const vk::CommandBufferInheritanceInfo& inheritance_info,
+      size_t frame_index,
+      const IndirectDrawBuffer* indirect_draw_buffer = nullptr);
+
+  /// \return The number of threads used for recording.
+  size_t getNumThreads() const;
+
+  /// \return The commands recorded by the last call to record(), summed over
+  /// all threads.
+  const RenderStatistics& getStatistics() const;
+
+ private:
+  /// Main loop of a worker thread.
+  /// \param thread_index The index of the thread's range and command pools.
+  void workerLoop(size_t thread_index);
+
+  /// Record the range of the current job which belongs to a thread.
+  /// \param thread_index The index of the range to record.
+  void recordRange(size_t thread_index);
+
+  /// The number of threads used for recording.
+  size_t num_threads;
+
+  /// Command pools indexed by thread and then by frame in flight.
+  std::vector<std::vector<std::shared_ptr<CommandPool>>> command_pools;
+
+  /// The worker threads. Contains num_threads - 1 entries.
+  std::vector<std::thread> workers;
+
+  /// Protects the job state below.
+  std::mutex mutex;
+
+  /// Signalled when a new job is available or the recorder is destroyed.
+  std::condition_variable job_available;
+
+  /// Signalled when the last worker finishes its range.
+  std::condition_variable job_done;
+
+  /// Incremented for every job so workers can detect new work.
+  uint64_t job_generation;
+
+  /// Number of workers which have not finished the current job.
+  size_t pending_workers;
+
+  /// Set when the worker threads should exit.
+  bool stopping;
+
+  /// The RenderQueue of the current job.
+  const RenderQueue* job_render_queue;
+
+  /// The inheritance info of the current job.
+  vk::CommandBufferInheritanceInfo job_inheritance_info;
+
+  /// The frame in flight of the current job.
+  size_t job_frame_index;
+
+  /// The indirect draw buffer of the current job, may be null.
+  const IndirectDrawBuffer* job_indirect_draw_buffer;
+
+  /// The command buffer recorded by each thread for the current job. Null
+  /// if the thread's range was empty.
+  std::vector<vk::CommandBuffer> job_command_buffers;
+
+  /// The commands recorded by each thread for the current job.
+  std::vector<RenderStatistics> job_statistics;
+
+  /// The first exception thrown while recording the current job.
+  std::exception_ptr job_exception;
+
+  /// The summed statistics of the last job.
+  RenderStatistics statistics;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_PARALLELCOMMANDRECORDER_H_
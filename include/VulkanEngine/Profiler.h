@@ -0,0 +1,474 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_PROFILER_H_
+#define INCLUDE_VULKANENGINE_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#define VULKANENGINE_PROFILE_CONCAT_INNER(a, b) a##b
+#define VULKANENGINE_PROFILE_CONCAT(a, b) \
+  VULKANENGINE_PROFILE_CONCAT_INNER(a, b)
+
+/// Measure the CPU time from this point to the end of the enclosing scope.
+/// \param name The name of the scope, must be a string literal.
+#define VULKANENGINE_PROFILE_SCOPE(name)                                  \
+  ::VulkanEngine::ProfileScope VULKANENGINE_PROFILE_CONCAT(profile_scope_, \
+                                                           __LINE__)(name)
+
+/// Measure the GPU time of the commands inserted into a command buffer from
+/// this point to the end of the enclosing scope.
+/// \param command_buffer The command buffer of the current frame in flight,
+/// or a secondary command buffer executed by it.
+/// \param name The name of the scope, must be a string literal.
+#define VULKANENGINE_PROFILE_GPU_SCOPE(command_buffer, name) \
+  ::VulkanEngine::GPUProfileScope VULKANENGINE_PROFILE_CONCAT( \
+      gpu_profile_scope_, __LINE__)(command_buffer, name)
+
+namespace VulkanEngine {
+
+/// Measures where the time of each frame goes. CPU scopes are recorded into a
+/// ring buffer belonging to the calling thread, so threads never contend while
+/// recording. GPU scopes write timestamp queries into a query pool belonging
+/// to the current frame in flight, which is read back once the frame's fence
+/// has been waited on. The scopes of each frame are gathered into a Frame and
+/// the most recent frames can be written as a Chrome trace, which can be
+/// viewed with chrome://tracing or Perfetto.
+/// If the device supports pipeline statistics queries, the vertices,
+/// primitives and shader invocations of each render pass or each group of
+/// draws can be counted as well, see setPipelineStatisticsLevel().
+/// Profiling is disabled by default, in which case a scope only tests a flag.
+/// Apart from recording scopes, the profiler must only be used from the
+/// thread which renders.
+class Profiler {
+ public:
+  /// The number of CPU scopes each thread can record between two frames.
+  /// Further scopes are dropped.
+  static constexpr size_t kThreadEventCapacity = 4096;
+
+  /// The number of GPU scopes which can be recorded for a frame.
+  static constexpr uint32_t kMaxGPUScopes = 256;
+
+  /// The number of pipeline statistics scopes which can be recorded for a
+  /// frame.
+  static constexpr uint32_t kMaxPipelineStatisticsScopes = 256;
+
+  /// Returned by beginGPUScope() and beginPipelineStatistics() if the scope
+  /// isn't measured.
+  static constexpr uint32_t kInvalidGPUScope =
+      std::numeric_limits<uint32_t>::max();
+
+  /// The scopes pipeline statistics are gathered for. Pipeline statistics
+  /// queries can't be nested, so only one level is gathered at a time.
+  enum class PipelineStatisticsLevel : uint8_t {
+    /// No pipeline statistics are gathered.
+    eDisabled,
+
+    /// Each render pass, see RenderPass::beginRenderPass(). Skipped for
+    /// render passes executing secondary command buffers unless the device
+    /// supports inherited queries.
+    eRenderPass,
+
+    /// Each group of draws sharing a pipeline, see RenderQueue::record().
+    eDrawGroup
+  };
+
+  /// A measured scope.
+  struct Event {
+    /// The name of the scope.
+    const char* name;
+
+    /// The begin and end of the scope in nanoseconds since the profiler was
+    /// created. GPU scopes are placed relative to the submission of their
+    /// frame, so their durations are exact but their offset from CPU scopes
+    /// is approximate.
+    uint64_t begin_ns;
+    uint64_t end_ns;
+
+    /// The index of the thread which recorded a CPU scope, starting at 1.
+    /// 0 for GPU scopes.
+    uint32_t thread_index;
+  };
+
+  /// The pipeline statistics of a scope. Implementations may count some
+  /// invocations more than once, so values are best compared between runs
+  /// on the same device.
+  struct PipelineStatistics {
+    /// The name of the scope.
+    const char* name = nullptr;
+
+    /// Vertices and primitives read by the input assembly stage.
+    uint64_t input_assembly_vertices = 0;
+    uint64_t input_assembly_primitives = 0;
+
+    /// Vertex shader invocations. Lower than input_assembly_vertices when
+    /// the post transform cache reuses vertices.
+    uint64_t vertex_shader_invocations = 0;
+
+    /// Primitives processed by the clipping stage and primitives it output.
+    uint64_t clipping_invocations = 0;
+    uint64_t clipping_primitives = 0;
+
+    /// Fragment shader invocations, which include overdraw.
+    uint64_t fragment_shader_invocations = 0;
+
+    /// Accumulate the statistics of another scope.
+    PipelineStatistics& operator+=(const PipelineStatistics& other);
+  };
+
+  /// The scopes measured during one frame.
+  struct Frame {
+    /// The number of the frame among all frames measured by the profiler.
+    uint64_t index = 0;
+
+    /// The CPU time the frame began and ended, see Event.
+    uint64_t begin_ns = 0;
+    uint64_t end_ns = 0;
+
+    /// The CPU scopes which ended during the frame.
+    std::vector<Event> cpu_events;
+
+    /// The GPU scopes of the frame. Empty if the device doesn't support
+    /// timestamp queries or the frame wasn't submitted.
+    std::vector<Event> gpu_events;
+
+    /// The pipeline statistics of the frame, see setPipelineStatisticsLevel().
+    std::vector<PipelineStatistics> pipeline_statistics;
+
+    /// \return The CPU time of the frame in milliseconds.
+    double getCPUTimeMs() const;
+
+    /// \return The time from the first GPU scope beginning to the last one
+    /// ending in milliseconds, 0 if there are no GPU scopes.
+    double getGPUTimeMs() const;
+
+    /// \return The summed time of all scopes with the given name in
+    /// milliseconds.
+    /// \param name The name of the scopes.
+    double getScopeTimeMs(const std::string& name) const;
+
+    /// \return The summed pipeline statistics of all scopes with the given
+    /// name.
+    /// \param name The name of the scopes.
+    PipelineStatistics getPipelineStatistics(const std::string& name) const;
+  };
+
+  /// Constructor.
+  Profiler();
+
+  /// Destructor.
+  ~Profiler();
+
+  /// Delete copy constructor, thread buffers refer to the profiler.
+  Profiler(const Profiler&) = delete;
+
+  /// Delete assignment operator, thread buffers refer to the profiler.
+  void operator=(const Profiler&) = delete;
+
+  /// Enable or disable profiling. Frames already measured are kept.
+  /// \param _enabled True to measure scopes.
+  void setEnabled(bool _enabled);
+
+  /// \return True if scopes are measured.
+  bool isEnabled() const;
+
+  /// Set the number of frames kept, older frames are discarded.
+  /// \param _max_frames The number of frames to keep.
+  void setMaxFrames(size_t _max_frames);
+
+  /// \return The number of frames kept.
+  size_t getMaxFrames() const;
+
+  /// Set the scopes pipeline statistics are gathered for. Only takes effect
+  /// while profiling is enabled and if the device supports pipeline
+  /// statistics queries.
+  /// \param level The scopes to gather statistics for.
+  void setPipelineStatisticsLevel(PipelineStatisticsLevel level);
+
+  /// \return The scopes pipeline statistics are gathered for.
+  PipelineStatisticsLevel getPipelineStatisticsLevel() const;
+
+  /// \return The time in nanoseconds since the profiler was created.
+  uint64_t now() const;
+
+  /// Record a CPU scope into the calling thread's buffer. Usually called by
+  /// ProfileScope.
+  /// \param name The name of the scope, must outlive the profiler.
+  /// \param begin_ns The begin of the scope, see now().
+  /// \param end_ns The end of the scope, see now().
+  void recordCPUEvent(const char* name, uint64_t begin_ns, uint64_t end_ns);
+
+  /// Begin a GPU scope by writing a timestamp into a command buffer.
+  /// \param command_buffer The command buffer of the current frame in flight,
+  /// or a secondary command buffer executed by it. May be called from any
+  /// thread.
+  /// \param name The name of the scope, must outlive the profiler.
+  /// \return The scope to pass to endGPUScope(), kInvalidGPUScope if the scope
+  /// isn't measured.
+  uint32_t beginGPUScope(const vk::CommandBuffer& command_buffer,
+                         const char* name);
+
+  /// End a GPU scope by writing a timestamp into a command buffer.
+  /// \param command_buffer The command buffer the scope was begun in.
+  /// \param scope The scope returned by beginGPUScope().
+  void endGPUScope(const vk::CommandBuffer& command_buffer, uint32_t scope);
+
+  /// Begin gathering pipeline statistics by beginning a query in a command
+  /// buffer.
+  /// \param command_buffer The command buffer of the current frame in flight,
+  /// or a secondary command buffer executed by it. May be called from any
+  /// thread.
+  /// \param name The name of the scope, must outlive the profiler.
+  /// \param level The level of the scope, nothing is gathered unless it
+  /// matches getPipelineStatisticsLevel().
+  /// \return The scope to pass to endPipelineStatistics(), kInvalidGPUScope
+  /// if the scope isn't measured.
+  uint32_t beginPipelineStatistics(const vk::CommandBuffer& command_buffer,
+                                   const char* name,
+                                   PipelineStatisticsLevel level);
+
+  /// End gathering pipeline statistics by ending a query.
+  /// \param command_buffer The command buffer the scope was begun in.
+  /// \param scope The scope returned by beginPipelineStatistics().
+  void endPipelineStatistics(const vk::CommandBuffer& command_buffer,
+                             uint32_t scope);
+
+  /// \return The pipeline statistics gathered by the render pass scope
+  /// active in the current frame's primary command buffer. Secondary command
+  /// buffers executed in the render pass must inherit them, see
+  /// vk::CommandBufferInheritanceInfo::pipelineStatistics.
+  vk::QueryPipelineStatisticFlags getInheritedPipelineStatistics() const;
+
+  /// \return True if secondary command buffers can be executed while a
+  /// render pass scope gathers pipeline statistics.
+  bool canInheritPipelineStatistics() const;
+
+  /// Read back the GPU scopes of the frame previously recorded for a frame in
+  /// flight. Called by VulkanManager::beginFrame() once the frame's fence has
+  /// been waited on.
+  /// \param frame_index The index of the frame in flight being begun.
+  void beginFrame(size_t frame_index);
+
+  /// Reset the timestamp queries of the current frame. Called by
+  /// RenderPass::beginFrame() once the frame's primary command buffer has
+  /// begun, GPU scopes are only measured after this.
+  /// \param command_buffer The primary command buffer of the frame.
+  void beginCommandBuffer(const vk::CommandBuffer& command_buffer);
+
+  /// Note that the current frame is being submitted. Called by
+  /// Swapchain::present().
+  void submitFrame();
+
+  /// Gather the CPU scopes recorded since the previous frame and end the
+  /// current frame. Called by VulkanManager::drawImage().
+  void endFrame();
+
+  /// Read back the GPU scopes of all frames still in flight. The device must
+  /// be idle.
+  void flush();
+
+  /// \return The measured frames, oldest first. Frames only appear once
+  /// their GPU scopes have been read back.
+  const std::deque<Frame>& getFrames() const;
+
+  /// Write the measured frames as a Chrome trace.
+  /// \param path The path of the JSON file to write.
+  /// \return False if the file couldn't be written.
+  bool writeChromeTrace(const std::filesystem::path& path) const;
+
+  /// \return The measured frames as a Chrome trace.
+  std::string toChromeTrace() const;
+
+  /// Read back all frames and destroy the query pools. The device must be
+  /// idle.
+  void clear();
+
+ private:
+  /// The CPU scopes recorded by one thread. The thread is the only writer
+  /// and endFrame() the only reader, so no lock is needed.
+  struct ThreadEvents {
+    /// The recorded scopes, used as a ring buffer.
+    std::vector<Event> events;
+
+    /// The number of scopes written and read so far.
+    std::atomic<uint64_t> write_count{0};
+    std::atomic<uint64_t> read_count{0};
+
+    /// See Event::thread_index.
+    uint32_t thread_index = 0;
+  };
+
+  /// The timestamp queries of one frame in flight.
+  struct FrameQueries {
+    /// The pool of 2 * kMaxGPUScopes timestamp queries.
+    vk::QueryPool query_pool;
+
+    /// The pool of kMaxPipelineStatisticsScopes pipeline statistics queries,
+    /// null if they aren't supported.
+    vk::QueryPool statistics_query_pool;
+
+    /// True once the queries have been reset in the frame's command buffer.
+    bool reset = false;
+
+    /// True once the frame's command buffer has been submitted.
+    bool submitted = false;
+
+    /// The CPU time the frame was submitted.
+    uint64_t submit_ns = 0;
+
+    /// The name of each GPU scope begun in the frame.
+    std::vector<const char*> scope_names;
+
+    /// The name of each pipeline statistics scope begun in the frame.
+    std::vector<const char*> statistics_scope_names;
+
+    /// The render pass scope active in the frame's primary command buffer,
+    /// kInvalidGPUScope if there is none.
+    uint32_t render_pass_statistics_scope = kInvalidGPUScope;
+
+    /// True if frame is waiting for its GPU scopes to be read back.
+    bool pending = false;
+
+    /// The frame waiting to be read back.
+    Frame frame;
+  };
+
+  /// \return The buffer of the calling thread, created on first use.
+  ThreadEvents& getThreadEvents();
+
+  /// Read back the GPU scopes of a frame in flight, if it has any pending,
+  /// and move its frame into frames.
+  /// \param queries The queries of the frame in flight.
+  void readGPUEvents(FrameQueries& queries);
+
+  /// Read back the pipeline statistics of a frame in flight into its frame.
+  /// \param queries The queries of the frame in flight, submitted.
+  void readPipelineStatistics(FrameQueries& queries);
+
+  /// Insert a frame into frames, keeping them sorted by index.
+  /// \param frame The frame to insert.
+  void addFrame(Frame&& frame);
+
+  /// Identifies the profiler in thread local storage, never reused.
+  const uint64_t id;
+
+  /// Time 0 of all events.
+  const std::chrono::steady_clock::time_point epoch;
+
+  /// See setEnabled().
+  std::atomic<bool> enabled;
+
+  /// See setMaxFrames().
+  size_t max_frames;
+
+  /// See setPipelineStatisticsLevel().
+  std::atomic<PipelineStatisticsLevel> pipeline_statistics_level;
+
+  /// True if the device can inherit pipeline statistics queries.
+  bool inherited_queries;
+
+  /// Protects thread_events and the GPU scopes of the current frame.
+  std::mutex mutex;
+
+  /// The buffers of all threads which have recorded scopes. Buffers of
+  /// threads which have exited are removed once they are empty.
+  std::vector<std::shared_ptr<ThreadEvents>> thread_events;
+
+  /// The number of threads which have recorded scopes.
+  uint32_t num_threads;
+
+  /// The queries of each frame in flight, created on first use.
+  std::vector<FrameQueries> frame_queries;
+
+  /// The frame in flight being recorded, null if beginFrame() hasn't been
+  /// called since the last frame ended.
+  FrameQueries* current_frame_queries;
+
+  /// The frame being recorded.
+  Frame current_frame;
+
+  /// The number of frames measured so far.
+  uint64_t frame_count;
+
+  /// The nanoseconds per timestamp tick, 0 if timestamps aren't supported.
+  float timestamp_period;
+
+  /// Masks the valid bits of timestamps, which are also required for GPU
+  /// scopes to be measured.
+  uint64_t timestamp_mask;
+
+  /// The measured frames, see getFrames().
+  std::deque<Frame> frames;
+};
+
+/// Measures the CPU time of a scope, see VULKANENGINE_PROFILE_SCOPE().
+class ProfileScope {
+ public:
+  /// Constructor. Begins the scope if the profiler is enabled.
+  /// \param _name The name of the scope, must be a string literal.
+  explicit ProfileScope(const char* _name);
+
+  /// Destructor. Ends the scope.
+  ~ProfileScope();
+
+  /// Delete copy constructor, a scope is measured once.
+  ProfileScope(const ProfileScope&) = delete;
+
+  /// Delete assignment operator, a scope is measured once.
+  void operator=(const ProfileScope&) = delete;
+
+ private:
+  /// The profiler the scope is recorded into, null if it was disabled.
+  Profiler* profiler;
+
+  /// The name of the scope.
+  const char* name;
+
+  /// The begin of the scope, see Profiler::now().
+  uint64_t begin_ns;
+};
+
+/// Measures the GPU time of a scope, see VULKANENGINE_PROFILE_GPU_SCOPE().
+class GPUProfileScope {
+ public:
+  /// Constructor. Writes the begin timestamp if the profiler is enabled.
+  /// \param _command_buffer The command buffer to measure.
+  /// \param name The name of the scope, must be a string literal.
+  GPUProfileScope(const vk::CommandBuffer& _command_buffer, const char* name);
+
+  /// Destructor. Writes the end timestamp.
+  ~GPUProfileScope();
+
+  /// Delete copy constructor, a scope is measured once.
+  GPUProfileScope(const GPUProfileScope&) = delete;
+
+  /// Delete assignment operator, a scope is measured once.
+  void operator=(const GPUProfileScope&) = delete;
+
+ private:
+  /// The profiler the scope is recorded into.
+  Profiler& profiler;
+
+  /// The command buffer the timestamps are written into.
+  vk::CommandBuffer command_buffer;
+
+  /// The scope returned by Profiler::beginGPUScope().
+  uint32_t scope;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_PROFILER_H_
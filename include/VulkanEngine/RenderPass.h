@@ -44,8 +44,24 @@ class RenderPass {
     return color_attachment;
   }
 
-  /// Begin the RenderPass.
-  void begin();
+  /// Begin the RenderPass. Same as calling beginFrame() followed by
+  /// beginRenderPass().
+  /// \param contents Use vk::SubpassContents::eSecondaryCommandBuffers if the
+  /// subpass will be recorded with secondary command buffers only.
+  void begin(vk::SubpassContents contents = vk::SubpassContents::eInline);
+
+  /// Wait until the current frame in flight can be reused and begin its
+  /// primary command buffer. Commands which must be recorded outside of the
+  /// render pass, such as compute dispatches, can be recorded before calling
+  /// beginRenderPass().
+  void beginFrame();
+
+  /// Begin the render pass in the current frame's primary command buffer.
+  /// beginFrame() must have been called.
+  /// \param contents Use vk::SubpassContents::eSecondaryCommandBuffers if the
+  /// subpass will be recorded with secondary command buffers only.
+  void beginRenderPass(
+      vk::SubpassContents contents = vk::SubpassContents::eInline);
 
   /// End the RenderPass.
   void end();
@@ -59,6 +75,13 @@ class RenderPass {
 
   uint32_t width;
   uint32_t height;
+
+  /// The GPU scope measuring the render pass, see Profiler::beginGPUScope().
+  uint32_t gpu_scope;
+
+  /// The scope gathering the pipeline statistics of the render pass, see
+  /// Profiler::beginPipelineStatistics().
+  uint32_t statistics_scope;
 };
 
 }  // namespace VulkanEngine
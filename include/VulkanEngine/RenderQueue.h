@@ -0,0 +1,195 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_RENDERQUEUE_H_
+#define INCLUDE_VULKANENGINE_RENDERQUEUE_H_
+
+#include <VulkanEngine/BoundingBox.h>
+
+#include <Eigen/Eigen>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+class GraphicsPipeline;
+class IndirectDrawBuffer;
+class MeshBase;
+class Shader;
+
+/// Describes a single draw emitted during scene traversal.
+/// The referenced objects are owned by the SceneObject which submitted the
+/// packet and must stay alive until the frame has been recorded.
+struct DrawPacket {
+  /// The pipeline to draw with.
+  GraphicsPipeline* graphics_pipeline;
+
+  /// The shader owning the descriptor sets to bind.
+  Shader* shader;
+
+  /// The geometry to draw.
+  MeshBase* mesh;
+
+  /// The index of the descriptor set to bind, usually the current frame.
+  uint32_t descriptor_set_index;
+
+  /// Distance from the camera along the view direction. Used to draw opaque
+  /// geometry front to back.
+  float depth = 0.0f;
+
+  /// Passed to the shader as the instance index, gl_InstanceIndex, so that
+  /// the shader can look up per draw data. Draws recorded into an
+  /// IndirectDrawBuffer are merged, so this is the only way to tell them
+  /// apart in the shader.
+  uint32_t draw_data_index = 0;
+
+  /// World space bounds of the geometry, used for culling. Only valid if
+  /// has_bounds is true, otherwise the draw is never culled.
+  BoundingBox<Eigen::Vector3f> bounds;
+
+  /// True if bounds has been set.
+  bool has_bounds = false;
+
+  /// Key the queue is sorted by. Computed by RenderQueue::submit().
+  uint64_t sort_key = 0;
+
+  /// Orders draws with the same sort_key. Computed by RenderQueue::submit().
+  uint32_t depth_key = 0;
+};
+
+/// Counts the commands recorded for a RenderQueue.
+struct RenderStatistics {
+  /// Number of draws.
+  size_t draws = 0;
+
+  /// Number of draw commands inserted into the command buffer. Lower than
+  /// draws when draws are merged into indirect draws.
+  size_t draw_calls = 0;
+
+  /// Number of vk::CommandBuffer::bindPipeline() calls.
+  size_t pipeline_binds = 0;
+
+  /// Number of vk::CommandBuffer::bindDescriptorSets() calls.
+  size_t descriptor_set_binds = 0;
+
+  /// Number of vk::CommandBuffer::bindVertexBuffers() calls.
+  size_t vertex_buffer_binds = 0;
+
+  /// Number of vk::CommandBuffer::bindIndexBuffer() calls.
+  size_t index_buffer_binds = 0;
+
+  /// CPU time spent sorting and recording in milliseconds.
+  double record_time_ms = 0.0;
+
+  /// Accumulate the statistics of another recording.
+  RenderStatistics& operator+=(const RenderStatistics& other);
+};
+
+/// Collects the DrawPacket instances submitted while traversing the scene so
+/// that command recording can happen in one place once traversal is done,
+/// either inline or split across several threads. Draws can be sorted by
+/// pipeline, descriptor sets and depth before recording, and state which is
+/// already bound is not bound again.
+class RenderQueue {
+ public:
+  /// Constructor.
+  RenderQueue();
+
+  /// Destructor.
+  ~RenderQueue();
+
+  /// Add a draw to the queue and compute its sort key.
+  /// \param draw_packet The DrawPacket to add.
+  void submit(const DrawPacket& draw_packet);
+
+  /// Remove all draws. Capacity is kept so that steady state frames don't
+  /// allocate.
+  void clear();
+
+  /// \return The number of draws in the queue.
+  size_t size() const;
+
+  /// \return All draws in the queue, in submission order until sort() is
+  /// called.
+  const std::vector<DrawPacket>& getDrawPackets() const;
+
+  /// Sort the draws by their sort key using a radix sort. Draws sharing a
+  /// pipeline are grouped first, then draws sharing a shader, and each group
+  /// is ordered front to back. The sort is stable.
+  void sort();
+
+  /// Group consecutive indexed draws which share pipeline, descriptor set and
+  /// geometry buffers into batches, which can each be issued as a single
+  /// indirect draw. Must be called after the last call to submit() or sort()
+  /// and before recording into an IndirectDrawBuffer.
+  void buildBatches();
+
+  /// \return True if buildBatches() has been called since the queue was last
+  /// modified.
+  bool hasBatches() const;
+
+  /// \return The index of the first draw of the batch a draw belongs to.
+  /// Requires hasBatches().
+  /// \param index The index of the draw.
+  size_t getBatchFirst(size_t index) const;
+
+  /// Record a range of the queue into a command buffer. Only reads the queue
+  /// so several ranges may be recorded concurrently into different command
+  /// buffers. Binds are skipped if the state is already bound by a previous
+  /// draw of the same range.
+  /// If an IndirectDrawBuffer is given, the draw at index i of the queue is
+  /// written to command i of the buffer, and each batch built by
+  /// buildBatches() is issued as a single indirect draw. The range must then
+  /// start at the first draw of a batch.
+  /// \param command_buffer The vk::CommandBuffer to insert the commands into.
+  /// \param begin Index of the first draw to record.
+  /// \param end One past the index of the last draw to record.
+  /// \param indirect_draw_buffer Optional buffer to write indirect draws to.
+  /// Must have a capacity of at least size() commands.
+  /// \return The number of commands recorded.
+  RenderStatistics record(
+      const vk::CommandBuffer& command_buffer, size_t begin, size_t end,
+      const IndirectDrawBuffer* indirect_draw_buffer = nullptr) const;
+
+  /// Compute the sort key of a draw.
+  /// The high 32 bits hold the pipeline id and the low 32 bits the shader id,
+  /// so that different ids never share a key.
+  /// \param draw_packet The draw to compute the key for.
+  /// \return The sort key.
+  static uint64_t computeSortKey(const DrawPacket& draw_packet);
+
+  /// Compute the key ordering draws with the same sort key by depth.
+  /// \param draw_packet The draw to compute the key for.
+  /// \return The depth key.
+  static uint32_t computeDepthKey(const DrawPacket& draw_packet);
+
+ private:
+  /// The sort keys together with the index of the draw they belong to.
+  struct SortEntry {
+    uint64_t key;
+    uint32_t depth_key;
+    uint32_t index;
+  };
+
+  /// The submitted draws.
+  std::vector<DrawPacket> draw_packets;
+
+  /// Scratch memory used by sort(), kept to avoid allocations.
+  std::vector<SortEntry> sort_entries;
+  std::vector<SortEntry> sort_entries_scratch;
+  std::vector<DrawPacket> draw_packets_scratch;
+
+  /// The first draw of the batch of each draw, filled by buildBatches().
+  std::vector<uint32_t> batch_firsts;
+
+  /// True if batch_firsts matches draw_packets.
+  bool batches_built;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_RENDERQUEUE_H_
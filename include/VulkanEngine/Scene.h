@@ -6,14 +6,21 @@
 #ifndef INCLUDE_VULKANENGINE_SCENE_H_
 #define INCLUDE_VULKANENGINE_SCENE_H_
 
+#include <VulkanEngine/GPUCullingPass.h>
+#include <VulkanEngine/IndirectDrawBuffer.h>
+#include <VulkanEngine/ParallelCommandRecorder.h>
 #include <VulkanEngine/SceneObject.h>
+#include <VulkanEngine/TransformHierarchy.h>
 #include <VulkanEngine/Window.h>
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 namespace VulkanEngine {
 
+class Camera;
+
 class Scene : public SceneObject {
  public:
   /// Constructor.
@@ -28,16 +35,118 @@ class Scene : public SceneObject {
   /// Get the currently active window.
   const std::shared_ptr<Window> getActiveWindow() const;
 
+  /// Set the number of threads used to record the draws submitted to the
+  /// RenderQueue. If 0, draws are recorded inline into the primary command
+  /// buffer, which is the default. Otherwise they are split across the given
+  /// number of threads, each recording a secondary command buffer. In that
+  /// case SceneObject instances must not record commands into the primary
+  /// command buffer directly.
+  /// \param num_threads The number of recording threads.
+  void setRecordingThreadCount(size_t num_threads);
+
+  /// \return The number of threads used for recording, 0 if inline.
+  size_t getRecordingThreadCount() const;
+
+  /// Enable or disable merging draws into indirect draws. When enabled, which
+  /// is the default, the draws of each frame are written to a per frame
+  /// IndirectDrawBuffer and consecutive draws with the same state are issued
+  /// with a single indirect draw. Requires the drawIndirectFirstInstance
+  /// device feature, without it draws are always recorded directly.
+  /// \param enabled True to use indirect draws.
+  void setIndirectDrawingEnabled(bool enabled);
+
+  /// \return True if draws are merged into indirect draws.
+  bool isIndirectDrawingEnabled() const;
+
+  /// Enable or disable skipping objects and shapes outside of the view
+  /// frustum while traversing the scene. Skipped objects don't update their
+  /// uniform buffers or submit draws, and whole subtrees are skipped when
+  /// their combined bounds are outside. Disabled by default. See
+  /// SceneObject::getLocalBoundingBox() and SceneObject::isCullable().
+  /// \param enabled True to cull objects on the CPU.
+  void setFrustumCullingEnabled(bool enabled);
+
+  /// \return True if objects are culled on the CPU during traversal.
+  bool isFrustumCullingEnabled() const;
+
+  /// Enable or disable culling draws on the GPU with a GPUCullingPass before
+  /// they are drawn. Disabled by default. Only draws submitted with bounds
+  /// are culled. Requires indirect drawing, see setIndirectDrawingEnabled().
+  /// \param enabled True to cull draws on the GPU.
+  void setGPUCullingEnabled(bool enabled);
+
+  /// \return True if draws are culled on the GPU.
+  bool isGPUCullingEnabled() const;
+
+  /// \return The GPUCullingPass used when GPU culling is enabled, e.g. to
+  /// set a depth pyramid for occlusion culling. Created on first use.
+  const std::shared_ptr<GPUCullingPass> getGPUCullingPass();
+
+  /// \return The commands recorded for the last frame and the CPU time spent
+  /// sorting and recording them.
+  const RenderStatistics& getRenderStatistics() const;
+
+  /// Find the nearest object under a position in the active window, e.g. the
+  /// mouse position returned by MouseInput::getPosition(). Uses the view and
+  /// projection of the last frame, see SceneObject::pickChild().
+  /// \param window_position The position in window coordinates, relative to
+  /// the top left corner.
+  /// \return The nearest object whose bounds are under the position, or null
+  /// if there is none or no frame has been drawn yet.
+  std::shared_ptr<SceneObject> pick(const Eigen::Vector2d& window_position);
+
  private:
   /// \param scene_state Contains information about the current state of the
   /// scene.
-  void update(std::shared_ptr<SceneState> scene_state) override;
+  void update(SceneState& scene_state) override;
+
+  /// Cull and record the draws submitted during traversal into the current
+  /// frame. Begins the render pass.
+  void recordRenderQueue();
+
+  /// Set the view of the current frame from the camera found when the
+  /// transform hierarchy was built, before any object is culled.
+  void updateView();
 
   /// The current state of the scene.
   std::shared_ptr<SceneState> state_instance;
 
   /// List of windows to render to.
   std::vector<std::shared_ptr<Window>> windows;
+
+  /// The world transform of every object in the scene, rebuilt when children
+  /// are added anywhere in the scene.
+  TransformHierarchy world_transforms;
+
+  /// The object of each node of world_transforms but the root.
+  std::vector<SceneObject*> world_transform_objects;
+
+  /// The last Camera in traversal order and its node, which sets the view
+  /// of the frame. Null if the scene has no camera.
+  Camera* camera;
+  uint32_t camera_node;
+
+  /// Records the RenderQueue using secondary command buffers. Null when
+  /// recording inline.
+  std::shared_ptr<ParallelCommandRecorder> command_recorder;
+
+  /// True if indirect drawing was requested with setIndirectDrawingEnabled().
+  bool indirect_drawing_enabled;
+
+  /// The indirect draw buffer of each frame in flight, created on first use.
+  std::vector<std::shared_ptr<IndirectDrawBuffer>> indirect_draw_buffers;
+
+  /// True if frustum culling was requested with setFrustumCullingEnabled().
+  bool frustum_culling_enabled;
+
+  /// True if GPU culling was requested with setGPUCullingEnabled().
+  bool gpu_culling_enabled;
+
+  /// Culls the draws on the GPU, created on first use.
+  std::shared_ptr<GPUCullingPass> gpu_culling_pass;
+
+  /// The commands recorded for the last frame.
+  RenderStatistics render_statistics;
 };
 
 }  // namespace VulkanEngine
@@ -6,9 +6,16 @@
 #ifndef INCLUDE_VULKANENGINE_SCENEOBJECT_H_
 #define INCLUDE_VULKANENGINE_SCENEOBJECT_H_
 
+#include <VulkanEngine/BoundingBox.h>
+#include <VulkanEngine/BoundingVolumeHierarchy.h>
+#include <VulkanEngine/Frustum.h>
 #include <VulkanEngine/SceneState.h>
+#include <VulkanEngine/TransformHierarchy.h>
 
+#include <Eigen/Eigen>
+#include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace VulkanEngine {
@@ -19,41 +26,305 @@ class SceneObject {
   /// Contructor.
   SceneObject();
 
+  /// Destructor.
+  virtual ~SceneObject();
+
   /// Add child SceneObject instances which will inherit the transformation of
   /// this SceneObject. \param _children The children to add.
   void addChildren(const std::vector<std::shared_ptr<SceneObject>>& _children);
 
   /// Get the current local transformation matrix.
   /// \return The current local transformation matrix
-  const Eigen::Matrix4f getTransform() const;
+  const Eigen::Matrix4f& getTransform() const;
 
   /// Set the current local transformation matrix.
   /// \param _transform The desired local transformation matrix.
   void setTransform(const Eigen::Matrix4f& _transform);
 
+  /// Get the bounds of the geometry drawn by this object itself, excluding
+  /// its children, in its local space.
+  /// \param [out] bounding_box Set to the bounds if the object has any.
+  /// \return True if the object draws geometry. False by default.
+  virtual bool getLocalBoundingBox(
+      BoundingBox<Eigen::Vector3f>& bounding_box) const;
+
+  /// \return True if the object and its children may be skipped during
+  /// traversal when their bounds are outside of the view frustum. True by
+  /// default. Objects with side effects in update(), such as a Camera, or
+  /// which draw geometry without reporting it in getLocalBoundingBox(),
+  /// should return false.
+  virtual bool isCullable() const;
+
+  /// Get the bounds of this object and all of its children in the local
+  /// space of this object, before its own transform is applied. The result
+  /// is cached until a transform or bounds in the subtree change or children
+  /// are added.
+  /// \param [out] bounding_box Set to the bounds if the subtree can be
+  /// culled.
+  /// \return True if the subtree has bounds and every object in it is
+  /// cullable.
+  bool getSubtreeBoundingBox(BoundingBox<Eigen::Vector3f>& bounding_box);
+
+  /// Find the nearest descendant of this object hit by a ray. An object is
+  /// hit if the ray hits the box returned by its getLocalBoundingBox(), the
+  /// geometry itself is not tested. Children with many siblings are found
+  /// through a BoundingVolumeHierarchy.
+  /// \param origin The origin of the ray in the local space of this object,
+  /// before its own transform is applied.
+  /// \param direction The direction of the ray in the same space.
+  /// \param [in,out] distance The maximum distance to search, in multiples of
+  /// direction. Set to the distance of the hit if an object is hit.
+  /// \return The nearest object hit, or null if none is.
+  std::shared_ptr<SceneObject> pickChild(const Eigen::Vector3f& origin,
+                                         const Eigen::Vector3f& direction,
+                                         float& distance);
+
  protected:
-  /// Update this scene object.
+  /// Called before update(). The total transform of scene_state is already
+  /// that of this object.
+  /// \param scene_state Contains information about the current state of the
+  /// scene.
+  virtual void preUpdate(SceneState& scene_state);
+
+  /// Update this scene object. Overrides must call SceneObject::update() to
+  /// update the children.
+  /// \param scene_state Contains information about the current state of the
+  /// scene.
+  virtual void update(SceneState& scene_state);
+
+  /// Called after update().
+  /// \param scene_state Contains information about the current state of the
+  /// scene.
+  virtual void postUpdate(SceneState& scene_state);
+
+  /// Deprecated, override preUpdate(SceneState&) instead. Called by the
+  /// default preUpdate(SceneState&) unless disableLegacyUpdate() was called.
   /// \param scene_state Contains information about the current state of the
   /// scene.
   virtual void preUpdate(std::shared_ptr<SceneState> scene_state);
 
-  /// Update this scene object.
+  /// Deprecated, override update(SceneState&) instead. Called by the default
+  /// update(SceneState&) unless disableLegacyUpdate() was called.
   /// \param scene_state Contains information about the current state of the
   /// scene.
   virtual void update(std::shared_ptr<SceneState> scene_state);
 
-  /// Update this scene object.
+  /// Deprecated, override postUpdate(SceneState&) instead. Called by the
+  /// default postUpdate(SceneState&) unless disableLegacyUpdate() was called.
   /// \param scene_state Contains information about the current state of the
   /// scene.
   virtual void postUpdate(std::shared_ptr<SceneState> scene_state);
 
+  /// Stop forwarding the SceneState& overloads of preUpdate(), update() and
+  /// postUpdate() to the deprecated std::shared_ptr<SceneState> overloads,
+  /// which costs reference counting on every visit. Subclasses which only
+  /// override the SceneState& overloads should call this in their
+  /// constructor. Plain SceneObject instances never forward.
+  void disableLegacyUpdate();
+
+  /// Invalidate the cached subtree bounds of this object and its ancestors.
+  /// Must be called when the result of getLocalBoundingBox() changes.
+  void invalidateBoundingBox();
+
+  /// Fill a TransformHierarchy with this object as the root and one node for
+  /// every path to each of its descendants, depth first in the order of the
+  /// children. The objects are registered with the hierarchy so that
+  /// setTransform() updates their nodes, until releaseTransformHierarchy()
+  /// is called. Objects may be registered with several hierarchies at once,
+  /// e.g. if they are part of several Scenes.
+  /// \param hierarchy The hierarchy to fill. Cleared first.
+  /// \param [out] objects Cleared and filled with the object of each node
+  /// but the root.
+  void buildTransformHierarchy(TransformHierarchy& hierarchy,
+                               std::vector<SceneObject*>& objects);
+
+  /// Unregister objects from a hierarchy they were registered with by
+  /// buildTransformHierarchy(). Other hierarchies are unaffected.
+  /// \param hierarchy The hierarchy to unregister from.
+  /// \param objects The objects to unregister.
+  static void releaseTransformHierarchy(
+      const TransformHierarchy& hierarchy,
+      const std::vector<SceneObject*>& objects);
+
+  /// \return True if children were added to this object or any of its
+  /// descendants since buildTransformHierarchy() was last called.
+  bool isTransformHierarchyDirty() const;
+
   /// The transformation matrix of this SceneObject.
   /// By default it is set to identity.
   Eigen::Matrix4f transform;
 
  private:
+  /// Whether the SceneState& update overloads forward to the deprecated ones.
+  enum class LegacyUpdate : uint8_t {
+    /// Not decided yet, decided on the first update.
+    eUnknown,
+
+    /// Forward to the std::shared_ptr<SceneState> overloads.
+    eEnabled,
+
+    /// Don't forward.
+    eDisabled
+  };
+
+  /// How a parent caches a child.
+  enum class ChildState : uint8_t {
+    /// The child's subtree isn't cullable, it is always updated.
+    eNotCullable,
+
+    /// The child's subtree has no bounds, it is always updated.
+    eNoBounds,
+
+    /// The child's subtree has bounds and may be culled.
+    eBounded
+  };
+
+  /// Children with at least this many bounded siblings are culled and picked
+  /// through a BoundingVolumeHierarchy instead of testing every child.
+  static constexpr size_t kMinChildrenForHierarchy = 64;
+
+  /// \return True if the SceneState& update overloads forward to the
+  /// deprecated ones.
+  bool usesLegacyUpdate();
+
+  /// Update the children which aren't culled.
+  /// \param scene_state Contains information about the current state of the
+  /// scene.
+  void updateChildren(SceneState& scene_state);
+
+  /// Recompute the cached subtree bounds if anything in the subtree changed.
+  void updateSubtreeBoundingBox();
+
+  /// Mark the cached subtree bounds of this object as invalid and notify its
+  /// parents.
+  void markSubtreeBoundingBoxDirty();
+
+  /// Mark the transform hierarchy of this object and its ancestors as out of
+  /// date.
+  void markTransformHierarchyDirty();
+
+  /// Add the nodes of the children of this object to a TransformHierarchy,
+  /// see buildTransformHierarchy().
+  /// \param hierarchy The hierarchy to add to.
+  /// \param node The node of this object.
+  /// \param [out] objects The object of each node added is appended.
+  void addTransformNodes(TransformHierarchy& hierarchy, uint32_t node,
+                         std::vector<SceneObject*>& objects);
+
+  /// Called by a child when its transform or subtree bounds changed.
+  /// \param index The index of the child in children.
+  void onChildBoundingBoxChanged(size_t index);
+
+  /// Bring the cached bounds of the children up to date. Only the children
+  /// which changed are updated, and the hierarchy over them is refit.
+  void updateChildBoundingBoxes();
+
+  /// Recompute the cached bounds of all children and rebuild the hierarchy
+  /// over them.
+  void rebuildChildBoundingBoxes();
+
+  /// Get the bounds of a child's subtree in the local space of this object.
+  /// \param index The index of the child in children.
+  /// \param [out] bounding_box Set to the bounds if the child is bounded.
+  /// \return How the child is cached.
+  ChildState getChildBoundingBox(size_t index,
+                                 BoundingBox<Eigen::Vector3f>& bounding_box);
+
+  /// Test the cached bounds of all children against the view frustum and
+  /// store the result in child_visibility.
+  /// \param scene_state The current state of the scene.
+  void cullChildren(SceneState& scene_state);
+
+  /// Find the nearest descendant of this object hit by a ray, see
+  /// pickChild().
+  /// \param origin The origin of the ray in the local space of this object.
+  /// \param direction The direction of the ray in the same space.
+  /// \param [in,out] distance The distance of the nearest hit so far.
+  /// \param [in,out] result The nearest object hit so far.
+  void pickChildren(const Eigen::Vector3f& origin,
+                    const Eigen::Vector3f& direction, float& distance,
+                    std::shared_ptr<SceneObject>& result);
+
+  /// Test a ray against an object and its descendants.
+  /// \param object The object to test.
+  /// \param origin The origin of the ray in the space of the object's parent.
+  /// \param direction The direction of the ray in the same space.
+  /// \param [in,out] distance The distance of the nearest hit so far.
+  /// \param [in,out] result The nearest object hit so far.
+  static void pickObject(const std::shared_ptr<SceneObject>& object,
+                         const Eigen::Vector3f& origin,
+                         const Eigen::Vector3f& direction, float& distance,
+                         std::shared_ptr<SceneObject>& result);
+
   /// Contains any children of this scene object.
   std::vector<std::shared_ptr<SceneObject>> children;
+
+  /// The objects this object is a child of, each with the index of this
+  /// object in its children. Used to propagate changes of the bounds.
+  std::vector<std::pair<SceneObject*, size_t>> parents;
+
+  /// The nodes of this object in the hierarchies it is registered with, one
+  /// for every path from the root of each hierarchy to this object.
+  std::vector<std::pair<TransformHierarchy*, uint32_t>> transform_nodes;
+
+  /// True if children were added below this object since the transform
+  /// hierarchy was built.
+  bool transform_hierarchy_dirty;
+
+  /// Cached result of getSubtreeBoundingBox().
+  BoundingBox<Eigen::Vector3f> subtree_bounding_box;
+
+  /// True if subtree_bounding_box is valid.
+  bool has_subtree_bounding_box;
+
+  /// True if every object in the subtree is cullable.
+  bool subtree_is_cullable;
+
+  /// True if the cached subtree bounds must be recomputed.
+  bool subtree_bounding_box_dirty;
+
+  /// True if the cached bounds of all children must be rebuilt.
+  bool child_bounding_boxes_dirty;
+
+  /// True if every child's subtree is cullable.
+  bool children_are_cullable;
+
+  /// Children whose bounds changed since the cache was updated.
+  std::vector<size_t> dirty_children;
+
+  /// 1 for each child in dirty_children.
+  std::vector<uint8_t> dirty_child_flags;
+
+  /// How each child is cached.
+  std::vector<ChildState> child_states;
+
+  /// Bounds of the bounded children in the local space of this object.
+  BoundingBoxArray child_bounding_boxes;
+
+  /// Index into children of each box in child_bounding_boxes.
+  std::vector<size_t> child_bounding_box_indices;
+
+  /// Index into child_bounding_boxes of each bounded child.
+  std::vector<size_t> child_bounding_box_slots;
+
+  /// Indices of the children which aren't bounded and are never culled.
+  std::vector<size_t> unbounded_children;
+
+  /// Hierarchy over child_bounding_boxes. Empty if there are fewer than
+  /// kMinChildrenForHierarchy boxes.
+  BoundingVolumeHierarchy child_hierarchy;
+
+  /// Frustum test result of each box in child_bounding_boxes.
+  std::vector<uint8_t> child_bounding_box_visibility;
+
+  /// Boxes of child_bounding_boxes found in the frustum by child_hierarchy.
+  std::vector<uint32_t> visible_child_bounding_boxes;
+
+  /// 1 if the child at the same index has to be updated, 0 if it was culled.
+  std::vector<uint8_t> child_visibility;
+
+  /// Whether the SceneState& update overloads forward to the deprecated ones.
+  LegacyUpdate legacy_update;
 };
 
 }  // namespace VulkanEngine
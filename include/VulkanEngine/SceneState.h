@@ -6,7 +6,12 @@
 #ifndef INCLUDE_VULKANENGINE_SCENESTATE_H_
 #define INCLUDE_VULKANENGINE_SCENESTATE_H_
 
+#include <VulkanEngine/Frustum.h>
+#include <VulkanEngine/RenderQueue.h>
+#include <VulkanEngine/TransformHierarchy.h>
+
 #include <Eigen/Eigen>
+#include <cstdint>
 #include <memory>
 
 namespace VulkanEngine {
@@ -14,46 +19,116 @@ namespace VulkanEngine {
 class Scene;
 
 /// Contains information about the current state of the scene.
-class SceneState {
+/// Passed by reference to every SceneObject during traversal. Must be owned
+/// by a std::shared_ptr so that it can be passed to the deprecated
+/// std::shared_ptr<SceneState> overloads of SceneObject.
+class SceneState : public std::enable_shared_from_this<SceneState> {
  public:
   /// Constructor.
   explicit SceneState(const Scene& _scene);
 
+  /// Delete copy constructor, the current transform may point into the
+  /// state itself.
+  SceneState(const SceneState&) = delete;
+
+  /// Delete assignment operator, the current transform may point into the
+  /// state itself.
+  void operator=(const SceneState&) = delete;
+
   const Scene& getScene() const;
 
   /// \return The current total transformation matrix.
-  const Eigen::Matrix4f getTransform() const;
+  const Eigen::Matrix4f& getTransform() const;
 
   /// Set the current total transformation matrix.
-  /// \param transform The transform to set
-  void setTransform(const Eigen::Matrix4f& transform);
+  /// \param _transform The transform to set
+  void setTransform(const Eigen::Matrix4f& _transform);
 
   /// \return The current total transform.
-  const Eigen::Matrix4f getTotalTransform() const;
+  const Eigen::Matrix4f& getTotalTransform() const;
+
+  /// Set the hierarchy holding the world transforms of the objects being
+  /// traversed.
+  /// \param hierarchy The hierarchy, must stay alive during traversal.
+  void setTransformHierarchy(const TransformHierarchy* hierarchy);
+
+  /// \return The hierarchy holding the world transforms of the objects being
+  /// traversed, null if none has been set.
+  const TransformHierarchy* getTransformHierarchy() const;
+
+  /// Make the world transform of a node of the transform hierarchy the
+  /// current total transform. The matrix isn't copied.
+  /// \param node The index of the node.
+  void setTransformNode(uint32_t node);
+
+  /// \return The node of the transform hierarchy of the object being
+  /// traversed.
+  uint32_t getTransformNode() const;
 
   /// \return The current view matrix.
-  const Eigen::Matrix4f getViewMatrix() const;
+  const Eigen::Matrix4f& getViewMatrix() const;
 
   /// Set the current view matrix.
   void setViewMatrix(const Eigen::Matrix4f& _view_matrix);
 
   /// \return The current projection matrix.
-  const Eigen::Matrix4f getProjectionMatrix() const;
+  const Eigen::Matrix4f& getProjectionMatrix() const;
 
   /// Set the current projection matrix.
   void setProjectionMatrix(const Eigen::Matrix4f& _projection_matrix);
 
+  /// \return The RenderQueue which draws are submitted to during traversal.
+  RenderQueue& getRenderQueue();
+
+  /// Enable or disable skipping objects outside of the view frustum during
+  /// traversal.
+  /// \param enabled True to cull objects.
+  void setFrustumCullingEnabled(bool enabled);
+
+  /// \return True if objects outside of the view frustum should be skipped.
+  /// Always false until a projection matrix has been set.
+  bool isFrustumCullingEnabled() const;
+
+  /// \return The view frustum of the current view and projection matrix in
+  /// world space.
+  const Frustum& getFrustum();
+
  private:
   const Scene& scene;
 
-  /// The current total transformation matrix.
-  Eigen::Matrix4f total_transform;
+  /// The transform set with setTransform().
+  Eigen::Matrix4f transform;
+
+  /// The current total transformation matrix. Points to either transform or
+  /// a world transform of transform_hierarchy.
+  const Eigen::Matrix4f* total_transform;
+
+  /// The world transforms of the objects being traversed.
+  const TransformHierarchy* transform_hierarchy;
+
+  /// The node of the object being traversed.
+  uint32_t transform_node;
 
   /// The current view matrix.
   Eigen::Matrix4f view_matrix;
 
   /// The current projection matrix.
   Eigen::Matrix4f projection_matrix;
+
+  /// Draws submitted during the current traversal.
+  RenderQueue render_queue;
+
+  /// True if frustum culling was requested with setFrustumCullingEnabled().
+  bool frustum_culling_enabled;
+
+  /// True once a projection matrix has been set.
+  bool has_projection_matrix;
+
+  /// The frustum of the current view and projection matrix.
+  Frustum frustum;
+
+  /// True if frustum has to be recomputed.
+  bool frustum_dirty;
 };
 
 }  // namespace VulkanEngine
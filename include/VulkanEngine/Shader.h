@@ -9,6 +9,7 @@
 #include <VulkanEngine/Descriptor.h>
 #include <VulkanEngine/ShaderModule.h>
 
+#include <cstdint>
 #include <vector>
 
 namespace VulkanEngine {
@@ -31,11 +32,21 @@ class Shader {
       const std::vector<std::vector<std::shared_ptr<Descriptor>>>&
           _descriptors);
 
+  /// Write a descriptor set again if any of its descriptors changed since it
+  /// was last written, see Descriptor::getVersion(). The descriptor set must
+  /// not be in use by the GPU, e.g. the set of the current frame in flight
+  /// before any commands using it have been recorded.
+  /// \param descriptor_set_index The index of the descriptor set.
+  void updateDescriptorSet(uint32_t descriptor_set_index);
+
   /// Bind a set of descriptors to an index.
   /// \param command_buffer Command buffer used for binding.
   /// \param descriptor_set_index The index to bind to.
+  /// \param pipeline_bind_point The type of pipeline using the descriptors.
   void bindDescriptorSet(const vk::CommandBuffer& command_buffer,
-                         uint32_t descriptor_set_index);
+                         uint32_t descriptor_set_index,
+                         vk::PipelineBindPoint pipeline_bind_point =
+                             vk::PipelineBindPoint::eGraphics);
 
   /// \return Vulkan PipelineShaderStageCreateInfo instances.
   const std::vector<vk::PipelineShaderStageCreateInfo>& getVkShaderStages()
@@ -44,7 +55,22 @@ class Shader {
   /// \return Vulkan PipelineLayout instances.
   const vk::PipelineLayout createVkPipelineLayout();
 
+  /// \return An id which is unique to this Shader instance.
+  uint32_t getId() const;
+
  private:
+  /// Write a descriptor set from its descriptors.
+  /// \param descriptor_set_index The index of the descriptor set.
+  void writeDescriptorSet(size_t descriptor_set_index);
+
+  /// \return The sum of the versions of the descriptors of a set, which
+  /// changes whenever any of their versions change.
+  /// \param descriptor_set_index The index of the descriptor set.
+  uint64_t getDescriptorSetVersion(size_t descriptor_set_index) const;
+
+  /// Unique id of this Shader.
+  const uint32_t id;
+
   /// List of ShaderStages for this shader.
   std::vector<vk::PipelineShaderStageCreateInfo> shader_stages;
 
@@ -63,6 +89,9 @@ class Shader {
   /// List of Vulkan DescriptorSets
   std::vector<vk::DescriptorSet> vk_descriptor_sets;
 
+  /// The version of each descriptor set when it was last written.
+  std::vector<uint64_t> descriptor_set_versions;
+
   /// Vulkan PipelineLayout.
   vk::PipelineLayout vk_pipeline_layout;
 };
@@ -7,6 +7,7 @@
 #define INCLUDE_VULKANENGINE_SHADERIMAGE_H_
 
 #include <VulkanEngine/Descriptor.h>
+#include <VulkanEngine/MipmapGenerator.h>
 
 #include <memory>
 
@@ -44,11 +45,13 @@ class ShaderImage
   /// width of the image. \param _height The height of the image. \param _depth
   /// The depth of the image. \param pixel_size The data size of a single pixel
   /// in the image.
+  /// \param mipmap_mode How mip levels are generated.
   ShaderImage(vk::ImageLayout initial_layout, vk::ImageUsageFlags usage_flags,
               VmaMemoryUsage vma_memory_usage, uint32_t width, uint32_t height,
               uint32_t depth, size_t pixel_size, uint32_t binding,
               uint32_t descriptor_count, vk::DescriptorType descriptor_type,
-              vk::ShaderStageFlags shader_stage_flags);
+              vk::ShaderStageFlags shader_stage_flags,
+              MipmapMode mipmap_mode = MipmapMode::eBlit);
 
   /// Destructor.
   ~ShaderImage();
@@ -66,6 +69,10 @@ class ShaderImage
       std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
       const vk::DescriptorSet& destination_set);
 
+  /// \return The number of times the image has been moved by the
+  /// MemoryDefragmenter, each move replaces the image view.
+  uint64_t getVersion() const override;
+
  private:
   /// The vk::Sampler created in createSampler().
   vk::Sampler vk_sampler;
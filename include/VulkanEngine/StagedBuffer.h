@@ -7,6 +7,8 @@
 #define INCLUDE_VULKANENGINE_STAGEDBUFFER_H_
 
 #include <VulkanEngine/Buffer.h>
+#include <VulkanEngine/FrameStatistics.h>
+#include <VulkanEngine/Profiler.h>
 
 namespace VulkanEngine {
 
@@ -43,6 +45,14 @@ class StagedBuffer : public DestinationClass {
   /// \param _data_size The size of the data in bytes.
   void updateBuffer(const void* _data, size_t _data_size) override;
 
+  /// Map the memory of the staging buffer, which allows writing data directly
+  /// into it instead of copying it from another buffer with updateBuffer().
+  /// \return Pointer to the start of the staging buffer's memory.
+  void* mapStagingMemory();
+
+  /// Unmap memory previously mapped with mapStagingMemory().
+  void unmapStagingMemory();
+
  protected:
   /// The source buffer. Data will be transferred from this buffer to the
   /// destination buffer when calling transferBuffer().
@@ -0,0 +1,57 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_STORAGEBUFFER_H_
+#define INCLUDE_VULKANENGINE_STORAGEBUFFER_H_
+
+#include <VulkanEngine/Buffer.h>
+#include <VulkanEngine/Descriptor.h>
+
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// A host visible buffer holding an array of T which is bound as a single
+/// storage buffer descriptor. Unlike UniformBuffer the whole array is visible
+/// to the shader as a runtime sized array, so it can be indexed with per draw
+/// values such as gl_InstanceIndex.
+template <typename T>
+class StorageBuffer : public Buffer, public Descriptor {
+ public:
+  /// Constructor.
+  /// \param _binding The binding index.
+  /// \param _num_elements The number of elements of type T in the buffer.
+  /// \param _vk_shader_stage_flags Specify which shader stages will access the
+  /// buffer.
+  StorageBuffer(uint32_t _binding, size_t _num_elements,
+                vk::ShaderStageFlags _vk_shader_stage_flags =
+                    vk::ShaderStageFlagBits::eAllGraphics);
+
+  /// Destructor.
+  virtual ~StorageBuffer();
+
+  /// \return The number of elements in the buffer.
+  size_t getNumElements() const;
+
+  virtual void appendVkDescriptorSets(
+      std::shared_ptr<std::vector<vk::WriteDescriptorSet>>
+          write_descriptor_sets,
+      std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
+      const vk::DescriptorSet& destination_set);
+
+ private:
+  /// The number of elements in the buffer.
+  size_t num_elements;
+
+  vk::DescriptorBufferInfo vk_descriptor_buffer_info;
+};
+
+}  // namespace VulkanEngine
+
+#include <StorageBuffer.cpp>  // NOLINT(build/include)
+
+#endif  // INCLUDE_VULKANENGINE_STORAGEBUFFER_H_
@@ -0,0 +1,151 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_STREAMEDTEXTURE_H_
+#define INCLUDE_VULKANENGINE_STREAMEDTEXTURE_H_
+
+#include <VulkanEngine/Descriptor.h>
+#include <VulkanEngine/StagedBuffer.h>
+#include <VulkanEngine/TextureFile.h>
+#include <VulkanEngine/TextureImage.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// A texture whose mip levels are streamed in and out of device memory by
+/// the TextureStreamer. Only the levels from getResidentLevel() down to the
+/// smallest are resident, in a TextureImage which is replaced whenever the
+/// resident levels change. The levels are kept in system memory by the
+/// TextureFile. Objects drawing the texture report how large it appears on
+/// screen with requestScreenSize(), which decides the levels the streamer
+/// makes resident. Create instances with TextureStreamer::createTexture().
+class StreamedTexture : public Descriptor {
+  /// Decides which levels are resident and replaces the image.
+  friend class TextureStreamer;
+
+ public:
+  /// Constructor. Creates the image holding the first resident levels and
+  /// queues its upload.
+  /// \param _texture_file The texture to stream, with all of its levels.
+  /// \param binding The binding of the descriptor.
+  /// \param shader_stage_flags The shader stages which sample the texture.
+  /// \param resident_level The first level to make resident.
+  StreamedTexture(std::shared_ptr<const TextureFile> _texture_file,
+                  uint32_t binding, vk::ShaderStageFlags shader_stage_flags,
+                  uint32_t resident_level);
+
+  /// Destructor. Waits for the image of a pending load to be created.
+  ~StreamedTexture();
+
+  /// Report the size of the texture on screen, which requests the levels
+  /// needed to draw it without magnification. Called every frame by the
+  /// objects drawing the texture, the largest size of a frame counts.
+  /// \param screen_size The number of pixels covered by the full width or
+  /// height of the texture.
+  void requestScreenSize(float screen_size);
+
+  /// \return The finest level resident in device memory.
+  uint32_t getResidentLevel() const;
+
+  /// \return The number of levels of the texture.
+  uint32_t getNumLevels() const;
+
+  /// \return The size in bytes of the device memory used by the resident
+  /// levels.
+  size_t getResidentSize() const;
+
+  /// \return The TransferQueue transfer uploading the first resident levels.
+  uint64_t getTransfer() const;
+
+  /// \return The texture being streamed.
+  const std::shared_ptr<const TextureFile>& getTextureFile() const;
+
+  /// Writes the image holding the resident levels.
+  void appendVkDescriptorSets(
+      std::shared_ptr<std::vector<vk::WriteDescriptorSet>>
+          write_descriptor_sets,
+      std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
+      const vk::DescriptorSet& destination_set) override;
+
+  /// \return The number of times the resident levels have changed.
+  uint64_t getVersion() const override;
+
+ private:
+  /// An image holding a range of levels.
+  using Image = StagedBuffer<TextureImage>;
+
+  /// Create an image with its levels copied to its staging buffer.
+  /// \param texture_file The texture to create the image for.
+  /// \param binding The binding of the descriptor.
+  /// \param shader_stage_flags The shader stages which sample the texture.
+  /// \param first_level The first level of the image.
+  /// \return The image, ready to be transferred.
+  static std::shared_ptr<Image> createImage(
+      const std::shared_ptr<const TextureFile>& texture_file,
+      uint32_t binding, vk::ShaderStageFlags shader_stage_flags,
+      uint32_t first_level);
+
+  /// Start creating an image with different resident levels in the
+  /// background. Nothing happens if a load is pending already.
+  /// \param first_level The first level of the image.
+  void load(uint32_t first_level);
+
+  /// Queue the upload of a loaded image and replace the resident image once
+  /// the upload has been recorded.
+  /// \return The replaced image, null if the image hasn't changed.
+  std::shared_ptr<Image> updateLoad();
+
+  /// \return True if an image is being loaded.
+  bool isLoading() const;
+
+  /// \return The estimated size in bytes of an image starting at a level.
+  /// \param first_level The first level of the image.
+  size_t getImageSize(uint32_t first_level) const;
+
+  /// The texture being streamed.
+  std::shared_ptr<const TextureFile> texture_file;
+
+  /// The image holding the resident levels.
+  std::shared_ptr<Image> image;
+
+  /// The TransferQueue transfer uploading image.
+  uint64_t transfer;
+
+  /// The image being created in the background, valid while loading.
+  std::future<std::shared_ptr<Image>> pending_image_future;
+
+  /// The created image whose upload is queued, null if none.
+  std::shared_ptr<Image> pending_image;
+
+  /// The TransferQueue transfer uploading pending_image.
+  uint64_t pending_transfer;
+
+  /// The first level of the image being loaded.
+  uint32_t pending_level;
+
+  /// The finest level requested since the last TextureStreamer::update(),
+  /// getNumLevels() if none.
+  uint32_t requested_level;
+
+  /// The level the streamer wants resident, kept between frames in which
+  /// the texture isn't drawn.
+  uint32_t target_level;
+
+  /// The TextureStreamer frame in which the texture was last drawn.
+  uint64_t last_request_frame;
+
+  /// See getVersion().
+  uint64_t version;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_STREAMEDTEXTURE_H_
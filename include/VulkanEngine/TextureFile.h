@@ -0,0 +1,175 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+
+#ifndef INCLUDE_VULKANENGINE_TEXTUREFILE_H_
+#define INCLUDE_VULKANENGINE_TEXTUREFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// A 2D texture read from a KTX2 or DDS file, together with all of its mip
+/// levels. The data is kept as it is stored in the file, so block compressed
+/// textures can be copied to the GPU without decoding them. For devices which
+/// can't sample the format, transcode() decompresses the texture on the CPU.
+/// Textures can also be created from images, compressed and saved as KTX2
+/// files, which is how TextureBaker precomputes textures offline.
+class TextureFile {
+ public:
+  /// A mip level of the texture.
+  struct Level {
+    /// Byte offset of the level from the start of getData(). Levels of loaded
+    /// files point into the contents of the file.
+    size_t offset;
+
+    /// Size of the level in bytes.
+    size_t size;
+
+    /// Width of the level in texels.
+    uint32_t width;
+
+    /// Height of the level in texels.
+    uint32_t height;
+  };
+
+  /// Constructor.
+  /// \param _vk_format The format of the texels in the data.
+  /// \param _levels The mip levels, the first being the largest.
+  /// \param _data The data the levels are stored in.
+  TextureFile(vk::Format _vk_format, std::vector<Level> _levels,
+              std::vector<uint8_t> _data);
+
+  /// Destructor.
+  ~TextureFile();
+
+  /// Read a KTX2 or DDS file. The container is detected from the contents of
+  /// the file. Only 2D textures without supercompression are supported.
+  /// Throws std::runtime_error if the file can't be read.
+  /// \param path The path of the file.
+  /// \return The texture.
+  static std::shared_ptr<TextureFile> load(const std::filesystem::path& path);
+
+  /// \return True if the path has the extension of a file load() reads.
+  /// \param path The path to check.
+  static bool isTextureFile(const std::filesystem::path& path);
+
+  /// Create a texture from an image, together with all of its mip levels.
+  /// Each level is a 2x2 box filtered version of the level above it.
+  /// \param texels The R8G8B8A8 texels of the image, row by row.
+  /// \param width The width of the image.
+  /// \param height The height of the image.
+  /// \param format eR8G8B8A8Unorm or eR8G8B8A8Srgb.
+  /// \return The texture.
+  static std::shared_ptr<TextureFile> createFromImage(
+      const uint8_t* texels, uint32_t width, uint32_t height,
+      vk::Format format = vk::Format::eR8G8B8A8Unorm);
+
+  /// Compress all levels of an R8G8B8A8 texture. Throws std::runtime_error if
+  /// the texture isn't R8G8B8A8 or the format isn't supported.
+  /// \param format The block compressed format. BC1 without alpha and BC3 are
+  /// supported, in UNORM and SRGB.
+  /// \return The compressed texture.
+  std::shared_ptr<TextureFile> compress(vk::Format format) const;
+
+  /// \return True if any texel isn't opaque. Textures which aren't R8G8B8A8
+  /// are transcoded first.
+  bool hasAlpha() const;
+
+  /// Write the texture to a KTX2 file. Throws std::runtime_error if the file
+  /// can't be written or the format has no data format descriptor, which is
+  /// the case for formats other than R8G8B8A8, BC1 and BC3.
+  /// \param path The path of the file.
+  void save(const std::filesystem::path& path) const;
+
+  /// Decompress all levels of the texture into R8G8B8A8 texels. Throws
+  /// std::runtime_error if canTranscode() is false for the format.
+  /// \return The decompressed texture, in eR8G8B8A8Srgb if the format of the
+  /// texture is sRGB and eR8G8B8A8Unorm otherwise.
+  std::shared_ptr<TextureFile> transcode() const;
+
+  /// \return True if transcode() can decompress the given format. BC1 to BC5
+  /// and ETC2 with unsigned data are supported, ASTC, BC6H and BC7 are not.
+  /// \param format The vk::Format to check.
+  static bool canTranscode(vk::Format format);
+
+  /// Get the size of the blocks a format stores texels in.
+  /// \param format The vk::Format.
+  /// \param [out] block_width The width of a block in texels.
+  /// \param [out] block_height The height of a block in texels.
+  /// \param [out] block_size The size of a block in bytes.
+  /// \return False if the format isn't supported by TextureFile.
+  static bool getBlockInfo(vk::Format format, uint32_t& block_width,
+                           uint32_t& block_height, uint32_t& block_size);
+
+  /// \return The size in bytes of a level of the given format and size.
+  /// \param format The vk::Format, must be supported by getBlockInfo().
+  /// \param width The width of the level in texels.
+  /// \param height The height of the level in texels.
+  static size_t getLevelSize(vk::Format format, uint32_t width,
+                             uint32_t height);
+
+  /// \return The format of the texels.
+  vk::Format getVkFormat() const;
+
+  /// \return The width of the first level.
+  uint32_t getWidth() const;
+
+  /// \return The height of the first level.
+  uint32_t getHeight() const;
+
+  /// \return The mip levels, the first being the largest.
+  const std::vector<Level>& getLevels() const;
+
+  /// \return The data the levels are stored in.
+  const uint8_t* getData() const;
+
+  /// \return The size of all levels in bytes.
+  size_t getDataSize() const;
+
+ private:
+  /// Read the contents of a KTX2 file.
+  /// \param file The contents of the file.
+  /// \return The texture, which keeps the contents.
+  static std::shared_ptr<TextureFile> loadKTX2(std::vector<uint8_t> file);
+
+  /// Read the contents of a DDS file.
+  /// \param file The contents of the file.
+  /// \return The texture, which keeps the contents.
+  static std::shared_ptr<TextureFile> loadDDS(std::vector<uint8_t> file);
+
+  /// Create a texture from levels stored in the contents of a file, checking
+  /// that they lie within the file.
+  /// \param format The vk::Format of the levels.
+  /// \param width The width of the first level.
+  /// \param height The height of the first level.
+  /// \param offsets The byte offset of each level in the file.
+  /// \param file The contents of the file.
+  /// \return The texture.
+  static std::shared_ptr<TextureFile> createFromFile(
+      vk::Format format, uint32_t width, uint32_t height,
+      const std::vector<size_t>& offsets, std::vector<uint8_t> file);
+
+  /// The format of the texels.
+  vk::Format vk_format;
+
+  /// The mip levels.
+  std::vector<Level> levels;
+
+  /// The data the levels are stored in.
+  std::vector<uint8_t> data;
+
+  /// The size of all levels.
+  size_t data_size;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_TEXTUREFILE_H_
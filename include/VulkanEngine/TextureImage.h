@@ -0,0 +1,122 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_TEXTUREIMAGE_H_
+#define INCLUDE_VULKANENGINE_TEXTUREIMAGE_H_
+
+#include <VulkanEngine/Descriptor.h>
+#include <VulkanEngine/ImageBase.h>
+#include <VulkanEngine/StagedBufferDestination.h>
+#include <VulkanEngine/TextureFile.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// A sampled 2D image holding the mip levels of a TextureFile. Unlike Image
+/// the format is chosen at runtime, and the levels are uploaded as they are
+/// stored in the file instead of being generated, so block compressed
+/// textures stay compressed in device memory. Use with StagedBuffer and copy
+/// the levels into the staging memory with copyLevels() before transferring.
+class TextureImage : public StagedBufferDestination,
+                     public ImageBase,
+                     public Descriptor {
+ public:
+  /// Constructor. Creates the image, its view and sampler.
+  /// \param texture_file The texture to create the image for. Its format
+  /// must be supported, see Device::supportsSampledImageFormat().
+  /// \param binding The binding of the descriptor.
+  /// \param shader_stage_flags The shader stages which sample the image.
+  /// \param _first_level The first level of the texture file to include.
+  /// Level 0 of the image is this level, so finer levels take no memory.
+  TextureImage(std::shared_ptr<const TextureFile> texture_file,
+               uint32_t binding, vk::ShaderStageFlags shader_stage_flags,
+               uint32_t _first_level = 0);
+
+  /// Destructor.
+  virtual ~TextureImage();
+
+  /// Copy the levels of a texture file into staging memory, with one copy per
+  /// level. The levels are packed in the order of their size, largest first.
+  /// \param texture_file The texture file the image was created for.
+  /// \param destination Memory of at least getStagingBufferSize() bytes, see
+  /// StagedBuffer::mapStagingMemory().
+  void copyLevels(const TextureFile& texture_file, void* destination) const;
+
+  /// \return The vk::Format of the image.
+  vk::Format getVkFormat() const;
+
+  /// \return The number of mip levels of the image.
+  uint32_t getNumLevels() const;
+
+  /// \return The level of the texture file which is level 0 of the image.
+  uint32_t getFirstLevel() const;
+
+  /// Get the internal vulkan image.
+  virtual vk::Image getVkImage() const;
+
+  /// Get the vk::ImageView.
+  virtual vk::ImageView getVkImageView() const;
+
+  /// Append descriptor sets to this image.
+  virtual void appendVkDescriptorSets(
+      std::shared_ptr<std::vector<vk::WriteDescriptorSet>>
+          write_descriptor_sets,
+      std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
+      const vk::DescriptorSet& destination_set);
+
+ protected:
+  /// Overridden to copy every level from a StagedBuffer to this image.
+  /// \param command_buffers The command buffer to insert the commands into.
+  /// \param source_buffer The source vk::Buffer in the StagedBuffer.
+  virtual void insertTransferCommand(const vk::CommandBuffer& command_buffer,
+                                     const vk::Buffer& source_buffer);
+
+  /// \return The data size for the staging buffer.
+  virtual size_t getStagingBufferSize() const;
+
+ private:
+  /// Insert a barrier transitioning all levels to a new layout.
+  /// \param command_buffer The command buffer to insert the barrier into.
+  /// \param new_layout The layout to transition to.
+  void transitionImageLayout(const vk::CommandBuffer& command_buffer,
+                             vk::ImageLayout new_layout);
+
+  /// The format of the image.
+  vk::Format vk_format;
+
+  /// The level of the texture file which is level 0 of the image.
+  uint32_t first_level;
+
+  /// The levels of the texture file the image was created for, with offsets
+  /// into the staging buffer.
+  std::vector<TextureFile::Level> levels;
+
+  /// The size of the data of all levels.
+  size_t data_size;
+
+  /// The current vk::ImageLayout.
+  vk::ImageLayout vk_image_layout;
+
+  /// Internal vk_image.
+  vk::Image vk_image;
+
+  /// The view of all levels of the image.
+  vk::ImageView vk_image_view;
+
+  /// The sampler of the image.
+  vk::Sampler vk_sampler;
+
+  /// The image info referenced by the descriptor set writes.
+  vk::DescriptorImageInfo vk_descriptor_image_info;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_TEXTUREIMAGE_H_
@@ -0,0 +1,139 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+
+#ifndef INCLUDE_VULKANENGINE_TEXTURESTREAMER_H_
+#define INCLUDE_VULKANENGINE_TEXTURESTREAMER_H_
+
+#include <VulkanEngine/StreamedTexture.h>
+#include <VulkanEngine/TextureFile.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// Decides which mip levels of each StreamedTexture are resident in device
+/// memory. Textures start out with only their small levels resident. Once per
+/// frame, update() loads the levels requested by the objects drawing each
+/// texture in the background, most recently drawn textures first, as long as
+/// the resident levels of all textures fit into a memory budget. When they
+/// don't, levels of the textures which have been drawn least recently are
+/// dropped. The budget is derived from the budget VMA reports for device
+/// local memory unless one is set with setMemoryBudget().
+class TextureStreamer {
+ public:
+  /// Textures are created with the largest level no larger than this
+  /// resident.
+  static constexpr uint32_t kInitialSize = 64;
+
+  /// The maximum number of textures loading higher levels at the same time.
+  static constexpr size_t kMaxPendingLoads = 4;
+
+  /// Constructor.
+  TextureStreamer();
+
+  /// Destructor.
+  ~TextureStreamer();
+
+  /// Delete copy constructor, the streamer streams textures for a single device.
+  TextureStreamer(const TextureStreamer&) = delete;
+
+  /// Delete assignment operator, the streamer streams textures for a single device.
+  void operator=(const TextureStreamer&) = delete;
+
+  /// Create a texture whose levels are streamed. Thread safe. The texture
+  /// is streamed for as long as the caller keeps it alive.
+  /// \param texture_file The texture with all of its levels, kept in system
+  /// memory.
+  /// \param binding The binding of the descriptor.
+  /// \param shader_stage_flags The shader stages which sample the texture.
+  /// \return The texture, its first levels upload with the transfer returned
+  /// by StreamedTexture::getTransfer().
+  std::shared_ptr<StreamedTexture> createTexture(
+      std::shared_ptr<const TextureFile> texture_file, uint32_t binding,
+      vk::ShaderStageFlags shader_stage_flags);
+
+  /// Update the resident levels of all textures using the sizes requested
+  /// since the last call. Called by Scene::update() at the start of every
+  /// frame, before the TransferQueue is flushed.
+  void update();
+
+  /// Set whether objects should stream their textures. Textures are loaded
+  /// with all of their levels resident otherwise. Disabled by default.
+  /// \param _enabled True to stream textures created from now on.
+  void setEnabled(bool _enabled);
+
+  /// \return True if objects should stream their textures.
+  bool isEnabled() const;
+
+  /// Set the number of bytes of device memory the resident levels may use.
+  /// \param _memory_budget The budget, 0 to derive it from the budget VMA
+  /// reports for device local memory.
+  void setMemoryBudget(size_t _memory_budget);
+
+  /// \return The budget used by the last call to update().
+  size_t getMemoryBudget() const;
+
+  /// \return The number of bytes of device memory used by the resident levels
+  /// of all textures.
+  size_t getResidentSize() const;
+
+  /// \return The number of textures being streamed.
+  size_t getNumTextures() const;
+
+  /// \return The number of textures with levels being loaded.
+  size_t getNumPendingLoads() const;
+
+  /// Stop streaming all textures.
+  void clear();
+
+ private:
+  /// Derive the budget from the budget VMA reports for device local heaps,
+  /// leaving room for the memory used by everything else.
+  /// \param streamed_size The device memory currently used by streamed
+  /// textures.
+  /// \return The budget in bytes.
+  static size_t queryMemoryBudget(size_t streamed_size);
+
+  /// \return The size in bytes the resident levels of a texture will have
+  /// once its pending load completes.
+  /// \param texture The texture.
+  static size_t getCommittedSize(const StreamedTexture& texture);
+
+  /// Protects textures.
+  mutable std::mutex mutex;
+
+  /// The textures being streamed.
+  std::vector<std::weak_ptr<StreamedTexture>> textures;
+
+  /// The living textures during update(), kept to avoid allocations.
+  std::vector<std::shared_ptr<StreamedTexture>> update_textures;
+
+  /// Textures considered for loading during update(), kept to avoid
+  /// allocations.
+  std::vector<StreamedTexture*> candidates;
+
+  /// See setEnabled().
+  std::atomic<bool> enabled;
+
+  /// See setMemoryBudget().
+  size_t memory_budget;
+
+  /// The budget used by the last call to update().
+  size_t current_memory_budget;
+
+  /// The number of calls to update().
+  uint64_t frame;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_TEXTURESTREAMER_H_
@@ -0,0 +1,133 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+
+#ifndef INCLUDE_VULKANENGINE_TRANSFERQUEUE_H_
+#define INCLUDE_VULKANENGINE_TRANSFERQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace VulkanEngine {
+
+/// Collects commands which upload data to the GPU, so that resources can be
+/// created and filled on any thread while the commands are recorded by the
+/// thread owning the frame's command buffer. Each frame, Scene::update()
+/// records the queued transfers in front of the frame's draws, up to a byte
+/// budget so that large loads are spread over several frames.
+/// Transfers are identified by increasing numbers, so a resource created on
+/// another thread can be used once isAvailable() returns true for the
+/// transfer which uploaded it.
+class TransferQueue {
+ public:
+  /// Constructor.
+  TransferQueue();
+
+  /// Destructor.
+  ~TransferQueue();
+
+  /// Delete copy constructor, queued transfers hold resources.
+  TransferQueue(const TransferQueue&) = delete;
+
+  /// Delete assignment operator, queued transfers hold resources.
+  void operator=(const TransferQueue&) = delete;
+
+  /// Queue a transfer. Thread safe.
+  /// \param record Records the transfer commands, e.g. by calling
+  /// StagedBuffer::transferBuffer(). Must keep the resources it uploads
+  /// alive.
+  /// \param size The number of bytes transferred, counted against the budget
+  /// of flush().
+  /// \return The number identifying the transfer.
+  uint64_t enqueue(
+      const std::function<void(const vk::CommandBuffer&)>& record,
+      size_t size);
+
+  /// \return True if commands recorded from now on can use the data of a
+  /// transfer. Thread safe.
+  /// \param transfer The number returned by enqueue(). 0 is always available.
+  bool isAvailable(uint64_t transfer) const;
+
+  /// Record queued transfers in order, followed by a barrier which makes
+  /// their data visible to the draws and dispatches recorded after it.
+  /// Stops once the budget is used up, but always records at least one
+  /// transfer. Must be called outside of a render pass, by the thread
+  /// recording the command buffer.
+  /// \param command_buffer The vk::CommandBuffer to insert the commands into.
+  /// \return The number of transfers recorded.
+  size_t flush(const vk::CommandBuffer& command_buffer);
+
+  /// Submit all queued transfers with a single use command buffer and wait
+  /// for them to complete. Must be called by the thread recording frames.
+  /// \return The number of transfers recorded.
+  size_t flush();
+
+  /// Set the number of bytes flush() records per call.
+  /// \param _budget The budget in bytes.
+  void setBudget(size_t _budget);
+
+  /// \return The number of bytes flush() records per call.
+  size_t getBudget() const;
+
+  /// \return The number of queued transfers. Thread safe.
+  size_t getNumPendingTransfers() const;
+
+  /// Drop all queued transfers without recording them, releasing their
+  /// resources.
+  void clear();
+
+ private:
+  /// A queued transfer.
+  struct Transfer {
+    /// The number identifying the transfer.
+    uint64_t id;
+
+    /// Records the transfer commands.
+    std::function<void(const vk::CommandBuffer&)> record;
+
+    /// The number of bytes transferred.
+    size_t size;
+  };
+
+  /// Remove transfers from the front of the queue.
+  /// \param max_size Stop once this many bytes have been taken, at least one
+  /// transfer is always taken.
+  /// \param transfers Receives the transfers.
+  void take(size_t max_size, std::vector<Transfer>& transfers);
+
+  /// Record transfers and the barrier following them.
+  /// \param command_buffer The vk::CommandBuffer to insert the commands into.
+  /// \param transfers The transfers to record.
+  static void record(const vk::CommandBuffer& command_buffer,
+                     const std::vector<Transfer>& transfers);
+
+  /// Protects pending_transfers and next_transfer.
+  mutable std::mutex mutex;
+
+  /// The queued transfers, in order.
+  std::deque<Transfer> pending_transfers;
+
+  /// The number identifying the next transfer.
+  uint64_t next_transfer;
+
+  /// The number of the last recorded transfer.
+  std::atomic<uint64_t> last_recorded_transfer;
+
+  /// The number of bytes flush() records per call.
+  size_t budget;
+
+  /// Transfers taken from the queue by flush(), kept to avoid allocations.
+  std::vector<Transfer> transfers_scratch;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_TRANSFERQUEUE_H_
@@ -0,0 +1,115 @@
+// Copyright (c) 2024 Michael Carlie. All Rights Reserved.
+//
+// This software is released under the MIT License.
+// https://opensource.org/licenses/MIT
+
+#ifndef INCLUDE_VULKANENGINE_TRANSFORMHIERARCHY_H_
+#define INCLUDE_VULKANENGINE_TRANSFORMHIERARCHY_H_
+
+#include <Eigen/Eigen>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace VulkanEngine {
+
+/// Stores the local and world transforms of a tree of nodes in contiguous
+/// arrays, ordered so that every node comes after its parent. World
+/// transforms are computed with a single linear pass over the arrays, which
+/// only visits nodes from the first changed node onwards and only multiplies
+/// matrices of changed nodes and their descendants.
+class TransformHierarchy {
+ public:
+  /// The parent of root nodes.
+  static constexpr uint32_t kNoParent = std::numeric_limits<uint32_t>::max();
+
+  /// Constructor.
+  TransformHierarchy();
+
+  /// Destructor.
+  ~TransformHierarchy();
+
+  /// Remove all nodes.
+  void clear();
+
+  /// Reserve memory for a number of nodes.
+  /// \param count The number of nodes.
+  void reserve(size_t count);
+
+  /// Append a node.
+  /// \param parent The parent of the node, must have been added before, or
+  /// kNoParent for a root.
+  /// \param local_transform The transform relative to the parent.
+  /// \return The index of the node.
+  uint32_t addNode(uint32_t parent, const Eigen::Matrix4f& local_transform);
+
+  /// \return The number of nodes.
+  size_t size() const;
+
+  /// \return The parent of a node, or kNoParent for a root.
+  /// \param node The index of the node.
+  uint32_t getParent(uint32_t node) const;
+
+  /// \return One past the last descendant of a node. If nodes are added
+  /// depth first, the descendants of a node are exactly the nodes between
+  /// the node and this index.
+  /// \param node The index of the node.
+  uint32_t getSubtreeEnd(uint32_t node) const;
+
+  /// Set the transform of a node relative to its parent. Its world transform
+  /// and those of its descendants are recomputed on the next update().
+  /// \param node The index of the node.
+  /// \param local_transform The new local transform.
+  void setLocalTransform(uint32_t node, const Eigen::Matrix4f& local_transform);
+
+  /// \return The transform of a node relative to its parent.
+  /// \param node The index of the node.
+  const Eigen::Matrix4f& getLocalTransform(uint32_t node) const;
+
+  /// \return The world transform of a node as of the last update().
+  /// \param node The index of the node.
+  const Eigen::Matrix4f& getWorldTransform(uint32_t node) const;
+
+  /// Recompute the world transforms of all nodes whose local transform or
+  /// an ancestor's local transform changed.
+  void update();
+
+  /// \return The number of world transforms recomputed by the last update().
+  size_t getNumUpdatedNodes() const;
+
+  /// Multiply two 4x4 column major matrices. Uses AVX2 to compute two
+  /// columns at once if the engine is built with it.
+  /// \param a The left matrix.
+  /// \param b The right matrix.
+  /// \param [out] result Set to a * b. Must not alias a or b.
+  static void multiply(const Eigen::Matrix4f& a, const Eigen::Matrix4f& b,
+                       Eigen::Matrix4f& result);
+
+ private:
+  /// The parent of each node.
+  std::vector<uint32_t> parents;
+
+  /// One past the last descendant of each node.
+  std::vector<uint32_t> subtree_ends;
+
+  /// The transform of each node relative to its parent.
+  std::vector<Eigen::Matrix4f> local_transforms;
+
+  /// The transform of each node relative to the root.
+  std::vector<Eigen::Matrix4f> world_transforms;
+
+  /// 1 for each node whose world transform has to be recomputed. During
+  /// update() also set for the descendants of such nodes.
+  std::vector<uint8_t> dirty;
+
+  /// The lowest index of a dirty node, size() if there is none.
+  size_t first_dirty_node;
+
+  /// The number of world transforms recomputed by the last update().
+  size_t num_updated_nodes;
+};
+
+}  // namespace VulkanEngine
+
+#endif  // INCLUDE_VULKANENGINE_TRANSFORMHIERARCHY_H_
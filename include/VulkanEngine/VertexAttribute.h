@@ -22,8 +22,17 @@ class VertexAttribute : public Attribute {
   /// \param data The vertex data which will be represented by this
   /// VertexAttribute instance. \param binding The binding index of the vertex
   /// attribute.
-  VertexAttribute(const T* data, size_t _num_elements, uint32_t _location,
-                  vk::Format _format);
+  /// \param _input_rate Whether the attribute advances per vertex or per
+  /// instance.
+  /// \param _num_locations The number of consecutive shader locations the
+  /// attribute occupies starting at _location, each of them _format. E.g 4
+  /// for an Eigen::Matrix4f read as a mat4 with
+  /// vk::Format::eR32G32B32A32Sfloat.
+  VertexAttribute(
+      const T* data, size_t _num_elements, uint32_t _location,
+      vk::Format _format,
+      vk::VertexInputRate _input_rate = vk::VertexInputRate::eVertex,
+      uint32_t _num_locations = 1);
 
   /// Destructor.
   virtual ~VertexAttribute();
@@ -34,8 +43,8 @@ class VertexAttribute : public Attribute {
       uint32_t binding_index) const;
 
   /// \return All vk::VertexInputAttributeDescription for this VertexAttribute
-  /// instance.
-  const vk::VertexInputAttributeDescription
+  /// instance, one per shader location.
+  const std::vector<vk::VertexInputAttributeDescription>
   getVkVertexInputAttributeDescriptions(uint32_t binding_index) const;
 
   /// \return The vk::Format of the VertexAttribute describing the format of the
@@ -48,6 +57,12 @@ class VertexAttribute : public Attribute {
 
   /// The format of the attribute's data.
   vk::Format format;
+
+  /// Whether the attribute advances per vertex or per instance.
+  vk::VertexInputRate input_rate;
+
+  /// The number of consecutive shader locations the attribute occupies.
+  uint32_t num_locations;
 };
 
 }  // namespace VulkanEngine
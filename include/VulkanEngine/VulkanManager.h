@@ -6,11 +6,20 @@
 #ifndef INCLUDE_VULKANENGINE_VULKANMANAGER_H_
 #define INCLUDE_VULKANENGINE_VULKANMANAGER_H_
 
+#include <VulkanEngine/AssetRegistry.h>
 #include <VulkanEngine/Camera.h>
+#include <VulkanEngine/DeletionQueue.h>
 #include <VulkanEngine/Device.h>
+#include <VulkanEngine/FrameStatistics.h>
 #include <VulkanEngine/IndexAttribute.h>
+#include <VulkanEngine/MemoryDefragmenter.h>
+#include <VulkanEngine/MemoryPools.h>
 #include <VulkanEngine/MeshBase.h>
+#include <VulkanEngine/MipmapGenerator.h>
+#include <VulkanEngine/Profiler.h>
 #include <VulkanEngine/Shader.h>
+#include <VulkanEngine/TextureStreamer.h>
+#include <VulkanEngine/TransferQueue.h>
 #include <VulkanEngine/UniformBuffer.h>
 #include <VulkanEngine/VertexAttribute.h>
 #include <VulkanEngine/Window.h>
@@ -82,8 +91,18 @@ class VulkanManager {
 
   vk::CommandBuffer getCurrentCommandBuffer();
 
+  /// \return The command pool of the current frame in flight. Command buffers
+  /// retrieved from it stay valid until the frame is begun again.
+  std::shared_ptr<CommandPool> getCurrentCommandPool();
+
   void waitForFence();
 
+  /// Start recording a new frame. Waits until the GPU has finished with the
+  /// previous submission of the current frame in flight, reads back its
+  /// profiled GPU scopes, resets its command pool and runs the destructions
+  /// of the DeletionQueue which have become safe.
+  void beginFrame();
+
   vk::Framebuffer getCurrentSwapchainFramebuffer();
 
   /// Executes all command buffers and swaps buffers.
@@ -101,6 +120,46 @@ class VulkanManager {
 
   const size_t getFramesInFlight() const { return frames_in_flight; }
 
+  /// \return The registry sharing loaded meshes and textures. Assets are
+  /// never shared between VulkanManager instances.
+  AssetRegistry& getAssetRegistry() { return asset_registry; }
+
+  /// \return The queue of uploads recorded at the start of each frame.
+  TransferQueue& getTransferQueue() { return transfer_queue; }
+
+  /// \return The streamer deciding which mip levels of streamed textures are
+  /// resident.
+  TextureStreamer& getTextureStreamer() { return texture_streamer; }
+
+  /// \return The generator used by images with MipmapMode::eCompute.
+  MipmapGenerator& getMipmapGenerator() { return mipmap_generator; }
+
+  /// \return The queue destroying Vulkan objects once the frames which may
+  /// use them have completed.
+  DeletionQueue& getDeletionQueue() { return deletion_queue; }
+
+  /// \return The defragmenter compacting device memory during idle frames.
+  MemoryDefragmenter& getMemoryDefragmenter() { return memory_defragmenter; }
+
+  /// \return The profiler measuring the CPU and GPU time of each frame.
+  Profiler& getProfiler() { return profiler; }
+
+  /// \return The draw calls, binds, triangles and uploads counted for each
+  /// frame. Only counted if built with ENABLE_FRAME_STATISTICS.
+  FrameStatistics& getFrameStatistics() { return frame_statistics; }
+
+  /// Configure the memory pools of the Device. Only takes effect if called
+  /// before initialize().
+  /// \param settings The settings of the pools.
+  void setMemoryPoolSettings(const MemoryPoolSettings& settings) {
+    memory_pool_settings = settings;
+  }
+
+  /// \return The settings the memory pools of the Device are created with.
+  const MemoryPoolSettings& getMemoryPoolSettings() const {
+    return memory_pool_settings;
+  }
+
  private:
   void cleanup();
 
@@ -117,6 +176,33 @@ class VulkanManager {
   size_t frames_in_flight;
   size_t current_frame;
 
+  /// Shares loaded assets, see getAssetRegistry().
+  AssetRegistry asset_registry;
+
+  /// Uploads waiting to be recorded, see getTransferQueue().
+  TransferQueue transfer_queue;
+
+  /// Streams texture levels, see getTextureStreamer().
+  TextureStreamer texture_streamer;
+
+  /// Generates mip levels with compute, see getMipmapGenerator().
+  MipmapGenerator mipmap_generator;
+
+  /// Destroys Vulkan objects, see getDeletionQueue().
+  DeletionQueue deletion_queue;
+
+  /// Moves allocations, see getMemoryDefragmenter().
+  MemoryDefragmenter memory_defragmenter;
+
+  /// Measures frames, see getProfiler().
+  Profiler profiler;
+
+  /// Counts the work of frames, see getFrameStatistics().
+  FrameStatistics frame_statistics;
+
+  /// See setMemoryPoolSettings().
+  MemoryPoolSettings memory_pool_settings;
+
   bool initialized;
 };
 
@@ -0,0 +1,214 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/AssetRegistry.h>
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+
+VulkanEngine::AssetRegistry::AssetRegistry()
+    : num_running_background_tasks(0),
+      stopping(false),
+      num_background_threads(0) {}
+
+VulkanEngine::AssetRegistry::~AssetRegistry() {
+  waitForBackgroundLoads();
+  stopWorkers();
+}
+
+size_t VulkanEngine::AssetRegistry::AssetIdHash::operator()(
+    const AssetId& asset_id) const {
+  return asset_id.first.hash_code() ^
+         (std::hash<std::string>()(asset_id.second) << 1);
+}
+
+std::shared_ptr<void> VulkanEngine::AssetRegistry::loadAsset(
+    const std::type_index& type, const std::string& key,
+    const std::function<std::shared_ptr<void>()>& loader) {
+  const AssetId asset_id(type, key);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  auto& entry = entries[asset_id];
+  if (auto asset = entry.asset.lock()) {
+    return asset;
+  }
+  if (entry.pending_load.valid()) {
+    // Copy the future, the entry may be erased once the lock is released.
+    auto pending_load = entry.pending_load;
+    lock.unlock();
+    return pending_load.get();
+  }
+
+  std::promise<std::shared_ptr<void>> promise;
+  entry.pending_load = promise.get_future().share();
+  lock.unlock();
+
+  std::shared_ptr<void> asset;
+  try {
+    asset = loader();
+  } catch (...) {
+    lock.lock();
+    entries.erase(asset_id);
+    lock.unlock();
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+
+  // References to entries stay valid when other entries are inserted, but
+  // prune() may have run while the lock was released.
+  lock.lock();
+  if (asset.get()) {
+    auto& loaded_entry = entries[asset_id];
+    loaded_entry.asset = asset;
+    loaded_entry.pending_load = std::shared_future<std::shared_ptr<void>>();
+  } else {
+    entries.erase(asset_id);
+  }
+  lock.unlock();
+
+  promise.set_value(asset);
+  return asset;
+}
+
+std::shared_ptr<void> VulkanEngine::AssetRegistry::findAsset(
+    const std::type_index& type, const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex);
+  const auto entry = entries.find(AssetId(type, key));
+  if (entry == entries.end()) {
+    return std::shared_ptr<void>();
+  }
+  return entry->second.asset.lock();
+}
+
+void VulkanEngine::AssetRegistry::prune() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto entry = entries.begin(); entry != entries.end();) {
+    // Entries which are being loaded have no asset yet.
+    if (entry->second.asset.expired() && !entry->second.pending_load.valid()) {
+      entry = entries.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+}
+
+size_t VulkanEngine::AssetRegistry::getNumAssets() {
+  prune();
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t num_assets = 0;
+  for (const auto& entry : entries) {
+    if (!entry.second.asset.expired()) {
+      ++num_assets;
+    }
+  }
+  return num_assets;
+}
+
+void VulkanEngine::AssetRegistry::waitForBackgroundLoads() {
+  std::unique_lock<std::mutex> lock(background_mutex);
+  background_tasks_done.wait(lock, [this]() {
+    return background_tasks.empty() && num_running_background_tasks == 0;
+  });
+}
+
+void VulkanEngine::AssetRegistry::setNumBackgroundThreads(
+    size_t num_threads) {
+  waitForBackgroundLoads();
+  stopWorkers();
+  std::lock_guard<std::mutex> lock(background_mutex);
+  num_background_threads = num_threads;
+}
+
+size_t VulkanEngine::AssetRegistry::getNumBackgroundThreads() const {
+  std::lock_guard<std::mutex> lock(background_mutex);
+  if (num_background_threads == 0) {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  return num_background_threads;
+}
+
+void VulkanEngine::AssetRegistry::startBackgroundLoad(
+    const std::function<void()>& task) {
+  const size_t num_workers = getNumBackgroundThreads();
+  {
+    std::lock_guard<std::mutex> lock(background_mutex);
+    background_tasks.push_back(task);
+    if (workers.empty()) {
+      for (size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back(&AssetRegistry::workerLoop, this);
+      }
+    }
+  }
+  background_task_available.notify_one();
+}
+
+void VulkanEngine::AssetRegistry::workerLoop() {
+  std::unique_lock<std::mutex> lock(background_mutex);
+  while (true) {
+    background_task_available.wait(
+        lock, [this]() { return stopping || !background_tasks.empty(); });
+    if (background_tasks.empty()) {
+      return;
+    }
+
+    auto task = std::move(background_tasks.front());
+    background_tasks.pop_front();
+    ++num_running_background_tasks;
+    lock.unlock();
+
+    task();
+
+    lock.lock();
+    --num_running_background_tasks;
+    if (background_tasks.empty() && num_running_background_tasks == 0) {
+      background_tasks_done.notify_all();
+    }
+  }
+}
+
+void VulkanEngine::AssetRegistry::stopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(background_mutex);
+    stopping = true;
+  }
+  background_task_available.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+  stopping = false;
+}
+
+std::string VulkanEngine::AssetRegistry::getKey(
+    const std::filesystem::path& path) {
+  std::error_code error;
+  const auto canonical_path = std::filesystem::weakly_canonical(path, error);
+  if (error) {
+    return std::filesystem::absolute(path).lexically_normal().string();
+  }
+  return canonical_path.string();
+}
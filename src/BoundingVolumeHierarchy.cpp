@@ -0,0 +1,418 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/BoundingVolumeHierarchy.h>
+
+#include <algorithm>
+#include <array>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// The number of bins the centroids are sorted into when choosing a split.
+constexpr size_t kNumBins = 16;
+
+/// Nodes with more primitives than this are always split.
+constexpr uint32_t kMaxLeafSize = 4;
+
+/// Subtrees with fewer primitives than this are built on the current thread.
+constexpr uint32_t kParallelBuildThreshold = 4096;
+
+/// The cost of visiting a node relative to testing a primitive.
+constexpr float kTraversalCost = 1.0f;
+
+/// Flags an entry of the query stack whose node is inside of the frustum.
+constexpr uint32_t kInsideFlag = 1u << 31;
+
+using Box = BoundingBox<Eigen::Vector3f>;
+
+Box emptyBox() {
+  Box box;
+  box.min.setConstant(std::numeric_limits<float>::max());
+  box.max.setConstant(std::numeric_limits<float>::lowest());
+  return box;
+}
+
+void growBox(Box& box, const Box& other) {
+  box.min = box.min.cwiseMin(other.min);
+  box.max = box.max.cwiseMax(other.max);
+}
+
+float surfaceArea(const Box& box) {
+  const Eigen::Vector3f size = (box.max - box.min).cwiseMax(0.0f);
+  return size.x() * size.y() + size.y() * size.z() + size.z() * size.x();
+}
+
+}  // namespace
+
+VulkanEngine::BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+    : num_nodes(0) {}
+
+VulkanEngine::BoundingVolumeHierarchy::~BoundingVolumeHierarchy() {}
+
+void VulkanEngine::BoundingVolumeHierarchy::build(
+    const BoundingBoxArray& bounding_boxes, size_t num_threads) {
+  clear();
+  const size_t count = bounding_boxes.size();
+  if (count == 0) {
+    return;
+  }
+  if (count >= kInsideFlag / 2) {
+    throw std::runtime_error(
+        "Too many primitives for bounding volume hierarchy");
+  }
+
+  primitive_bounding_boxes.resize(count);
+  primitive_centroids.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    primitive_bounding_boxes[i] = bounding_boxes.get(i);
+    primitive_centroids[i] =
+        (primitive_bounding_boxes[i].min + primitive_bounding_boxes[i].max) *
+        0.5f;
+  }
+  primitive_indices.resize(count);
+  std::iota(primitive_indices.begin(), primitive_indices.end(), 0u);
+  primitive_leaves.resize(count);
+
+  // A binary tree without empty leaves has at most 2 * count - 1 nodes.
+  nodes.resize(2 * count - 1);
+  parents.resize(2 * count - 1);
+  parents[0] = 0;
+  num_nodes = 1;
+
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  size_t parallel_depth = 0;
+  while ((size_t(1) << parallel_depth) < num_threads) {
+    ++parallel_depth;
+  }
+
+  buildNode(0, 0, static_cast<uint32_t>(count), parallel_depth);
+
+  nodes.resize(num_nodes);
+  parents.resize(num_nodes);
+  primitive_centroids.clear();
+}
+
+void VulkanEngine::BoundingVolumeHierarchy::clear() {
+  nodes.clear();
+  parents.clear();
+  primitive_indices.clear();
+  primitive_leaves.clear();
+  primitive_bounding_boxes.clear();
+  primitive_centroids.clear();
+  num_nodes = 0;
+}
+
+size_t VulkanEngine::BoundingVolumeHierarchy::size() const {
+  return primitive_bounding_boxes.size();
+}
+
+size_t VulkanEngine::BoundingVolumeHierarchy::getNumNodes() const {
+  return nodes.size();
+}
+
+const BoundingBox<Eigen::Vector3f>&
+VulkanEngine::BoundingVolumeHierarchy::getRootBoundingBox() const {
+  return nodes[0].bounding_box;
+}
+
+void VulkanEngine::BoundingVolumeHierarchy::setBoundingBox(
+    size_t primitive, const BoundingBox<Eigen::Vector3f>& bounding_box) {
+  primitive_bounding_boxes[primitive] = bounding_box;
+
+  // Walk up until a node's box doesn't change, the boxes above it then
+  // can't change either.
+  uint32_t node_index = primitive_leaves[primitive];
+  while (refitNode(node_index) && node_index != 0) {
+    node_index = parents[node_index];
+  }
+}
+
+void VulkanEngine::BoundingVolumeHierarchy::refit(
+    const BoundingBoxArray& bounding_boxes) {
+  if (bounding_boxes.size() != size()) {
+    throw std::runtime_error(
+        "Refitting bounding volume hierarchy with a different number of "
+        "primitives");
+  }
+
+  for (size_t i = 0; i < bounding_boxes.size(); ++i) {
+    primitive_bounding_boxes[i] = bounding_boxes.get(i);
+  }
+
+  // Children always come after their parent, so refitting in reverse order
+  // visits children first.
+  for (size_t i = nodes.size(); i-- > 0;) {
+    refitNode(static_cast<uint32_t>(i));
+  }
+}
+
+void VulkanEngine::BoundingVolumeHierarchy::intersectFrustum(
+    const Frustum& frustum, std::vector<uint32_t>& primitives) const {
+  primitives.clear();
+  if (nodes.empty()) {
+    return;
+  }
+
+  node_stack.clear();
+  node_stack.push_back(0);
+  while (!node_stack.empty()) {
+    const uint32_t entry = node_stack.back();
+    node_stack.pop_back();
+    const uint32_t node_index = entry & ~kInsideFlag;
+    bool inside = (entry & kInsideFlag) != 0;
+    const Node& node = nodes[node_index];
+
+    if (!inside) {
+      if (!frustum.intersects(node.bounding_box)) {
+        continue;
+      }
+      // Nothing below a node which is entirely inside needs to be tested.
+      inside = frustum.contains(node.bounding_box);
+    }
+
+    if (node.count == 0) {
+      const uint32_t flag = inside ? kInsideFlag : 0;
+      node_stack.push_back(node.first | flag);
+      node_stack.push_back((node.first + 1) | flag);
+      continue;
+    }
+
+    for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+      const uint32_t primitive = primitive_indices[i];
+      if (inside ||
+          frustum.intersects(primitive_bounding_boxes[primitive])) {
+        primitives.push_back(primitive);
+      }
+    }
+  }
+}
+
+void VulkanEngine::BoundingVolumeHierarchy::intersectRay(
+    const Eigen::Vector3f& origin, const Eigen::Vector3f& direction,
+    float max_distance, std::vector<RayHit>& hits) const {
+  hits.clear();
+  if (nodes.empty()) {
+    return;
+  }
+
+  const Eigen::Vector3f inverse_direction = direction.cwiseInverse();
+  float distance;
+
+  node_stack.clear();
+  node_stack.push_back(0);
+  while (!node_stack.empty()) {
+    const Node& node = nodes[node_stack.back()];
+    node_stack.pop_back();
+    if (!intersectRay(node.bounding_box, origin, inverse_direction,
+                      max_distance, distance)) {
+      continue;
+    }
+
+    if (node.count == 0) {
+      node_stack.push_back(node.first);
+      node_stack.push_back(node.first + 1);
+      continue;
+    }
+
+    for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+      const uint32_t primitive = primitive_indices[i];
+      if (intersectRay(primitive_bounding_boxes[primitive], origin,
+                       inverse_direction, max_distance, distance)) {
+        hits.push_back({distance, primitive});
+      }
+    }
+  }
+
+  std::sort(hits.begin(), hits.end(),
+            [](const RayHit& a, const RayHit& b) {
+              return a.distance < b.distance;
+            });
+}
+
+bool VulkanEngine::BoundingVolumeHierarchy::intersectRay(
+    const BoundingBox<Eigen::Vector3f>& bounding_box,
+    const Eigen::Vector3f& origin, const Eigen::Vector3f& inverse_direction,
+    float max_distance, float& distance) {
+  const Eigen::Vector3f t0 =
+      (bounding_box.min - origin).cwiseProduct(inverse_direction);
+  const Eigen::Vector3f t1 =
+      (bounding_box.max - origin).cwiseProduct(inverse_direction);
+  const float near = std::max(t0.cwiseMin(t1).maxCoeff(), 0.0f);
+  const float far = std::min(t0.cwiseMax(t1).minCoeff(), max_distance);
+  if (!(near <= far)) {
+    return false;
+  }
+  distance = near;
+  return true;
+}
+
+void VulkanEngine::BoundingVolumeHierarchy::buildNode(uint32_t node_index,
+                                                      uint32_t begin,
+                                                      uint32_t end,
+                                                      size_t parallel_depth) {
+  Node& node = nodes[node_index];
+  const uint32_t count = end - begin;
+
+  Box centroid_bounds = emptyBox();
+  node.bounding_box = emptyBox();
+  for (uint32_t i = begin; i < end; ++i) {
+    const uint32_t primitive = primitive_indices[i];
+    growBox(node.bounding_box, primitive_bounding_boxes[primitive]);
+    centroid_bounds.min =
+        centroid_bounds.min.cwiseMin(primitive_centroids[primitive]);
+    centroid_bounds.max =
+        centroid_bounds.max.cwiseMax(primitive_centroids[primitive]);
+  }
+
+  const auto make_leaf = [&]() {
+    node.first = begin;
+    node.count = count;
+    for (uint32_t i = begin; i < end; ++i) {
+      primitive_leaves[primitive_indices[i]] = node_index;
+    }
+  };
+
+  if (count == 1) {
+    make_leaf();
+    return;
+  }
+
+  Eigen::Vector3f::Index axis;
+  const float extent =
+      (centroid_bounds.max - centroid_bounds.min).maxCoeff(&axis);
+  uint32_t middle = begin + count / 2;
+
+  if (extent > 0.0f) {
+    // Sort the centroids into bins along the longest axis and pick the split
+    // between bins with the lowest surface area heuristic cost.
+    const float origin = centroid_bounds.min[axis];
+    const float scale = static_cast<float>(kNumBins) / extent;
+    const auto bin_index = [&](uint32_t primitive) {
+      const float offset = (primitive_centroids[primitive][axis] - origin);
+      return std::min(kNumBins - 1, static_cast<size_t>(offset * scale));
+    };
+
+    std::array<Box, kNumBins> bin_boxes;
+    std::array<uint32_t, kNumBins> bin_counts{};
+    bin_boxes.fill(emptyBox());
+    for (uint32_t i = begin; i < end; ++i) {
+      const uint32_t primitive = primitive_indices[i];
+      const size_t bin = bin_index(primitive);
+      growBox(bin_boxes[bin], primitive_bounding_boxes[primitive]);
+      ++bin_counts[bin];
+    }
+
+    // Cost of the right side of each split, split i lies after bin i.
+    std::array<float, kNumBins - 1> right_costs;
+    Box accumulated = emptyBox();
+    uint32_t accumulated_count = 0;
+    for (size_t i = kNumBins - 1; i > 0; --i) {
+      growBox(accumulated, bin_boxes[i]);
+      accumulated_count += bin_counts[i];
+      right_costs[i - 1] =
+          accumulated_count * (accumulated_count ? surfaceArea(accumulated)
+                                                 : 0.0f);
+    }
+
+    float best_cost = std::numeric_limits<float>::max();
+    size_t best_split = kNumBins;
+    accumulated = emptyBox();
+    accumulated_count = 0;
+    for (size_t i = 0; i < kNumBins - 1; ++i) {
+      growBox(accumulated, bin_boxes[i]);
+      accumulated_count += bin_counts[i];
+      if (accumulated_count == 0 || accumulated_count == count) {
+        continue;
+      }
+      const float cost =
+          accumulated_count * surfaceArea(accumulated) + right_costs[i];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_split = i;
+      }
+    }
+
+    const float node_area = surfaceArea(node.bounding_box);
+    const float leaf_cost = count * node_area;
+    const float split_cost = kTraversalCost * node_area + best_cost;
+    if (count <= kMaxLeafSize && leaf_cost <= split_cost) {
+      make_leaf();
+      return;
+    }
+
+    if (best_split < kNumBins) {
+      const auto split = std::partition(
+          primitive_indices.begin() + begin, primitive_indices.begin() + end,
+          [&](uint32_t primitive) {
+            return bin_index(primitive) <= best_split;
+          });
+      middle = static_cast<uint32_t>(split - primitive_indices.begin());
+    }
+  } else if (count <= kMaxLeafSize) {
+    make_leaf();
+    return;
+  }
+
+  const uint32_t left = num_nodes.fetch_add(2);
+  node.first = left;
+  node.count = 0;
+  parents[left] = node_index;
+  parents[left + 1] = node_index;
+
+  if (parallel_depth > 0 && count >= kParallelBuildThreshold) {
+    auto right = std::async(std::launch::async, [=]() {
+      buildNode(left + 1, middle, end, parallel_depth - 1);
+    });
+    buildNode(left, begin, middle, parallel_depth - 1);
+    right.get();
+  } else {
+    buildNode(left, begin, middle, 0);
+    buildNode(left + 1, middle, end, 0);
+  }
+}
+
+bool VulkanEngine::BoundingVolumeHierarchy::refitNode(uint32_t node_index) {
+  Node& node = nodes[node_index];
+  Box bounding_box;
+  if (node.count > 0) {
+    bounding_box = emptyBox();
+    for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+      growBox(bounding_box, primitive_bounding_boxes[primitive_indices[i]]);
+    }
+  } else {
+    bounding_box = nodes[node.first].bounding_box;
+    growBox(bounding_box, nodes[node.first + 1].bounding_box);
+  }
+
+  if (bounding_box.min == node.bounding_box.min &&
+      bounding_box.max == node.bounding_box.max) {
+    return false;
+  }
+  node.bounding_box = bounding_box;
+  return true;
+}
@@ -24,14 +24,22 @@
 VulkanEngine::Buffer::Buffer(size_t _data_size,
                              vk::BufferUsageFlags usage_flags,
                              vk::MemoryPropertyFlags memory_property_flags,
-                             VmaMemoryUsage vma_memory_usage)
-    : data_size(_data_size) {
-  createBuffer(usage_flags, memory_property_flags, vma_memory_usage);
+                             VmaMemoryUsage vma_memory_usage, bool transient)
+    : movable(false), data_size(_data_size) {
+  createBuffer(usage_flags, memory_property_flags, vma_memory_usage,
+               transient);
 }
 
 VulkanEngine::Buffer::~Buffer() {
-  vmaDestroyBuffer(VulkanManager::getInstance().getDevice()->getVmaAllocator(),
-                   static_cast<VkBuffer>(vk_buffer), vma_allocation);
+  auto& vulkan_manager = VulkanManager::getInstance();
+  vulkan_manager.getMemoryDefragmenter().unregisterResource(vma_allocation);
+  vulkan_manager.getDeletionQueue().enqueue(
+      [vk_buffer = vk_buffer, vma_allocation = vma_allocation]() {
+        auto device = VulkanManager::getInstance().getDevice();
+        device->getMemoryTelemetry().recordFree(vma_allocation);
+        vmaDestroyBuffer(device->getVmaAllocator(),
+                         static_cast<VkBuffer>(vk_buffer), vma_allocation);
+      });
 }
 
 const vk::Buffer VulkanEngine::Buffer::getVkBuffer() const { return vk_buffer; }
@@ -39,13 +47,27 @@ const vk::Buffer VulkanEngine::Buffer::getVkBuffer() const { return vk_buffer; }
 void VulkanEngine::Buffer::createBuffer(
     vk::BufferUsageFlags usage_flags,
     vk::MemoryPropertyFlags memory_property_flags,
-    VmaMemoryUsage vma_memory_usage) {
+    VmaMemoryUsage vma_memory_usage, bool transient) {
   auto& vulkan_manager = VulkanManager::getInstance();
 
-  auto buffer_info = vk::BufferCreateInfo()
-                         .setSize(data_size)
-                         .setUsage(usage_flags)
-                         .setSharingMode(vk::SharingMode::eExclusive);
+  // Other buffers may be referenced by descriptor sets, or written by the
+  // host, so only these are moved.
+  movable = vma_memory_usage == VMA_MEMORY_USAGE_GPU_ONLY &&
+            (usage_flags & (vk::BufferUsageFlagBits::eVertexBuffer |
+                            vk::BufferUsageFlagBits::eIndexBuffer)) &&
+            !(usage_flags & (vk::BufferUsageFlagBits::eUniformBuffer |
+                             vk::BufferUsageFlagBits::eStorageBuffer));
+  if (movable) {
+    usage_flags |= vk::BufferUsageFlagBits::eTransferSrc;
+  }
+
+  uniform_buffer =
+      static_cast<bool>(usage_flags & vk::BufferUsageFlagBits::eUniformBuffer);
+
+  buffer_create_info = vk::BufferCreateInfo()
+                           .setSize(data_size)
+                           .setUsage(usage_flags)
+                           .setSharingMode(vk::SharingMode::eExclusive);
 
   VmaAllocationCreateInfo vma_allocation_create_info = {};
   vma_allocation_create_info.usage = vma_memory_usage;
@@ -54,18 +76,20 @@ void VulkanEngine::Buffer::createBuffer(
 
   vk::Buffer buffer;
   VkBufferCreateInfo buffer_create_info_c_handle =
-      static_cast<VkBufferCreateInfo>(buffer_info);
+      static_cast<VkBufferCreateInfo>(buffer_create_info);
 
-  auto result = vmaCreateBuffer(
-      vulkan_manager.getDevice()->getVmaAllocator(),
-      &buffer_create_info_c_handle, &vma_allocation_create_info,
-      reinterpret_cast<VkBuffer*>(&buffer), &vma_allocation, nullptr);
+  auto result = vulkan_manager.getDevice()->getMemoryPools().createBuffer(
+      buffer_create_info_c_handle, vma_allocation_create_info,
+      reinterpret_cast<VkBuffer*>(&buffer), &vma_allocation, transient);
 
   if (result != VK_SUCCESS) {
     throw std::runtime_error("Could not create buffer!");
   }
 
   vk_buffer = buffer;
+  vulkan_manager.getDevice()->getMemoryTelemetry().recordAllocation(
+      vma_allocation,
+      MemoryTelemetry::getBufferCategory(usage_flags, vma_memory_usage));
 }
 
 void VulkanEngine::Buffer::insertTransferCommand(
@@ -74,6 +98,36 @@ void VulkanEngine::Buffer::insertTransferCommand(
       vk::BufferCopy().setSrcOffset(0).setDstOffset(0).setSize(data_size);
 
   command_buffer.copyBuffer(source_buffer, vk_buffer, buffer_copy);
+
+  if (movable) {
+    VulkanManager::getInstance().getMemoryDefragmenter().registerResource(
+        vma_allocation, this);
+  }
+}
+
+bool VulkanEngine::Buffer::beginMove(const vk::CommandBuffer& command_buffer,
+                                     VmaAllocation destination) {
+  auto device = VulkanManager::getInstance().getDevice();
+  moved_vk_buffer = device->getVkDevice().createBuffer(buffer_create_info);
+  if (vmaBindBufferMemory(device->getVmaAllocator(), destination,
+                          static_cast<VkBuffer>(moved_vk_buffer)) !=
+      VK_SUCCESS) {
+    device->getVkDevice().destroyBuffer(moved_vk_buffer);
+    moved_vk_buffer = nullptr;
+    return false;
+  }
+
+  auto buffer_copy =
+      vk::BufferCopy().setSrcOffset(0).setDstOffset(0).setSize(data_size);
+  command_buffer.copyBuffer(vk_buffer, moved_vk_buffer, buffer_copy);
+  return true;
+}
+
+void VulkanEngine::Buffer::endMove() {
+  VulkanManager::getInstance().getDevice()->getVkDevice().destroyBuffer(
+      vk_buffer);
+  vk_buffer = moved_vk_buffer;
+  moved_vk_buffer = nullptr;
 }
 
 size_t VulkanEngine::Buffer::getStagingBufferSize() const { return data_size; }
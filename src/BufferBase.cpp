@@ -19,17 +19,46 @@
 // SOFTWARE.
 
 #include <VulkanEngine/BufferBase.h>
+#include <VulkanEngine/FrameStatistics.h>
 #include <VulkanEngine/VulkanManager.h>
 
 void VulkanEngine::BufferBase::updateBuffer(const void* _data,
                                             size_t _data_size) {
+  void* mapped_memory = mapMemory();
+  std::memcpy(mapped_memory, _data, _data_size);
+  unmapMemory();
+  if (uniform_buffer) {
+    VULKANENGINE_COUNT_STATISTIC(eUniformUpdates, 1);
+  }
+}
+
+void* VulkanEngine::BufferBase::mapMemory() {
   void* mapped_memory = nullptr;
-  const VmaAllocator& vma_allocator =
-      VulkanManager::getInstance().getDevice()->getVmaAllocator();
-  auto result = vmaMapMemory(vma_allocator, vma_allocation, &mapped_memory);
+  auto result = vmaMapMemory(
+      VulkanManager::getInstance().getDevice()->getVmaAllocator(),
+      vma_allocation, &mapped_memory);
   if (result != VK_SUCCESS) {
     throw std::runtime_error("Could not map memory for buffer!");
   }
-  std::memcpy(mapped_memory, _data, _data_size);
-  vmaUnmapMemory(vma_allocator, vma_allocation);
+  return mapped_memory;
+}
+
+void VulkanEngine::BufferBase::unmapMemory() {
+  vmaUnmapMemory(VulkanManager::getInstance().getDevice()->getVmaAllocator(),
+                 vma_allocation);
+}
+
+size_t VulkanEngine::BufferBase::getAllocationSize() const {
+  VmaAllocationInfo allocation_info;
+  vmaGetAllocationInfo(
+      VulkanManager::getInstance().getDevice()->getVmaAllocator(),
+      vma_allocation, &allocation_info);
+  return static_cast<size_t>(allocation_info.size);
 }
+
+bool VulkanEngine::BufferBase::beginMove(
+    const vk::CommandBuffer& command_buffer, VmaAllocation destination) {
+  return false;
+}
+
+void VulkanEngine::BufferBase::endMove() {}
@@ -35,22 +35,29 @@ VulkanEngine::Camera::Camera(Eigen::Vector3f _look_at,
       z_far(_z_far),
       fov(_fov),
       width(_width),
-      height(_height) {}
+      height(_height) {
+  disableLegacyUpdate();
+}
 
 VulkanEngine::Camera::~Camera() {}
 
-void VulkanEngine::Camera::update(std::shared_ptr<SceneState> scene_state) {
-  auto active_window = scene_state->getScene().getActiveWindow();
+bool VulkanEngine::Camera::isCullable() const { return false; }
+
+void VulkanEngine::Camera::update(SceneState& scene_state) {
+  updateView(scene_state);
+  SceneObject::update(scene_state);
+}
+
+void VulkanEngine::Camera::updateView(SceneState& scene_state) {
+  auto active_window = scene_state.getScene().getActiveWindow();
   if (active_window.get() != nullptr) {
     setWidth(active_window->getFramebufferWidth());
     setHeight(active_window->getFramebufferHeight());
 
-    scene_state->setViewMatrix(scene_state->getTotalTransform() *
-                               getTransform().inverse() * getViewMatrix());
-    scene_state->setProjectionMatrix(getPerspectiveProjectionMatrix());
+    scene_state.setViewMatrix(scene_state.getTotalTransform() *
+                              getTransform().inverse() * getViewMatrix());
+    scene_state.setProjectionMatrix(getPerspectiveProjectionMatrix());
   }
-
-  SceneObject::update(scene_state);
 }
 
 void VulkanEngine::Camera::setLookAt(const Eigen::Vector3f& _look_at) {
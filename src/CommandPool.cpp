@@ -0,0 +1,88 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/CommandPool.h>
+
+#include <stdexcept>
+#include <vector>
+
+VulkanEngine::CommandPool::CommandPool(const vk::Device& _vk_device,
+                                       uint32_t queue_family_index,
+                                       vk::CommandPoolCreateFlags flags)
+    : vk_device(_vk_device),
+      primary_command_buffers_in_use(0),
+      secondary_command_buffers_in_use(0) {
+  vk::CommandPoolCreateInfo command_pool_info(flags, queue_family_index);
+  vk_command_pool = vk_device.createCommandPool(command_pool_info);
+  if (!vk_command_pool) {
+    throw std::runtime_error("Could not create command pool!");
+  }
+}
+
+VulkanEngine::CommandPool::~CommandPool() {
+  // Destroying the pool frees all command buffers allocated from it.
+  vk_device.destroyCommandPool(vk_command_pool);
+  vk_command_pool = nullptr;
+}
+
+vk::CommandBuffer VulkanEngine::CommandPool::getCommandBuffer(
+    vk::CommandBufferLevel level) {
+  const bool primary = level == vk::CommandBufferLevel::ePrimary;
+  auto& command_buffers =
+      primary ? primary_command_buffers : secondary_command_buffers;
+  auto& in_use = primary ? primary_command_buffers_in_use
+                         : secondary_command_buffers_in_use;
+
+  if (in_use == command_buffers.size()) {
+    command_buffers.push_back(allocateCommandBuffer(level));
+  }
+
+  return command_buffers[in_use++];
+}
+
+void VulkanEngine::CommandPool::reset() {
+  vk_device.resetCommandPool(vk_command_pool, vk::CommandPoolResetFlags());
+  primary_command_buffers_in_use = 0;
+  secondary_command_buffers_in_use = 0;
+}
+
+vk::CommandBuffer VulkanEngine::CommandPool::allocateCommandBuffer(
+    vk::CommandBufferLevel level) {
+  auto command_buffer_info = vk::CommandBufferAllocateInfo()
+                                 .setCommandBufferCount(1)
+                                 .setCommandPool(vk_command_pool)
+                                 .setLevel(level);
+
+  auto command_buffers = vk_device.allocateCommandBuffers(command_buffer_info);
+  if (command_buffers.empty()) {
+    throw std::runtime_error("Could not allocate command buffer!");
+  }
+
+  return command_buffers[0];
+}
+
+void VulkanEngine::CommandPool::freeCommandBuffer(
+    const vk::CommandBuffer& command_buffer) {
+  vk_device.freeCommandBuffers(vk_command_pool, command_buffer);
+}
+
+const vk::CommandPool& VulkanEngine::CommandPool::getVkCommandPool() const {
+  return vk_command_pool;
+}
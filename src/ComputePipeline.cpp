@@ -0,0 +1,91 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/ComputePipeline.h>
+#include <VulkanEngine/Shader.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <memory>
+
+VulkanEngine::ComputePipeline::ComputePipeline() {}
+
+VulkanEngine::ComputePipeline::~ComputePipeline() {
+  if (vk_compute_pipeline) {
+    VulkanManager::getInstance().getDeletionQueue().enqueue(
+        [vk_compute_pipeline = vk_compute_pipeline]() {
+          VulkanManager::getInstance()
+              .getDevice()
+              ->getVkDevice()
+              .destroyPipeline(vk_compute_pipeline);
+        });
+  }
+}
+
+void VulkanEngine::ComputePipeline::createComputePipeline(
+    const std::shared_ptr<Shader> _shader) {
+  const auto& shader_stages = _shader->getVkShaderStages();
+  if (shader_stages.size() != 1 ||
+      shader_stages[0].stage != vk::ShaderStageFlagBits::eCompute) {
+    throw std::runtime_error(
+        "A compute pipeline requires a shader with a single compute stage!");
+  }
+
+  const auto& vk_device =
+      VulkanManager::getInstance().getDevice()->getVkDevice();
+
+  auto pipeline_info = vk::ComputePipelineCreateInfo()
+                           .setStage(shader_stages[0])
+                           .setLayout(_shader->createVkPipelineLayout());
+
+  auto result = vk_device.createComputePipeline(nullptr, pipeline_info);
+  if (result.result != vk::Result::eSuccess) {
+    throw std::runtime_error("Could not create compute pipeline!");
+  }
+
+  // The previous pipeline may still be used by frames in flight.
+  if (vk_compute_pipeline) {
+    VulkanManager::getInstance().getDeletionQueue().enqueue(
+        [vk_compute_pipeline = vk_compute_pipeline]() {
+          VulkanManager::getInstance()
+              .getDevice()
+              ->getVkDevice()
+              .destroyPipeline(vk_compute_pipeline);
+        });
+  }
+  vk_compute_pipeline = result.value;
+  shader = _shader;
+}
+
+void VulkanEngine::ComputePipeline::bindPipeline(
+    const vk::CommandBuffer& command_buffer) {
+  command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute,
+                              vk_compute_pipeline);
+}
+
+void VulkanEngine::ComputePipeline::dispatch(
+    const vk::CommandBuffer& command_buffer, uint32_t group_count_x,
+    uint32_t group_count_y, uint32_t group_count_z) {
+  command_buffer.dispatch(group_count_x, group_count_y, group_count_z);
+}
+
+const std::shared_ptr<VulkanEngine::Shader>&
+VulkanEngine::ComputePipeline::getShader() const {
+  return shader;
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/DeletionQueue.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+VulkanEngine::DeletionQueue::DeletionQueue() : frame(0), idle_frame(0) {}
+
+VulkanEngine::DeletionQueue::~DeletionQueue() {}
+
+void VulkanEngine::DeletionQueue::enqueue(std::function<void()> destroy) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (frame != idle_frame) {
+      deletions.push_back({std::move(destroy), frame});
+      return;
+    }
+  }
+
+  // No commands have been recorded which could use the objects.
+  destroy();
+}
+
+void VulkanEngine::DeletionQueue::beginFrame() {
+  uint64_t completed_frame = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++frame;
+    const uint64_t frames_in_flight =
+        VulkanManager::getInstance().getFramesInFlight();
+    if (frame < frames_in_flight) {
+      return;
+    }
+    completed_frame = frame - frames_in_flight;
+  }
+
+  run(completed_frame + 1);
+}
+
+void VulkanEngine::DeletionQueue::flush() {
+  uint64_t current_frame = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle_frame = frame;
+    current_frame = frame;
+  }
+
+  run(current_frame + 1);
+}
+
+size_t VulkanEngine::DeletionQueue::getNumPending() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return deletions.size();
+}
+
+void VulkanEngine::DeletionQueue::run(uint64_t before_frame) {
+  // Destructions run without holding the lock, since they may queue further
+  // destructions.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t num_completed = 0;
+    while (num_completed < deletions.size() &&
+           deletions[num_completed].frame < before_frame) {
+      ++num_completed;
+    }
+    deletions_scratch.clear();
+    std::move(deletions.begin(), deletions.begin() + num_completed,
+              std::back_inserter(deletions_scratch));
+    deletions.erase(deletions.begin(), deletions.begin() + num_completed);
+  }
+
+  for (auto& deletion : deletions_scratch) {
+    deletion.destroy();
+  }
+  deletions_scratch.clear();
+}
@@ -46,3 +46,5 @@ const vk::DescriptorPoolSize VulkanEngine::Descriptor::getVkDescriptorPoolSize()
       .setDescriptorCount(descriptor_count)
       .setType(vk_descriptor_type);
 }
+
+uint64_t VulkanEngine::Descriptor::getVersion() const { return 0; }
@@ -21,11 +21,16 @@
 #include <VulkanEngine/Device.h>
 #include <VulkanEngine/VulkanManager.h>
 
+#include <cstring>
 #include <iostream>
 #include <limits>
 #include <vector>
 
-VulkanEngine::Device::Device() : graphics_queue_family_index(0) {
+VulkanEngine::Device::Device()
+    : graphics_queue_family_index(0),
+      api_version(VK_API_VERSION_1_0),
+      shader_draw_parameters(false),
+      vk_cmd_draw_indexed_indirect_count(nullptr) {
   auto& vulkan_manager = VulkanManager::getInstance();
   auto vk_instance = vulkan_manager.getVkInstance();
 
@@ -60,17 +65,32 @@ VulkanEngine::Device::Device() : graphics_queue_family_index(0) {
     throw std::runtime_error(
         "Could not find a valid physical device for rendering.");
   }
-  auto vk_physical_device = physical_devices[0];
+  vk_physical_device = physical_devices[0];
   vk::PhysicalDeviceProperties device_properties =
       vk_physical_device.getProperties();
   std::cout << "Chosen device: " << device_properties.deviceName << std::endl;
+  api_version = device_properties.apiVersion;
+  name = device_properties.deviceName.data();
 
   std::vector<vk::ExtensionProperties> physical_device_extensions =
       vk_physical_device.enumerateDeviceExtensionProperties();
 
   std::vector<const char*> physical_device_extension_names;
+  bool has_draw_indirect_count = false;
+  bool has_memory_budget = false;
+  bool has_shader_draw_parameters = false;
   for (const auto& ext : physical_device_extensions) {
     physical_device_extension_names.push_back(ext.extensionName);
+    if (std::strcmp(ext.extensionName,
+                    VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0) {
+      has_draw_indirect_count = true;
+    } else if (std::strcmp(ext.extensionName,
+                           VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) {
+      has_memory_budget = true;
+    } else if (std::strcmp(ext.extensionName,
+                           VK_KHR_SHADER_DRAW_PARAMETERS_EXTENSION_NAME) == 0) {
+      has_shader_draw_parameters = true;
+    }
   }
 
 #ifdef __APPLE__
@@ -90,16 +110,61 @@ VulkanEngine::Device::Device() : graphics_queue_family_index(0) {
     ++graphics_queue_family_index;
   }
 
+  // Timestamps can only be written if the graphics queue supports them.
+  timestamp_valid_bits = 0;
+  timestamp_period = 0.0f;
+  if (graphics_queue_family_index <
+      static_cast<int>(queue_family_properties.size())) {
+    timestamp_valid_bits =
+        queue_family_properties[graphics_queue_family_index].timestampValidBits;
+  }
+  if (timestamp_valid_bits > 0) {
+    timestamp_period = device_properties.limits.timestampPeriod;
+  }
+
   float queue_priorities[] = {1.0f};
   auto queue_info = vk::DeviceQueueCreateInfo()
                         .setPQueuePriorities(queue_priorities)
                         .setQueueCount(1)
                         .setQueueFamilyIndex(graphics_queue_family_index);
 
-  auto physical_device_features = vk::PhysicalDeviceFeatures()
-                                      .setSamplerAnisotropy(VK_TRUE)
-                                      .setFragmentStoresAndAtomics(VK_TRUE)
-                                      .setSampleRateShading(VK_TRUE);
+  // Indirect draws with more than one draw and per draw data indexed by
+  // firstInstance are used when the device supports them, as are block
+  // compressed texture formats. Pipeline statistics queries are enabled for
+  // the Profiler.
+  const auto supported_features = vk_physical_device.getFeatures();
+  enabled_features =
+      vk::PhysicalDeviceFeatures()
+          .setSamplerAnisotropy(VK_TRUE)
+          .setFragmentStoresAndAtomics(VK_TRUE)
+          .setSampleRateShading(VK_TRUE)
+          .setMultiDrawIndirect(supported_features.multiDrawIndirect)
+          .setDrawIndirectFirstInstance(
+              supported_features.drawIndirectFirstInstance)
+          .setTextureCompressionBC(supported_features.textureCompressionBC)
+          .setTextureCompressionETC2(supported_features.textureCompressionETC2)
+          .setTextureCompressionASTC_LDR(
+              supported_features.textureCompressionASTC_LDR)
+          .setPipelineStatisticsQuery(
+              supported_features.pipelineStatisticsQuery)
+          .setInheritedQueries(supported_features.inheritedQueries);
+
+  // gl_BaseInstance is used by instanced draws to read per draw data. It is
+  // a feature in Vulkan 1.1, before that enabling the extension is enough.
+  auto shader_draw_parameters_features =
+      vk::PhysicalDeviceShaderDrawParametersFeatures();
+  if (device_properties.apiVersion >= VK_API_VERSION_1_1) {
+    const auto features = vk_physical_device.getFeatures2<
+        vk::PhysicalDeviceFeatures2,
+        vk::PhysicalDeviceShaderDrawParametersFeatures>();
+    shader_draw_parameters_features.setShaderDrawParameters(
+        features.get<vk::PhysicalDeviceShaderDrawParametersFeatures>()
+            .shaderDrawParameters);
+    shader_draw_parameters =
+        shader_draw_parameters_features.shaderDrawParameters == VK_TRUE;
+  } else {
+    shader_draw_parameters = has_shader_draw_parameters;
+  }
 
   std::vector<const char*> layers;
 #ifdef ENABLE_VULKAN_VALIDATION
@@ -111,22 +176,45 @@ VulkanEngine::Device::Device() : graphics_queue_family_index(0) {
           .setPEnabledExtensionNames(layers)
           .setPQueueCreateInfos(&queue_info)
           .setQueueCreateInfoCount(1)
-          .setPEnabledFeatures(&physical_device_features)
+          .setPEnabledFeatures(&enabled_features)
           .setPpEnabledExtensionNames(physical_device_extension_names.data())
           .setEnabledExtensionCount(
               static_cast<uint32_t>(physical_device_extension_names.size()));
+  if (device_properties.apiVersion >= VK_API_VERSION_1_1) {
+    device_info.setPNext(&shader_draw_parameters_features);
+  }
 
   vk_device = vk_physical_device.createDevice(device_info);
 
+  if (has_draw_indirect_count) {
+    vk_cmd_draw_indexed_indirect_count =
+        reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vk_device.getProcAddr("vkCmdDrawIndexedIndirectCountKHR"));
+  }
+
   VmaAllocatorCreateInfo vma_allocator_create_info = {};
   vma_allocator_create_info.device = vk_device;
   vma_allocator_create_info.physicalDevice = vk_physical_device;
   vma_allocator_create_info.instance = vk_instance;
 
+  // The memory budget of each heap is queried by the TextureStreamer. VMA
+  // reads it with vkGetPhysicalDeviceMemoryProperties2, which is core in
+  // Vulkan 1.1, the version the instance is created with.
+  if (device_properties.apiVersion >= VK_API_VERSION_1_1) {
+    vma_allocator_create_info.vulkanApiVersion = VK_API_VERSION_1_1;
+    if (has_memory_budget) {
+      vma_allocator_create_info.flags |=
+          VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
+  }
+
   if (vmaCreateAllocator(&vma_allocator_create_info, &vma_allocator) !=
       VK_SUCCESS) {
     throw std::runtime_error("Failed to create VmaAllocator!");
   }
+  memory_telemetry.reset(new MemoryTelemetry(vma_allocator));
+  memory_pools.reset(
+      new MemoryPools(vma_allocator, vulkan_manager.getMemoryPoolSettings()));
 
   vk_graphics_queue = vk_device.getQueue(graphics_queue_family_index, 0);
 
@@ -137,25 +225,22 @@ VulkanEngine::Device::Device() : graphics_queue_family_index(0) {
   // auto surface_support = vk_physical_device.getSurfaceSupportKHR(
   //     graphics_queue_family_index, vk_surface);
 
-  vk::CommandPoolCreateInfo command_pool_info(
-      vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-      graphics_queue_family_index);
-
-  vk_command_pool = vk_device.createCommandPool(command_pool_info);
-
-  auto command_buffer_allocate_info =
-      vk::CommandBufferAllocateInfo()
-          .setCommandBufferCount(vulkan_manager.getFramesInFlight())
-          .setCommandPool(vk_command_pool)
-          .setLevel(vk::CommandBufferLevel::ePrimary);
+  for (size_t i = 0; i < vulkan_manager.getFramesInFlight(); ++i) {
+    frame_command_pools.emplace_back(
+        new CommandPool(vk_device, graphics_queue_family_index));
+    frame_command_buffers.push_back(
+        frame_command_pools.back()->getCommandBuffer());
+  }
 
-  vk_command_buffers =
-      vk_device.allocateCommandBuffers(command_buffer_allocate_info);
+  transient_command_pool.reset(
+      new CommandPool(vk_device, graphics_queue_family_index,
+                      vk::CommandPoolCreateFlagBits::eTransient));
 }
 
 VulkanEngine::Device::~Device() {
   destroyCommandBuffers();
-  vk_device.destroyCommandPool(vk_command_pool);
+  memory_telemetry.reset();
+  memory_pools.reset();
   vmaDestroyAllocator(vma_allocator);
   vma_allocator = nullptr;
   vk_device.destroy();
@@ -170,43 +255,113 @@ const vk::Device& VulkanEngine::Device::getVkDevice() const {
 }
 
 void VulkanEngine::Device::destroyCommandBuffers() {
-  if (vk_command_buffers.size() != 0) {
-    vk_device.freeCommandBuffers(vk_command_pool, vk_command_buffers);
-  }
-  vk_command_buffers.clear();
+  frame_command_buffers.clear();
+  frame_command_pools.clear();
+  transient_command_pool.reset();
 }
 
 void VulkanEngine::Device::waitIdle() { vk_device.waitIdle(); }
 
+void VulkanEngine::Device::beginFrame(size_t frame_index) {
+  auto& command_pool = frame_command_pools[frame_index];
+  command_pool->reset();
+  frame_command_buffers[frame_index] = command_pool->getCommandBuffer();
+}
+
 vk::CommandBuffer VulkanEngine::Device::getCommandBuffer(size_t index) {
-  return vk_command_buffers[index];
+  return frame_command_buffers[index];
+}
+
+std::shared_ptr<VulkanEngine::CommandPool>
+VulkanEngine::Device::getFrameCommandPool(size_t index) {
+  return frame_command_pools[index];
+}
+
+std::shared_ptr<VulkanEngine::CommandPool>
+VulkanEngine::Device::getTransientCommandPool() {
+  return transient_command_pool;
 }
 
 const VmaAllocator& VulkanEngine::Device::getVmaAllocator() {
   return vma_allocator;
 }
 
-vk::CommandPool VulkanEngine::Device::getVkCommandPool() {
-  return vk_command_pool;
+VulkanEngine::MemoryTelemetry& VulkanEngine::Device::getMemoryTelemetry() {
+  return *memory_telemetry;
+}
+
+VulkanEngine::MemoryPools& VulkanEngine::Device::getMemoryPools() {
+  return *memory_pools;
 }
 
 vk::Queue VulkanEngine::Device::getVkGraphicsQueue() {
   return vk_graphics_queue;
 }
 
-void VulkanEngine::Device::beginSingleUsageCommandBuffer() {
-  auto command_buffer_info = vk::CommandBufferAllocateInfo()
-                                 .setCommandBufferCount(1)
-                                 .setCommandPool(vk_command_pool)
-                                 .setLevel(vk::CommandBufferLevel::ePrimary);
+uint32_t VulkanEngine::Device::getGraphicsQueueFamilyIndex() const {
+  return static_cast<uint32_t>(graphics_queue_family_index);
+}
+
+const vk::PhysicalDeviceFeatures& VulkanEngine::Device::getEnabledFeatures()
+    const {
+  return enabled_features;
+}
+
+bool VulkanEngine::Device::supportsSampledImageFormat(vk::Format format) const {
+  const auto format_properties = vk_physical_device.getFormatProperties(format);
+  const auto required_features =
+      vk::FormatFeatureFlagBits::eSampledImage |
+      vk::FormatFeatureFlagBits::eSampledImageFilterLinear |
+      vk::FormatFeatureFlagBits::eTransferDst;
+  return (format_properties.optimalTilingFeatures & required_features) ==
+         required_features;
+}
+
+bool VulkanEngine::Device::supportsStorageImageFormat(vk::Format format) const {
+  const auto format_properties = vk_physical_device.getFormatProperties(format);
+  return static_cast<bool>(format_properties.optimalTilingFeatures &
+                           vk::FormatFeatureFlagBits::eStorageImage);
+}
+
+uint32_t VulkanEngine::Device::getApiVersion() const { return api_version; }
+
+const std::string& VulkanEngine::Device::getName() const { return name; }
 
-  auto command_buffers = vk_device.allocateCommandBuffers(command_buffer_info);
-  if (command_buffers.empty()) {
+float VulkanEngine::Device::getTimestampPeriod() const {
+  return timestamp_period;
+}
+
+uint32_t VulkanEngine::Device::getTimestampValidBits() const {
+  return timestamp_valid_bits;
+}
+
+bool VulkanEngine::Device::supportsShaderDrawParameters() const {
+  return shader_draw_parameters;
+}
+
+bool VulkanEngine::Device::supportsDrawIndirectCount() const {
+  return vk_cmd_draw_indexed_indirect_count != nullptr;
+}
+
+void VulkanEngine::Device::drawIndexedIndirectCount(
+    const vk::CommandBuffer& command_buffer, const vk::Buffer& buffer,
+    vk::DeviceSize offset, const vk::Buffer& count_buffer,
+    vk::DeviceSize count_buffer_offset, uint32_t max_draw_count,
+    uint32_t stride) const {
+  if (!supportsDrawIndirectCount()) {
     throw std::runtime_error(
-        "Could not allocate command buffer for buffer transfer!");
+        "vkCmdDrawIndexedIndirectCountKHR is not supported by the device.");
   }
 
-  single_use_command_buffer = command_buffers[0];
+  vk_cmd_draw_indexed_indirect_count(
+      static_cast<VkCommandBuffer>(command_buffer),
+      static_cast<VkBuffer>(buffer), offset,
+      static_cast<VkBuffer>(count_buffer), count_buffer_offset, max_draw_count,
+      stride);
+}
+
+void VulkanEngine::Device::beginSingleUsageCommandBuffer() {
+  single_use_command_buffer = transient_command_pool->allocateCommandBuffer();
 
   auto command_buffer_begin_info = vk::CommandBufferBeginInfo().setFlags(
       vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
@@ -231,7 +386,7 @@ void VulkanEngine::Device::endSingleUsageCommandBuffer() {
     throw std::runtime_error("Error waiting for fences");
   }
   vk_device.destroyFence(fence);
-  vk_device.freeCommandBuffers(vk_command_pool, single_use_command_buffer);
+  transient_command_pool->freeCommandBuffer(single_use_command_buffer);
 }
 
 #ifdef ENABLE_VULKAN_VALIDATION
@@ -0,0 +1,166 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/FrameStatistics.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+/// Source of FrameStatistics ids.
+std::atomic<uint64_t> next_frame_statistics_id(1);
+
+}  // namespace
+
+VulkanEngine::FrameStatistics::FrameStatistics()
+    : id(next_frame_statistics_id++),
+      window_size(60),
+      exited_totals(),
+      frame_totals(),
+      frame_count(0) {}
+
+VulkanEngine::FrameStatistics::~FrameStatistics() {}
+
+void VulkanEngine::FrameStatistics::count(Counter counter, uint64_t value) {
+  // Only the calling thread writes its totals, so a relaxed load and store
+  // is enough and cheaper than an atomic add.
+  auto& total = getThreadCounters().totals[static_cast<size_t>(counter)];
+  total.store(total.load(std::memory_order_relaxed) + value,
+              std::memory_order_relaxed);
+}
+
+void VulkanEngine::FrameStatistics::endFrame() {
+  std::array<uint64_t, kNumCounters> totals = exited_totals;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = thread_counters.begin(); it != thread_counters.end();) {
+      // Only this list refers to the counters of threads which have exited,
+      // so they won't change anymore.
+      const bool exited = it->use_count() == 1;
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      const auto& counters = **it;
+      for (size_t i = 0; i < kNumCounters; ++i) {
+        const uint64_t total =
+            counters.totals[i].load(std::memory_order_relaxed);
+        totals[i] += total;
+        if (exited) {
+          exited_totals[i] += total;
+        }
+      }
+
+      it = exited ? thread_counters.erase(it) : std::next(it);
+    }
+  }
+
+  Snapshot snapshot;
+  snapshot.index = frame_count++;
+  for (size_t i = 0; i < kNumCounters; ++i) {
+    snapshot.counters[i] = totals[i] - frame_totals[i];
+  }
+  frame_totals = totals;
+
+  frames.push_back(snapshot);
+  while (frames.size() > window_size) {
+    frames.pop_front();
+  }
+}
+
+void VulkanEngine::FrameStatistics::setWindowSize(size_t _window_size) {
+  if (_window_size == 0) {
+    throw std::runtime_error("The statistics window must hold a frame.");
+  }
+  window_size = _window_size;
+  while (frames.size() > window_size) {
+    frames.pop_front();
+  }
+}
+
+size_t VulkanEngine::FrameStatistics::getWindowSize() const {
+  return window_size;
+}
+
+const VulkanEngine::FrameStatistics::Snapshot&
+VulkanEngine::FrameStatistics::getLastFrame() const {
+  return frames.empty() ? empty_frame : frames.back();
+}
+
+const std::deque<VulkanEngine::FrameStatistics::Snapshot>&
+VulkanEngine::FrameStatistics::getFrames() const {
+  return frames;
+}
+
+double VulkanEngine::FrameStatistics::getAverage(Counter counter) const {
+  if (frames.empty()) {
+    return 0.0;
+  }
+
+  uint64_t sum = 0;
+  for (const auto& frame : frames) {
+    sum += frame.get(counter);
+  }
+  return static_cast<double>(sum) / static_cast<double>(frames.size());
+}
+
+void VulkanEngine::FrameStatistics::clear() { frames.clear(); }
+
+const char* VulkanEngine::FrameStatistics::getCounterName(Counter counter) {
+  switch (counter) {
+    case Counter::eDrawCalls:
+      return "draw_calls";
+    case Counter::ePipelineBinds:
+      return "pipeline_binds";
+    case Counter::eDescriptorSetBinds:
+      return "descriptor_set_binds";
+    case Counter::eTriangles:
+      return "triangles";
+    case Counter::eBytesUploaded:
+      return "bytes_uploaded";
+    case Counter::eUniformUpdates:
+      return "uniform_updates";
+  }
+  return "unknown";
+}
+
+VulkanEngine::FrameStatistics::ThreadCounters&
+VulkanEngine::FrameStatistics::getThreadCounters() {
+  // Each thread caches the counters of the statistics it last counted into.
+  thread_local uint64_t cached_id = 0;
+  thread_local std::shared_ptr<ThreadCounters> cached_counters;
+  if (cached_id != id) {
+    auto counters = std::make_shared<ThreadCounters>();
+    for (auto& total : counters->totals) {
+      total.store(0, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    thread_counters.push_back(counters);
+    cached_counters = counters;
+    cached_id = id;
+  }
+  return *cached_counters;
+}
+
+void VulkanEngine::countFrameStatistic(FrameStatistics::Counter counter,
+                                       uint64_t value) {
+  VulkanManager::getInstance().getFrameStatistics().count(counter, value);
+}
@@ -0,0 +1,197 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/Frustum.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <vector>
+
+void VulkanEngine::BoundingBoxArray::clear() {
+  min_x.clear();
+  min_y.clear();
+  min_z.clear();
+  max_x.clear();
+  max_y.clear();
+  max_z.clear();
+}
+
+void VulkanEngine::BoundingBoxArray::push_back(
+    const BoundingBox<Eigen::Vector3f>& bounding_box) {
+  min_x.push_back(bounding_box.min.x());
+  min_y.push_back(bounding_box.min.y());
+  min_z.push_back(bounding_box.min.z());
+  max_x.push_back(bounding_box.max.x());
+  max_y.push_back(bounding_box.max.y());
+  max_z.push_back(bounding_box.max.z());
+}
+
+BoundingBox<Eigen::Vector3f> VulkanEngine::BoundingBoxArray::get(
+    size_t index) const {
+  BoundingBox<Eigen::Vector3f> bounding_box;
+  bounding_box.min = Eigen::Vector3f(min_x[index], min_y[index], min_z[index]);
+  bounding_box.max = Eigen::Vector3f(max_x[index], max_y[index], max_z[index]);
+  return bounding_box;
+}
+
+void VulkanEngine::BoundingBoxArray::set(
+    size_t index, const BoundingBox<Eigen::Vector3f>& bounding_box) {
+  min_x[index] = bounding_box.min.x();
+  min_y[index] = bounding_box.min.y();
+  min_z[index] = bounding_box.min.z();
+  max_x[index] = bounding_box.max.x();
+  max_y[index] = bounding_box.max.y();
+  max_z[index] = bounding_box.max.z();
+}
+
+size_t VulkanEngine::BoundingBoxArray::size() const { return min_x.size(); }
+
+VulkanEngine::Frustum::Frustum() {
+  // Planes with a zero normal and positive distance contain every point.
+  planes.fill(Eigen::Vector4f(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+VulkanEngine::Frustum::Frustum(const Eigen::Matrix4f& view_projection) {
+  const Eigen::Vector4f row0 = view_projection.row(0).transpose();
+  const Eigen::Vector4f row1 = view_projection.row(1).transpose();
+  const Eigen::Vector4f row2 = view_projection.row(2).transpose();
+  const Eigen::Vector4f row3 = view_projection.row(3).transpose();
+
+  // Vulkan clip space has -w <= x, y <= w and 0 <= z <= w.
+  planes = {row3 + row0, row3 - row0, row3 + row1,
+            row3 - row1, row2,        row3 - row2};
+  for (auto& plane : planes) {
+    const float length = plane.head<3>().norm();
+    if (length > 0.0f) {
+      plane /= length;
+    }
+  }
+}
+
+const std::array<Eigen::Vector4f, 6>& VulkanEngine::Frustum::getPlanes()
+    const {
+  return planes;
+}
+
+bool VulkanEngine::Frustum::intersects(
+    const BoundingBox<Eigen::Vector3f>& bounding_box) const {
+  for (const auto& plane : planes) {
+    // The corner furthest along the plane normal.
+    const Eigen::Vector3f corner(
+        plane.x() >= 0.0f ? bounding_box.max.x() : bounding_box.min.x(),
+        plane.y() >= 0.0f ? bounding_box.max.y() : bounding_box.min.y(),
+        plane.z() >= 0.0f ? bounding_box.max.z() : bounding_box.min.z());
+    if (plane.head<3>().dot(corner) + plane.w() < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool VulkanEngine::Frustum::contains(
+    const BoundingBox<Eigen::Vector3f>& bounding_box) const {
+  for (const auto& plane : planes) {
+    // The corner furthest against the plane normal.
+    const Eigen::Vector3f corner(
+        plane.x() >= 0.0f ? bounding_box.min.x() : bounding_box.max.x(),
+        plane.y() >= 0.0f ? bounding_box.min.y() : bounding_box.max.y(),
+        plane.z() >= 0.0f ? bounding_box.min.z() : bounding_box.max.z());
+    if (plane.head<3>().dot(corner) + plane.w() < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void VulkanEngine::Frustum::intersects(const BoundingBoxArray& bounding_boxes,
+                                       std::vector<uint8_t>& visibility) const {
+  const size_t count = bounding_boxes.size();
+  visibility.assign(count, 1);
+
+  // The corner furthest along a plane's normal only depends on the signs of
+  // the normal, so each plane reads from a fixed set of component arrays.
+  std::array<std::array<const float*, 3>, 6> corners;
+  for (size_t j = 0; j < planes.size(); ++j) {
+    corners[j][0] = planes[j].x() >= 0.0f ? bounding_boxes.max_x.data()
+                                          : bounding_boxes.min_x.data();
+    corners[j][1] = planes[j].y() >= 0.0f ? bounding_boxes.max_y.data()
+                                          : bounding_boxes.min_y.data();
+    corners[j][2] = planes[j].z() >= 0.0f ? bounding_boxes.max_z.data()
+                                          : bounding_boxes.min_z.data();
+  }
+
+  size_t i = 0;
+#if defined(__AVX2__)
+  const __m256 zero = _mm256_setzero_ps();
+  for (; i + 8 <= count; i += 8) {
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (size_t j = 0; j < planes.size(); ++j) {
+      __m256 distance = _mm256_set1_ps(planes[j].w());
+      distance = _mm256_add_ps(
+          distance, _mm256_mul_ps(_mm256_set1_ps(planes[j].x()),
+                                  _mm256_loadu_ps(corners[j][0] + i)));
+      distance = _mm256_add_ps(
+          distance, _mm256_mul_ps(_mm256_set1_ps(planes[j].y()),
+                                  _mm256_loadu_ps(corners[j][1] + i)));
+      distance = _mm256_add_ps(
+          distance, _mm256_mul_ps(_mm256_set1_ps(planes[j].z()),
+                                  _mm256_loadu_ps(corners[j][2] + i)));
+      inside = _mm256_and_ps(inside,
+                             _mm256_cmp_ps(distance, zero, _CMP_NLT_UQ));
+    }
+
+    const int mask = _mm256_movemask_ps(inside);
+    for (size_t k = 0; k < 8; ++k) {
+      visibility[i + k] = static_cast<uint8_t>((mask >> k) & 1);
+    }
+  }
+#endif
+
+  for (; i < count; ++i) {
+    for (size_t j = 0; j < planes.size(); ++j) {
+      const float distance = planes[j].x() * corners[j][0][i] +
+                             planes[j].y() * corners[j][1][i] +
+                             planes[j].z() * corners[j][2][i] + planes[j].w();
+      if (distance < 0.0f) {
+        visibility[i] = 0;
+        break;
+      }
+    }
+  }
+}
+
+BoundingBox<Eigen::Vector3f> VulkanEngine::Frustum::transformBoundingBox(
+    const Eigen::Matrix4f& transform,
+    const BoundingBox<Eigen::Vector3f>& bounding_box) {
+  const Eigen::Vector3f center = (bounding_box.max + bounding_box.min) * 0.5f;
+  const Eigen::Vector3f extent = (bounding_box.max - bounding_box.min) * 0.5f;
+
+  const Eigen::Vector3f transformed_center =
+      (transform * center.homogeneous()).head<3>();
+  const Eigen::Vector3f transformed_extent =
+      transform.topLeftCorner<3, 3>().cwiseAbs() * extent;
+
+  BoundingBox<Eigen::Vector3f> result;
+  result.min = transformed_center - transformed_extent;
+  result.max = transformed_center + transformed_extent;
+  return result;
+}
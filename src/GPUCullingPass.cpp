@@ -0,0 +1,424 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/Frustum.h>
+#include <VulkanEngine/GPUCullingPass.h>
+#include <VulkanEngine/MeshBase.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Binds an existing vk::Buffer as a storage buffer, used to let the culling
+/// shader write into an IndirectDrawBuffer.
+class StorageBufferDescriptor : public VulkanEngine::Descriptor {
+ public:
+  StorageBufferDescriptor(uint32_t _binding, vk::Buffer _vk_buffer)
+      : Descriptor(_binding, 1, vk::DescriptorType::eStorageBuffer,
+                   vk::ShaderStageFlagBits::eCompute),
+        vk_buffer(_vk_buffer) {}
+
+  void appendVkDescriptorSets(
+      std::shared_ptr<std::vector<vk::WriteDescriptorSet>>
+          write_descriptor_sets,
+      std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
+      const vk::DescriptorSet& destination_set) override {
+    vk_descriptor_buffer_info = vk::DescriptorBufferInfo()
+                                    .setBuffer(vk_buffer)
+                                    .setOffset(0)
+                                    .setRange(VK_WHOLE_SIZE);
+
+    write_descriptor_sets->push_back(
+        vk::WriteDescriptorSet()
+            .setDstBinding(binding)
+            .setDstArrayElement(0)
+            .setDstSet(destination_set)
+            .setDescriptorType(vk_descriptor_type)
+            .setDescriptorCount(1)
+            .setPBufferInfo(&vk_descriptor_buffer_info));
+  }
+
+ private:
+  vk::Buffer vk_buffer;
+  vk::DescriptorBufferInfo vk_descriptor_buffer_info;
+};
+
+/// The number of invocations of a work group of the culling shader.
+constexpr uint32_t kWorkGroupSize = 64;
+
+/// DrawInput flag set if the draw is indexed and can be culled.
+constexpr uint32_t kIndexedFlag = 1;
+
+/// DrawInput flag set if the draw has bounds.
+constexpr uint32_t kHasBoundsFlag = 2;
+
+}  // namespace
+
+VulkanEngine::GPUCullingPass::GPUCullingPass()
+    : depth_pyramid_width(0),
+      depth_pyramid_height(0),
+      depth_pyramid_levels(0),
+      num_tested_draws(0) {}
+
+VulkanEngine::GPUCullingPass::~GPUCullingPass() {}
+
+void VulkanEngine::GPUCullingPass::setDepthPyramid(
+    const std::shared_ptr<Descriptor> _depth_pyramid, uint32_t width,
+    uint32_t height, uint32_t mip_levels) {
+  depth_pyramid = _depth_pyramid;
+  depth_pyramid_width = width;
+  depth_pyramid_height = height;
+  depth_pyramid_levels = mip_levels;
+
+  // The shader and descriptor set layouts depend on whether the pyramid is
+  // used, so everything is recreated on the next call to cull(). The
+  // DeletionQueue keeps the old resources alive for the frames in flight.
+  frames.clear();
+  shader_module.reset();
+  compute_pipeline.reset();
+}
+
+void VulkanEngine::GPUCullingPass::cull(
+    const vk::CommandBuffer& command_buffer, const RenderQueue& render_queue,
+    const IndirectDrawBuffer& indirect_draw_buffer,
+    const Eigen::Matrix4f& view_projection, size_t frame_index) {
+  num_tested_draws = 0;
+
+  const size_t num_draws = render_queue.size();
+  if (num_draws == 0) {
+    return;
+  }
+
+  if (!render_queue.hasBatches()) {
+    throw std::runtime_error(
+        "RenderQueue::buildBatches() must be called before culling.");
+  }
+
+  if (indirect_draw_buffer.getCapacity() < num_draws) {
+    throw std::runtime_error(
+        "The IndirectDrawBuffer is too small for the RenderQueue.");
+  }
+
+  auto& frame = prepareFrame(frame_index, num_draws, indirect_draw_buffer);
+
+  const auto& draw_packets = render_queue.getDrawPackets();
+  draw_inputs_scratch.resize(num_draws);
+  for (size_t i = 0; i < num_draws; ++i) {
+    const auto& draw_packet = draw_packets[i];
+    auto& draw_input = draw_inputs_scratch[i];
+    draw_input = DrawInput();
+
+    if (!draw_packet.mesh->isIndexed()) {
+      continue;
+    }
+
+    const auto command = draw_packet.mesh->getDrawIndexedIndirectCommand();
+    draw_input.index_count = command.indexCount;
+    draw_input.first_index = command.firstIndex;
+    draw_input.vertex_offset = command.vertexOffset;
+    draw_input.first_instance = draw_packet.draw_data_index;
+    draw_input.instance_count = command.instanceCount;
+    draw_input.batch_first =
+        static_cast<uint32_t>(render_queue.getBatchFirst(i));
+    draw_input.flags = kIndexedFlag;
+
+    if (draw_packet.has_bounds) {
+      draw_input.flags |= kHasBoundsFlag;
+      for (int j = 0; j < 3; ++j) {
+        draw_input.bounds_min[j] = draw_packet.bounds.min(j);
+        draw_input.bounds_max[j] = draw_packet.bounds.max(j);
+      }
+      ++num_tested_draws;
+    }
+  }
+  frame.draw_inputs->updateBuffer(draw_inputs_scratch.data(),
+                                  sizeof(DrawInput) * num_draws);
+
+  CullParameters parameters = {};
+  parameters.view_projection = view_projection;
+  const auto planes = extractFrustumPlanes(view_projection);
+  for (size_t i = 0; i < planes.size(); ++i) {
+    for (int j = 0; j < 4; ++j) {
+      parameters.planes[i][j] = planes[i](j);
+    }
+  }
+  parameters.draw_count = static_cast<uint32_t>(num_draws);
+  parameters.compact = indirect_draw_buffer.usesDrawCount() ? 1 : 0;
+  parameters.draw_counts_offset = static_cast<uint32_t>(
+      indirect_draw_buffer.getDrawCountOffset(0) / sizeof(uint32_t));
+  parameters.depth_pyramid_size[0] = static_cast<float>(depth_pyramid_width);
+  parameters.depth_pyramid_size[1] = static_cast<float>(depth_pyramid_height);
+  parameters.depth_pyramid_levels = static_cast<float>(depth_pyramid_levels);
+  frame.parameters->updateBuffer(&parameters, sizeof(parameters));
+
+  const vk::Buffer output = indirect_draw_buffer.getVkBuffer();
+  if (parameters.compact) {
+    // Visible draws are counted with atomics, so the counts start at 0.
+    command_buffer.fillBuffer(output,
+                              indirect_draw_buffer.getDrawCountOffset(0),
+                              sizeof(uint32_t) * num_draws, 0);
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(),
+        vk::MemoryBarrier()
+            .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+            .setDstAccessMask(vk::AccessFlagBits::eShaderRead |
+                              vk::AccessFlagBits::eShaderWrite),
+        nullptr, nullptr);
+  }
+
+  compute_pipeline->bindPipeline(command_buffer);
+  frame.shader->bindDescriptorSet(command_buffer, 0,
+                                  vk::PipelineBindPoint::eCompute);
+  compute_pipeline->dispatch(
+      command_buffer,
+      static_cast<uint32_t>((num_draws + kWorkGroupSize - 1) / kWorkGroupSize));
+
+  command_buffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eComputeShader,
+      vk::PipelineStageFlagBits::eDrawIndirect, vk::DependencyFlags(),
+      vk::MemoryBarrier()
+          .setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+          .setDstAccessMask(vk::AccessFlagBits::eIndirectCommandRead),
+      nullptr, nullptr);
+}
+
+size_t VulkanEngine::GPUCullingPass::getNumTestedDraws() const {
+  return num_tested_draws;
+}
+
+std::array<Eigen::Vector4f, 6>
+VulkanEngine::GPUCullingPass::extractFrustumPlanes(
+    const Eigen::Matrix4f& view_projection) {
+  return Frustum(view_projection).getPlanes();
+}
+
+VulkanEngine::GPUCullingPass::FrameResources&
+VulkanEngine::GPUCullingPass::prepareFrame(
+    size_t frame_index, size_t num_draws,
+    const IndirectDrawBuffer& indirect_draw_buffer) {
+  auto& vulkan_manager = VulkanManager::getInstance();
+  if (frames.size() != vulkan_manager.getFramesInFlight()) {
+    frames.resize(vulkan_manager.getFramesInFlight());
+  }
+
+  if (!shader_module.get()) {
+    shader_module.reset(
+        new ShaderModule(getComputeShaderString(depth_pyramid.get() != nullptr),
+                         false, vk::ShaderStageFlagBits::eCompute));
+  }
+
+  auto& frame = frames[frame_index];
+  bool descriptors_changed = false;
+
+  if (!frame.parameters.get()) {
+    frame.parameters.reset(new UniformBuffer<CullParameters>(
+        0, 1, vk::ShaderStageFlagBits::eCompute));
+    descriptors_changed = true;
+  }
+
+  if (!frame.draw_inputs.get() ||
+      frame.draw_inputs->getNumElements() < num_draws) {
+    // Grow geometrically so a slowly growing scene doesn't recreate the
+    // buffer every frame.
+    size_t num_elements =
+        frame.draw_inputs.get() ? frame.draw_inputs->getNumElements() : 64;
+    while (num_elements < num_draws) {
+      num_elements *= 2;
+    }
+    frame.draw_inputs.reset(new StorageBuffer<DrawInput>(
+        1, num_elements, vk::ShaderStageFlagBits::eCompute));
+    descriptors_changed = true;
+  }
+
+  if (frame.indirect_draw_buffer != indirect_draw_buffer.getVkBuffer()) {
+    frame.indirect_draw_buffer = indirect_draw_buffer.getVkBuffer();
+    descriptors_changed = true;
+  }
+
+  if (descriptors_changed) {
+    // The frame's fence has been waited on, so its previous descriptor set
+    // is no longer in use.
+    std::vector<std::shared_ptr<Descriptor>> descriptors = {
+        frame.parameters, frame.draw_inputs,
+        std::make_shared<StorageBufferDescriptor>(2,
+                                                  frame.indirect_draw_buffer)};
+    if (depth_pyramid.get()) {
+      descriptors.push_back(depth_pyramid);
+    }
+    frame.shader.reset(new Shader({shader_module}));
+    frame.shader->setDescriptors({descriptors});
+  }
+
+  // All frames use identical descriptor set layouts, so a pipeline created
+  // from the shader of any frame is compatible with the sets of all of them.
+  if (!compute_pipeline.get()) {
+    compute_pipeline.reset(new ComputePipeline());
+    compute_pipeline->createComputePipeline(frame.shader);
+  }
+
+  return frame;
+}
+
+const std::string VulkanEngine::GPUCullingPass::getComputeShaderString(
+    bool use_depth_pyramid) {
+  std::stringstream return_string;
+
+  return_string
+      << "#version 450\n"
+      << "layout(local_size_x = " << kWorkGroupSize << ") in;\n"
+      << "struct DrawInput {\n"
+      << "  uint index_count;\n"
+      << "  uint first_index;\n"
+      << "  int vertex_offset;\n"
+      << "  uint first_instance;\n"
+      << "  uint batch_first;\n"
+      << "  uint flags;\n"
+      << "  uint instance_count;\n"
+      << "  uint padding;\n"
+      << "  vec4 bounds_min;\n"
+      << "  vec4 bounds_max;\n"
+      << "};\n"
+      << "layout(std140, binding = 0) uniform CullParameters {\n"
+      << "  mat4 view_projection;\n"
+      << "  vec4 planes[6];\n"
+      << "  uint draw_count;\n"
+      << "  uint compact;\n"
+      << "  uint draw_counts_offset;\n"
+      << "  uint padding;\n"
+      << "  vec2 depth_pyramid_size;\n"
+      << "  float depth_pyramid_levels;\n"
+      << "} parameters;\n"
+      << "layout(std430, binding = 1) readonly buffer DrawInputs {\n"
+      << "  DrawInput draw_inputs[];\n"
+      << "};\n"
+      // Commands are 5 uints each, followed by the draw counts.
+      << "layout(std430, binding = 2) buffer IndirectDraws {\n"
+      << "  uint indirect_draws[];\n"
+      << "};\n";
+
+  if (use_depth_pyramid) {
+    return_string << "layout(binding = " << kDepthPyramidBinding
+                  << ") uniform sampler2D depth_pyramid;\n";
+  }
+
+  return_string
+      << "bool isInsideFrustum(vec3 bounds_min, vec3 bounds_max) {\n"
+      << "  for (int i = 0; i < 6; ++i) {\n"
+      << "    vec4 plane = parameters.planes[i];\n"
+      // The corner furthest along the plane normal.
+      << "    vec3 corner = mix(bounds_min, bounds_max,\n"
+      << "                      greaterThanEqual(plane.xyz, vec3(0.0)));\n"
+      << "    if (dot(plane.xyz, corner) + plane.w < 0.0) {\n"
+      << "      return false;\n"
+      << "    }\n"
+      << "  }\n"
+      << "  return true;\n"
+      << "}\n";
+
+  if (use_depth_pyramid) {
+    return_string
+        << "bool isOccluded(vec3 bounds_min, vec3 bounds_max) {\n"
+        << "  vec2 uv_min = vec2(1.0);\n"
+        << "  vec2 uv_max = vec2(0.0);\n"
+        << "  float nearest = 1.0;\n"
+        << "  for (int i = 0; i < 8; ++i) {\n"
+        << "    vec3 corner = vec3((i & 1) != 0 ? bounds_max.x : "
+           "bounds_min.x,\n"
+        << "                       (i & 2) != 0 ? bounds_max.y : "
+           "bounds_min.y,\n"
+        << "                       (i & 4) != 0 ? bounds_max.z : "
+           "bounds_min.z);\n"
+        << "    vec4 clip = parameters.view_projection * vec4(corner, 1.0);\n"
+        // Boxes crossing the near plane can't be projected, keep them.
+        << "    if (clip.w <= 0.0) {\n"
+        << "      return false;\n"
+        << "    }\n"
+        << "    vec3 ndc = clip.xyz / clip.w;\n"
+        << "    vec2 uv = ndc.xy * 0.5 + 0.5;\n"
+        << "    uv_min = min(uv_min, uv);\n"
+        << "    uv_max = max(uv_max, uv);\n"
+        << "    nearest = min(nearest, ndc.z);\n"
+        << "  }\n"
+        << "  uv_min = clamp(uv_min, 0.0, 1.0);\n"
+        << "  uv_max = clamp(uv_max, 0.0, 1.0);\n"
+        // Pick the level at which the box covers at most 2x2 texels.
+        << "  vec2 size = (uv_max - uv_min) * parameters.depth_pyramid_size;\n"
+        << "  float level = ceil(log2(max(max(size.x, size.y), 1.0)));\n"
+        << "  level = min(level, parameters.depth_pyramid_levels - 1.0);\n"
+        << "  float depth = max(\n"
+        << "      max(textureLod(depth_pyramid, uv_min, level).r,\n"
+        << "          textureLod(depth_pyramid, vec2(uv_max.x, uv_min.y), "
+           "level).r),\n"
+        << "      max(textureLod(depth_pyramid, vec2(uv_min.x, uv_max.y), "
+           "level).r,\n"
+        << "          textureLod(depth_pyramid, uv_max, level).r));\n"
+        << "  return nearest > depth;\n"
+        << "}\n";
+  }
+
+  return_string
+      << "void main() {\n"
+      << "  uint index = gl_GlobalInvocationID.x;\n"
+      << "  if (index >= parameters.draw_count) {\n"
+      << "    return;\n"
+      << "  }\n"
+      << "  DrawInput draw_input = draw_inputs[index];\n"
+      << "  if ((draw_input.flags & " << kIndexedFlag << "u) == 0u) {\n"
+      << "    return;\n"
+      << "  }\n"
+      << "  bool visible = true;\n"
+      << "  if ((draw_input.flags & " << kHasBoundsFlag << "u) != 0u) {\n"
+      << "    vec3 bounds_min = draw_input.bounds_min.xyz;\n"
+      << "    vec3 bounds_max = draw_input.bounds_max.xyz;\n"
+      << "    visible = isInsideFrustum(bounds_min, bounds_max);\n";
+  if (use_depth_pyramid) {
+    return_string
+        << "    visible = visible && !isOccluded(bounds_min, bounds_max);\n";
+  }
+  return_string
+      << "  }\n"
+      << "  uint command = index;\n"
+      << "  if (parameters.compact != 0u) {\n"
+      << "    if (!visible) {\n"
+      << "      return;\n"
+      << "    }\n"
+      << "    uint batch_first = draw_input.batch_first;\n"
+      << "    command = batch_first + atomicAdd(\n"
+      << "        indirect_draws[parameters.draw_counts_offset + "
+         "batch_first], 1u);\n"
+      << "  }\n"
+      << "  uint offset = command * 5u;\n"
+      << "  indirect_draws[offset] = draw_input.index_count;\n"
+      << "  indirect_draws[offset + 1u] =\n"
+      << "      visible ? draw_input.instance_count : 0u;\n"
+      << "  indirect_draws[offset + 2u] = draw_input.first_index;\n"
+      << "  indirect_draws[offset + 3u] = uint(draw_input.vertex_offset);\n"
+      << "  indirect_draws[offset + 4u] = draw_input.first_instance;\n"
+      << "}\n";
+
+  return return_string.str();
+}
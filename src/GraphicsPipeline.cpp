@@ -18,30 +18,45 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <VulkanEngine/FrameStatistics.h>
 #include <VulkanEngine/GraphicsPipeline.h>
 #include <VulkanEngine/MeshBase.h>
 #include <VulkanEngine/RenderPass.h>
 #include <VulkanEngine/Shader.h>
 #include <VulkanEngine/VulkanManager.h>
 
+#include <atomic>
 #include <memory>
 
-VulkanEngine::GraphicsPipeline::GraphicsPipeline() {}
+namespace {
+std::atomic<uint32_t> next_graphics_pipeline_id(0);
+}  // namespace
+
+VulkanEngine::GraphicsPipeline::GraphicsPipeline()
+    : id(next_graphics_pipeline_id++) {}
 
 VulkanEngine::GraphicsPipeline::~GraphicsPipeline() {
-  auto device = VulkanManager::getInstance().getDevice();
-  device->waitIdle();
   if (vk_graphics_pipeline) {
-    device->getVkDevice().destroyPipeline(vk_graphics_pipeline);
+    VulkanManager::getInstance().getDeletionQueue().enqueue(
+        [vk_graphics_pipeline = vk_graphics_pipeline]() {
+          VulkanManager::getInstance()
+              .getDevice()
+              ->getVkDevice()
+              .destroyPipeline(vk_graphics_pipeline);
+        });
   }
 }
 
 void VulkanEngine::GraphicsPipeline::bindPipeline() {
   auto& vulkan_manager = VulkanManager::getInstance();
-  vk::CommandBuffer current_command_buffer =
-      vulkan_manager.getCurrentCommandBuffer();
-  current_command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
-                                      vk_graphics_pipeline);
+  bindPipeline(vulkan_manager.getCurrentCommandBuffer());
+}
+
+void VulkanEngine::GraphicsPipeline::bindPipeline(
+    const vk::CommandBuffer& command_buffer) {
+  command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                              vk_graphics_pipeline);
+  VULKANENGINE_COUNT_STATISTIC(ePipelineBinds, 1);
 }
 
 void VulkanEngine::GraphicsPipeline::setViewPort(float x, float y, float width,
@@ -64,6 +79,8 @@ void VulkanEngine::GraphicsPipeline::setScissor(int32_t offset_x,
                    .setExtent(vk::Extent2D(width, height));
 }
 
+uint32_t VulkanEngine::GraphicsPipeline::getId() const { return id; }
+
 void VulkanEngine::GraphicsPipeline::setCullMode(
     vk::CullModeFlagBits cull_mode) {
   vk_cull_mode = cull_mode;
@@ -72,9 +89,16 @@ void VulkanEngine::GraphicsPipeline::setCullMode(
 void VulkanEngine::GraphicsPipeline::createGraphicsPipeline(
     const std::shared_ptr<MeshBase> mesh,
     const std::shared_ptr<Shader> shader) {
+  // The previous pipeline may still be used by frames in flight.
   if (vk_graphics_pipeline) {
-    VulkanManager::getInstance().getDevice()->getVkDevice().destroyPipeline(
-        vk_graphics_pipeline);
+    VulkanManager::getInstance().getDeletionQueue().enqueue(
+        [vk_graphics_pipeline = vk_graphics_pipeline]() {
+          VulkanManager::getInstance()
+              .getDevice()
+              ->getVkDevice()
+              .destroyPipeline(vk_graphics_pipeline);
+        });
+    vk_graphics_pipeline = nullptr;
   }
 
   auto viewport_info = vk::PipelineViewportStateCreateInfo()
@@ -26,13 +26,16 @@
 #include <VulkanEngine/VulkanManager.h>
 
 #include <algorithm>
+#include <array>
+#include <vector>
 
 template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
           vk::SampleCountFlagBits sample_count_flags>
 VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::Image(
     vk::ImageLayout initial_layout, vk::ImageUsageFlags usage_flags,
     VmaMemoryUsage vma_memory_usage, uint32_t _width, uint32_t _height,
-    uint32_t _depth, size_t pixel_size, bool generate_mip_maps)
+    uint32_t _depth, size_t pixel_size, bool generate_mip_maps,
+    MipmapMode _mipmap_mode)
     : StagedBufferDestination(),
       ImageBase(),
       width(_width),
@@ -40,21 +43,36 @@ VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::Image(
       depth(_depth),
       data_size(pixel_size * width * height * depth),
       mipmap_levels(1),
-      vk_image_layout(initial_layout) {
+      mipmap_mode(_mipmap_mode),
+      vk_image_layout(initial_layout),
+      num_moves(0) {
   if (generate_mip_maps) {
     mipmap_levels =
         static_cast<uint32_t>(std::floor(std::log2(std::max(width, height))));
   }
+  if (mipmap_mode == MipmapMode::eCompute &&
+      (mipmap_levels <= 1 || image_type != vk::ImageType::e2D ||
+       tiling != vk::ImageTiling::eOptimal || depth != 1 ||
+       !VulkanManager::getInstance().getMipmapGenerator().supports(
+           format, width, height))) {
+    mipmap_mode = MipmapMode::eBlit;
+  }
   createImage(usage_flags, vma_memory_usage);
 }
 
 template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
           vk::SampleCountFlagBits sample_count_flags>
 VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::~Image() {
-  VulkanManager::getInstance().getDevice()->getVkDevice().destroyImageView(
-      vk_image_view);
-  vmaDestroyImage(VulkanManager::getInstance().getDevice()->getVmaAllocator(),
-                  vk_image, vma_allocation);
+  auto& vulkan_manager = VulkanManager::getInstance();
+  vulkan_manager.getMemoryDefragmenter().unregisterResource(vma_allocation);
+  vulkan_manager.getDeletionQueue().enqueue(
+      [vk_image_view = vk_image_view, vk_image = vk_image,
+       vma_allocation = vma_allocation]() {
+        auto device = VulkanManager::getInstance().getDevice();
+        device->getVkDevice().destroyImageView(vk_image_view);
+        device->getMemoryTelemetry().recordFree(vma_allocation);
+        vmaDestroyImage(device->getVmaAllocator(), vk_image, vma_allocation);
+      });
 }
 
 template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
@@ -69,6 +87,9 @@ template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
 void VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::
     createImageView(vk::ImageViewType image_view_type,
                     vk::ImageAspectFlags image_aspect_flags) {
+  vk_image_view_type = image_view_type;
+  vk_image_aspect_flags = image_aspect_flags;
+
   auto subresource_range = vk::ImageSubresourceRange()
                                .setAspectMask(image_aspect_flags)
                                .setBaseMipLevel(0)
@@ -82,6 +103,15 @@ void VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::
                                     .setViewType(image_view_type)
                                     .setSubresourceRange(subresource_range);
 
+  // Storage usage is only added for the views of the MipmapGenerator and may
+  // not be supported by the format of the image itself.
+  auto image_view_usage_create_info = vk::ImageViewUsageCreateInfo().setUsage(
+      vk::ImageUsageFlags(image_create_info.usage) &
+      ~vk::ImageUsageFlags(vk::ImageUsageFlagBits::eStorage));
+  if (mipmap_mode == MipmapMode::eCompute) {
+    image_view_create_info.setPNext(&image_view_usage_create_info);
+  }
+
   vk_image_view =
       VulkanManager::getInstance().getDevice()->getVkDevice().createImageView(
           image_view_create_info);
@@ -193,6 +223,13 @@ VulkanEngine::Image<format, image_type, tiling,
   return sample_count_flags;
 }
 
+template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
+          vk::SampleCountFlagBits sample_count_flags>
+VulkanEngine::MipmapMode VulkanEngine::Image<
+    format, image_type, tiling, sample_count_flags>::getMipmapMode() const {
+  return mipmap_mode;
+}
+
 template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
           vk::SampleCountFlagBits sample_count_flags>
 vk::Image VulkanEngine::Image<format, image_type, tiling,
@@ -237,12 +274,20 @@ void VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::
                                    vk::ImageLayout::eTransferDstOptimal,
                                    buffer_image_copy);
 
-  if (mipmap_levels > 1) {
+  if (mipmap_levels > 1 && mipmap_mode == MipmapMode::eCompute) {
+    VulkanManager::getInstance().getMipmapGenerator().generate(
+        command_buffer, vk_image, format, width, height, mipmap_levels,
+        mipmap_resources);
+    vk_image_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+  } else if (mipmap_levels > 1) {
     generateMipmaps(command_buffer);
   } else {
     transitionImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal,
                           command_buffer);
   }
+
+  VulkanManager::getInstance().getMemoryDefragmenter().registerResource(
+      vma_allocation, this);
 }
 
 template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
@@ -259,8 +304,15 @@ void VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::
   auto image_extent =
       vk::Extent3D().setWidth(width).setHeight(height).setDepth(depth);
 
+  vk::ImageCreateFlags create_flags;
+  if (mipmap_mode == MipmapMode::eCompute) {
+    usage_flags |= vk::ImageUsageFlagBits::eStorage;
+    create_flags = MipmapGenerator::getImageCreateFlags(format);
+  }
+
   image_create_info = static_cast<VkImageCreateInfo>(
       vk::ImageCreateInfo()
+          .setFlags(create_flags)
           .setImageType(image_type)
           .setExtent(image_extent)
           .setMipLevels(mipmap_levels)
@@ -276,15 +328,18 @@ void VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::
   allocate_info.usage = vma_usage;
 
   VkImage c_image_handle;
-  auto allocation_result = vmaCreateImage(
-      VulkanManager::getInstance().getDevice()->getVmaAllocator(),
-      &image_create_info, &allocate_info, &c_image_handle, &vma_allocation,
-      nullptr);
+  auto allocation_result =
+      VulkanManager::getInstance().getDevice()->getMemoryPools().createImage(
+          image_create_info, allocate_info, &c_image_handle, &vma_allocation);
   if (allocation_result != VK_SUCCESS) {
     throw std::runtime_error("Could not allocate Image memory!");
   }
 
   vk_image = c_image_handle;
+  auto& memory_telemetry =
+      VulkanManager::getInstance().getDevice()->getMemoryTelemetry();
+  memory_telemetry.recordAllocation(
+      vma_allocation, MemoryTelemetry::getImageCategory(usage_flags));
 }
 
 template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
@@ -388,4 +443,109 @@ void VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::
   vk_image_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
 }
 
+template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
+          vk::SampleCountFlagBits sample_count_flags>
+bool VulkanEngine::Image<format, image_type, tiling, sample_count_flags>::
+    beginMove(const vk::CommandBuffer& command_buffer,
+              VmaAllocation destination) {
+  if (vk_image_layout != vk::ImageLayout::eShaderReadOnlyOptimal ||
+      !(vk::ImageUsageFlags(image_create_info.usage) &
+        vk::ImageUsageFlagBits::eTransferSrc)) {
+    return false;
+  }
+
+  auto device = VulkanManager::getInstance().getDevice();
+  auto moved_image_create_info =
+      vk::ImageCreateInfo(image_create_info)
+          .setInitialLayout(vk::ImageLayout::eUndefined);
+  moved_vk_image = device->getVkDevice().createImage(moved_image_create_info);
+  if (vmaBindImageMemory(device->getVmaAllocator(), destination,
+                         static_cast<VkImage>(moved_vk_image)) != VK_SUCCESS) {
+    device->getVkDevice().destroyImage(moved_vk_image);
+    moved_vk_image = nullptr;
+    return false;
+  }
+
+  auto subresource_range = vk::ImageSubresourceRange()
+                               .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                               .setBaseMipLevel(0)
+                               .setLevelCount(mipmap_levels)
+                               .setBaseArrayLayer(0)
+                               .setLayerCount(1);
+
+  std::array<vk::ImageMemoryBarrier, 2> image_memory_barriers;
+  image_memory_barriers[0]
+      .setImage(vk_image)
+      .setOldLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+      .setNewLayout(vk::ImageLayout::eTransferSrcOptimal)
+      .setSrcAccessMask(vk::AccessFlags())
+      .setDstAccessMask(vk::AccessFlagBits::eTransferRead)
+      .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+      .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+      .setSubresourceRange(subresource_range);
+  image_memory_barriers[1]
+      .setImage(moved_vk_image)
+      .setOldLayout(vk::ImageLayout::eUndefined)
+      .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+      .setSrcAccessMask(vk::AccessFlags())
+      .setDstAccessMask(vk::AccessFlagBits::eTransferWrite)
+      .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+      .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+      .setSubresourceRange(subresource_range);
+  command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                 vk::PipelineStageFlagBits::eTransfer,
+                                 vk::DependencyFlags(), nullptr, nullptr,
+                                 image_memory_barriers);
+
+  std::vector<vk::ImageCopy> image_copies(mipmap_levels);
+  for (uint32_t i = 0; i < mipmap_levels; ++i) {
+    auto image_subresource =
+        vk::ImageSubresourceLayers()
+            .setAspectMask(vk::ImageAspectFlagBits::eColor)
+            .setMipLevel(i)
+            .setBaseArrayLayer(0)
+            .setLayerCount(1);
+    image_copies[i]
+        .setSrcSubresource(image_subresource)
+        .setDstSubresource(image_subresource)
+        .setExtent(vk::Extent3D(std::max(width >> i, 1u),
+                                std::max(height >> i, 1u),
+                                std::max(depth >> i, 1u)));
+  }
+  command_buffer.copyImage(vk_image, vk::ImageLayout::eTransferSrcOptimal,
+                           moved_vk_image,
+                           vk::ImageLayout::eTransferDstOptimal, image_copies);
+
+  image_memory_barriers[1]
+      .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+      .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+      .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+      .setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+  command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                 vk::PipelineStageFlagBits::eFragmentShader,
+                                 vk::DependencyFlags(), nullptr, nullptr,
+                                 image_memory_barriers[1]);
+  return true;
+}
+
+template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
+          vk::SampleCountFlagBits sample_count_flags>
+void VulkanEngine::Image<format, image_type, tiling,
+                         sample_count_flags>::endMove() {
+  auto vk_device = VulkanManager::getInstance().getDevice()->getVkDevice();
+  const bool has_image_view = static_cast<bool>(vk_image_view);
+  vk_device.destroyImageView(vk_image_view);
+  vk_image_view = nullptr;
+  vk_device.destroyImage(vk_image);
+  vk_image = moved_vk_image;
+  moved_vk_image = nullptr;
+
+  // The views of the MipmapGenerator refer to the old image.
+  mipmap_resources.reset();
+  if (has_image_view) {
+    createImageView(vk_image_view_type, vk_image_aspect_flags);
+  }
+  ++num_moves;
+}
+
 #endif /* IMAGE_CPP */
@@ -0,0 +1,132 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/IndirectDrawBuffer.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+#include <memory>
+
+VulkanEngine::IndirectDrawBuffer::IndirectDrawBuffer()
+    : capacity(0), mapped_memory(nullptr) {
+  auto device = VulkanManager::getInstance().getDevice();
+  multi_draw_indirect = device->getEnabledFeatures().multiDrawIndirect;
+  draw_indirect_count = device->supportsDrawIndirectCount();
+}
+
+VulkanEngine::IndirectDrawBuffer::~IndirectDrawBuffer() {
+  if (buffer.get()) {
+    buffer->unmapMemory();
+  }
+}
+
+void VulkanEngine::IndirectDrawBuffer::reserve(size_t num_commands) {
+  if (num_commands <= capacity) {
+    return;
+  }
+
+  if (buffer.get()) {
+    buffer->unmapMemory();
+  }
+
+  // Grow geometrically so that a slowly growing scene doesn't recreate the
+  // buffer every frame.
+  capacity = std::max(num_commands, capacity * 2);
+  buffer.reset(new Buffer(
+      capacity * (sizeof(vk::DrawIndexedIndirectCommand) + sizeof(uint32_t)),
+      vk::BufferUsageFlagBits::eIndirectBuffer |
+          vk::BufferUsageFlagBits::eStorageBuffer |
+          vk::BufferUsageFlagBits::eTransferDst,
+      vk::MemoryPropertyFlagBits::eHostCoherent |
+          vk::MemoryPropertyFlagBits::eHostVisible,
+      VMA_MEMORY_USAGE_CPU_TO_GPU));
+  mapped_memory = buffer->mapMemory();
+}
+
+size_t VulkanEngine::IndirectDrawBuffer::getCapacity() const {
+  return capacity;
+}
+
+vk::DrawIndexedIndirectCommand*
+VulkanEngine::IndirectDrawBuffer::getCommands() const {
+  return static_cast<vk::DrawIndexedIndirectCommand*>(mapped_memory);
+}
+
+size_t VulkanEngine::IndirectDrawBuffer::draw(
+    const vk::CommandBuffer& command_buffer, size_t first_command,
+    size_t num_commands) const {
+  if (num_commands == 0) {
+    return 0;
+  }
+
+  if (first_command + num_commands > capacity) {
+    throw std::runtime_error("Indirect draw exceeds the buffer's capacity.");
+  }
+
+  const auto stride =
+      static_cast<uint32_t>(sizeof(vk::DrawIndexedIndirectCommand));
+  const auto vk_buffer = buffer->getVkBuffer();
+
+  if (draw_indirect_count) {
+    // The count is written next to the commands so that the GPU can later
+    // lower it, e.g. after culling, without changing the recorded commands.
+    auto draw_counts = reinterpret_cast<uint32_t*>(
+        static_cast<char*>(mapped_memory) + getDrawCountOffset(0));
+    draw_counts[first_command] = static_cast<uint32_t>(num_commands);
+    VulkanManager::getInstance().getDevice()->drawIndexedIndirectCount(
+        command_buffer, vk_buffer, getCommandOffset(first_command), vk_buffer,
+        getDrawCountOffset(first_command), static_cast<uint32_t>(num_commands),
+        stride);
+    return 1;
+  }
+
+  if (multi_draw_indirect) {
+    command_buffer.drawIndexedIndirect(vk_buffer,
+                                       getCommandOffset(first_command),
+                                       static_cast<uint32_t>(num_commands),
+                                       stride);
+    return 1;
+  }
+
+  for (size_t i = first_command; i < first_command + num_commands; ++i) {
+    command_buffer.drawIndexedIndirect(vk_buffer, getCommandOffset(i), 1,
+                                       stride);
+  }
+  return num_commands;
+}
+
+const vk::Buffer VulkanEngine::IndirectDrawBuffer::getVkBuffer() const {
+  return buffer.get() ? buffer->getVkBuffer() : vk::Buffer();
+}
+
+bool VulkanEngine::IndirectDrawBuffer::usesDrawCount() const {
+  return draw_indirect_count;
+}
+
+vk::DeviceSize VulkanEngine::IndirectDrawBuffer::getCommandOffset(
+    size_t index) const {
+  return index * sizeof(vk::DrawIndexedIndirectCommand);
+}
+
+vk::DeviceSize VulkanEngine::IndirectDrawBuffer::getDrawCountOffset(
+    size_t index) const {
+  return capacity * sizeof(vk::DrawIndexedIndirectCommand) +
+         index * sizeof(uint32_t);
+}
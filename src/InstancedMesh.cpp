@@ -0,0 +1,478 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/Buffer.h>
+#include <VulkanEngine/FrameStatistics.h>
+#include <VulkanEngine/Frustum.h>
+#include <VulkanEngine/InstancedMesh.h>
+#include <VulkanEngine/MeshBase.h>
+#include <VulkanEngine/RenderQueue.h>
+#include <VulkanEngine/Scene.h>
+#include <VulkanEngine/ShaderModule.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/// Wraps a shape of an OBJMesh, adding a vertex binding for the instance
+/// transforms and drawing every instance at once.
+class VulkanEngine::InstancedMesh::Shape : public MeshBase {
+ public:
+  /// Constructor.
+  /// \param _mesh The shape to draw.
+  /// \param _num_padding_instances See InstancedMesh::num_padding_instances.
+  /// \param _first_instance The first instance the shape is drawn with.
+  Shape(const std::shared_ptr<MeshBase> _mesh, size_t _num_padding_instances,
+        uint32_t _first_instance)
+      : mesh(_mesh),
+        instance_binding(mesh->createVkPipelineVertexInputStateCreateInfo()
+                             .vertexBindingDescriptionCount),
+        instance_offset((_num_padding_instances - _first_instance) *
+                        sizeof(Eigen::Matrix4f)),
+        first_instance(_first_instance),
+        instance_count(0) {
+    bounding_box.reset(new BoundingBox<Eigen::Vector3f>(
+        mesh->getBoundingBox<Eigen::Vector3f>()));
+  }
+
+  /// Set the instances to draw.
+  /// \param _instance_attribute The instance transforms.
+  /// \param _instance_count The number of instances.
+  void setInstances(
+      const std::shared_ptr<VertexAttribute<Eigen::Matrix4f>>&
+          _instance_attribute,
+      uint32_t _instance_count) {
+    instance_attribute = _instance_attribute;
+    instance_count = _instance_count;
+  }
+
+  const vk::PipelineVertexInputStateCreateInfo&
+  createVkPipelineVertexInputStateCreateInfo() override {
+    if (!instance_attribute.get()) {
+      throw std::runtime_error(
+          "InstancedMesh shape has no instance buffer to describe.");
+    }
+
+    const auto& mesh_info = mesh->createVkPipelineVertexInputStateCreateInfo();
+    binding_descriptions.assign(mesh_info.pVertexBindingDescriptions,
+                                mesh_info.pVertexBindingDescriptions +
+                                    mesh_info.vertexBindingDescriptionCount);
+    attribute_descriptions.assign(
+        mesh_info.pVertexAttributeDescriptions,
+        mesh_info.pVertexAttributeDescriptions +
+            mesh_info.vertexAttributeDescriptionCount);
+
+    binding_descriptions.push_back(
+        instance_attribute->getVkVertexInputBindingDescription(
+            instance_binding));
+    const auto instance_descriptions =
+        instance_attribute->getVkVertexInputAttributeDescriptions(
+            instance_binding);
+    attribute_descriptions.insert(attribute_descriptions.end(),
+                                  instance_descriptions.begin(),
+                                  instance_descriptions.end());
+
+    pipeline_vertex_input_state_info =
+        vk::PipelineVertexInputStateCreateInfo()
+            .setPVertexBindingDescriptions(binding_descriptions.data())
+            .setVertexBindingDescriptionCount(
+                static_cast<uint32_t>(binding_descriptions.size()))
+            .setPVertexAttributeDescriptions(attribute_descriptions.data())
+            .setVertexAttributeDescriptionCount(
+                static_cast<uint32_t>(attribute_descriptions.size()));
+    return pipeline_vertex_input_state_info;
+  }
+
+  const vk::PipelineInputAssemblyStateCreateInfo&
+  createVkPipelineInputAssemblyStateCreateInfo() override {
+    return mesh->createVkPipelineInputAssemblyStateCreateInfo();
+  }
+
+  void transferBuffers(const vk::CommandBuffer& command_buffer) override {
+    mesh->transferBuffers(command_buffer);
+  }
+
+  void bindVertexBuffers(const vk::CommandBuffer& command_buffer) override {
+    mesh->bindVertexBuffers(command_buffer);
+    command_buffer.bindVertexBuffers(
+        instance_binding, instance_attribute->getVkBuffer(), instance_offset);
+  }
+
+  void bindIndexBuffer(const vk::CommandBuffer& command_buffer) override {
+    mesh->bindIndexBuffer(command_buffer);
+  }
+
+  void draw(const vk::CommandBuffer& command_buffer) override {
+    const auto command = getDrawIndexedIndirectCommand();
+    command_buffer.drawIndexed(command.indexCount, command.instanceCount,
+                               command.firstIndex, command.vertexOffset,
+                               command.firstInstance);
+    VULKANENGINE_COUNT_STATISTIC(eDrawCalls, 1);
+    VULKANENGINE_COUNT_STATISTIC(
+        eTriangles, command.indexCount / 3 * command.instanceCount);
+  }
+
+  bool isIndexed() const override { return mesh->isIndexed(); }
+
+  vk::DrawIndexedIndirectCommand getDrawIndexedIndirectCommand()
+      const override {
+    return mesh->getDrawIndexedIndirectCommand()
+        .setInstanceCount(instance_count)
+        .setFirstInstance(first_instance);
+  }
+
+  vk::DrawIndirectCommand getDrawIndirectCommand() const override {
+    return mesh->getDrawIndirectCommand()
+        .setInstanceCount(instance_count)
+        .setFirstInstance(first_instance);
+  }
+
+  /// \return This shape, since every shape binds the instance buffer at a
+  /// different offset.
+  const void* getGeometryId() const override { return this; }
+
+ private:
+  /// The shape to draw.
+  std::shared_ptr<MeshBase> mesh;
+
+  /// The binding of the instance buffer, following those of the shape.
+  uint32_t instance_binding;
+
+  /// The offset the instance buffer is bound at in bytes.
+  vk::DeviceSize instance_offset;
+
+  /// The first instance the shape is drawn with.
+  uint32_t first_instance;
+
+  /// The number of instances to draw.
+  uint32_t instance_count;
+
+  /// The instance transforms of the current frame.
+  std::shared_ptr<VertexAttribute<Eigen::Matrix4f>> instance_attribute;
+
+  /// The bindings of the shape followed by the instance binding.
+  std::vector<vk::VertexInputBindingDescription> binding_descriptions;
+
+  /// The attributes of the shape followed by the instance transform.
+  std::vector<vk::VertexInputAttributeDescription> attribute_descriptions;
+
+  vk::PipelineVertexInputStateCreateInfo pipeline_vertex_input_state_info;
+};
+
+VulkanEngine::InstancedMesh::InstancedMesh(
+    const std::shared_ptr<OBJMesh> _obj_mesh)
+    : SceneObject(),
+      obj_mesh(_obj_mesh),
+      num_padding_instances(0),
+      instance_version(0),
+      graphics_pipeline_updated(false),
+      graphics_pipeline_width(0),
+      graphics_pipeline_height(0),
+      bounding_box(),
+      bounding_box_dirty(true) {
+  disableLegacyUpdate();
+
+  if (obj_mesh.get()) {
+    obj_mesh->waitUntilLoaded();
+  }
+  if (!obj_mesh.get() || obj_mesh->meshes.empty()) {
+    return;
+  }
+
+  auto& vulkan_manager = VulkanManager::getInstance();
+  if (!vulkan_manager.getDevice()->supportsShaderDrawParameters()) {
+    throw std::runtime_error(
+        "InstancedMesh requires shader draw parameters to index materials.");
+  }
+  const size_t frames_in_flight = vulkan_manager.getFramesInFlight();
+
+  const auto& meshes = obj_mesh->meshes;
+  num_padding_instances = meshes.size() - 1;
+  instance_data.assign(num_padding_instances, Eigen::Matrix4f::Identity());
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    shapes.push_back(std::make_shared<Shape>(meshes[i], num_padding_instances,
+                                             static_cast<uint32_t>(i)));
+  }
+
+  instance_attributes.resize(frames_in_flight);
+  instance_attribute_versions.assign(frames_in_flight, 0);
+
+  mvp_buffers.resize(frames_in_flight);
+  for (auto& ub : mvp_buffers) {
+    ub.reset(new UniformBuffer<OBJMesh::MvpUbo>(0));
+  }
+
+  // Same shaders as the OBJMesh, except for the vertex shader which applies
+  // the instance transforms.
+  std::shared_ptr<ShaderModule> vertex_shader(
+      new ShaderModule(obj_mesh->getVertexShaderString(true), false,
+                       vk::ShaderStageFlagBits::eVertex));
+  std::array<std::shared_ptr<ShaderModule>, 2> fragment_shaders;
+  for (const auto& texture : obj_mesh->shader_textures) {
+    const size_t variant = texture.get() != nullptr ? 1 : 0;
+    auto& fragment_shader = fragment_shaders[variant];
+    if (!fragment_shader.get()) {
+      fragment_shader.reset(new ShaderModule(
+          obj_mesh->getFragmentShaderString(variant == 1), false,
+          vk::ShaderStageFlagBits::eFragment));
+    }
+
+    std::shared_ptr<Shader> shader(
+        new Shader({fragment_shader, vertex_shader}));
+
+    std::vector<std::vector<std::shared_ptr<Descriptor>>> descriptors;
+    for (size_t j = 0; j < frames_in_flight; ++j) {
+      std::vector<std::shared_ptr<Descriptor>> frame_descriptors;
+      if (texture.get() != nullptr) {
+        frame_descriptors.push_back(texture);
+      }
+      frame_descriptors.push_back(mvp_buffers[j]);
+      frame_descriptors.push_back(obj_mesh->material_buffer);
+      descriptors.push_back(frame_descriptors);
+    }
+
+    shader->setDescriptors(descriptors);
+    shaders.push_back(shader);
+  }
+
+  graphics_pipelines.resize(fragment_shaders.size());
+}
+
+VulkanEngine::InstancedMesh::~InstancedMesh() {}
+
+size_t VulkanEngine::InstancedMesh::addInstance(
+    const Eigen::Matrix4f& instance_transform) {
+  instance_data.push_back(instance_transform);
+  onInstancesChanged();
+  return getNumInstances() - 1;
+}
+
+void VulkanEngine::InstancedMesh::setInstanceTransform(
+    size_t index, const Eigen::Matrix4f& instance_transform) {
+  instance_data[num_padding_instances + index] = instance_transform;
+  onInstancesChanged();
+}
+
+const Eigen::Matrix4f& VulkanEngine::InstancedMesh::getInstanceTransform(
+    size_t index) const {
+  return instance_data[num_padding_instances + index];
+}
+
+size_t VulkanEngine::InstancedMesh::getNumInstances() const {
+  return instance_data.size() - num_padding_instances;
+}
+
+void VulkanEngine::InstancedMesh::clearInstances() {
+  instance_data.resize(num_padding_instances);
+  onInstancesChanged();
+}
+
+bool VulkanEngine::InstancedMesh::getLocalBoundingBox(
+    BoundingBox<Eigen::Vector3f>& _bounding_box) const {
+  if (shapes.empty() || getNumInstances() == 0) {
+    return false;
+  }
+
+  if (bounding_box_dirty) {
+    const auto& mesh_bounding_box = obj_mesh->getBoundingBox();
+    bounding_box.min = Eigen::Vector3f::Constant(
+        std::numeric_limits<float>::max());
+    bounding_box.max = Eigen::Vector3f::Constant(
+        std::numeric_limits<float>::lowest());
+    for (size_t i = num_padding_instances; i < instance_data.size(); ++i) {
+      const auto instance_bounding_box =
+          Frustum::transformBoundingBox(instance_data[i], mesh_bounding_box);
+      bounding_box.min = bounding_box.min.cwiseMin(instance_bounding_box.min);
+      bounding_box.max = bounding_box.max.cwiseMax(instance_bounding_box.max);
+    }
+    bounding_box_dirty = false;
+  }
+
+  _bounding_box = bounding_box;
+  return true;
+}
+
+void VulkanEngine::InstancedMesh::onInstancesChanged() {
+  ++instance_version;
+  bounding_box_dirty = true;
+  invalidateBoundingBox();
+}
+
+void VulkanEngine::InstancedMesh::updateInstanceBuffer(
+    size_t frame_index, const vk::CommandBuffer& command_buffer) {
+  auto& instance_attribute = instance_attributes[frame_index];
+  if (instance_attribute.get() &&
+      instance_attribute_versions[frame_index] == instance_version) {
+    return;
+  }
+
+  // Each frame in flight has its own buffer, so the buffer of this frame is
+  // no longer read by the GPU. Grow geometrically to keep adding instances
+  // cheap.
+  if (!instance_attribute.get() ||
+      instance_attribute->getNumElements() < instance_data.size()) {
+    const size_t capacity =
+        std::max(instance_data.size(),
+                 instance_attribute.get()
+                     ? 2 * instance_attribute->getNumElements()
+                     : static_cast<size_t>(0));
+    std::vector<Eigen::Matrix4f> data(capacity, Eigen::Matrix4f::Identity());
+    std::copy(instance_data.begin(), instance_data.end(), data.begin());
+    instance_attribute.reset(new VertexAttribute<Eigen::Matrix4f>(
+        data.data(), data.size(), 3, vk::Format::eR32G32B32A32Sfloat,
+        vk::VertexInputRate::eInstance, 4));
+
+    // The render pass of the frame begins after traversal, so the copy is
+    // recorded in front of the draws instead of waiting for a separate
+    // submit.
+    instance_attribute->transferBuffer(command_buffer);
+  } else {
+    // The data is only needed until the copy has executed, so it is staged
+    // in a transient buffer which the DeletionQueue frees once the frame
+    // has completed.
+    const size_t size = sizeof(Eigen::Matrix4f) * instance_data.size();
+    Buffer staging_buffer(size, vk::BufferUsageFlagBits::eTransferSrc,
+                          vk::MemoryPropertyFlagBits::eHostVisible |
+                              vk::MemoryPropertyFlagBits::eHostCoherent,
+                          VMA_MEMORY_USAGE_CPU_ONLY, true);
+    staging_buffer.updateBuffer(instance_data.data(), size);
+    command_buffer.copyBuffer(staging_buffer.getVkBuffer(),
+                              instance_attribute->getVkBuffer(),
+                              vk::BufferCopy().setSize(size));
+    VULKANENGINE_COUNT_STATISTIC(eBytesUploaded, size);
+  }
+  command_buffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer,
+      vk::PipelineStageFlagBits::eVertexInput, vk::DependencyFlags(),
+      vk::MemoryBarrier()
+          .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+          .setDstAccessMask(vk::AccessFlagBits::eVertexAttributeRead),
+      nullptr, nullptr);
+  instance_attribute_versions[frame_index] = instance_version;
+}
+
+void VulkanEngine::InstancedMesh::update(SceneState& scene_state) {
+  const auto window = scene_state.getScene().getActiveWindow();
+  if (shapes.empty() || getNumInstances() == 0 || window.get() == nullptr) {
+    SceneObject::update(scene_state);
+    return;
+  }
+
+  auto& vulkan_manager = VulkanManager::getInstance();
+  const size_t frame_index = vulkan_manager.getCurrentFrame();
+
+  OBJMesh::MvpUbo ubo_data;
+  ubo_data.projection = scene_state.getProjectionMatrix();
+  ubo_data.view = scene_state.getViewMatrix();
+  ubo_data.model = scene_state.getTotalTransform();
+  mvp_buffers[frame_index]->updateBuffer(&ubo_data, sizeof(ubo_data));
+
+  updateInstanceBuffer(frame_index, vulkan_manager.getCurrentCommandBuffer());
+  const auto instance_count = static_cast<uint32_t>(getNumInstances());
+  for (auto& shape : shapes) {
+    shape->setInstances(instance_attributes[frame_index], instance_count);
+  }
+
+  if (graphics_pipeline_updated) {
+    graphics_pipeline_updated =
+        !window->sizeHasChanged() &&
+        graphics_pipeline_width == window->getFramebufferWidth() &&
+        graphics_pipeline_height == window->getFramebufferHeight();
+  }
+
+  if (!graphics_pipeline_updated) {
+    // Create each variant's pipeline from the first shape which uses it.
+    graphics_pipelines.assign(graphics_pipelines.size(),
+                              std::shared_ptr<GraphicsPipeline>());
+    const int32_t width = window->getFramebufferWidth();
+    const int32_t height = window->getFramebufferHeight();
+    graphics_pipeline_width = window->getFramebufferWidth();
+    graphics_pipeline_height = window->getFramebufferHeight();
+    for (size_t i = 0; i < shapes.size(); ++i) {
+      auto& graphics_pipeline =
+          graphics_pipelines[obj_mesh->pipeline_indices[i]];
+      if (graphics_pipeline.get()) {
+        continue;
+      }
+      graphics_pipeline.reset(new GraphicsPipeline());
+      graphics_pipeline->setViewPort(0, 0, static_cast<float>(width),
+                                     static_cast<float>(height), 0.0f, 1.0f);
+      graphics_pipeline->setScissor(0, 0, width, height);
+      graphics_pipeline->createGraphicsPipeline(
+          shapes[i], shaders[obj_mesh->shader_indices[i]]);
+    }
+    graphics_pipeline_updated = true;
+  }
+
+  // All shapes are culled together using the bounds of every instance.
+  BoundingBox<Eigen::Vector3f> local_bounding_box;
+  getLocalBoundingBox(local_bounding_box);
+  const Eigen::Vector3f center =
+      (local_bounding_box.max + local_bounding_box.min) * 0.5f;
+  const float depth = -(ubo_data.view * ubo_data.model).row(2).dot(
+      center.homogeneous());
+
+  DrawPacket draw_packet = {};
+  draw_packet.descriptor_set_index = static_cast<uint32_t>(frame_index);
+  draw_packet.depth = depth;
+  draw_packet.bounds =
+      Frustum::transformBoundingBox(ubo_data.model, local_bounding_box);
+  draw_packet.has_bounds = true;
+
+  // Textures may have been streamed or moved since the descriptor sets were
+  // written, see OBJMesh::update().
+  for (const auto& shader : shaders) {
+    shader->updateDescriptorSet(draw_packet.descriptor_set_index);
+  }
+
+  // Streamed textures are requested at the size of the nearest instance.
+  if (!obj_mesh->streamed_textures.empty()) {
+    const auto& mesh_bounding_box = obj_mesh->getBoundingBox();
+    const float instance_radius =
+        0.5f * (mesh_bounding_box.max - mesh_bounding_box.min).norm();
+    const float radius =
+        0.5f * (local_bounding_box.max - local_bounding_box.min).norm();
+    const float nearest_depth = depth - radius + instance_radius;
+    const float screen_size = OBJMesh::getScreenSize(
+        ubo_data.projection, static_cast<float>(window->getFramebufferHeight()),
+        instance_radius, nearest_depth);
+    for (const auto& texture : obj_mesh->shape_streamed_textures) {
+      if (texture.get()) {
+        texture->requestScreenSize(screen_size);
+      }
+    }
+  }
+
+  auto& render_queue = scene_state.getRenderQueue();
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    draw_packet.graphics_pipeline =
+        graphics_pipelines[obj_mesh->pipeline_indices[i]].get();
+    draw_packet.shader = shaders[obj_mesh->shader_indices[i]].get();
+    draw_packet.mesh = shapes[i].get();
+    draw_packet.draw_data_index = static_cast<uint32_t>(i);
+    render_queue.submit(draw_packet);
+  }
+
+  SceneObject::update(scene_state);
+}
@@ -0,0 +1,202 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/BufferBase.h>
+#include <VulkanEngine/MemoryDefragmenter.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+
+VulkanEngine::MemoryDefragmenter::MemoryDefragmenter()
+    : context(nullptr),
+      next_pool(0),
+      enabled(false),
+      pass_interval(30),
+      frames_since_pass(0),
+      max_bytes_per_pass(32ull << 20),
+      num_moved_allocations(0),
+      moved_bytes(0) {}
+
+VulkanEngine::MemoryDefragmenter::~MemoryDefragmenter() {}
+
+void VulkanEngine::MemoryDefragmenter::registerResource(
+    VmaAllocation vma_allocation, BufferBase* resource) {
+  std::lock_guard<std::mutex> lock(mutex);
+  resources[vma_allocation] = resource;
+}
+
+void VulkanEngine::MemoryDefragmenter::unregisterResource(
+    VmaAllocation vma_allocation) {
+  std::lock_guard<std::mutex> lock(mutex);
+  resources.erase(vma_allocation);
+}
+
+void VulkanEngine::MemoryDefragmenter::update() {
+  if (!enabled || ++frames_since_pass < pass_interval) {
+    return;
+  }
+
+  // Moving allocations stalls the frame, so wait until loading is done.
+  auto& vulkan_manager = VulkanManager::getInstance();
+  if (vulkan_manager.getTransferQueue().getNumPendingTransfers() > 0 ||
+      vulkan_manager.getTextureStreamer().getNumPendingLoads() > 0) {
+    return;
+  }
+
+  frames_since_pass = 0;
+  runPass();
+}
+
+bool VulkanEngine::MemoryDefragmenter::runPass() {
+  auto device = VulkanManager::getInstance().getDevice();
+  auto vma_allocator = device->getVmaAllocator();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!context && !beginDefragmentation()) {
+    return false;
+  }
+
+  VmaDefragmentationPassMoveInfo pass_info = {};
+  if (vmaBeginDefragmentationPass(vma_allocator, context, &pass_info) ==
+      VK_SUCCESS) {
+    endDefragmentation();
+    return false;
+  }
+
+  // The moved allocations may be used by the frames in flight.
+  device->waitIdle();
+
+  beginSingleUsageCommandBuffer();
+  moved_resources.clear();
+  for (uint32_t i = 0; i < pass_info.moveCount; ++i) {
+    auto& move = pass_info.pMoves[i];
+    auto resource = resources.find(move.srcAllocation);
+    if (resource == resources.end() ||
+        !resource->second->beginMove(single_use_command_buffer,
+                                     move.dstTmpAllocation)) {
+      move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+      continue;
+    }
+    moved_resources.push_back(resource->second);
+  }
+
+  // Make the copies visible to the frames recorded from now on.
+  auto memory_barrier =
+      vk::MemoryBarrier()
+          .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+          .setDstAccessMask(vk::AccessFlagBits::eMemoryRead);
+  single_use_command_buffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer,
+      vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags(),
+      memory_barrier, nullptr, nullptr);
+  endSingleUsageCommandBuffer();
+
+  // The old buffers and images must be destroyed before VMA frees the memory
+  // they are bound to.
+  for (auto resource : moved_resources) {
+    resource->endMove();
+    moved_bytes += resource->getAllocationSize();
+  }
+  num_moved_allocations += moved_resources.size();
+
+  if (vmaEndDefragmentationPass(vma_allocator, context, &pass_info) ==
+      VK_SUCCESS) {
+    endDefragmentation();
+  }
+
+  return !moved_resources.empty();
+}
+
+void VulkanEngine::MemoryDefragmenter::setEnabled(bool _enabled) {
+  enabled = _enabled;
+}
+
+bool VulkanEngine::MemoryDefragmenter::isEnabled() const { return enabled; }
+
+void VulkanEngine::MemoryDefragmenter::setPassInterval(
+    uint32_t _pass_interval) {
+  pass_interval = std::max(_pass_interval, 1u);
+}
+
+uint32_t VulkanEngine::MemoryDefragmenter::getPassInterval() const {
+  return pass_interval;
+}
+
+void VulkanEngine::MemoryDefragmenter::setMaxBytesPerPass(
+    vk::DeviceSize _max_bytes_per_pass) {
+  max_bytes_per_pass = _max_bytes_per_pass;
+}
+
+vk::DeviceSize VulkanEngine::MemoryDefragmenter::getMaxBytesPerPass() const {
+  return max_bytes_per_pass;
+}
+
+size_t VulkanEngine::MemoryDefragmenter::getNumResources() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return resources.size();
+}
+
+size_t VulkanEngine::MemoryDefragmenter::getNumMovedAllocations() const {
+  return num_moved_allocations;
+}
+
+vk::DeviceSize VulkanEngine::MemoryDefragmenter::getMovedBytes() const {
+  return moved_bytes;
+}
+
+void VulkanEngine::MemoryDefragmenter::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (context) {
+    endDefragmentation();
+  }
+  resources.clear();
+}
+
+bool VulkanEngine::MemoryDefragmenter::beginDefragmentation() {
+  auto device = VulkanManager::getInstance().getDevice();
+
+  // The transient pool uses the linear algorithm, which VMA can't
+  // defragment.
+  VmaPool vma_pool = nullptr;
+  if (next_pool++ % 2 == 1) {
+    vma_pool =
+        device->getMemoryPools().getVmaPool(MemoryPools::Pool::eGeometry);
+    if (!vma_pool) {
+      return false;
+    }
+  }
+
+  VmaDefragmentationInfo defragmentation_info = {};
+  defragmentation_info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+  defragmentation_info.pool = vma_pool;
+  defragmentation_info.maxBytesPerPass = max_bytes_per_pass;
+  defragmentation_info.maxAllocationsPerPass = kMaxAllocationsPerPass;
+
+  return vmaBeginDefragmentation(device->getVmaAllocator(),
+                                 &defragmentation_info,
+                                 &context) == VK_SUCCESS;
+}
+
+void VulkanEngine::MemoryDefragmenter::endDefragmentation() {
+  vmaEndDefragmentation(
+      VulkanManager::getInstance().getDevice()->getVmaAllocator(), context,
+      nullptr);
+  context = nullptr;
+}
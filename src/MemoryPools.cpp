@@ -0,0 +1,229 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/MemoryPools.h>
+
+VulkanEngine::MemoryPools::MemoryPools(VmaAllocator _vma_allocator,
+                                       const MemoryPoolSettings& _settings)
+    : vma_allocator(_vma_allocator),
+      settings(_settings),
+      geometry_pool(nullptr),
+      host_visible_pool(nullptr),
+      transient_pool(nullptr),
+      host_visible_memory_property_flags(0),
+      enabled(_settings.enabled),
+      num_fallbacks(0) {
+  VkMemoryPropertyFlags geometry_memory_property_flags = 0;
+  if (settings.geometry_block_size > 0) {
+    // Transfer source usage lets the MemoryDefragmenter copy the buffers.
+    geometry_pool = createPool(vk::BufferUsageFlagBits::eVertexBuffer |
+                                   vk::BufferUsageFlagBits::eIndexBuffer |
+                                   vk::BufferUsageFlagBits::eTransferSrc |
+                                   vk::BufferUsageFlagBits::eTransferDst,
+                               VMA_MEMORY_USAGE_GPU_ONLY, 0, 0,
+                               settings.geometry_block_size, 0,
+                               geometry_memory_property_flags);
+  }
+
+  // Both pools use the same memory type.
+  const auto host_visible_usage = vk::BufferUsageFlagBits::eUniformBuffer |
+                                  vk::BufferUsageFlagBits::eTransferSrc;
+  const VkMemoryPropertyFlags host_visible_required_flags =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  if (settings.host_visible_block_size > 0) {
+    host_visible_pool = createPool(
+        host_visible_usage, VMA_MEMORY_USAGE_CPU_TO_GPU,
+        host_visible_required_flags, 0, settings.host_visible_block_size, 0,
+        host_visible_memory_property_flags);
+  }
+
+  // A single block lets VMA use the linear pool as a ring buffer.
+  if (settings.transient_pool_size > 0) {
+    transient_pool = createPool(
+        host_visible_usage, VMA_MEMORY_USAGE_CPU_TO_GPU,
+        host_visible_required_flags, VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT,
+        settings.transient_pool_size, 1, host_visible_memory_property_flags);
+  }
+}
+
+VulkanEngine::MemoryPools::~MemoryPools() {
+  if (geometry_pool) {
+    vmaDestroyPool(vma_allocator, geometry_pool);
+  }
+  if (host_visible_pool) {
+    vmaDestroyPool(vma_allocator, host_visible_pool);
+  }
+  if (transient_pool) {
+    vmaDestroyPool(vma_allocator, transient_pool);
+  }
+}
+
+VkResult VulkanEngine::MemoryPools::createBuffer(
+    const VkBufferCreateInfo& buffer_create_info,
+    VmaAllocationCreateInfo allocation_create_info, VkBuffer* vk_buffer,
+    VmaAllocation* vma_allocation, bool transient) {
+  allocation_create_info.pool =
+      choosePool(buffer_create_info, allocation_create_info, transient);
+  if (allocation_create_info.pool) {
+    const auto result =
+        vmaCreateBuffer(vma_allocator, &buffer_create_info,
+                        &allocation_create_info, vk_buffer, vma_allocation,
+                        nullptr);
+    if (result == VK_SUCCESS) {
+      return result;
+    }
+    ++num_fallbacks;
+    allocation_create_info.pool = nullptr;
+  }
+
+  return vmaCreateBuffer(vma_allocator, &buffer_create_info,
+                         &allocation_create_info, vk_buffer, vma_allocation,
+                         nullptr);
+}
+
+VkResult VulkanEngine::MemoryPools::createImage(
+    const VkImageCreateInfo& image_create_info,
+    VmaAllocationCreateInfo allocation_create_info, VkImage* vk_image,
+    VmaAllocation* vma_allocation) {
+  if (enabled && settings.dedicated_attachments &&
+      (image_create_info.usage &
+       (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) != 0) {
+    allocation_create_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+  }
+
+  return vmaCreateImage(vma_allocator, &image_create_info,
+                        &allocation_create_info, vk_image, vma_allocation,
+                        nullptr);
+}
+
+void VulkanEngine::MemoryPools::setEnabled(bool _enabled) {
+  enabled = _enabled;
+}
+
+bool VulkanEngine::MemoryPools::isEnabled() const { return enabled; }
+
+vk::DeviceSize VulkanEngine::MemoryPools::getAllocatedBytes(Pool pool) const {
+  const VmaPool vma_pool = getVmaPool(pool);
+  if (!vma_pool) {
+    return 0;
+  }
+
+  VmaStatistics statistics;
+  vmaGetPoolStatistics(vma_allocator, vma_pool, &statistics);
+  return statistics.allocationBytes;
+}
+
+size_t VulkanEngine::MemoryPools::getNumFallbacks() const {
+  return num_fallbacks;
+}
+
+VmaPool VulkanEngine::MemoryPools::getVmaPool(Pool pool) const {
+  switch (pool) {
+    case Pool::eGeometry:
+      return geometry_pool;
+    case Pool::eHostVisible:
+      return host_visible_pool;
+    case Pool::eTransient:
+      return transient_pool;
+  }
+  return nullptr;
+}
+
+VmaPool VulkanEngine::MemoryPools::createPool(
+    vk::BufferUsageFlags buffer_usage_flags, VmaMemoryUsage vma_memory_usage,
+    VkMemoryPropertyFlags required_flags, VmaPoolCreateFlags flags,
+    vk::DeviceSize block_size, size_t max_block_count,
+    VkMemoryPropertyFlags& memory_property_flags) {
+  // Buffers of the same usage share their memory type requirements, so a
+  // small example buffer is enough to find the memory type of the pool.
+  auto buffer_create_info = static_cast<VkBufferCreateInfo>(
+      vk::BufferCreateInfo()
+          .setSize(1024)
+          .setUsage(buffer_usage_flags)
+          .setSharingMode(vk::SharingMode::eExclusive));
+
+  VmaAllocationCreateInfo allocation_create_info = {};
+  allocation_create_info.usage = vma_memory_usage;
+  allocation_create_info.requiredFlags = required_flags;
+
+  VmaPoolCreateInfo pool_create_info = {};
+  if (vmaFindMemoryTypeIndexForBufferInfo(
+          vma_allocator, &buffer_create_info, &allocation_create_info,
+          &pool_create_info.memoryTypeIndex) != VK_SUCCESS) {
+    return nullptr;
+  }
+  vmaGetMemoryTypeProperties(vma_allocator, pool_create_info.memoryTypeIndex,
+                             &memory_property_flags);
+
+  pool_create_info.flags = flags;
+  pool_create_info.blockSize = block_size;
+  pool_create_info.maxBlockCount = max_block_count;
+
+  VmaPool pool = nullptr;
+  if (vmaCreatePool(vma_allocator, &pool_create_info, &pool) != VK_SUCCESS) {
+    return nullptr;
+  }
+  return pool;
+}
+
+VmaPool VulkanEngine::MemoryPools::choosePool(
+    const VkBufferCreateInfo& buffer_create_info,
+    const VmaAllocationCreateInfo& allocation_create_info,
+    bool transient) const {
+  if (!enabled) {
+    return nullptr;
+  }
+
+  const vk::BufferUsageFlags usage(buffer_create_info.usage);
+  if (geometry_pool &&
+      allocation_create_info.usage == VMA_MEMORY_USAGE_GPU_ONLY &&
+      (usage & (vk::BufferUsageFlagBits::eVertexBuffer |
+                vk::BufferUsageFlagBits::eIndexBuffer))) {
+    return geometry_pool;
+  }
+
+  const bool host_visible =
+      allocation_create_info.usage == VMA_MEMORY_USAGE_CPU_TO_GPU ||
+      allocation_create_info.usage == VMA_MEMORY_USAGE_CPU_ONLY;
+  const bool uniform_or_staging =
+      (usage & vk::BufferUsageFlagBits::eUniformBuffer) ||
+      usage == vk::BufferUsageFlagBits::eTransferSrc;
+  if (!host_visible || !uniform_or_staging ||
+      (allocation_create_info.requiredFlags &
+       host_visible_memory_property_flags) !=
+          allocation_create_info.requiredFlags) {
+    return nullptr;
+  }
+
+  // Long lived buffers would never be freed in order and fill the linear
+  // pool for good, so only transient ones are allocated from it.
+  if (transient && transient_pool &&
+      buffer_create_info.size <= settings.transient_max_allocation_size) {
+    return transient_pool;
+  }
+  if (host_visible_pool &&
+      buffer_create_info.size <= settings.host_visible_max_allocation_size) {
+    return host_visible_pool;
+  }
+
+  return nullptr;
+}
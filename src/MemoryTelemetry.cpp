@@ -0,0 +1,193 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/MemoryTelemetry.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+VulkanEngine::MemoryTelemetry::MemoryTelemetry(VmaAllocator _vma_allocator)
+    : vma_allocator(_vma_allocator), bytes(0), peak_bytes(0) {}
+
+VulkanEngine::MemoryTelemetry::~MemoryTelemetry() {}
+
+void VulkanEngine::MemoryTelemetry::recordAllocation(
+    VmaAllocation vma_allocation, Category category) {
+  VmaAllocationInfo allocation_info;
+  vmaGetAllocationInfo(vma_allocator, vma_allocation, &allocation_info);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  allocations[vma_allocation] = {category, allocation_info.size};
+
+  auto& statistics = categories[static_cast<size_t>(category)];
+  ++statistics.allocation_count;
+  statistics.bytes += allocation_info.size;
+  statistics.peak_bytes = std::max(statistics.peak_bytes, statistics.bytes);
+
+  bytes += allocation_info.size;
+  peak_bytes = std::max(peak_bytes, bytes);
+}
+
+void VulkanEngine::MemoryTelemetry::recordFree(VmaAllocation vma_allocation) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = allocations.find(vma_allocation);
+  if (it == allocations.end()) {
+    return;
+  }
+
+  auto& statistics = categories[static_cast<size_t>(it->second.category)];
+  --statistics.allocation_count;
+  statistics.bytes -= it->second.size;
+  bytes -= it->second.size;
+  allocations.erase(it);
+}
+
+VulkanEngine::MemoryTelemetry::Snapshot
+VulkanEngine::MemoryTelemetry::getSnapshot() const {
+  Snapshot snapshot;
+
+  const VkPhysicalDeviceMemoryProperties* memory_properties = nullptr;
+  vmaGetMemoryProperties(vma_allocator, &memory_properties);
+  std::vector<VmaBudget> budgets(memory_properties->memoryHeapCount);
+  vmaGetHeapBudgets(vma_allocator, budgets.data());
+
+  for (uint32_t i = 0; i < memory_properties->memoryHeapCount; ++i) {
+    HeapStatistics heap;
+    heap.device_local = (memory_properties->memoryHeaps[i].flags &
+                         VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    heap.usage = budgets[i].usage;
+    heap.budget = budgets[i].budget;
+    heap.block_bytes = budgets[i].statistics.blockBytes;
+    heap.allocation_bytes = budgets[i].statistics.allocationBytes;
+    heap.block_count = budgets[i].statistics.blockCount;
+    heap.allocation_count = budgets[i].statistics.allocationCount;
+    snapshot.heaps.push_back(heap);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  snapshot.categories = categories;
+  snapshot.allocation_count = allocations.size();
+  snapshot.bytes = bytes;
+  snapshot.peak_bytes = peak_bytes;
+  return snapshot;
+}
+
+bool VulkanEngine::MemoryTelemetry::writeJSON(
+    const std::filesystem::path& path) const {
+  std::ofstream file(path);
+  if (!file) {
+    return false;
+  }
+  file << getSnapshot().toJSON();
+  return static_cast<bool>(file);
+}
+
+void VulkanEngine::MemoryTelemetry::resetPeaks() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto& statistics : categories) {
+    statistics.peak_bytes = statistics.bytes;
+  }
+  peak_bytes = bytes;
+}
+
+VulkanEngine::MemoryTelemetry::Category
+VulkanEngine::MemoryTelemetry::getBufferCategory(
+    vk::BufferUsageFlags usage_flags, VmaMemoryUsage vma_memory_usage) {
+  if (usage_flags & vk::BufferUsageFlagBits::eVertexBuffer) {
+    return Category::eVertex;
+  } else if (usage_flags & vk::BufferUsageFlagBits::eIndexBuffer) {
+    return Category::eIndex;
+  } else if (usage_flags & vk::BufferUsageFlagBits::eUniformBuffer) {
+    return Category::eUniform;
+  } else if (usage_flags == vk::BufferUsageFlagBits::eTransferSrc &&
+             vma_memory_usage == VMA_MEMORY_USAGE_CPU_ONLY) {
+    return Category::eStaging;
+  }
+  return Category::eOther;
+}
+
+VulkanEngine::MemoryTelemetry::Category
+VulkanEngine::MemoryTelemetry::getImageCategory(
+    vk::ImageUsageFlags usage_flags) {
+  if (usage_flags & (vk::ImageUsageFlagBits::eColorAttachment |
+                     vk::ImageUsageFlagBits::eDepthStencilAttachment)) {
+    return Category::eAttachment;
+  }
+  return Category::eTexture;
+}
+
+const char* VulkanEngine::MemoryTelemetry::getCategoryName(Category category) {
+  switch (category) {
+    case Category::eVertex:
+      return "vertex";
+    case Category::eIndex:
+      return "index";
+    case Category::eUniform:
+      return "uniform";
+    case Category::eStaging:
+      return "staging";
+    case Category::eTexture:
+      return "texture";
+    case Category::eAttachment:
+      return "attachment";
+    default:
+      return "other";
+  }
+}
+
+std::string VulkanEngine::MemoryTelemetry::Snapshot::toJSON() const {
+  std::stringstream json;
+  json << "{\n"
+       << "  \"allocation_count\": " << allocation_count << ",\n"
+       << "  \"bytes\": " << bytes << ",\n"
+       << "  \"peak_bytes\": " << peak_bytes << ",\n"
+       << "  \"categories\": {\n";
+
+  for (size_t i = 0; i < kNumCategories; ++i) {
+    const auto& statistics = categories[i];
+    json << "    \"" << getCategoryName(static_cast<Category>(i))
+         << "\": {\"allocation_count\": " << statistics.allocation_count
+         << ", \"bytes\": " << statistics.bytes
+         << ", \"peak_bytes\": " << statistics.peak_bytes << "}"
+         << (i + 1 < kNumCategories ? ",\n" : "\n");
+  }
+
+  json << "  },\n"
+       << "  \"heaps\": [\n";
+
+  for (size_t i = 0; i < heaps.size(); ++i) {
+    const auto& heap = heaps[i];
+    json << "    {\"device_local\": "
+         << (heap.device_local ? "true" : "false")
+         << ", \"usage\": " << heap.usage << ", \"budget\": " << heap.budget
+         << ", \"block_bytes\": " << heap.block_bytes
+         << ", \"allocation_bytes\": " << heap.allocation_bytes
+         << ", \"block_count\": " << heap.block_count
+         << ", \"allocation_count\": " << heap.allocation_count << "}"
+         << (i + 1 < heaps.size() ? ",\n" : "\n");
+  }
+
+  json << "  ]\n"
+       << "}\n";
+  return json.str();
+}
@@ -22,6 +22,7 @@
 #define MESH_CPP
 
 #include <VulkanEngine/BoundingBox.h>
+#include <VulkanEngine/FrameStatistics.h>
 #include <VulkanEngine/Mesh.h>
 #include <VulkanEngine/Utilities.h>
 
@@ -32,7 +33,11 @@
 template <typename PositionType, typename IndexType,
           class... AdditionalAttributeTypes>
 VulkanEngine::Mesh<PositionType, IndexType, AdditionalAttributeTypes...>::Mesh()
-    : pipeline_input_state_info_initialized(false) {
+    : pipeline_input_state_info_initialized(false),
+      has_draw_range(false),
+      first_index(0),
+      index_count(0),
+      vertex_offset(0) {
   bounding_box.reset(new BoundingBox<PositionType>());
 }
 
@@ -84,6 +89,17 @@ void VulkanEngine::Mesh<PositionType, IndexType, AdditionalAttributeTypes...>::
   downcast_bbox->min = min;
 }
 
+template <typename PositionType, typename IndexType,
+          class... AdditionalAttributeTypes>
+void VulkanEngine::Mesh<PositionType, IndexType, AdditionalAttributeTypes...>::
+    setDrawRange(uint32_t _first_index, uint32_t _index_count,
+                 int32_t _vertex_offset) {
+  has_draw_range = true;
+  first_index = _first_index;
+  index_count = _index_count;
+  vertex_offset = _vertex_offset;
+}
+
 template <typename PositionType, typename IndexType,
           class... AdditionalAttributeTypes>
 const vk::PipelineVertexInputStateCreateInfo& VulkanEngine::Mesh<
@@ -97,8 +113,11 @@ const vk::PipelineVertexInputStateCreateInfo& VulkanEngine::Mesh<
 
   binding_descriptions.push_back(
       positions->getVkVertexInputBindingDescription(binding_index));
-  attribute_descriptions.push_back(
-      positions->getVkVertexInputAttributeDescriptions(binding_index));
+  const auto position_descriptions =
+      positions->getVkVertexInputAttributeDescriptions(binding_index);
+  attribute_descriptions.insert(attribute_descriptions.end(),
+                                position_descriptions.begin(),
+                                position_descriptions.end());
 
   auto visitor = [this, &binding_index](const auto& attrib_vec) {
     for (const auto& attrib : attrib_vec) {
@@ -106,8 +125,10 @@ const vk::PipelineVertexInputStateCreateInfo& VulkanEngine::Mesh<
         ++binding_index;
         binding_descriptions.push_back(
             attrib->getVkVertexInputBindingDescription(binding_index));
-        attribute_descriptions.push_back(
-            attrib->getVkVertexInputAttributeDescriptions(binding_index));
+        const auto descriptions =
+            attrib->getVkVertexInputAttributeDescriptions(binding_index);
+        attribute_descriptions.insert(attribute_descriptions.end(),
+                                      descriptions.begin(), descriptions.end());
       }
     }
   };
@@ -207,12 +228,64 @@ template <typename PositionType, typename IndexType,
 void VulkanEngine::Mesh<PositionType, IndexType, AdditionalAttributeTypes...>::
     draw(const vk::CommandBuffer& command_buffer) {
   if (indices.get()) {
-    command_buffer.drawIndexed(static_cast<uint32_t>(indices->getNumElements()),
-                               1, 0, 0, 0);
+    const auto command = getDrawIndexedIndirectCommand();
+    command_buffer.drawIndexed(command.indexCount, command.instanceCount,
+                               command.firstIndex, command.vertexOffset,
+                               command.firstInstance);
+    VULKANENGINE_COUNT_STATISTIC(
+        eTriangles, command.indexCount / 3 * command.instanceCount);
   } else {
-    command_buffer.draw(static_cast<uint32_t>(positions->getNumElements()), 1,
-                        0, 0);
+    const auto command = getDrawIndirectCommand();
+    command_buffer.draw(command.vertexCount, command.instanceCount,
+                        command.firstVertex, command.firstInstance);
+    VULKANENGINE_COUNT_STATISTIC(eTriangles, command.vertexCount / 3);
   }
+  VULKANENGINE_COUNT_STATISTIC(eDrawCalls, 1);
+}
+
+template <typename PositionType, typename IndexType,
+          class... AdditionalAttributeTypes>
+bool VulkanEngine::Mesh<PositionType, IndexType,
+                        AdditionalAttributeTypes...>::isIndexed() const {
+  return indices.get() != nullptr;
+}
+
+template <typename PositionType, typename IndexType,
+          class... AdditionalAttributeTypes>
+vk::DrawIndexedIndirectCommand
+VulkanEngine::Mesh<PositionType, IndexType,
+                   AdditionalAttributeTypes...>::getDrawIndexedIndirectCommand()
+    const {
+  if (!has_draw_range) {
+    return vk::DrawIndexedIndirectCommand()
+        .setIndexCount(static_cast<uint32_t>(indices->getNumElements()))
+        .setInstanceCount(1);
+  }
+
+  return vk::DrawIndexedIndirectCommand()
+      .setIndexCount(index_count)
+      .setInstanceCount(1)
+      .setFirstIndex(first_index)
+      .setVertexOffset(vertex_offset);
+}
+
+template <typename PositionType, typename IndexType,
+          class... AdditionalAttributeTypes>
+vk::DrawIndirectCommand
+VulkanEngine::Mesh<PositionType, IndexType,
+                   AdditionalAttributeTypes...>::getDrawIndirectCommand()
+    const {
+  return vk::DrawIndirectCommand()
+      .setVertexCount(static_cast<uint32_t>(positions->getNumElements()))
+      .setInstanceCount(1);
+}
+
+template <typename PositionType, typename IndexType,
+          class... AdditionalAttributeTypes>
+const void* VulkanEngine::Mesh<PositionType, IndexType,
+                               AdditionalAttributeTypes...>::getGeometryId()
+    const {
+  return positions.get();
 }
 
 #endif /* MESH_CPP */
@@ -0,0 +1,425 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/ComputePipeline.h>
+#include <VulkanEngine/Descriptor.h>
+#include <VulkanEngine/MipmapGenerator.h>
+#include <VulkanEngine/Shader.h>
+#include <VulkanEngine/ShaderModule.h>
+#include <VulkanEngine/StorageBuffer.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// Binds one view per level as an array of storage images.
+class StorageImageDescriptor : public VulkanEngine::Descriptor {
+ public:
+  StorageImageDescriptor(uint32_t _binding,
+                         const std::vector<vk::ImageView>& _vk_image_views)
+      : Descriptor(_binding, static_cast<uint32_t>(_vk_image_views.size()),
+                   vk::DescriptorType::eStorageImage,
+                   vk::ShaderStageFlagBits::eCompute),
+        vk_image_views(_vk_image_views) {}
+
+  void appendVkDescriptorSets(
+      std::shared_ptr<std::vector<vk::WriteDescriptorSet>>
+          write_descriptor_sets,
+      std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
+      const vk::DescriptorSet& destination_set) override {
+    vk_descriptor_image_infos.clear();
+    for (const auto& vk_image_view : vk_image_views) {
+      vk_descriptor_image_infos.push_back(
+          vk::DescriptorImageInfo()
+              .setImageView(vk_image_view)
+              .setImageLayout(vk::ImageLayout::eGeneral));
+    }
+
+    write_descriptor_sets->push_back(
+        vk::WriteDescriptorSet()
+            .setDstBinding(binding)
+            .setDstArrayElement(0)
+            .setDstSet(destination_set)
+            .setDescriptorType(vk_descriptor_type)
+            .setDescriptorCount(
+                static_cast<uint32_t>(vk_descriptor_image_infos.size()))
+            .setPImageInfo(vk_descriptor_image_infos.data()));
+  }
+
+ private:
+  std::vector<vk::ImageView> vk_image_views;
+  std::vector<vk::DescriptorImageInfo> vk_descriptor_image_infos;
+};
+
+/// The width and height of the tile of level 0 reduced by a work group.
+constexpr uint32_t kTileSize = 64;
+
+/// The number of levels below the source level written by one reduction.
+constexpr uint32_t kLevelsPerReduction = 6;
+
+/// Append a GLSL function which reduces a 64x64 tile of a source level to the
+/// following levels, up to 6 of them. Each of the 256 invocations computes
+/// 2x2 texels of the first level and one texel of the second, further levels
+/// are reduced from a 16x16 tile in shared memory. Image array indices must
+/// be constant, so the function is unrolled per level.
+/// \param shader_string The stream to append to.
+/// \param source_level The level to reduce from.
+/// \param last_level The last level of the image.
+void appendReduceFunction(std::stringstream& shader_string,
+                          uint32_t source_level, uint32_t last_level) {
+  const uint32_t s = source_level;
+  const uint32_t end =
+      std::min(source_level + kLevelsPerReduction, last_level);
+
+  shader_string
+      << "void reduceFrom" << s << "(ivec2 group) {\n"
+      << "  uint index = gl_LocalInvocationIndex;\n"
+      << "  ivec2 thread = ivec2(index % 16u, index / 16u);\n"
+      << "  ivec2 source_size = imageSize(levels[" << s << "]);\n"
+      << "  ivec2 size = imageSize(levels[" << s + 1 << "]);\n"
+      << "  vec4 sum = vec4(0.0);\n"
+      << "  for (int i = 0; i < 4; ++i) {\n"
+      << "    ivec2 coord = group * 32 + thread * 2 + ivec2(i & 1, i >> 1);\n"
+      << "    ivec2 src = min(coord, size - 1) * 2;\n"
+      << "    vec4 color = 0.25 * (\n";
+  const char* offsets[4] = {"ivec2(0, 0)", "ivec2(1, 0)", "ivec2(0, 1)",
+                            "ivec2(1, 1)"};
+  for (uint32_t i = 0; i < 4; ++i) {
+    shader_string << "        decode(imageLoad(levels[" << s << "], min(src + "
+                  << offsets[i] << ", source_size - 1)))"
+                  << (i < 3 ? " +\n" : ");\n");
+  }
+  shader_string << "    if (all(lessThan(coord, size))) {\n"
+                << "      imageStore(levels[" << s + 1
+                << "], coord, encode(color));\n"
+                << "    }\n"
+                << "    sum += color;\n"
+                << "  }\n";
+
+  if (s + 2 > end) {
+    shader_string << "}\n";
+    return;
+  }
+
+  shader_string << "  ivec2 coord = group * 16 + thread;\n"
+                << "  vec4 color = 0.25 * sum;\n"
+                << "  if (all(lessThan(coord, imageSize(levels[" << s + 2
+                << "])))) {\n"
+                << "    imageStore(levels[" << s + 2
+                << "], coord, encode(color));\n"
+                << "  }\n"
+                << "  tile[thread.y][thread.x] = color;\n";
+
+  // Sources are clamped to the size of the level above, so the sources of
+  // texels inside of the image lie in the part of the tile written by this
+  // group. In a partial last group, texels outside of the image may have
+  // sources before that part, which are clamped to the tile as well. Their
+  // results are never stored.
+  for (uint32_t level = s + 3; level <= end; ++level) {
+    const uint32_t n = 16u >> (level - s - 2);
+    shader_string
+        << "  barrier();\n"
+        << "  {\n"
+        << "    bool active = index < " << n * n << "u;\n"
+        << "    ivec2 local = ivec2(index % " << n << "u, index / " << n
+        << "u);\n"
+        << "    ivec2 coord = group * " << n << " + local;\n"
+        << "    vec4 color = vec4(0.0);\n"
+        << "    if (active) {\n"
+        << "      ivec2 source_size = imageSize(levels[" << level - 1
+        << "]);\n"
+        << "      for (int i = 0; i < 4; ++i) {\n"
+        << "        ivec2 src = max(min(coord * 2 + ivec2(i & 1, i >> 1),\n"
+        << "                            source_size - 1) - group * " << 2 * n
+        << ", ivec2(0));\n"
+        << "        color += 0.25 * tile[src.y][src.x];\n"
+        << "      }\n"
+        << "    }\n"
+        << "    barrier();\n"
+        << "    if (active) {\n"
+        << "      tile[local.y][local.x] = color;\n"
+        << "      if (all(lessThan(coord, imageSize(levels[" << level
+        << "])))) {\n"
+        << "        imageStore(levels[" << level
+        << "], coord, encode(color));\n"
+        << "      }\n"
+        << "    }\n"
+        << "  }\n";
+  }
+  shader_string << "}\n";
+}
+
+}  // namespace
+
+VulkanEngine::MipmapGenerator::ImageResources::~ImageResources() {
+  VulkanManager::getInstance().getDeletionQueue().enqueue(
+      [level_views = std::move(level_views)]() {
+        const auto& vk_device =
+            VulkanManager::getInstance().getDevice()->getVkDevice();
+        for (const auto& level_view : level_views) {
+          vk_device.destroyImageView(level_view);
+        }
+      });
+}
+
+VulkanEngine::MipmapGenerator::MipmapGenerator() {}
+
+VulkanEngine::MipmapGenerator::~MipmapGenerator() {}
+
+bool VulkanEngine::MipmapGenerator::supports(vk::Format format,
+                                             uint32_t width,
+                                             uint32_t height) const {
+  FormatInfo format_info;
+  if (!getFormatInfo(format, format_info) ||
+      std::max(width, height) > kMaxSize) {
+    return false;
+  }
+
+  // sRGB images rely on vk::ImageCreateFlagBits::eExtendedUsage and
+  // vk::ImageViewUsageCreateInfo, which are core in Vulkan 1.1.
+  const auto& device = VulkanManager::getInstance().getDevice();
+  return device->getApiVersion() >= VK_API_VERSION_1_1 &&
+         device->supportsStorageImageFormat(format_info.storage_format);
+}
+
+vk::ImageCreateFlags VulkanEngine::MipmapGenerator::getImageCreateFlags(
+    vk::Format format) {
+  FormatInfo format_info;
+  if (getFormatInfo(format, format_info) && format_info.srgb) {
+    // Allows views with the UNORM format, and storage usage even though the
+    // sRGB format itself doesn't support it.
+    return vk::ImageCreateFlagBits::eMutableFormat |
+           vk::ImageCreateFlagBits::eExtendedUsage;
+  }
+  return vk::ImageCreateFlags();
+}
+
+void VulkanEngine::MipmapGenerator::generate(
+    const vk::CommandBuffer& command_buffer, vk::Image image,
+    vk::Format format, uint32_t width, uint32_t height, uint32_t mip_levels,
+    std::shared_ptr<ImageResources>& resources) {
+  FormatInfo format_info;
+  if (!getFormatInfo(format, format_info)) {
+    throw std::runtime_error("Format not supported by the MipmapGenerator!");
+  }
+
+  if (!resources.get()) {
+    const auto& vk_device =
+        VulkanManager::getInstance().getDevice()->getVkDevice();
+
+    resources = std::make_shared<ImageResources>();
+    for (uint32_t i = 0; i < mip_levels; ++i) {
+      auto subresource_range =
+          vk::ImageSubresourceRange()
+              .setAspectMask(vk::ImageAspectFlagBits::eColor)
+              .setBaseMipLevel(i)
+              .setLevelCount(1)
+              .setBaseArrayLayer(0)
+              .setLayerCount(1);
+
+      auto image_view_create_info =
+          vk::ImageViewCreateInfo()
+              .setFormat(format_info.storage_format)
+              .setImage(image)
+              .setViewType(vk::ImageViewType::e2D)
+              .setSubresourceRange(subresource_range);
+
+      resources->level_views.push_back(
+          vk_device.createImageView(image_view_create_info));
+    }
+
+    resources->counter.reset(
+        new StorageBuffer<uint32_t>(1, 1, vk::ShaderStageFlagBits::eCompute));
+    const uint32_t zero = 0;
+    resources->counter->updateBuffer(&zero, sizeof(zero));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& variant = variants[std::make_pair(format, mip_levels)];
+    if (!variant.shader_module.get()) {
+      variant.shader_module.reset(
+          new ShaderModule(getComputeShaderString(format_info, mip_levels),
+                           false, vk::ShaderStageFlagBits::eCompute));
+    }
+
+    resources->shader.reset(new Shader({variant.shader_module}));
+    resources->shader->setDescriptors(
+        {{std::make_shared<StorageImageDescriptor>(0, resources->level_views),
+          resources->counter}});
+
+    // All images of a variant use identical descriptor set layouts, so the
+    // pipeline created from the first one is compatible with all of them.
+    if (!variant.compute_pipeline.get()) {
+      variant.compute_pipeline.reset(new ComputePipeline());
+      variant.compute_pipeline->createComputePipeline(resources->shader);
+    }
+    resources->compute_pipeline = variant.compute_pipeline;
+  }
+
+  auto subresource_range = vk::ImageSubresourceRange()
+                               .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                               .setBaseMipLevel(0)
+                               .setLevelCount(mip_levels)
+                               .setBaseArrayLayer(0)
+                               .setLayerCount(1);
+
+  auto image_memory_barrier =
+      vk::ImageMemoryBarrier()
+          .setImage(image)
+          .setSubresourceRange(subresource_range)
+          .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+          .setNewLayout(vk::ImageLayout::eGeneral)
+          .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+          .setDstAccessMask(vk::AccessFlagBits::eShaderRead |
+                            vk::AccessFlagBits::eShaderWrite)
+          .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+          .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+
+  command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                 vk::PipelineStageFlagBits::eComputeShader,
+                                 vk::DependencyFlags(), nullptr, nullptr,
+                                 image_memory_barrier);
+
+  resources->compute_pipeline->bindPipeline(command_buffer);
+  resources->shader->bindDescriptorSet(command_buffer, 0,
+                                       vk::PipelineBindPoint::eCompute);
+  resources->compute_pipeline->dispatch(
+      command_buffer, (width + kTileSize - 1) / kTileSize,
+      (height + kTileSize - 1) / kTileSize);
+
+  image_memory_barrier.setOldLayout(vk::ImageLayout::eGeneral)
+      .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+      .setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+      .setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+
+  command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                 vk::PipelineStageFlagBits::eFragmentShader,
+                                 vk::DependencyFlags(), nullptr, nullptr,
+                                 image_memory_barrier);
+}
+
+void VulkanEngine::MipmapGenerator::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  variants.clear();
+}
+
+bool VulkanEngine::MipmapGenerator::getFormatInfo(vk::Format format,
+                                                  FormatInfo& format_info) {
+  switch (format) {
+    case vk::Format::eR8G8B8A8Unorm:
+      format_info = {vk::Format::eR8G8B8A8Unorm, "rgba8", false};
+      return true;
+    case vk::Format::eR8G8B8A8Srgb:
+      format_info = {vk::Format::eR8G8B8A8Unorm, "rgba8", true};
+      return true;
+    case vk::Format::eR8G8Unorm:
+      format_info = {vk::Format::eR8G8Unorm, "rg8", false};
+      return true;
+    case vk::Format::eR8Unorm:
+      format_info = {vk::Format::eR8Unorm, "r8", false};
+      return true;
+    case vk::Format::eR16G16B16A16Sfloat:
+      format_info = {vk::Format::eR16G16B16A16Sfloat, "rgba16f", false};
+      return true;
+    case vk::Format::eR32G32B32A32Sfloat:
+      format_info = {vk::Format::eR32G32B32A32Sfloat, "rgba32f", false};
+      return true;
+    case vk::Format::eR32Sfloat:
+      format_info = {vk::Format::eR32Sfloat, "r32f", false};
+      return true;
+    default:
+      return false;
+  }
+}
+
+const std::string VulkanEngine::MipmapGenerator::getComputeShaderString(
+    const FormatInfo& format_info, uint32_t mip_levels) {
+  std::stringstream return_string;
+  const uint32_t last_level = mip_levels - 1;
+
+  return_string
+      << "#version 450\n"
+      << "layout(local_size_x = 256) in;\n"
+      << "layout(binding = 0, " << format_info.glsl_format
+      << ") uniform coherent image2D levels[" << mip_levels << "];\n"
+      << "layout(std430, binding = 1) coherent buffer Counter {\n"
+      << "  uint counter;\n"
+      << "};\n"
+      << "shared vec4 tile[16][16];\n"
+      << "shared bool is_last;\n";
+
+  // Texels are averaged in linear space.
+  if (format_info.srgb) {
+    return_string
+        << "vec4 decode(vec4 texel) {\n"
+        << "  bvec3 cutoff = lessThanEqual(texel.rgb, vec3(0.04045));\n"
+        << "  vec3 high = pow((texel.rgb + 0.055) / 1.055, vec3(2.4));\n"
+        << "  return vec4(mix(high, texel.rgb / 12.92, cutoff), texel.a);\n"
+        << "}\n"
+        << "vec4 encode(vec4 color) {\n"
+        << "  vec3 rgb = clamp(color.rgb, 0.0, 1.0);\n"
+        << "  bvec3 cutoff = lessThanEqual(rgb, vec3(0.0031308));\n"
+        << "  vec3 high = 1.055 * pow(rgb, vec3(1.0 / 2.4)) - 0.055;\n"
+        << "  return vec4(mix(high, rgb * 12.92, cutoff), color.a);\n"
+        << "}\n";
+  } else {
+    return_string << "vec4 decode(vec4 texel) { return texel; }\n"
+                  << "vec4 encode(vec4 color) { return color; }\n";
+  }
+
+  appendReduceFunction(return_string, 0, last_level);
+  if (last_level > kLevelsPerReduction) {
+    appendReduceFunction(return_string, kLevelsPerReduction, last_level);
+  }
+
+  return_string << "void main() {\n"
+                << "  reduceFrom0(ivec2(gl_WorkGroupID.xy));\n";
+
+  if (last_level > kLevelsPerReduction) {
+    // Level 6 is written by the first invocation of each work group, which
+    // makes it visible before counting the group as done. The last group to
+    // finish reduces level 6 of the whole image.
+    return_string
+        << "  if (gl_LocalInvocationIndex == 0u) {\n"
+        << "    memoryBarrierImage();\n"
+        << "    uint num_groups = gl_NumWorkGroups.x * gl_NumWorkGroups.y;\n"
+        << "    is_last = atomicAdd(counter, 1u) == num_groups - 1u;\n"
+        << "  }\n"
+        << "  barrier();\n"
+        << "  if (!is_last) {\n"
+        << "    return;\n"
+        << "  }\n"
+        << "  memoryBarrierImage();\n"
+        << "  if (gl_LocalInvocationIndex == 0u) {\n"
+        << "    counter = 0u;\n"
+        << "  }\n"
+        << "  reduceFrom" << kLevelsPerReduction << "(ivec2(0));\n";
+  }
+
+  return_string << "}\n";
+
+  return return_string.str();
+}
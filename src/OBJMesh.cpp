@@ -18,24 +18,32 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <VulkanEngine/AssetRegistry.h>
 #include <VulkanEngine/Mesh.h>
 #include <VulkanEngine/MeshBase.h>
 #include <VulkanEngine/OBJMesh.h>
+#include <VulkanEngine/Profiler.h>
 #include <VulkanEngine/Scene.h>
 #include <VulkanEngine/ShaderImage.h>
-#include <VulkanEngine/SingleUsageCommandBuffer.h>
+#include <VulkanEngine/TextureFile.h>
+#include <VulkanEngine/TextureImage.h>
 #include <VulkanEngine/Utilities.h>
 #include <VulkanEngine/VulkanManager.h>
 
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <filesystem>
 #include <functional>
 #include <future>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <string>
+#include <system_error>
 #include <thread>
 #include <tuple>
 #include <unordered_map>
@@ -49,10 +57,22 @@
 
 namespace OBJMeshInternal {
 
-template <typename IndexType>
+/// Vertex data of a single shape. Indices are relative to the shape's first
+/// vertex.
+struct ShapeData {
+  std::vector<Eigen::Vector3f> positions;
+  std::vector<Eigen::Vector3f> normals;
+  std::vector<Eigen::Vector2f> texcoords;
+  std::vector<uint32_t> indices;
+  Eigen::Vector3f max_position;
+  Eigen::Vector3f min_position;
+};
+
 void getShape(const tinyobj::shape_t& shape, const tinyobj::attrib_t& attrib,
-              std::vector<std::shared_ptr<VulkanEngine::MeshBase>>& meshes,
-              const size_t index) {
+              std::vector<ShapeData>& shape_data, const size_t index) {
+  VULKANENGINE_PROFILE_SCOPE("OBJMesh::getShape");
+  using IndexType = uint32_t;
+
   using Vertex = std::tuple<const Eigen::Vector3f&, const Eigen::Vector3f&,
                             const Eigen::Vector2f&>;
   std::unordered_map<Vertex, size_t> unique_vertices;
@@ -145,6 +165,7 @@ void getShape(const tinyobj::shape_t& shape, const tinyobj::attrib_t& attrib,
   }
 
   if (!has_normals) {
+    VULKANENGINE_PROFILE_SCOPE("OBJMesh::computeNormals");
     normals = std::vector<Eigen::Vector3f>(positions.size(),
                                            Eigen::Vector3f(0.0f, 0.0f, 0.0f));
     for (size_t i = 0; i < indices.size(); i += 3) {
@@ -173,44 +194,101 @@ void getShape(const tinyobj::shape_t& shape, const tinyobj::attrib_t& attrib,
     has_normals = true;
   }
 
-  using MeshType = VulkanEngine::Mesh<Eigen::Vector3f, IndexType,
+  // All shapes share the same vertex buffers, so every vertex needs a normal
+  // and texture coordinate.
+  normals.resize(positions.size(), Eigen::Vector3f(0.0f, 0.0f, 0.0f));
+  texcoords.resize(positions.size(), Eigen::Vector2f(0.0f, 0.0f));
+
+  auto& data = shape_data[index];
+  data.positions = std::move(positions);
+  data.normals = std::move(normals);
+  data.texcoords = std::move(texcoords);
+  data.indices = std::move(indices);
+  data.max_position = max_position;
+  data.min_position = min_position;
+}
+
+/// Concatenate the vertex data of all shapes into one set of vertex and index
+/// buffers and create a Mesh for each shape which draws its part of them.
+/// This lets the draws of all shapes be merged into indirect draws.
+void createMeshes(
+    const std::vector<ShapeData>& shape_data,
+    std::vector<std::shared_ptr<VulkanEngine::MeshBase>>& meshes) {
+  VULKANENGINE_PROFILE_SCOPE("OBJMesh::createMeshes");
+  using MeshType = VulkanEngine::Mesh<Eigen::Vector3f, uint32_t,
                                       Eigen::Vector3f, Eigen::Vector2f>;
 
+  size_t num_vertices = 0;
+  size_t num_indices = 0;
+  for (const auto& data : shape_data) {
+    num_vertices += data.positions.size();
+    num_indices += data.indices.size();
+  }
+
+  if (num_indices == 0) {
+    throw std::runtime_error("OBJ file does not contain any faces.");
+  }
+
+  std::vector<Eigen::Vector3f> positions;
+  positions.reserve(num_vertices);
+  std::vector<Eigen::Vector3f> normals;
+  normals.reserve(num_vertices);
+  std::vector<Eigen::Vector2f> texcoords;
+  texcoords.reserve(num_vertices);
+  std::vector<uint32_t> indices;
+  indices.reserve(num_indices);
+
+  for (const auto& data : shape_data) {
+    positions.insert(positions.end(), data.positions.begin(),
+                     data.positions.end());
+    normals.insert(normals.end(), data.normals.begin(), data.normals.end());
+    texcoords.insert(texcoords.end(), data.texcoords.begin(),
+                     data.texcoords.end());
+    indices.insert(indices.end(), data.indices.begin(), data.indices.end());
+  }
+
   std::shared_ptr<VulkanEngine::VertexAttribute<Eigen::Vector3f>>
       position_attribute(new VulkanEngine::VertexAttribute<Eigen::Vector3f>(
           positions.data(), positions.size(), 0, vk::Format::eR32G32B32Sfloat));
 
-  std::shared_ptr<VulkanEngine::IndexAttribute<IndexType>> index_attribute(
-      new VulkanEngine::IndexAttribute<IndexType>(indices.data(),
-                                                  indices.size()));
+  std::shared_ptr<VulkanEngine::IndexAttribute<uint32_t>> index_attribute(
+      new VulkanEngine::IndexAttribute<uint32_t>(indices.data(),
+                                                 indices.size()));
 
   typename MeshType::template AttributeContainer<Eigen::Vector3f>
       normal_attribute;
-  if (!normals.empty()) {
-    normal_attribute.emplace_back(
-        new VulkanEngine::VertexAttribute<Eigen::Vector3f>(
-            normals.data(), normals.size(), 1, vk::Format::eR32G32B32Sfloat));
-  }
+  normal_attribute.emplace_back(
+      new VulkanEngine::VertexAttribute<Eigen::Vector3f>(
+          normals.data(), normals.size(), 1, vk::Format::eR32G32B32Sfloat));
 
   typename MeshType::template AttributeContainer<Eigen::Vector2f>
       texcoord_attribute;
-  if (!texcoords.empty()) {
-    texcoord_attribute.emplace_back(
-        new VulkanEngine::VertexAttribute<Eigen::Vector2f>(
-            texcoords.data(), texcoords.size(), 2, vk::Format::eR32G32Sfloat));
-  }
+  texcoord_attribute.emplace_back(
+      new VulkanEngine::VertexAttribute<Eigen::Vector2f>(
+          texcoords.data(), texcoords.size(), 2, vk::Format::eR32G32Sfloat));
 
   // AttributeContainer for additional attributes (normals and texcoords)
   std::tuple<typename MeshType::template AttributeContainer<Eigen::Vector3f>,
              typename MeshType::template AttributeContainer<Eigen::Vector2f>>
       additional_attributes(normal_attribute, texcoord_attribute);
 
-  auto mesh = std::make_shared<MeshType>();
-  mesh->setPositions(position_attribute);
-  mesh->setIndices(index_attribute);
-  mesh->setAttributes(additional_attributes);
-  mesh->setBoundingBox(max_position, min_position);
-  meshes[index] = mesh;
+  uint32_t first_index = 0;
+  int32_t vertex_offset = 0;
+  for (size_t i = 0; i < shape_data.size(); ++i) {
+    const auto& data = shape_data[i];
+    const auto index_count = static_cast<uint32_t>(data.indices.size());
+
+    auto mesh = std::make_shared<MeshType>();
+    mesh->setPositions(position_attribute);
+    mesh->setIndices(index_attribute);
+    mesh->setAttributes(additional_attributes);
+    mesh->setDrawRange(first_index, index_count, vertex_offset);
+    mesh->setBoundingBox(data.max_position, data.min_position);
+    meshes[i] = mesh;
+
+    first_index += index_count;
+    vertex_offset += static_cast<int32_t>(data.positions.size());
+  }
 }
 
 }  // namespace OBJMeshInternal
@@ -218,8 +296,18 @@ void getShape(const tinyobj::shape_t& shape, const tinyobj::attrib_t& attrib,
 VulkanEngine::OBJMesh::OBJMesh(
     std::filesystem::path obj_file, std::filesystem::path mtl_path,
     const std::shared_ptr<Shader>
-        _shader)  // TODO(michael) support custom shader.
-    : SceneObject(), graphics_pipeline_updated(false), bounding_box() {
+        _shader,  // TODO(michael) support custom shader.
+    LoadMode load_mode)
+    : SceneObject(),
+      num_resident_shapes(0),
+      texture_memory_size(0),
+      pipeline_shapes({kNoShape, kNoShape}),
+      graphics_pipeline_updated(false),
+      graphics_pipeline_width(0),
+      graphics_pipeline_height(0),
+      bounding_box() {
+  disableLegacyUpdate();
+
   std::error_code obj_file_error;
   if (!std::filesystem::exists(obj_file, obj_file_error)) {
     std::cerr << "Provided obj path " + (obj_file.string()) +
@@ -244,69 +332,276 @@ VulkanEngine::OBJMesh::OBJMesh(
     mtl_path = obj_file_copy.remove_filename();
   }
 
-  // Load mesh
-  loadOBJ(obj_file.string().c_str(), mtl_path.string().c_str());
-
-  // Transfer mesh vertex data to GPU
-  VulkanEngine::SingleUsageCommandBuffer command_buffer;
-  command_buffer.beginSingleUsageCommandBuffer();
-  for (const auto& m : meshes) {
-    m->transferBuffers(command_buffer.single_use_command_buffer);
+  // Load mesh, or share it with other OBJMesh instances of the same files.
+  auto& asset_registry = VulkanManager::getInstance().getAssetRegistry();
+  const std::string key =
+      AssetRegistry::getKey(obj_file) + "|" + AssetRegistry::getKey(mtl_path);
+  const std::string obj_path_string = obj_file.string();
+  const std::string mtl_path_string = mtl_path.string();
+  const std::function<std::shared_ptr<Model>()> loader =
+      [obj_path_string, mtl_path_string]() {
+        return loadModel(obj_path_string, mtl_path_string);
+      };
+
+  if (load_mode == LoadMode::eAsynchronous) {
+    pending_model = asset_registry.loadAsync<Model>(key, loader);
+    return;
   }
-  command_buffer.endSingleUsageCommandBuffer();
+
+  std::promise<std::shared_ptr<Model>> loaded_model;
+  loaded_model.set_value(asset_registry.load<Model>(key, loader));
+  pending_model = loaded_model.get_future().share();
+  waitUntilLoaded();
 }
 
 VulkanEngine::OBJMesh::~OBJMesh() {}
 
+bool VulkanEngine::OBJMesh::isLoaded() const {
+  return model.get() && num_resident_shapes == meshes.size();
+}
+
+float VulkanEngine::OBJMesh::getLoadProgress() const {
+  if (!model.get()) {
+    return 0.0f;
+  }
+  return static_cast<float>(num_resident_shapes) /
+         static_cast<float>(meshes.size());
+}
+
+size_t VulkanEngine::OBJMesh::getTextureMemorySize() const {
+  size_t size = texture_memory_size;
+  for (const auto& texture : streamed_textures) {
+    size += texture->getResidentSize();
+  }
+  return size;
+}
+
+void VulkanEngine::OBJMesh::waitUntilLoaded() {
+  if (pending_model.valid()) {
+    pending_model.wait();
+  }
+  updateLoading();
+  if (!model.get()) {
+    return;
+  }
+
+  for (const auto& texture : model->shape_textures) {
+    if (texture.valid()) {
+      texture.wait();
+    }
+  }
+  VulkanManager::getInstance().getTransferQueue().flush();
+  updateLoading();
+}
+
+void VulkanEngine::OBJMesh::updateLoading() {
+  if (!model.get()) {
+    if (!pending_model.valid() ||
+        pending_model.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+      return;
+    }
+
+    auto loaded_model = std::move(pending_model);
+    try {
+      model = loaded_model.get();
+    } catch (const std::exception& e) {
+      std::cerr << "Failed to load OBJ file: " << e.what() << std::endl;
+      return;
+    }
+
+    meshes = model->meshes;
+    material_buffer = model->material_buffer;
+    bounding_box = model->bounding_box;
+    shape_resident.assign(meshes.size(), 0);
+    shape_streamed_textures.assign(meshes.size(),
+                                   std::shared_ptr<StreamedTexture>());
+    pipeline_indices.assign(meshes.size(), 0);
+    shader_indices.assign(meshes.size(), 0);
+    createShaders();
+    invalidateBoundingBox();
+  }
+
+  auto& transfer_queue = VulkanManager::getInstance().getTransferQueue();
+  if (num_resident_shapes == meshes.size() ||
+      !transfer_queue.isAvailable(model->transfer)) {
+    return;
+  }
+
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    if (shape_resident[i]) {
+      continue;
+    }
+
+    const auto& shape_texture = model->shape_textures[i];
+    std::shared_ptr<Texture> texture;
+    if (shape_texture.valid()) {
+      if (shape_texture.wait_for(std::chrono::seconds(0)) !=
+          std::future_status::ready) {
+        continue;
+      }
+      try {
+        texture = shape_texture.get();
+      } catch (const std::exception& e) {
+        std::cerr << "Failed to load OBJMesh texture: " << e.what()
+                  << std::endl;
+      }
+      if (texture.get() && !transfer_queue.isAvailable(texture->transfer)) {
+        continue;
+      }
+    }
+
+    if (texture.get() &&
+        texture_shader_indices.find(texture->descriptor.get()) ==
+            texture_shader_indices.end()) {
+      if (texture->streamed_texture.get()) {
+        streamed_textures.push_back(texture->streamed_texture);
+      } else {
+        texture_memory_size += texture->size;
+      }
+    }
+    if (texture.get()) {
+      shape_streamed_textures[i] = texture->streamed_texture;
+    }
+
+    // Shapes whose texture failed to load are drawn untextured.
+    addShape(i, texture.get() ? texture->descriptor
+                              : std::shared_ptr<Descriptor>());
+  }
+}
+
 const BoundingBox<Eigen::Vector3f>& VulkanEngine::OBJMesh::getBoundingBox()
     const {
   return bounding_box;
 }
 
-void VulkanEngine::OBJMesh::update(std::shared_ptr<SceneState> scene_state) {
+bool VulkanEngine::OBJMesh::getLocalBoundingBox(
+    BoundingBox<Eigen::Vector3f>& _bounding_box) const {
+  if (meshes.empty()) {
+    return false;
+  }
+  _bounding_box = bounding_box;
+  return true;
+}
+
+void VulkanEngine::OBJMesh::update(SceneState& scene_state) {
+  updateLoading();
+
   MvpUbo ubo_data;
-  ubo_data.projection = scene_state->getProjectionMatrix();
-  ubo_data.view = scene_state->getViewMatrix();
-  ubo_data.model = scene_state->getTotalTransform();
+  ubo_data.projection = scene_state.getProjectionMatrix();
+  ubo_data.view = scene_state.getViewMatrix();
+  ubo_data.model = scene_state.getTotalTransform();
 
-  for (auto& ub : mvp_buffers) {
-    ub->updateBuffer(&ubo_data, sizeof(ubo_data));
+  // World space bounds of each shape, used to skip shapes outside of the
+  // view frustum here and for culling on the GPU.
+  shape_bounding_boxes.clear();
+  for (const auto& mesh : meshes) {
+    shape_bounding_boxes.push_back(Frustum::transformBoundingBox(
+        ubo_data.model, mesh->getBoundingBox<Eigen::Vector3f>()));
+  }
+  if (scene_state.isFrustumCullingEnabled()) {
+    scene_state.getFrustum().intersects(shape_bounding_boxes,
+                                        shape_visibility);
+  } else {
+    shape_visibility.assign(meshes.size(), 1);
+  }
+
+  const bool any_shape_visible =
+      std::find(shape_visibility.cbegin(), shape_visibility.cend(), 1) !=
+      shape_visibility.cend();
+  if (any_shape_visible) {
+    for (auto& ub : mvp_buffers) {
+      ub->updateBuffer(&ubo_data, sizeof(ubo_data));
+    }
   }
 
   auto& vulkan_manager = VulkanManager::getInstance();
 
-  const auto window = scene_state->getScene().getActiveWindow();
+  // Compare against the size the pipelines were created for as well, since
+  // the frame in which the size changed may have been culled.
+  const auto window = scene_state.getScene().getActiveWindow();
   if (graphics_pipeline_updated) {
-    graphics_pipeline_updated = !window->sizeHasChanged();
+    graphics_pipeline_updated =
+        !window->sizeHasChanged() &&
+        graphics_pipeline_width == window->getFramebufferWidth() &&
+        graphics_pipeline_height == window->getFramebufferHeight();
   }
 
   if (!graphics_pipeline_updated) {
-    graphics_pipelines.clear();
-    for (size_t i = 0; i < meshes.size(); ++i) {
-      int32_t width = window->getFramebufferWidth();
-      int32_t height = window->getFramebufferHeight();
-      graphics_pipelines.push_back(
-          std::shared_ptr<GraphicsPipeline>(new GraphicsPipeline()));
-      graphics_pipelines.back()->setViewPort(0, 0, static_cast<float>(width),
-                                             static_cast<float>(height), 0.0f,
-                                             1.0f);
-      graphics_pipelines.back()->setScissor(0, 0, width, height);
-      graphics_pipelines.back()->createGraphicsPipeline(meshes[i], shaders[i]);
+    graphics_pipelines.assign(graphics_pipelines.size(),
+                              std::shared_ptr<GraphicsPipeline>());
+  }
+
+  // Create each variant's pipeline from the first shape which uses it. While
+  // loading, the first shape of a variant may become available in any frame.
+  for (size_t i = 0; i < graphics_pipelines.size(); ++i) {
+    auto& graphics_pipeline = graphics_pipelines[i];
+    const size_t shape = pipeline_shapes[i];
+    if (graphics_pipeline.get() || shape == kNoShape) {
+      continue;
     }
+    int32_t width = window->getFramebufferWidth();
+    int32_t height = window->getFramebufferHeight();
+    graphics_pipeline_width = window->getFramebufferWidth();
+    graphics_pipeline_height = window->getFramebufferHeight();
+    graphics_pipeline.reset(new GraphicsPipeline());
+    graphics_pipeline->setViewPort(0, 0, static_cast<float>(width),
+                                   static_cast<float>(height), 0.0f, 1.0f);
+    graphics_pipeline->setScissor(0, 0, width, height);
+    graphics_pipeline->createGraphicsPipeline(meshes[shape],
+                                              shaders[shader_indices[shape]]);
   }
   if (window.get() != nullptr) {
+    auto& render_queue = scene_state.getRenderQueue();
+    const auto descriptor_set_index =
+        static_cast<uint32_t>(vulkan_manager.getCurrentFrame());
+    const Eigen::Matrix4f model_view = ubo_data.view * ubo_data.model;
+
+    // Streamed textures change their image whenever their resident levels
+    // change, and the MemoryDefragmenter recreates the view of every texture
+    // it moves. Only descriptors whose version changed are rewritten.
+    for (const auto& shader : shaders) {
+      shader->updateDescriptorSet(descriptor_set_index);
+    }
     for (size_t i = 0; i < meshes.size(); ++i) {
-      graphics_pipelines[i]->bindPipeline();
-
-      auto current_command_buffer = vulkan_manager.getCurrentCommandBuffer();
+      if (!shape_visibility[i] || !shape_resident[i]) {
+        continue;
+      }
 
-      meshes[i]->bindVertexBuffers(current_command_buffer);
-      meshes[i]->bindIndexBuffer(current_command_buffer);
-      shaders[i]->bindDescriptorSet(
-          current_command_buffer,
-          static_cast<uint32_t>(vulkan_manager.getCurrentFrame()));
+      // The camera looks along -z in view space.
+      const auto& mesh_bbox = meshes[i]->getBoundingBox<Eigen::Vector3f>();
+      const Eigen::Vector3f center = (mesh_bbox.max + mesh_bbox.min) * 0.5f;
+      const float depth = -model_view.row(2).dot(center.homogeneous());
+
+      if (shape_streamed_textures[i].get()) {
+        const Eigen::Vector3f extent =
+            Eigen::Vector3f(shape_bounding_boxes.max_x[i],
+                            shape_bounding_boxes.max_y[i],
+                            shape_bounding_boxes.max_z[i]) -
+            Eigen::Vector3f(shape_bounding_boxes.min_x[i],
+                            shape_bounding_boxes.min_y[i],
+                            shape_bounding_boxes.min_z[i]);
+        shape_streamed_textures[i]->requestScreenSize(getScreenSize(
+            ubo_data.projection,
+            static_cast<float>(window->getFramebufferHeight()),
+            0.5f * extent.norm(), depth));
+      }
 
-      meshes[i]->draw(current_command_buffer);
+      // The shape index selects the shape's material in the shader.
+      DrawPacket draw_packet = {graphics_pipelines[pipeline_indices[i]].get(),
+                                shaders[shader_indices[i]].get(),
+                                meshes[i].get(), descriptor_set_index, depth,
+                                static_cast<uint32_t>(i)};
+
+      draw_packet.bounds.min = {shape_bounding_boxes.min_x[i],
+                                shape_bounding_boxes.min_y[i],
+                                shape_bounding_boxes.min_z[i]};
+      draw_packet.bounds.max = {shape_bounding_boxes.max_x[i],
+                                shape_bounding_boxes.max_y[i],
+                                shape_bounding_boxes.max_z[i]};
+      draw_packet.has_bounds = true;
+
+      render_queue.submit(draw_packet);
     }
   }
 
@@ -318,14 +613,10 @@ void VulkanEngine::OBJMesh::update(std::shared_ptr<SceneState> scene_state) {
 void processShapeChunk(
     int start, int end, const std::vector<tinyobj::shape_t>& shapes,
     const tinyobj::attrib_t& attrib,
-    std::vector<std::shared_ptr<VulkanEngine::MeshBase>>& meshes,
+    std::vector<OBJMeshInternal::ShapeData>& shape_data,
     std::mutex& log_shapes_processsing, size_t& processed_shapes) {
   for (size_t i = start; i < end; ++i) {
-    if (shapes[i].mesh.indices.size() > std::numeric_limits<uint16_t>::max()) {
-      OBJMeshInternal::getShape<uint32_t>(shapes[i], attrib, meshes, i);
-    } else {
-      OBJMeshInternal::getShape<uint16_t>(shapes[i], attrib, meshes, i);
-    }
+    OBJMeshInternal::getShape(shapes[i], attrib, shape_data, i);
   }
   std::lock_guard<std::mutex> lock(log_shapes_processsing);
   processed_shapes += end - start;
@@ -336,6 +627,7 @@ void processShapeChunk(
 void computeBoundingBox(
     const std::vector<std::shared_ptr<VulkanEngine::MeshBase>>& meshes,
     BoundingBox<Eigen::Vector3f>& bounding_box) {
+  VULKANENGINE_PROFILE_SCOPE("OBJMesh::computeBoundingBox");
   for (const auto& mesh : meshes) {
     // Calculate the bbox for the whole OBJ
     const auto& mesh_bbox = mesh->getBoundingBox<Eigen::Vector3f>();
@@ -361,8 +653,167 @@ void computeBoundingBox(
   }
 }
 
-void VulkanEngine::OBJMesh::loadOBJ(const char* obj_path,
-                                    const char* mtl_path) {
+std::shared_ptr<VulkanEngine::OBJMesh::Texture>
+VulkanEngine::OBJMesh::loadTexture(const std::filesystem::path& texture_path) {
+  VULKANENGINE_PROFILE_SCOPE("OBJMesh::loadTexture");
+  const auto start_time = std::chrono::steady_clock::now();
+  if (!TextureFile::isTextureFile(texture_path)) {
+    // Prefer textures baked offline, which are already compressed and have
+    // all of their mip levels.
+    auto baked_path = texture_path;
+    baked_path.replace_extension(".ktx2");
+    std::error_code baked_error;
+    std::error_code source_error;
+    const auto baked_time =
+        std::filesystem::last_write_time(baked_path, baked_error);
+    const auto source_time =
+        std::filesystem::last_write_time(texture_path, source_error);
+    if (!baked_error && !source_error && baked_time >= source_time) {
+      return loadTexture(baked_path);
+    }
+  }
+
+  auto texture = TextureFile::isTextureFile(texture_path)
+                     ? loadTextureFile(texture_path)
+                     : loadImage(texture_path);
+  if (!texture) {
+    return texture;
+  }
+
+  const std::chrono::duration<double, std::milli> load_time =
+      std::chrono::steady_clock::now() - start_time;
+  std::cout << "Loaded texture: " << texture_path.filename().string() << " ("
+            << (texture->size >> 10) << " KiB, " << load_time.count()
+            << " ms)" << std::endl;
+  return texture;
+}
+
+std::shared_ptr<VulkanEngine::OBJMesh::Texture>
+VulkanEngine::OBJMesh::loadTextureFile(
+    const std::filesystem::path& texture_path) {
+  std::shared_ptr<const TextureFile> texture_file;
+  try {
+    texture_file = TextureFile::load(texture_path);
+    if (!VulkanManager::getInstance()
+             .getDevice()
+             ->supportsSampledImageFormat(texture_file->getVkFormat())) {
+      std::cout << "OBJMesh texture: " << texture_path.filename().string()
+                << " is transcoded, "
+                << vk::to_string(texture_file->getVkFormat())
+                << " is not supported by the device" << std::endl;
+      texture_file = texture_file->transcode();
+    }
+  } catch (const std::runtime_error& e) {
+    std::cerr << "OBJMesh texture: " << texture_path.filename().string()
+              << " could not be loaded: " << e.what() << std::endl;
+    return std::shared_ptr<Texture>();
+  }
+
+  if (VulkanManager::getInstance().getTextureStreamer().isEnabled()) {
+    return createStreamedTexture(std::move(texture_file));
+  }
+
+  std::shared_ptr<StagedBuffer<TextureImage>> image(
+      new StagedBuffer<TextureImage>(texture_file, 1,
+                                     vk::ShaderStageFlagBits::eFragment));
+  void* staging_memory = image->mapStagingMemory();
+  image->copyLevels(*texture_file, staging_memory);
+  image->unmapStagingMemory();
+
+  auto texture = std::make_shared<Texture>();
+  texture->descriptor = image;
+  texture->size = image->getAllocationSize();
+  texture->transfer = VulkanManager::getInstance().getTransferQueue().enqueue(
+      [image](const vk::CommandBuffer& command_buffer) {
+        image->transferBuffer(command_buffer);
+      },
+      texture_file->getDataSize());
+  return texture;
+}
+
+std::shared_ptr<VulkanEngine::OBJMesh::Texture>
+VulkanEngine::OBJMesh::loadImage(const std::filesystem::path& texture_path) {
+  using RGBATexture2D1S = StagedBuffer<ShaderImage<
+      vk::Format::eR8G8B8A8Unorm, vk::ImageType::e2D,
+      vk::ImageTiling::eOptimal, vk::SampleCountFlagBits::e1>>;
+
+  int texture_width;
+  int texture_height;
+  int channels_in_file;
+  unsigned char* image_data =
+      stbi_load(texture_path.string().c_str(), &texture_width, &texture_height,
+                &channels_in_file, 4);
+  if (!image_data) {
+    std::cerr << "OBJMesh texture: " << texture_path.filename().string()
+              << " could not be loaded" << std::endl;
+    return std::shared_ptr<Texture>();
+  }
+
+  if (VulkanManager::getInstance().getTextureStreamer().isEnabled()) {
+    std::shared_ptr<const TextureFile> texture_file =
+        TextureFile::createFromImage(image_data,
+                                     static_cast<uint32_t>(texture_width),
+                                     static_cast<uint32_t>(texture_height));
+    stbi_image_free(image_data);
+    return createStreamedTexture(std::move(texture_file));
+  }
+
+  std::shared_ptr<RGBATexture2D1S> image(new RGBATexture2D1S(
+      vk::ImageLayout::eUndefined,
+      vk::ImageUsageFlagBits::eTransferDst |
+          vk::ImageUsageFlagBits::eTransferSrc |
+          vk::ImageUsageFlagBits::eSampled,
+      VMA_MEMORY_USAGE_GPU_ONLY, static_cast<uint32_t>(texture_width),
+      static_cast<uint32_t>(texture_height), 1, sizeof(unsigned char) * 4, 1,
+      1, vk::DescriptorType::eCombinedImageSampler,
+      vk::ShaderStageFlagBits::eFragment));
+
+  image->setImageData(image_data);
+  stbi_image_free(image_data);
+  image->createImageView(vk::ImageViewType::e2D,
+                         vk::ImageAspectFlagBits::eColor);
+  image->createSampler();
+
+  auto texture = std::make_shared<Texture>();
+  texture->descriptor = image;
+  texture->size = image->getAllocationSize();
+  texture->transfer = VulkanManager::getInstance().getTransferQueue().enqueue(
+      [image](const vk::CommandBuffer& command_buffer) {
+        image->transferBuffer(command_buffer);
+      },
+      static_cast<size_t>(texture_width) * texture_height * 4);
+  return texture;
+}
+
+std::shared_ptr<VulkanEngine::OBJMesh::Texture>
+VulkanEngine::OBJMesh::createStreamedTexture(
+    std::shared_ptr<const TextureFile> texture_file) {
+  auto streamed_texture =
+      VulkanManager::getInstance().getTextureStreamer().createTexture(
+          std::move(texture_file), 1, vk::ShaderStageFlagBits::eFragment);
+
+  auto texture = std::make_shared<Texture>();
+  texture->descriptor = streamed_texture;
+  texture->streamed_texture = streamed_texture;
+  texture->size = streamed_texture->getResidentSize();
+  texture->transfer = streamed_texture->getTransfer();
+  return texture;
+}
+
+float VulkanEngine::OBJMesh::getScreenSize(const Eigen::Matrix4f& projection,
+                                           float framebuffer_height,
+                                           float radius, float depth) {
+  // The camera is inside of the object, which may cover the whole screen.
+  if (depth <= radius) {
+    return std::numeric_limits<float>::max();
+  }
+  return radius * std::abs(projection(1, 1)) * framebuffer_height / depth;
+}
+
+std::shared_ptr<VulkanEngine::OBJMesh::Model>
+VulkanEngine::OBJMesh::loadModel(const std::string& obj_path,
+                                 const std::string& mtl_path) {
+  VULKANENGINE_PROFILE_SCOPE("OBJMesh::loadModel");
   auto begin = std::chrono::system_clock::now();
 
   tinyobj::attrib_t attrib;
@@ -370,11 +821,14 @@ void VulkanEngine::OBJMesh::loadOBJ(const char* obj_path,
   std::vector<tinyobj::material_t> materials;
   std::string err;
 
-  // TODO(michael) Get rid of need to triangulate using primitive restart
-  if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err, obj_path, mtl_path,
-                        true)) {
-    throw std::runtime_error(
-        "Could not load obj file: " + std::string(obj_path) + ", " + err);
+  {
+    VULKANENGINE_PROFILE_SCOPE("OBJMesh::parse");
+    // TODO(michael) Get rid of need to triangulate using primitive restart
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &err,
+                          obj_path.c_str(), mtl_path.c_str(), true)) {
+      throw std::runtime_error("Could not load obj file: " + obj_path + ", " +
+                               err);
+    }
   }
 
   auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -382,21 +836,44 @@ void VulkanEngine::OBJMesh::loadOBJ(const char* obj_path,
                   .count();
   std::cout << "Load obj time: " << time << "(ms)" << std::endl;
 
-  bounding_box.max = {std::numeric_limits<float>::min(),
-                      std::numeric_limits<float>::min(),
-                      std::numeric_limits<float>::min()};
-  bounding_box.min = {std::numeric_limits<float>::max(),
-                      std::numeric_limits<float>::max(),
-                      std::numeric_limits<float>::max()};
+  auto model = std::make_shared<Model>();
+
+  // Start decoding the textures of all materials first, so that they are
+  // decoded concurrently in the background while the shapes are processed.
+  // Textures are shared with every other OBJ file using them.
+  auto& asset_registry = VulkanManager::getInstance().getAssetRegistry();
+  std::vector<std::shared_future<std::shared_ptr<Texture>>> material_textures(
+      materials.size());
+  std::unordered_map<std::string, size_t> texture_materials;
+  for (size_t i = 0; i < materials.size(); ++i) {
+    const auto& texture_name = materials[i].diffuse_texname;
+    if (texture_name == "") {
+      continue;
+    }
+
+    const auto texture_material = texture_materials.find(texture_name);
+    if (texture_material != texture_materials.end()) {
+      material_textures[i] = material_textures[texture_material->second];
+      continue;
+    }
+    texture_materials[texture_name] = i;
 
-  mvp_buffers.resize(VulkanManager::getInstance().getFramesInFlight());
-  for (auto& ub : mvp_buffers) {
-    ub.reset(new VulkanEngine::UniformBuffer<MvpUbo>(0));
+    const std::filesystem::path texture_path(mtl_path + texture_name);
+    material_textures[i] = asset_registry.loadAsync<Texture>(
+        AssetRegistry::getKey(texture_path),
+        [texture_path]() { return loadTexture(texture_path); });
   }
 
-  material_buffers.resize(VulkanManager::getInstance().getFramesInFlight());
+  model->bounding_box.max = {std::numeric_limits<float>::min(),
+                             std::numeric_limits<float>::min(),
+                             std::numeric_limits<float>::min()};
+  model->bounding_box.min = {std::numeric_limits<float>::max(),
+                             std::numeric_limits<float>::max(),
+                             std::numeric_limits<float>::max()};
 
+  auto& meshes = model->meshes;
   meshes.resize(shapes.size());
+  std::vector<OBJMeshInternal::ShapeData> shape_data(shapes.size());
 
   int num_threads = std::min(std::thread::hardware_concurrency() * 6,
                              static_cast<unsigned int>(meshes.size()));
@@ -412,7 +889,8 @@ void VulkanEngine::OBJMesh::loadOBJ(const char* obj_path,
 
     futures.push_back(std::async(
         std::launch::async, processShapeChunk, start, end, std::ref(shapes),
-        std::ref(attrib), std::ref(meshes), std::ref(log_shapes_processing),
+        std::ref(attrib), std::ref(shape_data),
+        std::ref(log_shapes_processing),
         std::ref(processed_shapes)));
   }
 
@@ -422,131 +900,141 @@ void VulkanEngine::OBJMesh::loadOBJ(const char* obj_path,
   }
   std::cout << std::endl;
 
+  size_t geometry_size = 0;
+  for (const auto& data : shape_data) {
+    geometry_size += data.positions.size() * (sizeof(Eigen::Vector3f) * 2 +
+                                              sizeof(Eigen::Vector2f)) +
+                     data.indices.size() * sizeof(uint32_t);
+  }
+
+  OBJMeshInternal::createMeshes(shape_data, meshes);
+  shape_data.clear();
+
   std::thread compute_bbox_thread(computeBoundingBox, std::ref(meshes),
-                                  std::ref(bounding_box));
+                                  std::ref(model->bounding_box));
+
+  // All shapes share the same buffers so transferring those of the first one
+  // is enough.
+  model->transfer = VulkanManager::getInstance().getTransferQueue().enqueue(
+      [mesh = meshes.front()](const vk::CommandBuffer& command_buffer) {
+        mesh->transferBuffers(command_buffer);
+      },
+      geometry_size);
 
   std::cout << "Processing materials..." << std::endl;
 
+  // The materials of all shapes live in one storage buffer indexed by the
+  // shape index, so shapes which share a texture can share a shader too.
+  std::vector<Material> material_data(shapes.size());
+  model->material_buffer.reset(new StorageBuffer<Material>(
+      2, material_data.size(), vk::ShaderStageFlagBits::eFragment));
+  model->shape_textures.resize(shapes.size());
+
   for (auto i = 0; i < shapes.size(); ++i) {
     int material_id =
         shapes[i]
             .mesh.material_ids[0];  // TODO(michael) support per face materials.
     if (material_id == -1) {
-      for (auto& material_buffer_list : material_buffers) {
-        auto material_buffer = std::shared_ptr<UniformBuffer<Material>>(
-            new VulkanEngine::UniformBuffer<Material>(2));
-        Material material_data;
-        material_buffer->updateBuffer(&material_data, sizeof(material_data));
-        material_buffer_list.push_back(material_buffer);
-      }
-    } else {
-      for (auto& material_buffer_list : material_buffers) {
-        auto material_buffer = std::shared_ptr<UniformBuffer<Material>>(
-            new VulkanEngine::UniformBuffer<Material>(2));
-        Material material_data;
-        material_data.ambient[0] = materials[material_id].ambient[0];
-        material_data.ambient[1] = materials[material_id].ambient[1];
-        material_data.ambient[2] = materials[material_id].ambient[2];
-        material_data.diffuse[0] = materials[material_id].diffuse[0];
-        material_data.diffuse[1] = materials[material_id].diffuse[1];
-        material_data.diffuse[2] = materials[material_id].diffuse[2];
-        material_data.specular[0] = materials[material_id].specular[0];
-        material_data.specular[1] = materials[material_id].specular[1];
-        material_data.specular[2] = materials[material_id].specular[2];
-        material_buffer->updateBuffer(&material_data, sizeof(material_data));
-        material_buffer_list.push_back(material_buffer);
-      }
-    }
-
-    using RGBATexture2D1S =
-        VulkanEngine::StagedBuffer<VulkanEngine::ShaderImage<
-            vk::Format::eR8G8B8A8Unorm, vk::ImageType::e2D,
-            vk::ImageTiling::eOptimal, vk::SampleCountFlagBits::e1>>;
-
-    std::shared_ptr<RGBATexture2D1S> texture;
-
-    VulkanEngine::SingleUsageCommandBuffer command_buffer;
-    command_buffer.beginSingleUsageCommandBuffer();
-    if (material_id != -1 && materials[material_id].diffuse_texname != "") {
-      if (textures.count(materials[material_id].diffuse_texname) == 0) {
-        int texture_width;
-        int texture_height;
-        int channels_in_file;
-        unsigned char* image_data = stbi_load(
-            (std::string(mtl_path) + materials[material_id].diffuse_texname)
-                .c_str(),
-            &texture_width, &texture_height, &channels_in_file, 4);
-
-        if (image_data) {
-          texture.reset(new RGBATexture2D1S(
-              vk::ImageLayout::eUndefined,
-              vk::ImageUsageFlagBits::eTransferDst |
-                  vk::ImageUsageFlagBits::eTransferSrc |
-                  vk::ImageUsageFlagBits::eSampled,
-              VMA_MEMORY_USAGE_GPU_ONLY, static_cast<uint32_t>(texture_width),
-              static_cast<uint32_t>(texture_height), 1,
-              sizeof(unsigned char) * 4, 1, 1,
-              vk::DescriptorType::eCombinedImageSampler,
-              vk::ShaderStageFlagBits::eFragment));
-
-          texture->setImageData(image_data);
-          texture->createImageView(vk::ImageViewType::e2D,
-                                   vk::ImageAspectFlagBits::eColor);
-          texture->createSampler();
-          texture->transferBuffer(command_buffer.single_use_command_buffer);
-          textures[materials[material_id].diffuse_texname] = texture;
-          std::cout << "Loaded texture: "
-                    << materials[material_id].diffuse_texname << std::endl;
-
-        } else {
-          std::cerr << "OBJMesh texture: " << materials[i].diffuse_texname
-                    << " could not be loaded" << std::endl;
-        }
-      } else {
-        texture = std::static_pointer_cast<RGBATexture2D1S>(
-            textures[materials[material_id].diffuse_texname]);
-      }
-    }
-    command_buffer.endSingleUsageCommandBuffer();
-
-    std::shared_ptr<Shader> shader;
-    std::shared_ptr<ShaderModule> vertex_shader(new ShaderModule(
-        getVertexShaderString(), false, vk::ShaderStageFlagBits::eVertex));
-    std::shared_ptr<ShaderModule> fragment_shader(
-        new ShaderModule(getFragmentShaderString(texture.get() != nullptr),
-                         false, vk::ShaderStageFlagBits::eFragment));
-    shader.reset(new Shader({fragment_shader, vertex_shader}));
-
-    std::vector<std::vector<std::shared_ptr<Descriptor>>> descriptors;
-    for (size_t j = 0; j < VulkanManager::getInstance().getFramesInFlight();
-         ++j) {
-      std::vector<std::shared_ptr<Descriptor>> frame_descriptors;
-      if (texture.get() != nullptr) {
-        frame_descriptors.push_back(texture);
-      }
-      frame_descriptors.push_back(mvp_buffers[j]);
-      frame_descriptors.push_back(material_buffers[j].back());
-      descriptors.push_back(frame_descriptors);
+      continue;
     }
 
-    shader->setDescriptors(descriptors);
-    shaders.push_back(shader);
+    auto& material = material_data[i];
+    material.ambient[0] = materials[material_id].ambient[0];
+    material.ambient[1] = materials[material_id].ambient[1];
+    material.ambient[2] = materials[material_id].ambient[2];
+    material.diffuse[0] = materials[material_id].diffuse[0];
+    material.diffuse[1] = materials[material_id].diffuse[1];
+    material.diffuse[2] = materials[material_id].diffuse[2];
+    material.specular[0] = materials[material_id].specular[0];
+    material.specular[1] = materials[material_id].specular[1];
+    material.specular[2] = materials[material_id].specular[2];
+
+    model->shape_textures[i] = material_textures[material_id];
   }
 
+  model->material_buffer->updateBuffer(
+      material_data.data(), sizeof(Material) * material_data.size());
+
   compute_bbox_thread.join();
 
   time = std::chrono::duration_cast<std::chrono::milliseconds>(
              std::chrono::system_clock::now() - begin)
              .count();
   std::cout << "OBJ load time: " << time << "(ms)" << std::endl;
+
+  return model;
 }
 
-const std::string VulkanEngine::OBJMesh::getVertexShaderString() const {
+void VulkanEngine::OBJMesh::createShaders() {
+  auto& vulkan_manager = VulkanManager::getInstance();
+
+  mvp_buffers.resize(vulkan_manager.getFramesInFlight());
+  for (auto& ub : mvp_buffers) {
+    ub.reset(new VulkanEngine::UniformBuffer<MvpUbo>(0));
+  }
+
+  // Shader modules only depend on whether a shape is textured. Compile each
+  // variant once and share it between shapes.
+  vertex_shader.reset(new ShaderModule(getVertexShaderString(), false,
+                                       vk::ShaderStageFlagBits::eVertex));
+  graphics_pipelines.resize(fragment_shaders.size());
+}
+
+void VulkanEngine::OBJMesh::addShape(
+    size_t index, const std::shared_ptr<Descriptor>& texture) {
+  const size_t variant = texture.get() != nullptr ? 1 : 0;
+  auto& fragment_shader = fragment_shaders[variant];
+  if (!fragment_shader.get()) {
+    fragment_shader.reset(
+        new ShaderModule(getFragmentShaderString(variant == 1), false,
+                         vk::ShaderStageFlagBits::eFragment));
+  }
+  pipeline_indices[index] = variant;
+  if (pipeline_shapes[variant] == kNoShape) {
+    pipeline_shapes[variant] = index;
+  }
+  shape_resident[index] = 1;
+  ++num_resident_shapes;
+
+  auto texture_shader_index = texture_shader_indices.find(texture.get());
+  if (texture_shader_index != texture_shader_indices.end()) {
+    shader_indices[index] = texture_shader_index->second;
+    return;
+  }
+  texture_shader_indices[texture.get()] = shaders.size();
+  shader_indices[index] = shaders.size();
+
+  std::shared_ptr<Shader> shader;
+  shader.reset(new Shader({fragment_shader, vertex_shader}));
+
+  std::vector<std::vector<std::shared_ptr<Descriptor>>> descriptors;
+  for (size_t j = 0; j < VulkanManager::getInstance().getFramesInFlight();
+       ++j) {
+    std::vector<std::shared_ptr<Descriptor>> frame_descriptors;
+    if (texture.get() != nullptr) {
+      frame_descriptors.push_back(texture);
+    }
+    frame_descriptors.push_back(mvp_buffers[j]);
+    frame_descriptors.push_back(material_buffer);
+    descriptors.push_back(frame_descriptors);
+  }
+
+  shader->setDescriptors(descriptors);
+  shaders.push_back(shader);
+  shader_textures.push_back(texture);
+}
+
+const std::string VulkanEngine::OBJMesh::getVertexShaderString(
+    bool instanced) const {
   std::stringstream return_string;
 
   return_string
       << "#version 450\n"
-      << "#extension GL_ARB_separate_shader_objects : enable\n"
+      << "#extension GL_ARB_separate_shader_objects : enable\n";
+  if (instanced) {
+    return_string << "#extension GL_ARB_shader_draw_parameters : enable\n";
+  }
+  return_string
       << "layout(binding = 0) uniform UniformBufferObject {\n"
       << "  mat4 model;\n"
       << "  mat4 view;\n"
@@ -559,19 +1047,37 @@ const std::string VulkanEngine::OBJMesh::getVertexShaderString() const {
       << "layout(location = 2) out vec3 outNormal;\n"
       << "layout(location = 2) in vec2 inTexcoords;\n"
       << "layout(location = 3) out vec2 outTexcoords;\n"
+      << "layout(location = 4) flat out uint outDrawIndex;\n";
+  if (instanced) {
+    return_string << "layout(location = 3) in mat4 inInstanceTransform;\n";
+  }
 
+  return_string
       << "out gl_PerVertex {\n"
       << "  vec4 gl_Position;\n"
       << "};\n"
-      << "void main() {\n"
-      << "  gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, "
+      << "void main() {\n";
+  if (instanced) {
+    return_string << "  mat4 model = ubo.model * inInstanceTransform;\n";
+  } else {
+    return_string << "  mat4 model = ubo.model;\n";
+  }
+  return_string
+      << "  gl_Position = ubo.proj * ubo.view * model * vec4(inPosition, "
          "1.0);\n"
       << "  outCameraPosition = vec3(inverse(ubo.view)[3]);\n"
-      << "  outFragWorldPosition = vec3(ubo.model * vec4(inPosition, 1.0));\n"
-      << "  outNormal = normalize(mat3(transpose(inverse(ubo.model))) * "
+      << "  outFragWorldPosition = vec3(model * vec4(inPosition, 1.0));\n"
+      << "  outNormal = normalize(mat3(transpose(inverse(model))) * "
          "inNormal);\n"
-      << "  outTexcoords = inTexcoords;\n"
-      << "}\n";
+      << "  outTexcoords = inTexcoords;\n";
+  // gl_InstanceIndex also counts the instances of an instanced draw, only
+  // firstInstance identifies the shape.
+  if (instanced) {
+    return_string << "  outDrawIndex = uint(gl_BaseInstanceARB);\n";
+  } else {
+    return_string << "  outDrawIndex = uint(gl_InstanceIndex);\n";
+  }
+  return_string << "}\n";
 
   return return_string.str();
 }
@@ -587,19 +1093,25 @@ const std::string VulkanEngine::OBJMesh::getFragmentShaderString(
                 << "layout(location = 1) in vec3 inFragWorldPosition;\n"
                 << "layout(location = 2) in vec3 inNormal;\n"
                 << "layout(location = 3) in vec2 inTexcoords;\n"
+                << "layout(location = 4) flat in uint inDrawIndex;\n"
                 << "layout(location = 0) out vec4 outColor;\n";
 
   if (has_texture) {
     return_string << "layout(binding = 1) uniform sampler2D texSampler;\n";
   }
 
-  return_string << "layout(std140, set = 0, binding = 2) uniform Material {\n"
+  return_string << "struct Material {\n"
                 << "  vec4 ambient;\n"
                 << "  vec4 diffuse;\n"
                 << "  vec4 specular;\n"
-                << "} material;\n";
-
-  return_string << "void main() {\n";
+                << "};\n"
+                << "layout(std430, set = 0, binding = 2) readonly buffer "
+                   "Materials {\n"
+                << "  Material materials[];\n"
+                << "};\n";
+
+  return_string << "void main() {\n"
+                << "  Material material = materials[inDrawIndex];\n";
   if (has_texture) {
     return_string << "  vec4 texColor = texture(texSampler, inTexcoords);\n";
   } else {
@@ -0,0 +1,210 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/Device.h>
+#include <VulkanEngine/ParallelCommandRecorder.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+VulkanEngine::ParallelCommandRecorder::ParallelCommandRecorder(
+    size_t _num_threads)
+    : num_threads(_num_threads),
+      job_generation(0),
+      pending_workers(0),
+      stopping(false),
+      job_render_queue(nullptr),
+      job_frame_index(0),
+      job_indirect_draw_buffer(nullptr) {
+  if (num_threads == 0) {
+    throw std::runtime_error(
+        "ParallelCommandRecorder requires at least one thread!");
+  }
+
+  auto& vulkan_manager = VulkanManager::getInstance();
+  auto device = vulkan_manager.getDevice();
+
+  command_pools.resize(num_threads);
+  for (auto& thread_command_pools : command_pools) {
+    for (size_t i = 0; i < vulkan_manager.getFramesInFlight(); ++i) {
+      thread_command_pools.emplace_back(new CommandPool(
+          device->getVkDevice(), device->getGraphicsQueueFamilyIndex()));
+    }
+  }
+
+  for (size_t i = 1; i < num_threads; ++i) {
+    workers.emplace_back(&ParallelCommandRecorder::workerLoop, this, i);
+  }
+}
+
+VulkanEngine::ParallelCommandRecorder::~ParallelCommandRecorder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  job_available.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  // Command buffers recorded for the frames in flight may still be pending,
+  // so the pools are only destroyed once those frames have completed.
+  VulkanManager::getInstance().getDeletionQueue().enqueue(
+      [command_pools = command_pools]() mutable { command_pools.clear(); });
+}
+
+std::vector<vk::CommandBuffer> VulkanEngine::ParallelCommandRecorder::record(
+    const RenderQueue& render_queue,
+    const vk::CommandBufferInheritanceInfo& inheritance_info,
+    size_t frame_index, const IndirectDrawBuffer* indirect_draw_buffer) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job_render_queue = &render_queue;
+    job_inheritance_info = inheritance_info;
+    job_frame_index = frame_index;
+    job_indirect_draw_buffer = indirect_draw_buffer;
+    job_command_buffers.assign(num_threads, vk::CommandBuffer());
+    job_statistics.assign(num_threads, RenderStatistics());
+    job_exception = nullptr;
+    pending_workers = workers.size();
+    ++job_generation;
+  }
+  job_available.notify_all();
+
+  try {
+    recordRange(0);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!job_exception) {
+      job_exception = std::current_exception();
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  job_done.wait(lock, [this] { return pending_workers == 0; });
+  job_render_queue = nullptr;
+  job_indirect_draw_buffer = nullptr;
+
+  if (job_exception) {
+    std::rethrow_exception(job_exception);
+  }
+
+  statistics = RenderStatistics();
+  for (const auto& thread_statistics : job_statistics) {
+    statistics += thread_statistics;
+  }
+
+  std::vector<vk::CommandBuffer> command_buffers;
+  command_buffers.reserve(num_threads);
+  for (const auto& command_buffer : job_command_buffers) {
+    if (command_buffer) {
+      command_buffers.push_back(command_buffer);
+    }
+  }
+
+  return command_buffers;
+}
+
+size_t VulkanEngine::ParallelCommandRecorder::getNumThreads() const {
+  return num_threads;
+}
+
+const VulkanEngine::RenderStatistics&
+VulkanEngine::ParallelCommandRecorder::getStatistics() const {
+  return statistics;
+}
+
+void VulkanEngine::ParallelCommandRecorder::workerLoop(size_t thread_index) {
+  uint64_t last_generation = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    job_available.wait(lock, [this, last_generation] {
+      return stopping || job_generation != last_generation;
+    });
+    if (stopping) {
+      return;
+    }
+    last_generation = job_generation;
+
+    lock.unlock();
+    try {
+      recordRange(thread_index);
+    } catch (...) {
+      lock.lock();
+      if (!job_exception) {
+        job_exception = std::current_exception();
+      }
+      lock.unlock();
+    }
+    lock.lock();
+
+    if (--pending_workers == 0) {
+      job_done.notify_one();
+    }
+  }
+}
+
+void VulkanEngine::ParallelCommandRecorder::recordRange(size_t thread_index) {
+  auto& command_pool = command_pools[thread_index][job_frame_index];
+  command_pool->reset();
+
+  // Split the queue into contiguous ranges of near equal size so that draws
+  // keep their submission order once the command buffers are executed.
+  const size_t draw_count = job_render_queue->size();
+  size_t begin = draw_count * thread_index / num_threads;
+  size_t end = draw_count * (thread_index + 1) / num_threads;
+
+  // An indirect draw covers a whole batch, so ranges must not split batches.
+  // Moving every boundary back to the start of its batch keeps the ranges
+  // contiguous.
+  if (job_indirect_draw_buffer) {
+    if (begin < draw_count) {
+      begin = job_render_queue->getBatchFirst(begin);
+    }
+    if (end < draw_count) {
+      end = job_render_queue->getBatchFirst(end);
+    }
+  }
+
+  if (begin == end) {
+    return;
+  }
+
+  auto command_buffer =
+      command_pool->getCommandBuffer(vk::CommandBufferLevel::eSecondary);
+
+  auto begin_info =
+      vk::CommandBufferBeginInfo()
+          .setFlags(vk::CommandBufferUsageFlagBits::eRenderPassContinue |
+                    vk::CommandBufferUsageFlagBits::eOneTimeSubmit)
+          .setPInheritanceInfo(&job_inheritance_info);
+
+  command_buffer.begin(begin_info);
+  job_statistics[thread_index] =
+      job_render_queue->record(command_buffer, begin, end,
+                               job_indirect_draw_buffer);
+  command_buffer.end();
+
+  job_command_buffers[thread_index] = command_buffer;
+}
@@ -0,0 +1,619 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/Profiler.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// Source of Profiler ids.
+std::atomic<uint64_t> next_profiler_id(1);
+
+/// The pipeline statistics gathered, their results are written in the order
+/// of the flag bits, see Profiler::PipelineStatistics.
+const vk::QueryPipelineStatisticFlags kPipelineStatisticFlags =
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+    vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+    vk::QueryPipelineStatisticFlagBits::eClippingInvocations |
+    vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+    vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+
+/// The number of flags in kPipelineStatisticFlags.
+constexpr uint32_t kNumPipelineStatistics = 6;
+
+/// Escape a string for use in JSON.
+std::string escapeJSON(const char* string) {
+  std::string escaped;
+  for (const char* c = string; *c != '\0'; ++c) {
+    if (*c == '"' || *c == '\\') {
+      escaped += '\\';
+    }
+    escaped += *c;
+  }
+  return escaped;
+}
+
+}  // namespace
+
+double VulkanEngine::Profiler::Frame::getCPUTimeMs() const {
+  return static_cast<double>(end_ns - begin_ns) / 1e6;
+}
+
+double VulkanEngine::Profiler::Frame::getGPUTimeMs() const {
+  if (gpu_events.empty()) {
+    return 0.0;
+  }
+
+  uint64_t begin = gpu_events.front().begin_ns;
+  uint64_t end = gpu_events.front().end_ns;
+  for (const auto& event : gpu_events) {
+    begin = std::min(begin, event.begin_ns);
+    end = std::max(end, event.end_ns);
+  }
+  return static_cast<double>(end - begin) / 1e6;
+}
+
+double VulkanEngine::Profiler::Frame::getScopeTimeMs(
+    const std::string& name) const {
+  uint64_t time = 0;
+  for (const auto* events : {&cpu_events, &gpu_events}) {
+    for (const auto& event : *events) {
+      if (name == event.name) {
+        time += event.end_ns - event.begin_ns;
+      }
+    }
+  }
+  return static_cast<double>(time) / 1e6;
+}
+
+VulkanEngine::Profiler::PipelineStatistics&
+VulkanEngine::Profiler::PipelineStatistics::operator+=(
+    const PipelineStatistics& other) {
+  input_assembly_vertices += other.input_assembly_vertices;
+  input_assembly_primitives += other.input_assembly_primitives;
+  vertex_shader_invocations += other.vertex_shader_invocations;
+  clipping_invocations += other.clipping_invocations;
+  clipping_primitives += other.clipping_primitives;
+  fragment_shader_invocations += other.fragment_shader_invocations;
+  return *this;
+}
+
+VulkanEngine::Profiler::PipelineStatistics
+VulkanEngine::Profiler::Frame::getPipelineStatistics(
+    const std::string& name) const {
+  PipelineStatistics sum;
+  for (const auto& statistics : pipeline_statistics) {
+    if (name == statistics.name) {
+      sum.name = statistics.name;
+      sum += statistics;
+    }
+  }
+  return sum;
+}
+
+VulkanEngine::Profiler::Profiler()
+    : id(next_profiler_id++),
+      epoch(std::chrono::steady_clock::now()),
+      enabled(false),
+      max_frames(300),
+      pipeline_statistics_level(PipelineStatisticsLevel::eDisabled),
+      inherited_queries(false),
+      num_threads(0),
+      current_frame_queries(nullptr),
+      frame_count(0),
+      timestamp_period(0.0f),
+      timestamp_mask(0) {}
+
+VulkanEngine::Profiler::~Profiler() {}
+
+void VulkanEngine::Profiler::setEnabled(bool _enabled) {
+  if (enabled.exchange(_enabled) == _enabled) {
+    return;
+  }
+
+  // Scopes recorded while disabled would be attributed to the wrong frame.
+  current_frame = Frame();
+  current_frame.begin_ns = now();
+  current_frame_queries = nullptr;
+}
+
+bool VulkanEngine::Profiler::isEnabled() const {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+void VulkanEngine::Profiler::setMaxFrames(size_t _max_frames) {
+  max_frames = _max_frames;
+  while (frames.size() > max_frames) {
+    frames.pop_front();
+  }
+}
+
+size_t VulkanEngine::Profiler::getMaxFrames() const { return max_frames; }
+
+void VulkanEngine::Profiler::setPipelineStatisticsLevel(
+    PipelineStatisticsLevel level) {
+  pipeline_statistics_level = level;
+}
+
+VulkanEngine::Profiler::PipelineStatisticsLevel
+VulkanEngine::Profiler::getPipelineStatisticsLevel() const {
+  return pipeline_statistics_level.load(std::memory_order_relaxed);
+}
+
+uint64_t VulkanEngine::Profiler::now() const {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - epoch)
+          .count());
+}
+
+void VulkanEngine::Profiler::recordCPUEvent(const char* name,
+                                            uint64_t begin_ns,
+                                            uint64_t end_ns) {
+  auto& thread = getThreadEvents();
+  const uint64_t write_count =
+      thread.write_count.load(std::memory_order_relaxed);
+  if (write_count - thread.read_count.load(std::memory_order_acquire) >=
+      thread.events.size()) {
+    return;
+  }
+
+  thread.events[write_count % thread.events.size()] = {
+      name, begin_ns, end_ns, thread.thread_index};
+  thread.write_count.store(write_count + 1, std::memory_order_release);
+}
+
+uint32_t VulkanEngine::Profiler::beginGPUScope(
+    const vk::CommandBuffer& command_buffer, const char* name) {
+  if (!isEnabled()) {
+    return kInvalidGPUScope;
+  }
+
+  vk::QueryPool query_pool;
+  uint32_t scope;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto* frame = current_frame_queries;
+    if (!frame || !frame->query_pool || !frame->reset ||
+        frame->scope_names.size() >= kMaxGPUScopes) {
+      return kInvalidGPUScope;
+    }
+    query_pool = frame->query_pool;
+    scope = static_cast<uint32_t>(frame->scope_names.size());
+    frame->scope_names.push_back(name);
+  }
+
+  command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe,
+                                query_pool, scope * 2);
+  return scope;
+}
+
+void VulkanEngine::Profiler::endGPUScope(
+    const vk::CommandBuffer& command_buffer, uint32_t scope) {
+  if (scope == kInvalidGPUScope || !current_frame_queries) {
+    return;
+  }
+
+  command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe,
+                                current_frame_queries->query_pool,
+                                scope * 2 + 1);
+}
+
+uint32_t VulkanEngine::Profiler::beginPipelineStatistics(
+    const vk::CommandBuffer& command_buffer, const char* name,
+    PipelineStatisticsLevel level) {
+  if (!isEnabled() || level == PipelineStatisticsLevel::eDisabled ||
+      level != getPipelineStatisticsLevel()) {
+    return kInvalidGPUScope;
+  }
+
+  vk::QueryPool query_pool;
+  uint32_t scope;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto* frame = current_frame_queries;
+    if (!frame || !frame->statistics_query_pool || !frame->reset ||
+        frame->statistics_scope_names.size() >= kMaxPipelineStatisticsScopes) {
+      return kInvalidGPUScope;
+    }
+    query_pool = frame->statistics_query_pool;
+    scope = static_cast<uint32_t>(frame->statistics_scope_names.size());
+    frame->statistics_scope_names.push_back(name);
+    if (level == PipelineStatisticsLevel::eRenderPass) {
+      frame->render_pass_statistics_scope = scope;
+    }
+  }
+
+  command_buffer.beginQuery(query_pool, scope, vk::QueryControlFlags());
+  return scope;
+}
+
+void VulkanEngine::Profiler::endPipelineStatistics(
+    const vk::CommandBuffer& command_buffer, uint32_t scope) {
+  if (scope == kInvalidGPUScope || !current_frame_queries) {
+    return;
+  }
+
+  command_buffer.endQuery(current_frame_queries->statistics_query_pool, scope);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (current_frame_queries->render_pass_statistics_scope == scope) {
+    current_frame_queries->render_pass_statistics_scope = kInvalidGPUScope;
+  }
+}
+
+vk::QueryPipelineStatisticFlags
+VulkanEngine::Profiler::getInheritedPipelineStatistics() const {
+  if (!current_frame_queries ||
+      current_frame_queries->render_pass_statistics_scope == kInvalidGPUScope) {
+    return vk::QueryPipelineStatisticFlags();
+  }
+  return kPipelineStatisticFlags;
+}
+
+bool VulkanEngine::Profiler::canInheritPipelineStatistics() const {
+  return inherited_queries;
+}
+
+void VulkanEngine::Profiler::beginFrame(size_t frame_index) {
+  if (!isEnabled()) {
+    current_frame_queries = nullptr;
+    return;
+  }
+
+  auto& vulkan_manager = VulkanManager::getInstance();
+  if (frame_queries.empty()) {
+    auto device = vulkan_manager.getDevice();
+    timestamp_period = device->getTimestampPeriod();
+    const uint32_t valid_bits = device->getTimestampValidBits();
+    timestamp_mask =
+        valid_bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << valid_bits) - 1;
+
+    // Timestamps written by a queue without valid bits are undefined.
+    frame_queries.resize(vulkan_manager.getFramesInFlight());
+    if (timestamp_period > 0.0f && valid_bits != 0) {
+      auto query_pool_info = vk::QueryPoolCreateInfo()
+                                 .setQueryType(vk::QueryType::eTimestamp)
+                                 .setQueryCount(kMaxGPUScopes * 2);
+      for (auto& frame : frame_queries) {
+        frame.query_pool =
+            device->getVkDevice().createQueryPool(query_pool_info);
+      }
+    }
+
+    const auto& features = device->getEnabledFeatures();
+    inherited_queries = features.inheritedQueries;
+    if (features.pipelineStatisticsQuery) {
+      auto query_pool_info =
+          vk::QueryPoolCreateInfo()
+              .setQueryType(vk::QueryType::ePipelineStatistics)
+              .setQueryCount(kMaxPipelineStatisticsScopes)
+              .setPipelineStatistics(kPipelineStatisticFlags);
+      for (auto& frame : frame_queries) {
+        frame.statistics_query_pool =
+            device->getVkDevice().createQueryPool(query_pool_info);
+      }
+    }
+  }
+
+  auto& frame = frame_queries[frame_index];
+  readGPUEvents(frame);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  frame.reset = false;
+  frame.submitted = false;
+  frame.scope_names.clear();
+  frame.statistics_scope_names.clear();
+  frame.render_pass_statistics_scope = kInvalidGPUScope;
+  current_frame_queries = &frame;
+}
+
+void VulkanEngine::Profiler::beginCommandBuffer(
+    const vk::CommandBuffer& command_buffer) {
+  if (!current_frame_queries) {
+    return;
+  }
+
+  if (current_frame_queries->query_pool) {
+    command_buffer.resetQueryPool(current_frame_queries->query_pool, 0,
+                                  kMaxGPUScopes * 2);
+  }
+  if (current_frame_queries->statistics_query_pool) {
+    command_buffer.resetQueryPool(current_frame_queries->statistics_query_pool,
+                                  0, kMaxPipelineStatisticsScopes);
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  current_frame_queries->reset = true;
+}
+
+void VulkanEngine::Profiler::submitFrame() {
+  if (!current_frame_queries) {
+    return;
+  }
+
+  current_frame_queries->submitted = true;
+  current_frame_queries->submit_ns = now();
+}
+
+void VulkanEngine::Profiler::endFrame() {
+  if (!isEnabled()) {
+    current_frame_queries = nullptr;
+    return;
+  }
+
+  const uint64_t end_ns = now();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = thread_events.begin(); it != thread_events.end();) {
+      auto& thread = **it;
+      const uint64_t read_count =
+          thread.read_count.load(std::memory_order_relaxed);
+      const uint64_t write_count =
+          thread.write_count.load(std::memory_order_acquire);
+      for (uint64_t i = read_count; i < write_count; ++i) {
+        current_frame.cpu_events.push_back(
+            thread.events[i % thread.events.size()]);
+      }
+      thread.read_count.store(write_count, std::memory_order_release);
+
+      // The thread has exited if the profiler holds the only reference.
+      if (it->use_count() == 1) {
+        it = thread_events.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  current_frame.index = frame_count++;
+  current_frame.end_ns = end_ns;
+  if (current_frame_queries &&
+      (!current_frame_queries->scope_names.empty() ||
+       !current_frame_queries->statistics_scope_names.empty())) {
+    current_frame_queries->frame = std::move(current_frame);
+    current_frame_queries->pending = true;
+  } else {
+    addFrame(std::move(current_frame));
+  }
+
+  current_frame = Frame();
+  current_frame.begin_ns = end_ns;
+  current_frame_queries = nullptr;
+}
+
+void VulkanEngine::Profiler::flush() {
+  for (auto& frame : frame_queries) {
+    readGPUEvents(frame);
+  }
+}
+
+const std::deque<VulkanEngine::Profiler::Frame>&
+VulkanEngine::Profiler::getFrames() const {
+  return frames;
+}
+
+bool VulkanEngine::Profiler::writeChromeTrace(
+    const std::filesystem::path& path) const {
+  std::ofstream file(path);
+  if (!file) {
+    return false;
+  }
+  file << toChromeTrace();
+  return static_cast<bool>(file);
+}
+
+std::string VulkanEngine::Profiler::toChromeTrace() const {
+  std::stringstream json;
+  json << std::fixed << std::setprecision(3);
+  json << "{\n"
+       << "  \"displayTimeUnit\": \"ms\",\n"
+       << "  \"traceEvents\": [\n"
+       << "    {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, "
+          "\"args\": {\"name\": \"CPU\"}},\n"
+       << "    {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+          "\"args\": {\"name\": \"GPU\"}}";
+
+  // Times are in microseconds. CPU threads are numbered from 1, frames are
+  // shown on their own track.
+  const auto write_event = [&json](const char* name, uint64_t begin_ns,
+                                   uint64_t end_ns, int pid, uint32_t tid) {
+    json << ",\n    {\"name\": \"" << escapeJSON(name)
+         << "\", \"ph\": \"X\", \"ts\": " << static_cast<double>(begin_ns) / 1e3
+         << ", \"dur\": " << static_cast<double>(end_ns - begin_ns) / 1e3
+         << ", \"pid\": " << pid << ", \"tid\": " << tid << "}";
+  };
+
+  for (const auto& frame : frames) {
+    const std::string name = "Frame " + std::to_string(frame.index);
+    write_event(name.c_str(), frame.begin_ns, frame.end_ns, 0, 0);
+    for (const auto& event : frame.cpu_events) {
+      write_event(event.name, event.begin_ns, event.end_ns, 0,
+                  event.thread_index);
+    }
+    for (const auto& event : frame.gpu_events) {
+      write_event(event.name, event.begin_ns, event.end_ns, 1, 0);
+    }
+  }
+
+  json << "\n  ]\n}\n";
+  return json.str();
+}
+
+void VulkanEngine::Profiler::clear() {
+  if (frame_queries.empty()) {
+    return;
+  }
+  flush();
+
+  auto device = VulkanManager::getInstance().getDevice();
+  for (auto& frame : frame_queries) {
+    if (frame.query_pool) {
+      device->getVkDevice().destroyQueryPool(frame.query_pool);
+    }
+    if (frame.statistics_query_pool) {
+      device->getVkDevice().destroyQueryPool(frame.statistics_query_pool);
+    }
+  }
+  frame_queries.clear();
+  current_frame_queries = nullptr;
+}
+
+VulkanEngine::Profiler::ThreadEvents&
+VulkanEngine::Profiler::getThreadEvents() {
+  // Each thread caches the buffer of the profiler it last recorded into.
+  thread_local uint64_t cached_id = 0;
+  thread_local std::shared_ptr<ThreadEvents> cached_events;
+  if (cached_id != id) {
+    auto events = std::make_shared<ThreadEvents>();
+    events->events.resize(kThreadEventCapacity);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    events->thread_index = ++num_threads;
+    thread_events.push_back(events);
+    cached_events = events;
+    cached_id = id;
+  }
+  return *cached_events;
+}
+
+void VulkanEngine::Profiler::readGPUEvents(FrameQueries& queries) {
+  if (!queries.pending) {
+    return;
+  }
+  queries.pending = false;
+
+  auto& frame = queries.frame;
+  const auto num_scopes = static_cast<uint32_t>(queries.scope_names.size());
+  std::vector<uint64_t> timestamps(num_scopes * 2);
+
+  // Frames which failed to present are never submitted.
+  auto result = vk::Result::eNotReady;
+  if (queries.submitted) {
+    readPipelineStatistics(queries);
+  }
+  if (queries.submitted && num_scopes > 0) {
+    auto device = VulkanManager::getInstance().getDevice();
+    result = device->getVkDevice().getQueryPoolResults(
+        queries.query_pool, 0, num_scopes * 2,
+        timestamps.size() * sizeof(uint64_t), timestamps.data(),
+        sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+  }
+
+  if (result == vk::Result::eSuccess) {
+    uint64_t first_timestamp = timestamp_mask;
+    for (auto& timestamp : timestamps) {
+      timestamp &= timestamp_mask;
+      first_timestamp = std::min(first_timestamp, timestamp);
+    }
+
+    const auto to_ns = [&](uint64_t timestamp) {
+      return queries.submit_ns +
+             static_cast<uint64_t>(
+                 static_cast<double>(timestamp - first_timestamp) *
+                 timestamp_period);
+    };
+    for (uint32_t i = 0; i < num_scopes; ++i) {
+      const uint64_t begin = timestamps[i * 2];
+      const uint64_t end = std::max(begin, timestamps[i * 2 + 1]);
+      frame.gpu_events.push_back(
+          {queries.scope_names[i], to_ns(begin), to_ns(end), 0});
+    }
+  }
+
+  addFrame(std::move(frame));
+  frame = Frame();
+}
+
+void VulkanEngine::Profiler::readPipelineStatistics(FrameQueries& queries) {
+  const auto num_scopes =
+      static_cast<uint32_t>(queries.statistics_scope_names.size());
+  if (num_scopes == 0) {
+    return;
+  }
+
+  std::vector<uint64_t> results(num_scopes * kNumPipelineStatistics);
+  auto device = VulkanManager::getInstance().getDevice();
+  const auto result = device->getVkDevice().getQueryPoolResults(
+      queries.statistics_query_pool, 0, num_scopes,
+      results.size() * sizeof(uint64_t), results.data(),
+      kNumPipelineStatistics * sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+  if (result != vk::Result::eSuccess) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < num_scopes; ++i) {
+    const uint64_t* values = &results[i * kNumPipelineStatistics];
+    PipelineStatistics statistics;
+    statistics.name = queries.statistics_scope_names[i];
+    statistics.input_assembly_vertices = values[0];
+    statistics.input_assembly_primitives = values[1];
+    statistics.vertex_shader_invocations = values[2];
+    statistics.clipping_invocations = values[3];
+    statistics.clipping_primitives = values[4];
+    statistics.fragment_shader_invocations = values[5];
+    queries.frame.pipeline_statistics.push_back(statistics);
+  }
+}
+
+void VulkanEngine::Profiler::addFrame(Frame&& frame) {
+  auto it = frames.end();
+  while (it != frames.begin() && std::prev(it)->index > frame.index) {
+    --it;
+  }
+  frames.insert(it, std::move(frame));
+
+  while (frames.size() > max_frames) {
+    frames.pop_front();
+  }
+}
+
+VulkanEngine::ProfileScope::ProfileScope(const char* _name)
+    : profiler(nullptr), name(_name), begin_ns(0) {
+  auto& vulkan_profiler = VulkanManager::getInstance().getProfiler();
+  if (vulkan_profiler.isEnabled()) {
+    profiler = &vulkan_profiler;
+    begin_ns = profiler->now();
+  }
+}
+
+VulkanEngine::ProfileScope::~ProfileScope() {
+  if (profiler) {
+    profiler->recordCPUEvent(name, begin_ns, profiler->now());
+  }
+}
+
+VulkanEngine::GPUProfileScope::GPUProfileScope(
+    const vk::CommandBuffer& _command_buffer, const char* name)
+    : profiler(VulkanManager::getInstance().getProfiler()),
+      command_buffer(_command_buffer),
+      scope(profiler.beginGPUScope(command_buffer, name)) {}
+
+VulkanEngine::GPUProfileScope::~GPUProfileScope() {
+  profiler.endGPUScope(command_buffer, scope);
+}
@@ -19,12 +19,16 @@
 // SOFTWARE.
 
 #include <VulkanEngine/Image.h>
+#include <VulkanEngine/Profiler.h>
 #include <VulkanEngine/RenderPass.h>
 
 #include "VulkanEngine/VulkanManager.h"
 
 VulkanEngine::RenderPass::RenderPass(uint32_t _width, uint32_t _height)
-    : width(_width), height(_height) {
+    : width(_width),
+      height(_height),
+      gpu_scope(Profiler::kInvalidGPUScope),
+      statistics_scope(Profiler::kInvalidGPUScope) {
   depth_stencil_attachment.reset(new DepthStencilImageAttachment(
       vk::ImageLayout::eUndefined,
       vk::ImageUsageFlagBits::eDepthStencilAttachment,
@@ -137,28 +141,41 @@ const vk::RenderPass& VulkanEngine::RenderPass::getVkRenderPass() const {
   return vk_render_pass;
 }
 
-void VulkanEngine::RenderPass::begin() {
-  const std::array<float, 4> clear_color_array = {0.0f, 0.0f, 0.0f, 1.0f};
-  auto clear_color =
-      vk::ClearValue().setColor(vk::ClearColorValue(clear_color_array));
-  auto clear_depth_stencil =
-      vk::ClearValue().setDepthStencil(vk::ClearDepthStencilValue(1.0f, 0));
+void VulkanEngine::RenderPass::begin(vk::SubpassContents contents) {
+  beginFrame();
+  beginRenderPass(contents);
+}
 
-  std::array<vk::ClearValue, 3> clear_values = {
-      clear_color, clear_depth_stencil, clear_color};
+void VulkanEngine::RenderPass::beginFrame() {
+  VULKANENGINE_PROFILE_SCOPE("RenderPass::beginFrame");
 
+  // The command buffer is re-recorded from a freshly reset pool every frame.
   auto begin_info =
       vk::CommandBufferBeginInfo()
-          .setFlags(vk::CommandBufferUsageFlagBits::eSimultaneousUse)
+          .setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit)
           .setPInheritanceInfo(nullptr);
 
   auto& vulkan_manager = VulkanManager::getInstance();
 
-  vulkan_manager.waitForFence();
+  vulkan_manager.beginFrame();
 
   auto command_buffer = vulkan_manager.getCurrentCommandBuffer();
-
   command_buffer.begin(begin_info);
+  vulkan_manager.getProfiler().beginCommandBuffer(command_buffer);
+}
+
+void VulkanEngine::RenderPass::beginRenderPass(vk::SubpassContents contents) {
+  const std::array<float, 4> clear_color_array = {0.0f, 0.0f, 0.0f, 1.0f};
+  auto clear_color =
+      vk::ClearValue().setColor(vk::ClearColorValue(clear_color_array));
+  auto clear_depth_stencil =
+      vk::ClearValue().setDepthStencil(vk::ClearDepthStencilValue(1.0f, 0));
+
+  std::array<vk::ClearValue, 3> clear_values = {
+      clear_color, clear_depth_stencil, clear_color};
+
+  auto& vulkan_manager = VulkanManager::getInstance();
+  auto command_buffer = vulkan_manager.getCurrentCommandBuffer();
 
   auto render_pass_info =
       vk::RenderPassBeginInfo()
@@ -168,12 +185,30 @@ void VulkanEngine::RenderPass::begin() {
           .setClearValueCount(static_cast<uint32_t>(clear_values.size()))
           .setPClearValues(clear_values.data());
 
-  command_buffer.beginRenderPass(render_pass_info,
-                                 vk::SubpassContents::eInline);
+  // The scopes are ended in end(), once the render pass has ended. Secondary
+  // command buffers can only be executed during a pipeline statistics query
+  // if the device supports inherited queries.
+  auto& profiler = vulkan_manager.getProfiler();
+  gpu_scope = profiler.beginGPUScope(command_buffer, "RenderPass");
+  if (contents == vk::SubpassContents::eInline ||
+      profiler.canInheritPipelineStatistics()) {
+    statistics_scope = profiler.beginPipelineStatistics(
+        command_buffer, "RenderPass",
+        Profiler::PipelineStatisticsLevel::eRenderPass);
+  }
+  command_buffer.beginRenderPass(render_pass_info, contents);
 }
 
 void VulkanEngine::RenderPass::end() {
-  auto command_buffer = VulkanManager::getInstance().getCurrentCommandBuffer();
+  VULKANENGINE_PROFILE_SCOPE("RenderPass::end");
+
+  auto& vulkan_manager = VulkanManager::getInstance();
+  auto command_buffer = vulkan_manager.getCurrentCommandBuffer();
   command_buffer.endRenderPass();
+  auto& profiler = vulkan_manager.getProfiler();
+  profiler.endPipelineStatistics(command_buffer, statistics_scope);
+  statistics_scope = Profiler::kInvalidGPUScope;
+  profiler.endGPUScope(command_buffer, gpu_scope);
+  gpu_scope = Profiler::kInvalidGPUScope;
   command_buffer.end();
 }
@@ -0,0 +1,287 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/FrameStatistics.h>
+#include <VulkanEngine/GraphicsPipeline.h>
+#include <VulkanEngine/IndirectDrawBuffer.h>
+#include <VulkanEngine/MeshBase.h>
+#include <VulkanEngine/Profiler.h>
+#include <VulkanEngine/RenderQueue.h>
+#include <VulkanEngine/Shader.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+VulkanEngine::RenderStatistics& VulkanEngine::RenderStatistics::operator+=(
+    const RenderStatistics& other) {
+  draws += other.draws;
+  draw_calls += other.draw_calls;
+  pipeline_binds += other.pipeline_binds;
+  descriptor_set_binds += other.descriptor_set_binds;
+  vertex_buffer_binds += other.vertex_buffer_binds;
+  index_buffer_binds += other.index_buffer_binds;
+  record_time_ms += other.record_time_ms;
+  return *this;
+}
+
+VulkanEngine::RenderQueue::RenderQueue() : batches_built(false) {}
+
+VulkanEngine::RenderQueue::~RenderQueue() {}
+
+void VulkanEngine::RenderQueue::submit(const DrawPacket& draw_packet) {
+  draw_packets.push_back(draw_packet);
+  draw_packets.back().sort_key = computeSortKey(draw_packet);
+  draw_packets.back().depth_key = computeDepthKey(draw_packet);
+  batches_built = false;
+}
+
+void VulkanEngine::RenderQueue::clear() {
+  draw_packets.clear();
+  batches_built = false;
+}
+
+size_t VulkanEngine::RenderQueue::size() const { return draw_packets.size(); }
+
+const std::vector<VulkanEngine::DrawPacket>&
+VulkanEngine::RenderQueue::getDrawPackets() const {
+  return draw_packets;
+}
+
+void VulkanEngine::RenderQueue::sort() {
+  batches_built = false;
+
+  const size_t count = draw_packets.size();
+  if (count < 2) {
+    return;
+  }
+
+  sort_entries.resize(count);
+  sort_entries_scratch.resize(count);
+
+  // The four depth key bytes are the least significant, followed by the
+  // eight bytes of the sort key.
+  constexpr size_t kKeyBytes = 12;
+  const auto get_byte = [](const SortEntry& entry, size_t byte) {
+    return static_cast<uint32_t>(
+        byte < 4 ? (entry.depth_key >> (byte * 8)) & 0xFF
+                 : (entry.key >> ((byte - 4) * 8)) & 0xFF);
+  };
+
+  // Build the histograms of all key bytes in a single pass.
+  std::array<std::array<uint32_t, 256>, kKeyBytes> histograms = {};
+  for (size_t i = 0; i < count; ++i) {
+    const auto& draw_packet = draw_packets[i];
+    sort_entries[i] = {draw_packet.sort_key, draw_packet.depth_key,
+                       static_cast<uint32_t>(i)};
+    for (size_t byte = 0; byte < kKeyBytes; ++byte) {
+      ++histograms[byte][get_byte(sort_entries[i], byte)];
+    }
+  }
+
+  // Least significant byte first. Each pass is stable so the result is
+  // ordered by the full key.
+  for (size_t byte = 0; byte < kKeyBytes; ++byte) {
+    auto& histogram = histograms[byte];
+
+    // Skip passes where every key has the same value for this byte, which is
+    // common for the pipeline and shader ids.
+    if (histogram[get_byte(sort_entries[0], byte)] == count) {
+      continue;
+    }
+
+    uint32_t offset = 0;
+    for (auto& bucket : histogram) {
+      const uint32_t bucket_size = bucket;
+      bucket = offset;
+      offset += bucket_size;
+    }
+
+    for (const auto& entry : sort_entries) {
+      sort_entries_scratch[histogram[get_byte(entry, byte)]++] = entry;
+    }
+    sort_entries.swap(sort_entries_scratch);
+  }
+
+  draw_packets_scratch.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    draw_packets_scratch[i] = draw_packets[sort_entries[i].index];
+  }
+  draw_packets.swap(draw_packets_scratch);
+}
+
+void VulkanEngine::RenderQueue::buildBatches() {
+  batch_firsts.resize(draw_packets.size());
+
+  size_t batch_first = 0;
+  for (size_t i = 0; i < draw_packets.size(); ++i) {
+    const auto& draw_packet = draw_packets[i];
+    const auto& first_packet = draw_packets[batch_first];
+    const bool merge =
+        i > 0 && draw_packet.mesh->isIndexed() &&
+        first_packet.mesh->isIndexed() &&
+        draw_packet.graphics_pipeline == first_packet.graphics_pipeline &&
+        draw_packet.shader == first_packet.shader &&
+        draw_packet.descriptor_set_index == first_packet.descriptor_set_index &&
+        draw_packet.mesh->getGeometryId() == first_packet.mesh->getGeometryId();
+    if (!merge) {
+      batch_first = i;
+    }
+    batch_firsts[i] = static_cast<uint32_t>(batch_first);
+  }
+
+  batches_built = true;
+}
+
+bool VulkanEngine::RenderQueue::hasBatches() const { return batches_built; }
+
+size_t VulkanEngine::RenderQueue::getBatchFirst(size_t index) const {
+  return batch_firsts[index];
+}
+
+VulkanEngine::RenderStatistics VulkanEngine::RenderQueue::record(
+    const vk::CommandBuffer& command_buffer, size_t begin, size_t end,
+    const IndirectDrawBuffer* indirect_draw_buffer) const {
+  RenderStatistics statistics;
+
+  if (indirect_draw_buffer && !batches_built) {
+    throw std::runtime_error(
+        "RenderQueue::buildBatches() must be called before recording indirect "
+        "draws.");
+  }
+
+  const GraphicsPipeline* bound_graphics_pipeline = nullptr;
+  const Shader* bound_shader = nullptr;
+  uint32_t bound_descriptor_set_index = 0;
+  const void* bound_geometry = nullptr;
+
+  // The draws of each pipeline are measured as a group on the GPU.
+  auto& profiler = VulkanManager::getInstance().getProfiler();
+  uint32_t gpu_scope = Profiler::kInvalidGPUScope;
+  uint32_t statistics_scope = Profiler::kInvalidGPUScope;
+
+  end = std::min(end, draw_packets.size());
+  for (size_t i = begin; i < end; ++i) {
+    const auto& draw_packet = draw_packets[i];
+
+    if (draw_packet.graphics_pipeline != bound_graphics_pipeline) {
+      profiler.endPipelineStatistics(command_buffer, statistics_scope);
+      profiler.endGPUScope(command_buffer, gpu_scope);
+      gpu_scope = profiler.beginGPUScope(command_buffer, "Draw group");
+      statistics_scope = profiler.beginPipelineStatistics(
+          command_buffer, "Draw group",
+          Profiler::PipelineStatisticsLevel::eDrawGroup);
+      draw_packet.graphics_pipeline->bindPipeline(command_buffer);
+      bound_graphics_pipeline = draw_packet.graphics_pipeline;
+      // Pipelines of different shaders may use incompatible layouts, so
+      // descriptor sets are always bound again after a pipeline change.
+      bound_shader = nullptr;
+      ++statistics.pipeline_binds;
+    }
+
+    const void* geometry = draw_packet.mesh->getGeometryId();
+    if (geometry != bound_geometry) {
+      draw_packet.mesh->bindVertexBuffers(command_buffer);
+      draw_packet.mesh->bindIndexBuffer(command_buffer);
+      bound_geometry = geometry;
+      ++statistics.vertex_buffer_binds;
+      ++statistics.index_buffer_binds;
+    }
+
+    if (draw_packet.shader != bound_shader ||
+        draw_packet.descriptor_set_index != bound_descriptor_set_index) {
+      draw_packet.shader->bindDescriptorSet(command_buffer,
+                                            draw_packet.descriptor_set_index);
+      bound_shader = draw_packet.shader;
+      bound_descriptor_set_index = draw_packet.descriptor_set_index;
+      ++statistics.descriptor_set_binds;
+    }
+
+    if (!draw_packet.mesh->isIndexed()) {
+      const auto command = draw_packet.mesh->getDrawIndirectCommand();
+      command_buffer.draw(command.vertexCount, command.instanceCount,
+                          command.firstVertex, draw_packet.draw_data_index);
+      VULKANENGINE_COUNT_STATISTIC(eDrawCalls, 1);
+      VULKANENGINE_COUNT_STATISTIC(
+          eTriangles, command.vertexCount / 3 * command.instanceCount);
+      ++statistics.draws;
+      ++statistics.draw_calls;
+      continue;
+    }
+
+    if (!indirect_draw_buffer) {
+      const auto command = draw_packet.mesh->getDrawIndexedIndirectCommand();
+      command_buffer.drawIndexed(command.indexCount, command.instanceCount,
+                                 command.firstIndex, command.vertexOffset,
+                                 draw_packet.draw_data_index);
+      VULKANENGINE_COUNT_STATISTIC(eDrawCalls, 1);
+      VULKANENGINE_COUNT_STATISTIC(
+          eTriangles, command.indexCount / 3 * command.instanceCount);
+      ++statistics.draws;
+      ++statistics.draw_calls;
+      continue;
+    }
+
+    // Write the commands of the whole batch and draw them at once.
+    auto commands = indirect_draw_buffer->getCommands();
+    size_t batch_end = i;
+    do {
+      const auto& batch_packet = draw_packets[batch_end];
+      // Built on the stack, the mapped memory may be slow to read back.
+      auto command = batch_packet.mesh->getDrawIndexedIndirectCommand();
+      command.firstInstance = batch_packet.draw_data_index;
+      commands[batch_end] = command;
+      VULKANENGINE_COUNT_STATISTIC(
+          eTriangles, command.indexCount / 3 * command.instanceCount);
+      ++batch_end;
+    } while (batch_end < end && batch_firsts[batch_end] == batch_firsts[i]);
+
+    const size_t draw_calls =
+        indirect_draw_buffer->draw(command_buffer, i, batch_end - i);
+    VULKANENGINE_COUNT_STATISTIC(eDrawCalls, draw_calls);
+    statistics.draw_calls += draw_calls;
+    statistics.draws += batch_end - i;
+    i = batch_end - 1;
+  }
+  profiler.endPipelineStatistics(command_buffer, statistics_scope);
+  profiler.endGPUScope(command_buffer, gpu_scope);
+
+  return statistics;
+}
+
+uint64_t VulkanEngine::RenderQueue::computeSortKey(
+    const DrawPacket& draw_packet) {
+  const uint64_t pipeline_id = draw_packet.graphics_pipeline->getId();
+  const uint64_t shader_id = draw_packet.shader->getId();
+  return (pipeline_id << 32) | shader_id;
+}
+
+uint32_t VulkanEngine::RenderQueue::computeDepthKey(
+    const DrawPacket& draw_packet) {
+  // The bit pattern of a non-negative float increases monotonically with its
+  // value, so it can be sorted as an unsigned integer. Anything behind the
+  // camera or NaN is clamped to 0.
+  const float depth = draw_packet.depth > 0.0f ? draw_packet.depth : 0.0f;
+  uint32_t depth_bits;
+  std::memcpy(&depth_bits, &depth, sizeof(depth_bits));
+  return depth_bits;
+}
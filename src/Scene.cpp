@@ -18,19 +18,33 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <VulkanEngine/Camera.h>
+#include <VulkanEngine/Profiler.h>
 #include <VulkanEngine/RenderPass.h>
 #include <VulkanEngine/Scene.h>
 #include <VulkanEngine/VulkanManager.h>
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
 VulkanEngine::Scene::Scene(const std::vector<std::shared_ptr<Window>>& _windows)
-    : windows(_windows) {}
+    : windows(_windows),
+      camera(nullptr),
+      camera_node(0),
+      indirect_drawing_enabled(true),
+      frustum_culling_enabled(false),
+      gpu_culling_enabled(false) {
+  disableLegacyUpdate();
+}
 
-VulkanEngine::Scene::~Scene() {}
+VulkanEngine::Scene::~Scene() {
+  releaseTransformHierarchy(world_transforms, world_transform_objects);
+}
 
 void VulkanEngine::Scene::update() {
+  VULKANENGINE_PROFILE_SCOPE("Scene::update");
+
   if (!state_instance.get()) {
     state_instance.reset(new SceneState(*this));
   }
@@ -40,9 +54,49 @@ void VulkanEngine::Scene::update() {
       window->update();
     }
   }
-  VulkanManager::getInstance().getDefaultRenderPass()->begin();
-  SceneObject::update(state_instance);
-  VulkanManager::getInstance().getDefaultRenderPass()->end();
+
+  state_instance->getRenderQueue().clear();
+  state_instance->setFrustumCullingEnabled(frustum_culling_enabled);
+
+  if (isTransformHierarchyDirty()) {
+    releaseTransformHierarchy(world_transforms, world_transform_objects);
+    buildTransformHierarchy(world_transforms, world_transform_objects);
+
+    // Node 0 is the root, so object i has node i + 1.
+    camera = nullptr;
+    for (size_t i = 0; i < world_transform_objects.size(); ++i) {
+      auto object_camera = dynamic_cast<Camera*>(world_transform_objects[i]);
+      if (object_camera != nullptr) {
+        camera = object_camera;
+        camera_node = static_cast<uint32_t>(i + 1);
+      }
+    }
+  }
+  world_transforms.update();
+  state_instance->setTransformHierarchy(&world_transforms);
+  updateView();
+  state_instance->setTransformNode(0);
+
+  // The render pass only begins once traversal is done, so that commands
+  // which must be recorded outside of it, such as culling, can be inserted
+  // for the draws of the frame. Uploads are recorded first so that objects
+  // can draw whatever became available before traversal. Texture levels
+  // requested during the previous traversal are queued for upload first.
+  // Memory is defragmented before the frame begins, since moved resources
+  // must not be referenced by commands recorded before the move.
+  auto& vulkan_manager = VulkanManager::getInstance();
+  auto render_pass = vulkan_manager.getDefaultRenderPass();
+  vulkan_manager.getMemoryDefragmenter().update();
+  render_pass->beginFrame();
+  vulkan_manager.getTextureStreamer().update();
+  vulkan_manager.getTransferQueue().flush(
+      vulkan_manager.getCurrentCommandBuffer());
+  {
+    VULKANENGINE_PROFILE_SCOPE("Scene::traverse");
+    SceneObject::update(*state_instance);
+  }
+  recordRenderQueue();
+  render_pass->end();
 }
 
 const std::shared_ptr<VulkanEngine::Window>
@@ -54,4 +108,172 @@ VulkanEngine::Scene::getActiveWindow() const {
   return std::shared_ptr<VulkanEngine::Window>();
 }
 
-void VulkanEngine::Scene::update(std::shared_ptr<SceneState> scene_state) {}
+void VulkanEngine::Scene::setRecordingThreadCount(size_t num_threads) {
+  if (num_threads == getRecordingThreadCount()) {
+    return;
+  }
+
+  if (num_threads == 0) {
+    command_recorder.reset();
+  } else {
+    command_recorder.reset(new ParallelCommandRecorder(num_threads));
+  }
+}
+
+size_t VulkanEngine::Scene::getRecordingThreadCount() const {
+  return command_recorder.get() ? command_recorder->getNumThreads() : 0;
+}
+
+void VulkanEngine::Scene::setIndirectDrawingEnabled(bool enabled) {
+  indirect_drawing_enabled = enabled;
+}
+
+bool VulkanEngine::Scene::isIndirectDrawingEnabled() const {
+  // The draw index is passed to shaders through firstInstance, which indirect
+  // draws only support with drawIndirectFirstInstance.
+  return indirect_drawing_enabled && VulkanManager::getInstance()
+                                         .getDevice()
+                                         ->getEnabledFeatures()
+                                         .drawIndirectFirstInstance;
+}
+
+void VulkanEngine::Scene::setFrustumCullingEnabled(bool enabled) {
+  frustum_culling_enabled = enabled;
+}
+
+bool VulkanEngine::Scene::isFrustumCullingEnabled() const {
+  return frustum_culling_enabled;
+}
+
+void VulkanEngine::Scene::setGPUCullingEnabled(bool enabled) {
+  gpu_culling_enabled = enabled;
+}
+
+bool VulkanEngine::Scene::isGPUCullingEnabled() const {
+  return gpu_culling_enabled && isIndirectDrawingEnabled();
+}
+
+const std::shared_ptr<VulkanEngine::GPUCullingPass>
+VulkanEngine::Scene::getGPUCullingPass() {
+  if (!gpu_culling_pass.get()) {
+    gpu_culling_pass.reset(new GPUCullingPass());
+  }
+  return gpu_culling_pass;
+}
+
+const VulkanEngine::RenderStatistics&
+VulkanEngine::Scene::getRenderStatistics() const {
+  return render_statistics;
+}
+
+std::shared_ptr<VulkanEngine::SceneObject> VulkanEngine::Scene::pick(
+    const Eigen::Vector2d& window_position) {
+  const auto window = getActiveWindow();
+  if (!state_instance.get() || !window.get() || window->getWidth() == 0 ||
+      window->getHeight() == 0) {
+    return std::shared_ptr<SceneObject>();
+  }
+
+  // Unproject the position on the near and far planes. Vulkan normalized
+  // device coordinates have y pointing down like window coordinates.
+  const Eigen::Vector2f ndc(
+      static_cast<float>(2.0 * window_position.x() / window->getWidth() - 1.0),
+      static_cast<float>(2.0 * window_position.y() / window->getHeight() -
+                         1.0));
+  const Eigen::Matrix4f inverse_view_projection =
+      (state_instance->getProjectionMatrix() * state_instance->getViewMatrix())
+          .inverse();
+  const Eigen::Vector4f near_point =
+      inverse_view_projection * Eigen::Vector4f(ndc.x(), ndc.y(), 0.0f, 1.0f);
+  const Eigen::Vector4f far_point =
+      inverse_view_projection * Eigen::Vector4f(ndc.x(), ndc.y(), 1.0f, 1.0f);
+
+  const Eigen::Vector3f origin = near_point.head<3>() / near_point.w();
+  const Eigen::Vector3f direction =
+      far_point.head<3>() / far_point.w() - origin;
+
+  // The scene's children are in world space, so search up to the far plane.
+  float distance = 1.0f;
+  return pickChild(origin, direction, distance);
+}
+
+void VulkanEngine::Scene::update(SceneState& scene_state) {}
+
+void VulkanEngine::Scene::updateView() {
+  // The camera is a child like any other, so the children of the root would
+  // otherwise be culled with the view of the previous frame.
+  if (camera != nullptr) {
+    state_instance->setTransformNode(camera_node);
+    camera->updateView(*state_instance);
+  }
+}
+
+void VulkanEngine::Scene::recordRenderQueue() {
+  VULKANENGINE_PROFILE_SCOPE("Scene::recordRenderQueue");
+  auto begin = std::chrono::steady_clock::now();
+
+  auto& vulkan_manager = VulkanManager::getInstance();
+  auto command_buffer = vulkan_manager.getCurrentCommandBuffer();
+  auto& render_queue = state_instance->getRenderQueue();
+
+  render_queue.sort();
+
+  IndirectDrawBuffer* indirect_draw_buffer = nullptr;
+  if (isIndirectDrawingEnabled()) {
+    const auto frame_index = vulkan_manager.getCurrentFrame();
+    if (indirect_draw_buffers.size() != vulkan_manager.getFramesInFlight()) {
+      indirect_draw_buffers.resize(vulkan_manager.getFramesInFlight());
+    }
+    auto& frame_indirect_draw_buffer = indirect_draw_buffers[frame_index];
+    if (!frame_indirect_draw_buffer.get()) {
+      frame_indirect_draw_buffer.reset(new IndirectDrawBuffer());
+    }
+    // The frame's fence has been waited on in RenderPass::beginFrame(), so
+    // the buffer can safely be recreated if it has to grow.
+    frame_indirect_draw_buffer->reserve(render_queue.size());
+    indirect_draw_buffer = frame_indirect_draw_buffer.get();
+    render_queue.buildBatches();
+
+    if (isGPUCullingEnabled()) {
+      VULKANENGINE_PROFILE_GPU_SCOPE(command_buffer, "GPUCullingPass");
+      const Eigen::Matrix4f view_projection =
+          state_instance->getProjectionMatrix() *
+          state_instance->getViewMatrix();
+      getGPUCullingPass()->cull(command_buffer, render_queue,
+                                *indirect_draw_buffer, view_projection,
+                                frame_index);
+    }
+  }
+
+  vulkan_manager.getDefaultRenderPass()->beginRenderPass(
+      command_recorder.get() ? vk::SubpassContents::eSecondaryCommandBuffers
+                             : vk::SubpassContents::eInline);
+
+  if (!command_recorder.get()) {
+    render_statistics = render_queue.record(
+        command_buffer, 0, render_queue.size(), indirect_draw_buffer);
+  } else if (render_queue.size() == 0) {
+    render_statistics = RenderStatistics();
+  } else {
+    auto inheritance_info =
+        vk::CommandBufferInheritanceInfo()
+            .setRenderPass(
+                vulkan_manager.getDefaultRenderPass()->getVkRenderPass())
+            .setSubpass(0)
+            .setFramebuffer(vulkan_manager.getCurrentSwapchainFramebuffer())
+            .setPipelineStatistics(vulkan_manager.getProfiler()
+                                       .getInheritedPipelineStatistics());
+
+    auto secondary_command_buffers =
+        command_recorder->record(render_queue, inheritance_info,
+                                 vulkan_manager.getCurrentFrame(),
+                                 indirect_draw_buffer);
+    command_buffer.executeCommands(secondary_command_buffers);
+    render_statistics = command_recorder->getStatistics();
+  }
+
+  render_statistics.record_time_ms =
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - begin)
+          .count();
+}
@@ -21,51 +21,496 @@
 #include <VulkanEngine/SceneObject.h>
 
 #include <algorithm>
+#include <limits>
 #include <memory>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
+namespace {
+
+/// Marks a child without an entry in child_bounding_boxes.
+constexpr size_t kNoSlot = std::numeric_limits<size_t>::max();
+
+}  // namespace
+
 VulkanEngine::SceneObject::SceneObject()
-    : transform(Eigen::Matrix4f::Identity()) {}
+    : transform(Eigen::Matrix4f::Identity()),
+      transform_hierarchy_dirty(true),
+      has_subtree_bounding_box(false),
+      subtree_is_cullable(true),
+      subtree_bounding_box_dirty(true),
+      child_bounding_boxes_dirty(true),
+      children_are_cullable(true),
+      legacy_update(LegacyUpdate::eUnknown) {}
 
-/// Update this scene object.
-/// \param scene_state Contains information about the current state of the
-/// scene.
-void VulkanEngine::SceneObject::preUpdate(
-    std::shared_ptr<SceneState> scene_state) {
-  scene_state->setTransform(scene_state->getTotalTransform() * transform);
+VulkanEngine::SceneObject::~SceneObject() {
+  // Parents own their children, so only the children can outlive this object
+  // and have to forget about it.
+  for (const auto& child : children) {
+    if (child.get() == nullptr) {
+      continue;
+    }
+    auto& child_parents = child->parents;
+    child_parents.erase(
+        std::remove_if(child_parents.begin(), child_parents.end(),
+                       [this](const std::pair<SceneObject*, size_t>& parent) {
+                         return parent.first == this;
+                       }),
+        child_parents.end());
+  }
+}
+
+void VulkanEngine::SceneObject::preUpdate(SceneState& scene_state) {
+  if (usesLegacyUpdate()) {
+    preUpdate(scene_state.shared_from_this());
+  }
+}
+
+void VulkanEngine::SceneObject::update(SceneState& scene_state) {
+  if (usesLegacyUpdate()) {
+    update(scene_state.shared_from_this());
+    return;
+  }
+  updateChildren(scene_state);
 }
 
+void VulkanEngine::SceneObject::postUpdate(SceneState& scene_state) {
+  if (usesLegacyUpdate()) {
+    postUpdate(scene_state.shared_from_this());
+  }
+}
+
+void VulkanEngine::SceneObject::preUpdate(
+    std::shared_ptr<SceneState> scene_state) {}
+
 void VulkanEngine::SceneObject::update(
     std::shared_ptr<SceneState> scene_state) {
-  /// Update all children
-  for (const auto& child : children) {
-    if (child.get() != nullptr) {
-      child->preUpdate(scene_state);
-      child->update(scene_state);
-      child->postUpdate(scene_state);
-    }
-  }
+  updateChildren(*scene_state);
 }
 
-/// Update this scene object.
-/// \param scene_state Contains information about the current state of the
-/// scene.
 void VulkanEngine::SceneObject::postUpdate(
-    std::shared_ptr<SceneState> scene_state) {
-  scene_state->setTransform(scene_state->getTotalTransform() *
-                            transform.inverse());
+    std::shared_ptr<SceneState> scene_state) {}
+
+void VulkanEngine::SceneObject::disableLegacyUpdate() {
+  legacy_update = LegacyUpdate::eDisabled;
+}
+
+bool VulkanEngine::SceneObject::usesLegacyUpdate() {
+  if (legacy_update == LegacyUpdate::eUnknown) {
+    // Only subclasses can override the deprecated overloads.
+    legacy_update = typeid(*this) == typeid(SceneObject)
+                        ? LegacyUpdate::eDisabled
+                        : LegacyUpdate::eEnabled;
+  }
+  return legacy_update == LegacyUpdate::eEnabled;
+}
+
+void VulkanEngine::SceneObject::updateChildren(SceneState& scene_state) {
+  const bool frustum_culling = scene_state.isFrustumCullingEnabled();
+  if (frustum_culling) {
+    cullChildren(scene_state);
+  }
+
+  // The nodes of the children follow the node of this object depth first.
+  // Children added since the hierarchy was built have no node yet and are
+  // skipped until the next frame.
+  const TransformHierarchy& hierarchy = *scene_state.getTransformHierarchy();
+  const uint32_t node = scene_state.getTransformNode();
+  const uint32_t subtree_end = hierarchy.getSubtreeEnd(node);
+  uint32_t child_node = node + 1;
+
+  /// Update all children
+  for (size_t i = 0; i < children.size() && child_node < subtree_end; ++i) {
+    const auto& child = children[i];
+    if (child.get() == nullptr) {
+      continue;
+    }
+    const uint32_t next_child_node = hierarchy.getSubtreeEnd(child_node);
+    if (frustum_culling && i < child_visibility.size() &&
+        !child_visibility[i]) {
+      child_node = next_child_node;
+      continue;
+    }
+    scene_state.setTransformNode(child_node);
+    child->preUpdate(scene_state);
+    child->update(scene_state);
+    child->postUpdate(scene_state);
+    scene_state.setTransformNode(node);
+    child_node = next_child_node;
+  }
 }
 
 void VulkanEngine::SceneObject::addChildren(
     const std::vector<std::shared_ptr<SceneObject>>& _children) {
-  children.insert(children.end(), _children.cbegin(), _children.cend());
+  for (const auto& child : _children) {
+    if (child.get() != nullptr) {
+      child->parents.emplace_back(this, children.size());
+    }
+    children.push_back(child);
+  }
+  child_bounding_boxes_dirty = true;
+  markSubtreeBoundingBoxDirty();
+  markTransformHierarchyDirty();
 }
 
-const Eigen::Matrix4f VulkanEngine::SceneObject::getTransform() const {
+const Eigen::Matrix4f& VulkanEngine::SceneObject::getTransform() const {
   return transform;
 }
 
 void VulkanEngine::SceneObject::setTransform(
     const Eigen::Matrix4f& _transform) {
   transform = _transform;
+  for (const auto& transform_node : transform_nodes) {
+    transform_node.first->setLocalTransform(transform_node.second, transform);
+  }
+
+  // The subtree bounds are in local space and don't change, only the bounds
+  // the parents cached for this object do.
+  for (const auto& parent : parents) {
+    parent.first->onChildBoundingBoxChanged(parent.second);
+  }
+}
+
+bool VulkanEngine::SceneObject::getLocalBoundingBox(
+    BoundingBox<Eigen::Vector3f>& bounding_box) const {
+  return false;
+}
+
+bool VulkanEngine::SceneObject::isCullable() const { return true; }
+
+bool VulkanEngine::SceneObject::getSubtreeBoundingBox(
+    BoundingBox<Eigen::Vector3f>& bounding_box) {
+  updateSubtreeBoundingBox();
+  if (!subtree_is_cullable || !has_subtree_bounding_box) {
+    return false;
+  }
+  bounding_box = subtree_bounding_box;
+  return true;
+}
+
+std::shared_ptr<VulkanEngine::SceneObject>
+VulkanEngine::SceneObject::pickChild(const Eigen::Vector3f& origin,
+                                     const Eigen::Vector3f& direction,
+                                     float& distance) {
+  std::shared_ptr<SceneObject> result;
+  float nearest = distance;
+  pickChildren(origin, direction, nearest, result);
+  if (result.get() != nullptr) {
+    distance = nearest;
+  }
+  return result;
+}
+
+void VulkanEngine::SceneObject::invalidateBoundingBox() {
+  markSubtreeBoundingBoxDirty();
+}
+
+void VulkanEngine::SceneObject::buildTransformHierarchy(
+    TransformHierarchy& hierarchy, std::vector<SceneObject*>& objects) {
+  hierarchy.clear();
+  objects.clear();
+  // The root's own transform isn't applied to its children.
+  const uint32_t root =
+      hierarchy.addNode(TransformHierarchy::kNoParent,
+                        Eigen::Matrix4f::Identity());
+  addTransformNodes(hierarchy, root, objects);
+  transform_hierarchy_dirty = false;
+}
+
+void VulkanEngine::SceneObject::releaseTransformHierarchy(
+    const TransformHierarchy& hierarchy,
+    const std::vector<SceneObject*>& objects) {
+  for (const auto object : objects) {
+    auto& nodes = object->transform_nodes;
+    nodes.erase(std::remove_if(nodes.begin(), nodes.end(),
+                               [&hierarchy](const auto& node) {
+                                 return node.first == &hierarchy;
+                               }),
+                nodes.end());
+  }
+}
+
+bool VulkanEngine::SceneObject::isTransformHierarchyDirty() const {
+  return transform_hierarchy_dirty;
+}
+
+void VulkanEngine::SceneObject::updateSubtreeBoundingBox() {
+  if (!subtree_bounding_box_dirty) {
+    return;
+  }
+
+  updateChildBoundingBoxes();
+
+  subtree_is_cullable = isCullable() && children_are_cullable;
+  has_subtree_bounding_box = getLocalBoundingBox(subtree_bounding_box);
+
+  BoundingBox<Eigen::Vector3f> children_bounding_box;
+  bool has_children_bounding_box = false;
+  if (child_hierarchy.size() > 0) {
+    children_bounding_box = child_hierarchy.getRootBoundingBox();
+    has_children_bounding_box = true;
+  } else {
+    for (size_t i = 0; i < child_bounding_boxes.size(); ++i) {
+      const auto child_bounding_box = child_bounding_boxes.get(i);
+      if (has_children_bounding_box) {
+        children_bounding_box.min =
+            children_bounding_box.min.cwiseMin(child_bounding_box.min);
+        children_bounding_box.max =
+            children_bounding_box.max.cwiseMax(child_bounding_box.max);
+      } else {
+        children_bounding_box = child_bounding_box;
+        has_children_bounding_box = true;
+      }
+    }
+  }
+
+  if (has_children_bounding_box) {
+    if (has_subtree_bounding_box) {
+      subtree_bounding_box.min =
+          subtree_bounding_box.min.cwiseMin(children_bounding_box.min);
+      subtree_bounding_box.max =
+          subtree_bounding_box.max.cwiseMax(children_bounding_box.max);
+    } else {
+      subtree_bounding_box = children_bounding_box;
+      has_subtree_bounding_box = true;
+    }
+  }
+
+  subtree_bounding_box_dirty = false;
+}
+
+void VulkanEngine::SceneObject::markSubtreeBoundingBoxDirty() {
+  // If already dirty, the parents have been notified and will update the
+  // bounds they cached for this object.
+  if (subtree_bounding_box_dirty) {
+    return;
+  }
+  subtree_bounding_box_dirty = true;
+  for (const auto& parent : parents) {
+    parent.first->onChildBoundingBoxChanged(parent.second);
+  }
+}
+
+void VulkanEngine::SceneObject::markTransformHierarchyDirty() {
+  // If already dirty, the ancestors are dirty as well.
+  if (transform_hierarchy_dirty) {
+    return;
+  }
+  transform_hierarchy_dirty = true;
+  for (const auto& parent : parents) {
+    parent.first->markTransformHierarchyDirty();
+  }
+}
+
+void VulkanEngine::SceneObject::addTransformNodes(
+    TransformHierarchy& hierarchy, uint32_t node,
+    std::vector<SceneObject*>& objects) {
+  for (const auto& child : children) {
+    if (child.get() == nullptr) {
+      continue;
+    }
+    const uint32_t child_node = hierarchy.addNode(node, child->transform);
+    child->transform_nodes.emplace_back(&hierarchy, child_node);
+    child->transform_hierarchy_dirty = false;
+    objects.push_back(child.get());
+    child->addTransformNodes(hierarchy, child_node, objects);
+  }
+}
+
+void VulkanEngine::SceneObject::onChildBoundingBoxChanged(size_t index) {
+  if (!child_bounding_boxes_dirty && !dirty_child_flags[index]) {
+    dirty_child_flags[index] = 1;
+    dirty_children.push_back(index);
+  }
+  markSubtreeBoundingBoxDirty();
+}
+
+void VulkanEngine::SceneObject::updateChildBoundingBoxes() {
+  if (!child_bounding_boxes_dirty && !dirty_children.empty()) {
+    // Refitting the whole hierarchy at once is cheaper than refitting the
+    // path to the root of every box when many children changed.
+    const bool refit_all =
+        dirty_children.size() > child_bounding_boxes.size() / 8;
+    BoundingBox<Eigen::Vector3f> bounding_box;
+    for (const auto index : dirty_children) {
+      dirty_child_flags[index] = 0;
+      if (child_bounding_boxes_dirty || children[index].get() == nullptr) {
+        continue;
+      }
+
+      const auto state = getChildBoundingBox(index, bounding_box);
+      if (state != child_states[index]) {
+        child_bounding_boxes_dirty = true;
+      } else if (state == ChildState::eBounded) {
+        const size_t slot = child_bounding_box_slots[index];
+        child_bounding_boxes.set(slot, bounding_box);
+        if (child_hierarchy.size() > 0 && !refit_all) {
+          child_hierarchy.setBoundingBox(slot, bounding_box);
+        }
+      }
+    }
+    dirty_children.clear();
+
+    if (!child_bounding_boxes_dirty && refit_all &&
+        child_hierarchy.size() > 0) {
+      child_hierarchy.refit(child_bounding_boxes);
+    }
+  }
+
+  if (child_bounding_boxes_dirty) {
+    rebuildChildBoundingBoxes();
+  }
+}
+
+void VulkanEngine::SceneObject::rebuildChildBoundingBoxes() {
+  child_states.assign(children.size(), ChildState::eNoBounds);
+  child_bounding_box_slots.assign(children.size(), kNoSlot);
+  dirty_child_flags.assign(children.size(), 0);
+  dirty_children.clear();
+  child_bounding_boxes.clear();
+  child_bounding_box_indices.clear();
+  unbounded_children.clear();
+  children_are_cullable = true;
+
+  BoundingBox<Eigen::Vector3f> bounding_box;
+  for (size_t i = 0; i < children.size(); ++i) {
+    if (children[i].get() == nullptr) {
+      continue;
+    }
+
+    const auto state = getChildBoundingBox(i, bounding_box);
+    child_states[i] = state;
+    if (state == ChildState::eBounded) {
+      child_bounding_box_slots[i] = child_bounding_boxes.size();
+      child_bounding_boxes.push_back(bounding_box);
+      child_bounding_box_indices.push_back(i);
+    } else {
+      unbounded_children.push_back(i);
+      children_are_cullable =
+          children_are_cullable && state != ChildState::eNotCullable;
+    }
+  }
+
+  if (child_bounding_boxes.size() >= kMinChildrenForHierarchy) {
+    child_hierarchy.build(child_bounding_boxes);
+  } else {
+    child_hierarchy.clear();
+  }
+
+  child_bounding_boxes_dirty = false;
+}
+
+VulkanEngine::SceneObject::ChildState
+VulkanEngine::SceneObject::getChildBoundingBox(
+    size_t index, BoundingBox<Eigen::Vector3f>& bounding_box) {
+  const auto& child = children[index];
+  child->updateSubtreeBoundingBox();
+  if (!child->subtree_is_cullable) {
+    return ChildState::eNotCullable;
+  }
+  if (!child->has_subtree_bounding_box) {
+    return ChildState::eNoBounds;
+  }
+  bounding_box = Frustum::transformBoundingBox(child->transform,
+                                               child->subtree_bounding_box);
+  return ChildState::eBounded;
+}
+
+void VulkanEngine::SceneObject::cullChildren(SceneState& scene_state) {
+  updateChildBoundingBoxes();
+
+  // Test the boxes in the local space of this object, so they don't have to
+  // be transformed every frame.
+  const Frustum frustum(scene_state.getProjectionMatrix() *
+                        scene_state.getViewMatrix() *
+                        scene_state.getTotalTransform());
+
+  if (child_hierarchy.size() > 0) {
+    child_visibility.assign(children.size(), 0);
+    for (const auto index : unbounded_children) {
+      child_visibility[index] = 1;
+    }
+    child_hierarchy.intersectFrustum(frustum, visible_child_bounding_boxes);
+    for (const auto slot : visible_child_bounding_boxes) {
+      child_visibility[child_bounding_box_indices[slot]] = 1;
+    }
+    return;
+  }
+
+  child_visibility.assign(children.size(), 1);
+  frustum.intersects(child_bounding_boxes, child_bounding_box_visibility);
+  for (size_t i = 0; i < child_bounding_box_indices.size(); ++i) {
+    child_visibility[child_bounding_box_indices[i]] =
+        child_bounding_box_visibility[i];
+  }
+}
+
+void VulkanEngine::SceneObject::pickChildren(
+    const Eigen::Vector3f& origin, const Eigen::Vector3f& direction,
+    float& distance, std::shared_ptr<SceneObject>& result) {
+  updateChildBoundingBoxes();
+
+  std::vector<BoundingVolumeHierarchy::RayHit> hits;
+  if (child_hierarchy.size() > 0) {
+    child_hierarchy.intersectRay(origin, direction, distance, hits);
+  } else {
+    const Eigen::Vector3f inverse_direction = direction.cwiseInverse();
+    float hit_distance;
+    for (size_t i = 0; i < child_bounding_boxes.size(); ++i) {
+      if (BoundingVolumeHierarchy::intersectRay(
+              child_bounding_boxes.get(i), origin, inverse_direction,
+              distance, hit_distance)) {
+        hits.push_back({hit_distance, static_cast<uint32_t>(i)});
+      }
+    }
+    std::sort(hits.begin(), hits.end(),
+              [](const BoundingVolumeHierarchy::RayHit& a,
+                 const BoundingVolumeHierarchy::RayHit& b) {
+                return a.distance < b.distance;
+              });
+  }
+
+  // Subtrees are visited front to back, so the search ends once a subtree
+  // starts behind the nearest hit.
+  for (const auto& hit : hits) {
+    if (hit.distance > distance) {
+      break;
+    }
+    pickObject(children[child_bounding_box_indices[hit.primitive]], origin,
+               direction, distance, result);
+  }
+
+  // Subtrees which aren't cullable have no cached bounds but may still
+  // contain bounded objects.
+  for (const auto index : unbounded_children) {
+    if (child_states[index] == ChildState::eNotCullable) {
+      pickObject(children[index], origin, direction, distance, result);
+    }
+  }
+}
+
+void VulkanEngine::SceneObject::pickObject(
+    const std::shared_ptr<SceneObject>& object, const Eigen::Vector3f& origin,
+    const Eigen::Vector3f& direction, float& distance,
+    std::shared_ptr<SceneObject>& result) {
+  // Distances along the ray are preserved by affine transforms when the
+  // direction is transformed along with the origin.
+  const Eigen::Matrix4f inverse_transform = object->transform.inverse();
+  const Eigen::Vector3f local_origin =
+      (inverse_transform * origin.homogeneous()).head<3>();
+  const Eigen::Vector3f local_direction =
+      inverse_transform.topLeftCorner<3, 3>() * direction;
+
+  BoundingBox<Eigen::Vector3f> bounding_box;
+  float hit_distance;
+  if (object->getLocalBoundingBox(bounding_box) &&
+      BoundingVolumeHierarchy::intersectRay(
+          bounding_box, local_origin, local_direction.cwiseInverse(),
+          distance, hit_distance)) {
+    distance = hit_distance;
+    result = object;
+  }
+
+  object->pickChildren(local_origin, local_direction, distance, result);
 }
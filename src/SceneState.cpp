@@ -24,40 +24,91 @@
 
 VulkanEngine::SceneState::SceneState(const Scene& _scene)
     : scene(_scene),
-      total_transform(Eigen::Matrix4f::Identity()),
-      view_matrix(),
-      projection_matrix() {}
+      transform(Eigen::Matrix4f::Identity()),
+      total_transform(&transform),
+      transform_hierarchy(nullptr),
+      transform_node(0),
+      view_matrix(Eigen::Matrix4f::Identity()),
+      projection_matrix(Eigen::Matrix4f::Identity()),
+      frustum_culling_enabled(false),
+      has_projection_matrix(false),
+      frustum_dirty(true) {}
 
 const VulkanEngine::Scene& VulkanEngine::SceneState::getScene() const {
   return scene;
 }
 
-const Eigen::Matrix4f VulkanEngine::SceneState::getTransform() const {
-  return total_transform;
+const Eigen::Matrix4f& VulkanEngine::SceneState::getTransform() const {
+  return *total_transform;
 }
 
-void VulkanEngine::SceneState::setTransform(const Eigen::Matrix4f& transform) {
-  total_transform = transform;
+void VulkanEngine::SceneState::setTransform(
+    const Eigen::Matrix4f& _transform) {
+  transform = _transform;
+  total_transform = &transform;
 }
 
-const Eigen::Matrix4f VulkanEngine::SceneState::getTotalTransform() const {
-  return total_transform;
+const Eigen::Matrix4f& VulkanEngine::SceneState::getTotalTransform() const {
+  return *total_transform;
 }
 
-const Eigen::Matrix4f VulkanEngine::SceneState::getViewMatrix() const {
+void VulkanEngine::SceneState::setTransformHierarchy(
+    const TransformHierarchy* hierarchy) {
+  transform_hierarchy = hierarchy;
+}
+
+const VulkanEngine::TransformHierarchy*
+VulkanEngine::SceneState::getTransformHierarchy() const {
+  return transform_hierarchy;
+}
+
+void VulkanEngine::SceneState::setTransformNode(uint32_t node) {
+  transform_node = node;
+  total_transform = &transform_hierarchy->getWorldTransform(node);
+}
+
+uint32_t VulkanEngine::SceneState::getTransformNode() const {
+  return transform_node;
+}
+
+const Eigen::Matrix4f& VulkanEngine::SceneState::getViewMatrix() const {
   return view_matrix;
 }
 
 void VulkanEngine::SceneState::setViewMatrix(
     const Eigen::Matrix4f& _view_matrix) {
   view_matrix = _view_matrix;
+  frustum_dirty = true;
 }
 
-const Eigen::Matrix4f VulkanEngine::SceneState::getProjectionMatrix() const {
+const Eigen::Matrix4f& VulkanEngine::SceneState::getProjectionMatrix()
+    const {
   return projection_matrix;
 }
 
 void VulkanEngine::SceneState::setProjectionMatrix(
     const Eigen::Matrix4f& _projection_matrix) {
   projection_matrix = _projection_matrix;
+  has_projection_matrix = true;
+  frustum_dirty = true;
+}
+
+VulkanEngine::RenderQueue& VulkanEngine::SceneState::getRenderQueue() {
+  return render_queue;
+}
+
+void VulkanEngine::SceneState::setFrustumCullingEnabled(bool enabled) {
+  frustum_culling_enabled = enabled;
+}
+
+bool VulkanEngine::SceneState::isFrustumCullingEnabled() const {
+  return frustum_culling_enabled && has_projection_matrix;
+}
+
+const VulkanEngine::Frustum& VulkanEngine::SceneState::getFrustum() {
+  if (frustum_dirty) {
+    frustum = Frustum(projection_matrix * view_matrix);
+    frustum_dirty = false;
+  }
+  return frustum;
 }
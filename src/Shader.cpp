@@ -19,14 +19,22 @@
 // SOFTWARE.
 
 #include <VulkanEngine/Device.h>
+#include <VulkanEngine/FrameStatistics.h>
 #include <VulkanEngine/Shader.h>
 #include <VulkanEngine/VulkanManager.h>
 
+#include <atomic>
 #include <memory>
+#include <utility>
 #include <vector>
 
+namespace {
+std::atomic<uint32_t> next_shader_id(0);
+}  // namespace
+
 VulkanEngine::Shader::Shader(
-    const std::vector<std::shared_ptr<ShaderModule>>& _shader_modules) {
+    const std::vector<std::shared_ptr<ShaderModule>>& _shader_modules)
+    : id(next_shader_id++) {
   shader_modules = _shader_modules;
   for (const auto& sm : shader_modules) {
     auto shader_stage_info = vk::PipelineShaderStageCreateInfo()
@@ -38,24 +46,38 @@ VulkanEngine::Shader::Shader(
 }
 
 VulkanEngine::Shader::~Shader() {
-  const auto& vk_device =
-      VulkanManager::getInstance().getDevice()->getVkDevice();
-  vk_device.destroyDescriptorPool(vk_descriptor_pool);
-  vk_device.destroyPipelineLayout(vk_pipeline_layout);
-  for (const auto& dsl : vk_descriptor_set_layouts) {
-    vk_device.destroyDescriptorSetLayout(dsl);
-  }
+  VulkanManager::getInstance().getDeletionQueue().enqueue(
+      [vk_descriptor_pool = vk_descriptor_pool,
+       vk_pipeline_layout = vk_pipeline_layout,
+       vk_descriptor_set_layouts = std::move(vk_descriptor_set_layouts)]() {
+        const auto& vk_device =
+            VulkanManager::getInstance().getDevice()->getVkDevice();
+        vk_device.destroyDescriptorPool(vk_descriptor_pool);
+        vk_device.destroyPipelineLayout(vk_pipeline_layout);
+        for (const auto& dsl : vk_descriptor_set_layouts) {
+          vk_device.destroyDescriptorSetLayout(dsl);
+        }
+      });
 }
 
 void VulkanEngine::Shader::setDescriptors(
     const std::vector<std::vector<std::shared_ptr<Descriptor>>>& _descriptors) {
-  const auto& vk_device =
-      VulkanManager::getInstance().getDevice()->getVkDevice();
+  auto& vulkan_manager = VulkanManager::getInstance();
+  const auto& vk_device = vulkan_manager.getDevice()->getVkDevice();
 
   // Causes the pipeline layout to be recreated and include changes to
-  // descriptors
-  if (vk_pipeline_layout) {
-    vk_device.destroyPipelineLayout(vk_pipeline_layout);
+  // descriptors. The previous layout and descriptor sets may still be used
+  // by frames in flight.
+  if (vk_pipeline_layout || vk_descriptor_pool) {
+    vulkan_manager.getDeletionQueue().enqueue(
+        [vk_pipeline_layout = vk_pipeline_layout,
+         vk_descriptor_pool = vk_descriptor_pool]() {
+          const auto& vk_device =
+              VulkanManager::getInstance().getDevice()->getVkDevice();
+          vk_device.destroyPipelineLayout(vk_pipeline_layout);
+          vk_device.destroyDescriptorPool(vk_descriptor_pool);
+        });
+    vk_pipeline_layout = nullptr;
   }
 
   descriptors = _descriptors;
@@ -80,9 +102,6 @@ void VulkanEngine::Shader::setDescriptors(
           .setPPoolSizes(pool_sizes.data())
           .setMaxSets(static_cast<uint32_t>(descriptors.size()));
 
-  if (vk_descriptor_pool) {
-    vk_device.destroyDescriptorPool(vk_descriptor_pool);
-  }
   vk_descriptor_pool = vk_device.createDescriptorPool(pool_create_info);
 
   for (uint32_t i = 0; i < descriptors.size(); ++i) {
@@ -105,27 +124,28 @@ void VulkanEngine::Shader::setDescriptors(
   vk_descriptor_sets =
       vk_device.allocateDescriptorSets(descriptor_set_allocate_info);
 
+  descriptor_set_versions.resize(descriptors.size());
   for (size_t i = 0; i < descriptors.size(); ++i) {
-    auto write_descriptor_sets =
-        std::make_shared<std::vector<vk::WriteDescriptorSet>>();
-    auto copy_descriptor_sets =
-        std::make_shared<std::vector<vk::CopyDescriptorSet>>();
-
-    for (const auto& d : descriptors[i]) {
-      d->appendVkDescriptorSets(write_descriptor_sets, copy_descriptor_sets,
-                                vk_descriptor_sets[i]);
-    }
+    writeDescriptorSet(i);
+  }
+}
 
-    vk_device.updateDescriptorSets(*write_descriptor_sets.get(), nullptr);
+void VulkanEngine::Shader::updateDescriptorSet(uint32_t descriptor_set_index) {
+  if (descriptor_set_index < vk_descriptor_sets.size() &&
+      descriptor_set_versions[descriptor_set_index] !=
+          getDescriptorSetVersion(descriptor_set_index)) {
+    writeDescriptorSet(descriptor_set_index);
   }
 }
 
 void VulkanEngine::Shader::bindDescriptorSet(
-    const vk::CommandBuffer& command_buffer, uint32_t descriptor_set_index) {
+    const vk::CommandBuffer& command_buffer, uint32_t descriptor_set_index,
+    vk::PipelineBindPoint pipeline_bind_point) {
   if (descriptor_set_index < vk_descriptor_sets.size()) {
     command_buffer.bindDescriptorSets(
-        vk::PipelineBindPoint::eGraphics, createVkPipelineLayout(), 0,
+        pipeline_bind_point, createVkPipelineLayout(), 0,
         vk_descriptor_sets[descriptor_set_index], nullptr);
+    VULKANENGINE_COUNT_STATISTIC(eDescriptorSetBinds, 1);
   }
 }
 
@@ -155,3 +175,31 @@ const vk::PipelineLayout VulkanEngine::Shader::createVkPipelineLayout() {
 
   return vk_pipeline_layout;
 }
+
+uint32_t VulkanEngine::Shader::getId() const { return id; }
+
+void VulkanEngine::Shader::writeDescriptorSet(size_t descriptor_set_index) {
+  auto write_descriptor_sets =
+      std::make_shared<std::vector<vk::WriteDescriptorSet>>();
+  auto copy_descriptor_sets =
+      std::make_shared<std::vector<vk::CopyDescriptorSet>>();
+
+  for (const auto& d : descriptors[descriptor_set_index]) {
+    d->appendVkDescriptorSets(write_descriptor_sets, copy_descriptor_sets,
+                              vk_descriptor_sets[descriptor_set_index]);
+  }
+
+  VulkanManager::getInstance().getDevice()->getVkDevice().updateDescriptorSets(
+      *write_descriptor_sets.get(), nullptr);
+  descriptor_set_versions[descriptor_set_index] =
+      getDescriptorSetVersion(descriptor_set_index);
+}
+
+uint64_t VulkanEngine::Shader::getDescriptorSetVersion(
+    size_t descriptor_set_index) const {
+  uint64_t version = 0;
+  for (const auto& d : descriptors[descriptor_set_index]) {
+    version += d->getVersion();
+  }
+  return version;
+}
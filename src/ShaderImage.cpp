@@ -34,10 +34,11 @@ VulkanEngine::ShaderImage<format, image_type, tiling, sample_count_flags>::
                 uint32_t height, uint32_t depth, size_t pixel_size,
                 uint32_t binding, uint32_t decriptor_count,
                 vk::DescriptorType descriptor_type,
-                vk::ShaderStageFlags shader_stage_flags)
+                vk::ShaderStageFlags shader_stage_flags,
+                MipmapMode mipmap_mode)
     : Image<format, image_type, tiling, sample_count_flags>(
           initial_layout, usage_flags, vma_memory_usage, width, height, depth,
-          pixel_size, true),
+          pixel_size, true, mipmap_mode),
       Descriptor(binding, decriptor_count, descriptor_type,
                  shader_stage_flags) {}
 
@@ -45,8 +46,11 @@ template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
           vk::SampleCountFlagBits sample_count_flags>
 VulkanEngine::ShaderImage<format, image_type, tiling,
                           sample_count_flags>::~ShaderImage() {
-  VulkanManager::getInstance().getDevice()->getVkDevice().destroySampler(
-      vk_sampler);
+  VulkanManager::getInstance().getDeletionQueue().enqueue(
+      [vk_sampler = vk_sampler]() {
+        VulkanManager::getInstance().getDevice()->getVkDevice().destroySampler(
+            vk_sampler);
+      });
 }
 
 template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
@@ -113,4 +117,11 @@ void VulkanEngine::ShaderImage<format, image_type, tiling, sample_count_flags>::
           .setPImageInfo(&vk_descriptor_image_info));
 }
 
+template <vk::Format format, vk::ImageType image_type, vk::ImageTiling tiling,
+          vk::SampleCountFlagBits sample_count_flags>
+uint64_t VulkanEngine::ShaderImage<format, image_type, tiling,
+                                   sample_count_flags>::getVersion() const {
+  return this->num_moves;
+}
+
 #endif /* SHADERIMAGE_CPP */
@@ -25,23 +25,10 @@
 #include <limits>
 
 void VulkanEngine::SingleUsageCommandBuffer::beginSingleUsageCommandBuffer() {
-  auto command_buffer_info =
-      vk::CommandBufferAllocateInfo()
-          .setCommandBufferCount(1)
-          .setCommandPool(
-              VulkanManager::getInstance().getDevice()->getVkCommandPool())
-          .setLevel(vk::CommandBufferLevel::ePrimary);
-
-  auto command_buffers = VulkanManager::getInstance()
-                             .getDevice()
-                             ->getVkDevice()
-                             .allocateCommandBuffers(command_buffer_info);
-  if (command_buffers.empty()) {
-    throw std::runtime_error(
-        "Could not allocate command buffer for buffer transfer!");
-  }
-
-  single_use_command_buffer = command_buffers[0];
+  single_use_command_buffer = VulkanManager::getInstance()
+                                  .getDevice()
+                                  ->getTransientCommandPool()
+                                  ->allocateCommandBuffer();
 
   auto command_buffer_begin_info = vk::CommandBufferBeginInfo().setFlags(
       vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
@@ -71,7 +58,9 @@ void VulkanEngine::SingleUsageCommandBuffer::endSingleUsageCommandBuffer() {
   }
   auto vk_device = VulkanManager::getInstance().getDevice()->getVkDevice();
   vk_device.destroyFence(fence);
-  vk_device.freeCommandBuffers(
-      VulkanManager::getInstance().getDevice()->getVkCommandPool(),
-      single_use_command_buffer);
+  VulkanManager::getInstance()
+      .getDevice()
+      ->getTransientCommandPool()
+      ->freeCommandBuffer(single_use_command_buffer);
+  single_use_command_buffer = nullptr;
 }
@@ -40,6 +40,8 @@ VulkanEngine::StagedBuffer<DestinationClass>::~StagedBuffer() {}
 template <class DestinationClass>
 void VulkanEngine::StagedBuffer<DestinationClass>::transferBuffer(
     const vk::CommandBuffer& command_buffer) {
+  VULKANENGINE_PROFILE_SCOPE("StagedBuffer::transferBuffer");
+
   const vk::CommandBuffer& command_buffer_to_use =
       command_buffer ? command_buffer : this->single_use_command_buffer;
   bool created_single_use_command_buffer = false;
@@ -50,6 +52,7 @@ void VulkanEngine::StagedBuffer<DestinationClass>::transferBuffer(
 
   this->insertTransferCommand(command_buffer_to_use,
                               source_buffer.getVkBuffer());
+  VULKANENGINE_COUNT_STATISTIC(eBytesUploaded, this->getStagingBufferSize());
 
   if (created_single_use_command_buffer) {
     this->endSingleUsageCommandBuffer();
@@ -62,4 +65,14 @@ void VulkanEngine::StagedBuffer<DestinationClass>::updateBuffer(
   source_buffer.updateBuffer(_data, _data_size);
 }
 
+template <class DestinationClass>
+void* VulkanEngine::StagedBuffer<DestinationClass>::mapStagingMemory() {
+  return source_buffer.mapMemory();
+}
+
+template <class DestinationClass>
+void VulkanEngine::StagedBuffer<DestinationClass>::unmapStagingMemory() {
+  source_buffer.unmapMemory();
+}
+
 #endif /* STAGEDBUFFER_CPP */
@@ -0,0 +1,69 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STORAGEBUFFER_CPP
+#define STORAGEBUFFER_CPP
+
+#include <VulkanEngine/StorageBuffer.h>
+
+#include <memory>
+#include <vector>
+
+template <typename T>
+VulkanEngine::StorageBuffer<T>::StorageBuffer(
+    uint32_t _binding, size_t _num_elements,
+    vk::ShaderStageFlags _vk_shader_stage_flags)
+    : Buffer(sizeof(T) * _num_elements, vk::BufferUsageFlagBits::eStorageBuffer,
+             vk::MemoryPropertyFlagBits::eHostCoherent |
+                 vk::MemoryPropertyFlagBits::eHostVisible,
+             VMA_MEMORY_USAGE_CPU_TO_GPU),
+      Descriptor(_binding, 1, vk::DescriptorType::eStorageBuffer,
+                 _vk_shader_stage_flags),
+      num_elements(_num_elements) {}
+
+template <typename T>
+VulkanEngine::StorageBuffer<T>::~StorageBuffer() {}
+
+template <typename T>
+size_t VulkanEngine::StorageBuffer<T>::getNumElements() const {
+  return num_elements;
+}
+
+template <typename T>
+void VulkanEngine::StorageBuffer<T>::appendVkDescriptorSets(
+    std::shared_ptr<std::vector<vk::WriteDescriptorSet>> write_descriptor_sets,
+    std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
+    const vk::DescriptorSet& destination_set) {
+  vk_descriptor_buffer_info = vk::DescriptorBufferInfo()
+                                  .setBuffer(getVkBuffer())
+                                  .setOffset(0)
+                                  .setRange(VK_WHOLE_SIZE);
+
+  write_descriptor_sets->push_back(
+      vk::WriteDescriptorSet()
+          .setDstBinding(binding)
+          .setDstArrayElement(0)
+          .setDstSet(destination_set)
+          .setDescriptorType(vk_descriptor_type)
+          .setDescriptorCount(1)
+          .setPBufferInfo(&vk_descriptor_buffer_info));
+}
+
+#endif /* STORAGEBUFFER_CPP */
@@ -0,0 +1,182 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/StreamedTexture.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+VulkanEngine::StreamedTexture::StreamedTexture(
+    std::shared_ptr<const TextureFile> _texture_file, uint32_t binding,
+    vk::ShaderStageFlags shader_stage_flags, uint32_t resident_level)
+    : Descriptor(binding, 1, vk::DescriptorType::eCombinedImageSampler,
+                 shader_stage_flags),
+      texture_file(std::move(_texture_file)),
+      transfer(0),
+      pending_transfer(0),
+      pending_level(0),
+      requested_level(getNumLevels()),
+      target_level(resident_level),
+      last_request_frame(0),
+      version(0) {
+  image = createImage(texture_file, binding, shader_stage_flags,
+                      resident_level);
+  transfer = VulkanManager::getInstance().getTransferQueue().enqueue(
+      [resident_image = image](const vk::CommandBuffer& command_buffer) {
+        resident_image->transferBuffer(command_buffer);
+      },
+      getImageSize(resident_level));
+}
+
+VulkanEngine::StreamedTexture::~StreamedTexture() {}
+
+void VulkanEngine::StreamedTexture::requestScreenSize(float screen_size) {
+  // Each level halves the size of the texture, so this is the smallest level
+  // which is still at least as large as the texture on screen.
+  const auto& level = texture_file->getLevels().front();
+  const auto texture_size =
+      static_cast<float>(std::max(level.width, level.height));
+  const float levels_above =
+      std::log2(texture_size / std::max(screen_size, 1.0f));
+  const auto level_needed =
+      levels_above > 0.0f ? static_cast<uint32_t>(levels_above) : 0u;
+  requested_level =
+      std::min({requested_level, level_needed, getNumLevels() - 1});
+}
+
+uint32_t VulkanEngine::StreamedTexture::getResidentLevel() const {
+  return image->getFirstLevel();
+}
+
+uint32_t VulkanEngine::StreamedTexture::getNumLevels() const {
+  return static_cast<uint32_t>(texture_file->getLevels().size());
+}
+
+size_t VulkanEngine::StreamedTexture::getResidentSize() const {
+  return image->getAllocationSize();
+}
+
+uint64_t VulkanEngine::StreamedTexture::getTransfer() const {
+  return transfer;
+}
+
+const std::shared_ptr<const VulkanEngine::TextureFile>&
+VulkanEngine::StreamedTexture::getTextureFile() const {
+  return texture_file;
+}
+
+void VulkanEngine::StreamedTexture::appendVkDescriptorSets(
+    std::shared_ptr<std::vector<vk::WriteDescriptorSet>> write_descriptor_sets,
+    std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
+    const vk::DescriptorSet& destination_set) {
+  image->appendVkDescriptorSets(write_descriptor_sets, copy_descriptor_sets,
+                                destination_set);
+}
+
+uint64_t VulkanEngine::StreamedTexture::getVersion() const { return version; }
+
+std::shared_ptr<VulkanEngine::StreamedTexture::Image>
+VulkanEngine::StreamedTexture::createImage(
+    const std::shared_ptr<const TextureFile>& texture_file, uint32_t binding,
+    vk::ShaderStageFlags shader_stage_flags, uint32_t first_level) {
+  std::shared_ptr<Image> image(
+      new Image(texture_file, binding, shader_stage_flags, first_level));
+  void* staging_memory = image->mapStagingMemory();
+  image->copyLevels(*texture_file, staging_memory);
+  image->unmapStagingMemory();
+  return image;
+}
+
+void VulkanEngine::StreamedTexture::load(uint32_t first_level) {
+  if (isLoading()) {
+    return;
+  }
+
+  // The image is created and filled on another thread, its upload is
+  // recorded by the TransferQueue once it is ready.
+  pending_level = first_level;
+  pending_image_future = std::async(
+      std::launch::async,
+      [texture_file = texture_file, binding = binding,
+       shader_stage_flags = vk_shader_stage_flags, first_level]() {
+        return createImage(texture_file, binding, shader_stage_flags,
+                           first_level);
+      });
+}
+
+std::shared_ptr<VulkanEngine::StreamedTexture::Image>
+VulkanEngine::StreamedTexture::updateLoad() {
+  auto& transfer_queue = VulkanManager::getInstance().getTransferQueue();
+  if (pending_image_future.valid()) {
+    if (pending_image_future.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      return std::shared_ptr<Image>();
+    }
+
+    // The resident levels stay as they are if the image can't be created,
+    // e.g. because device memory ran out.
+    try {
+      pending_image = pending_image_future.get();
+    } catch (const std::exception& e) {
+      std::cerr << "StreamedTexture: levels could not be loaded: " << e.what()
+                << std::endl;
+      return std::shared_ptr<Image>();
+    }
+    pending_transfer = transfer_queue.enqueue(
+        [loaded_image =
+             pending_image](const vk::CommandBuffer& command_buffer) {
+          loaded_image->transferBuffer(command_buffer);
+        },
+        getImageSize(pending_level));
+    return std::shared_ptr<Image>();
+  }
+
+  if (!pending_image.get() || !transfer_queue.isAvailable(pending_transfer)) {
+    return std::shared_ptr<Image>();
+  }
+
+  auto replaced_image = std::move(image);
+  image = std::move(pending_image);
+  pending_image.reset();
+  transfer = pending_transfer;
+  ++version;
+  return replaced_image;
+}
+
+bool VulkanEngine::StreamedTexture::isLoading() const {
+  return pending_image_future.valid() || pending_image.get() != nullptr;
+}
+
+size_t VulkanEngine::StreamedTexture::getImageSize(uint32_t first_level) const {
+  const auto& levels = texture_file->getLevels();
+  size_t size = 0;
+  for (size_t i = first_level; i < levels.size(); ++i) {
+    size += levels[i].size;
+  }
+  return size;
+}
@@ -18,6 +18,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <VulkanEngine/Profiler.h>
 #include <VulkanEngine/Swapchain.h>
 
 #include <limits>
@@ -132,6 +133,8 @@ VulkanEngine::Swapchain::~Swapchain() {
 }
 
 bool VulkanEngine::Swapchain::present() {
+  VULKANENGINE_PROFILE_SCOPE("Swapchain::present");
+
   uint32_t image_index;
   auto& vulkan_manager = VulkanManager::getInstance();
   auto vk_device = vulkan_manager.getDevice()->getVkDevice();
@@ -186,6 +189,7 @@ bool VulkanEngine::Swapchain::present() {
   vk_device.resetFences(vk_in_flight_fences[current_frame]);
 
   auto vk_graphics_queue = vulkan_manager.getDevice()->getVkGraphicsQueue();
+  vulkan_manager.getProfiler().submitFrame();
   vk_graphics_queue.submit(submit_info, vk_in_flight_fences[current_frame]);
 
   vk::SwapchainKHR swapchains[] = {vk_swapchain};
@@ -0,0 +1,1342 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/TextureFile.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// The identifier every KTX2 file starts with.
+constexpr std::array<uint8_t, 12> kKTX2Identifier = {
+    0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+/// Size of the KTX2 header including the identifier.
+constexpr size_t kKTX2HeaderSize = 80;
+
+/// Size of the DDS header including the magic number.
+constexpr size_t kDDSHeaderSize = 128;
+
+/// Size of the header following the DDS header when the four character code
+/// is "DX10".
+constexpr size_t kDDSDX10HeaderSize = 20;
+
+/// Flags of the DDS header and pixel format.
+constexpr uint32_t kDDSMipMapCount = 0x20000;
+constexpr uint32_t kDDSPixelFormatFourCC = 0x4;
+constexpr uint32_t kDDSPixelFormatRGB = 0x40;
+constexpr uint32_t kDDSCubemap = 0x200;
+constexpr uint32_t kDDSVolume = 0x200000;
+
+/// D3D10_RESOURCE_DIMENSION_TEXTURE2D.
+constexpr uint32_t kDDSTexture2D = 3;
+
+/// Modifiers of the ETC1 and ETC2 individual and differential modes.
+constexpr int kETCModifiers[8][2] = {{2, 8},   {5, 17},  {9, 29},  {13, 42},
+                                     {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+/// Distances of the ETC2 T and H modes.
+constexpr int kETCDistances[8] = {3, 6, 11, 16, 20, 32, 41, 64};
+
+/// Modifiers of EAC blocks.
+constexpr int kEACModifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14},  {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12},  {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11},  {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10},  {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},   {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},   {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},   {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},    {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+/// Texels of a decoded block, in rows of RGBA.
+using Texels = std::array<std::array<uint8_t, 4>, 16>;
+
+/// Read a little endian value, checking that it lies within the file.
+template <typename T>
+T read(const std::vector<uint8_t>& file, size_t offset) {
+  if (offset > file.size() || file.size() - offset < sizeof(T)) {
+    throw std::runtime_error("Texture file is truncated.");
+  }
+  T value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(file[offset + i]) << (8 * i);
+  }
+  return value;
+}
+
+/// \return The number of levels of a full mip chain, each level half the
+/// size of the previous one down to 1x1.
+/// \param width The width of level 0, not 0.
+/// \param height The height of level 0, not 0.
+uint32_t getMaxLevelCount(uint32_t width, uint32_t height) {
+  uint32_t level_count = 1;
+  while ((std::max(width, height) >> level_count) != 0) {
+    ++level_count;
+  }
+  return level_count;
+}
+
+/// Read a big endian 64 bit value as stored by ETC2 and EAC blocks.
+uint64_t readBigEndian(const uint8_t* block) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < 8; ++i) {
+    value = (value << 8) | block[i];
+  }
+  return value;
+}
+
+/// \return A four character code as stored in DDS files.
+constexpr uint32_t makeFourCC(char a, char b, char c, char d) {
+  return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+         (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+/// \return The vk::Format of a DXGI_FORMAT, eUndefined if not supported.
+vk::Format getDXGIFormat(uint32_t dxgi_format) {
+  switch (dxgi_format) {
+    case 28:
+      return vk::Format::eR8G8B8A8Unorm;
+    case 29:
+      return vk::Format::eR8G8B8A8Srgb;
+    case 71:
+      return vk::Format::eBc1RgbaUnormBlock;
+    case 72:
+      return vk::Format::eBc1RgbaSrgbBlock;
+    case 74:
+      return vk::Format::eBc2UnormBlock;
+    case 75:
+      return vk::Format::eBc2SrgbBlock;
+    case 77:
+      return vk::Format::eBc3UnormBlock;
+    case 78:
+      return vk::Format::eBc3SrgbBlock;
+    case 80:
+      return vk::Format::eBc4UnormBlock;
+    case 81:
+      return vk::Format::eBc4SnormBlock;
+    case 83:
+      return vk::Format::eBc5UnormBlock;
+    case 84:
+      return vk::Format::eBc5SnormBlock;
+    case 87:
+      return vk::Format::eB8G8R8A8Unorm;
+    case 91:
+      return vk::Format::eB8G8R8A8Srgb;
+    case 95:
+      return vk::Format::eBc6HUfloatBlock;
+    case 96:
+      return vk::Format::eBc6HSfloatBlock;
+    case 98:
+      return vk::Format::eBc7UnormBlock;
+    case 99:
+      return vk::Format::eBc7SrgbBlock;
+    default:
+      return vk::Format::eUndefined;
+  }
+}
+
+/// \return True if the format stores sRGB encoded colors.
+bool isSrgb(vk::Format format) {
+  switch (format) {
+    case vk::Format::eR8G8B8A8Srgb:
+    case vk::Format::eB8G8R8A8Srgb:
+    case vk::Format::eBc1RgbSrgbBlock:
+    case vk::Format::eBc1RgbaSrgbBlock:
+    case vk::Format::eBc2SrgbBlock:
+    case vk::Format::eBc3SrgbBlock:
+    case vk::Format::eEtc2R8G8B8SrgbBlock:
+    case vk::Format::eEtc2R8G8B8A1SrgbBlock:
+    case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+      return true;
+    default:
+      return false;
+  }
+}
+
+uint8_t clampColor(int value) {
+  return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+}
+
+/// Expand a 565 color of a BC block to 8 bits per channel.
+std::array<int, 3> expand565(uint16_t color) {
+  const int r = (color >> 11) & 0x1f;
+  const int g = (color >> 5) & 0x3f;
+  const int b = color & 0x1f;
+  return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+/// Decode the color block shared by BC1, BC2 and BC3.
+/// \param block The 8 byte block.
+/// \param [out] texels The decoded texels.
+/// \param has_alpha Decode the three color mode with transparent black, as
+/// done by BC1 with alpha. BC2 and BC3 always use four colors.
+/// \param four_colors Always use the four color mode.
+void decodeBCColor(const uint8_t* block, Texels& texels, bool has_alpha,
+                   bool four_colors) {
+  const uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+  const uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+  const auto c0 = expand565(color0);
+  const auto c1 = expand565(color1);
+
+  std::array<std::array<uint8_t, 4>, 4> colors;
+  for (size_t c = 0; c < 3; ++c) {
+    colors[0][c] = static_cast<uint8_t>(c0[c]);
+    colors[1][c] = static_cast<uint8_t>(c1[c]);
+    if (four_colors || color0 > color1) {
+      colors[2][c] = static_cast<uint8_t>((2 * c0[c] + c1[c]) / 3);
+      colors[3][c] = static_cast<uint8_t>((c0[c] + 2 * c1[c]) / 3);
+    } else {
+      colors[2][c] = static_cast<uint8_t>((c0[c] + c1[c]) / 2);
+      colors[3][c] = 0;
+    }
+  }
+  colors[0][3] = colors[1][3] = colors[2][3] = 255;
+  colors[3][3] = (!four_colors && color0 <= color1 && has_alpha) ? 0 : 255;
+
+  const uint32_t indices = static_cast<uint32_t>(block[4]) |
+                           (static_cast<uint32_t>(block[5]) << 8) |
+                           (static_cast<uint32_t>(block[6]) << 16) |
+                           (static_cast<uint32_t>(block[7]) << 24);
+  for (size_t i = 0; i < 16; ++i) {
+    texels[i] = colors[(indices >> (2 * i)) & 3];
+  }
+}
+
+/// Decode a single channel block as used by BC3 alpha, BC4 and BC5.
+/// \param block The 8 byte block.
+/// \param [out] texels The decoded texels.
+/// \param channel The channel of texels to write.
+void decodeBCChannel(const uint8_t* block, Texels& texels, size_t channel) {
+  const int a0 = block[0];
+  const int a1 = block[1];
+  std::array<uint8_t, 8> values;
+  values[0] = static_cast<uint8_t>(a0);
+  values[1] = static_cast<uint8_t>(a1);
+  if (a0 > a1) {
+    for (int i = 2; i < 8; ++i) {
+      values[i] = static_cast<uint8_t>(((8 - i) * a0 + (i - 1) * a1) / 7);
+    }
+  } else {
+    for (int i = 2; i < 6; ++i) {
+      values[i] = static_cast<uint8_t>(((6 - i) * a0 + (i - 1) * a1) / 5);
+    }
+    values[6] = 0;
+    values[7] = 255;
+  }
+
+  uint64_t indices = 0;
+  for (size_t i = 0; i < 6; ++i) {
+    indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+  }
+  for (size_t i = 0; i < 16; ++i) {
+    texels[i][channel] = values[(indices >> (3 * i)) & 7];
+  }
+}
+
+/// Decode the explicit alpha of a BC2 block.
+/// \param block The 8 byte block.
+/// \param [out] texels The decoded texels.
+void decodeBC2Alpha(const uint8_t* block, Texels& texels) {
+  for (size_t i = 0; i < 16; ++i) {
+    const int alpha = (block[i / 2] >> (4 * (i % 2))) & 0xf;
+    texels[i][3] = static_cast<uint8_t>(alpha * 17);
+  }
+}
+
+/// Decode an ETC2 color block, which includes ETC1 blocks.
+/// \param block The 8 byte block.
+/// \param [out] texels The decoded texels.
+/// \param punchthrough Decode the block as part of an R8G8B8A1 texture, in
+/// which the differential bit marks opaque blocks.
+void decodeETC2Color(const uint8_t* block, Texels& texels,
+                     bool punchthrough) {
+  const uint64_t bits = readBigEndian(block);
+  const bool differential = punchthrough || ((bits >> 33) & 1);
+  const bool opaque = !punchthrough || ((bits >> 33) & 1);
+  const bool flip = (bits >> 32) & 1;
+
+  const auto extend4 = [](int value) { return (value << 4) | value; };
+  const auto extend5 = [](int value) { return (value << 3) | (value >> 2); };
+  const auto getIndex = [bits](size_t x, size_t y) {
+    const size_t bit = x * 4 + y;
+    return static_cast<int>((((bits >> (16 + bit)) & 1) << 1) |
+                            ((bits >> bit) & 1));
+  };
+
+  // Paint colors selected directly by the index, used by the T and H modes.
+  const auto writePaintColors =
+      [&](const std::array<std::array<int, 3>, 4>& paint_colors) {
+        for (size_t y = 0; y < 4; ++y) {
+          for (size_t x = 0; x < 4; ++x) {
+            const int index = getIndex(x, y);
+            auto& texel = texels[y * 4 + x];
+            for (size_t c = 0; c < 3; ++c) {
+              texel[c] = clampColor(paint_colors[index][c]);
+            }
+            texel[3] = 255;
+            if (!opaque && index == 2) {
+              texel = {0, 0, 0, 0};
+            }
+          }
+        }
+      };
+
+  std::array<std::array<int, 3>, 2> base_colors;
+  for (size_t c = 0; c < 3; ++c) {
+    if (!differential) {
+      base_colors[0][c] = extend4((bits >> (60 - 8 * c)) & 0xf);
+      base_colors[1][c] = extend4((bits >> (56 - 8 * c)) & 0xf);
+      continue;
+    }
+
+    const int base = (bits >> (59 - 8 * c)) & 0x1f;
+    int delta = (bits >> (56 - 8 * c)) & 0x7;
+    delta = delta >= 4 ? delta - 8 : delta;
+    if (base + delta >= 0 && base + delta <= 31) {
+      base_colors[0][c] = extend5(base);
+      base_colors[1][c] = extend5(base + delta);
+      continue;
+    }
+
+    if (c == 0) {
+      // T mode.
+      const std::array<int, 3> color0 = {
+          extend4(static_cast<int>(((bits >> 59) & 0x3) << 2 |
+                                   ((bits >> 56) & 0x3))),
+          extend4((bits >> 52) & 0xf), extend4((bits >> 48) & 0xf)};
+      const std::array<int, 3> color1 = {extend4((bits >> 44) & 0xf),
+                                         extend4((bits >> 40) & 0xf),
+                                         extend4((bits >> 36) & 0xf)};
+      const int distance =
+          kETCDistances[((bits >> 34) & 0x3) << 1 | ((bits >> 32) & 1)];
+      writePaintColors({color0,
+                        {color1[0] + distance, color1[1] + distance,
+                         color1[2] + distance},
+                        color1,
+                        {color1[0] - distance, color1[1] - distance,
+                         color1[2] - distance}});
+    } else if (c == 1) {
+      // H mode.
+      const std::array<int, 3> color0 = {
+          extend4((bits >> 59) & 0xf),
+          extend4(static_cast<int>(((bits >> 56) & 0x7) << 1 |
+                                   ((bits >> 52) & 1))),
+          extend4(static_cast<int>(((bits >> 51) & 1) << 3 |
+                                   ((bits >> 47) & 0x7)))};
+      const std::array<int, 3> color1 = {extend4((bits >> 43) & 0xf),
+                                         extend4((bits >> 39) & 0xf),
+                                         extend4((bits >> 35) & 0xf)};
+      const int value0 = (color0[0] << 16) | (color0[1] << 8) | color0[2];
+      const int value1 = (color1[0] << 16) | (color1[1] << 8) | color1[2];
+      const int distance =
+          kETCDistances[((bits >> 34) & 1) << 2 | ((bits >> 32) & 1) << 1 |
+                        (value0 >= value1 ? 1 : 0)];
+      writePaintColors({{{color0[0] + distance, color0[1] + distance,
+                          color0[2] + distance},
+                         {color0[0] - distance, color0[1] - distance,
+                          color0[2] - distance},
+                         {color1[0] + distance, color1[1] + distance,
+                          color1[2] + distance},
+                         {color1[0] - distance, color1[1] - distance,
+                          color1[2] - distance}}});
+    } else {
+      // Planar mode, which is always opaque.
+      const auto extend6 = [](int value) {
+        return (value << 2) | (value >> 4);
+      };
+      const auto extend7 = [](int value) {
+        return (value << 1) | (value >> 6);
+      };
+      const std::array<int, 3> origin = {
+          extend6((bits >> 57) & 0x3f),
+          extend7(static_cast<int>(((bits >> 56) & 1) << 6 |
+                                   ((bits >> 49) & 0x3f))),
+          extend6(static_cast<int>(((bits >> 48) & 1) << 5 |
+                                   ((bits >> 43) & 0x3) << 3 |
+                                   ((bits >> 39) & 0x7)))};
+      const std::array<int, 3> horizontal = {
+          extend6(static_cast<int>(((bits >> 34) & 0x1f) << 1 |
+                                   ((bits >> 32) & 1))),
+          extend7((bits >> 25) & 0x7f), extend6((bits >> 19) & 0x3f)};
+      const std::array<int, 3> vertical = {extend6((bits >> 13) & 0x3f),
+                                           extend7((bits >> 6) & 0x7f),
+                                           extend6(bits & 0x3f)};
+      for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+          auto& texel = texels[y * 4 + x];
+          for (size_t i = 0; i < 3; ++i) {
+            texel[i] = clampColor((x * (horizontal[i] - origin[i]) +
+                                   y * (vertical[i] - origin[i]) +
+                                   4 * origin[i] + 2) >>
+                                  2);
+          }
+          texel[3] = 255;
+        }
+      }
+    }
+    return;
+  }
+
+  // Individual and differential modes.
+  const std::array<int, 2> tables = {static_cast<int>((bits >> 37) & 0x7),
+                                     static_cast<int>((bits >> 34) & 0x7)};
+  for (size_t y = 0; y < 4; ++y) {
+    for (size_t x = 0; x < 4; ++x) {
+      const size_t sub_block = flip ? (y >= 2) : (x >= 2);
+      const int index = getIndex(x, y);
+      const int* modifiers = kETCModifiers[tables[sub_block]];
+      int modifier = (index & 1) ? modifiers[1] : modifiers[0];
+      modifier = (index & 2) ? -modifier : modifier;
+      if (!opaque && index == 0) {
+        modifier = 0;
+      }
+
+      auto& texel = texels[y * 4 + x];
+      for (size_t c = 0; c < 3; ++c) {
+        texel[c] = clampColor(base_colors[sub_block][c] + modifier);
+      }
+      texel[3] = 255;
+      if (!opaque && index == 2) {
+        texel = {0, 0, 0, 0};
+      }
+    }
+  }
+}
+
+/// Decode an EAC block holding a single channel.
+/// \param block The 8 byte block.
+/// \param [out] texels The decoded texels.
+/// \param channel The channel of texels to write.
+/// \param eleven_bit Decode the block as 11 bit data, as used by the EAC R11
+/// formats, instead of 8 bit alpha.
+void decodeEAC(const uint8_t* block, Texels& texels, size_t channel,
+               bool eleven_bit) {
+  const uint64_t bits = readBigEndian(block);
+  const int base = block[0];
+  const int multiplier = block[1] >> 4;
+  const int* modifiers = kEACModifiers[block[1] & 0xf];
+  for (size_t i = 0; i < 16; ++i) {
+    const int modifier = modifiers[(bits >> (45 - 3 * i)) & 0x7];
+    uint8_t value;
+    if (eleven_bit) {
+      int value11 = base * 8 + 4 +
+                    modifier * (multiplier != 0 ? multiplier * 8 : 1);
+      value11 = std::min(std::max(value11, 0), 2047);
+      value = static_cast<uint8_t>((value11 * 255 + 1023) / 2047);
+    } else {
+      value = clampColor(base + modifier * multiplier);
+    }
+    // EAC texels are stored column by column.
+    texels[(i % 4) * 4 + i / 4][channel] = value;
+  }
+}
+
+/// Decode a block of a format supported by TextureFile::canTranscode().
+/// \param format The vk::Format of the block.
+/// \param block The block.
+/// \param [out] texels The decoded texels.
+void decodeBlock(vk::Format format, const uint8_t* block, Texels& texels) {
+  switch (format) {
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+      decodeBCColor(block, texels, false, false);
+      break;
+    case vk::Format::eBc1RgbaUnormBlock:
+    case vk::Format::eBc1RgbaSrgbBlock:
+      decodeBCColor(block, texels, true, false);
+      break;
+    case vk::Format::eBc2UnormBlock:
+    case vk::Format::eBc2SrgbBlock:
+      decodeBCColor(block + 8, texels, false, true);
+      decodeBC2Alpha(block, texels);
+      break;
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+      decodeBCColor(block + 8, texels, false, true);
+      decodeBCChannel(block, texels, 3);
+      break;
+    case vk::Format::eBc4UnormBlock:
+      texels.fill({0, 0, 0, 255});
+      decodeBCChannel(block, texels, 0);
+      break;
+    case vk::Format::eBc5UnormBlock:
+      texels.fill({0, 0, 0, 255});
+      decodeBCChannel(block, texels, 0);
+      decodeBCChannel(block + 8, texels, 1);
+      break;
+    case vk::Format::eEtc2R8G8B8UnormBlock:
+    case vk::Format::eEtc2R8G8B8SrgbBlock:
+      decodeETC2Color(block, texels, false);
+      break;
+    case vk::Format::eEtc2R8G8B8A1UnormBlock:
+    case vk::Format::eEtc2R8G8B8A1SrgbBlock:
+      decodeETC2Color(block, texels, true);
+      break;
+    case vk::Format::eEtc2R8G8B8A8UnormBlock:
+    case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+      decodeETC2Color(block + 8, texels, false);
+      decodeEAC(block, texels, 3, false);
+      break;
+    case vk::Format::eEacR11UnormBlock:
+      texels.fill({0, 0, 0, 255});
+      decodeEAC(block, texels, 0, true);
+      break;
+    case vk::Format::eEacR11G11UnormBlock:
+      texels.fill({0, 0, 0, 255});
+      decodeEAC(block, texels, 0, true);
+      decodeEAC(block + 8, texels, 1, true);
+      break;
+    case vk::Format::eB8G8R8A8Unorm:
+    case vk::Format::eB8G8R8A8Srgb:
+      texels[0] = {block[2], block[1], block[0], block[3]};
+      break;
+    default:
+      texels[0] = {block[0], block[1], block[2], block[3]};
+      break;
+  }
+}
+
+/// Write a little endian value into a file which is large enough to hold it.
+template <typename T>
+void write(std::vector<uint8_t>& file, size_t offset, T value) {
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    file[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+/// Read the block of texels at a position of an R8G8B8A8 level. Positions
+/// past the edges of the level repeat the last row or column.
+void readTexels(const uint8_t* level_data, uint32_t width, uint32_t height,
+                uint32_t x, uint32_t y, Texels& texels) {
+  for (uint32_t row = 0; row < 4; ++row) {
+    const uint32_t texel_y = std::min(y + row, height - 1);
+    for (uint32_t column = 0; column < 4; ++column) {
+      const uint32_t texel_x = std::min(x + column, width - 1);
+      std::memcpy(
+          texels[row * 4 + column].data(),
+          level_data + (static_cast<size_t>(texel_y) * width + texel_x) * 4,
+          4);
+    }
+  }
+}
+
+/// Quantize a color to the 565 format of BC color endpoints.
+uint16_t quantize565(const std::array<float, 3>& color) {
+  const auto quantize = [](float value, long max) {
+    return std::min(std::max(std::lround(value * max / 255.0f), 0L), max);
+  };
+  return static_cast<uint16_t>((quantize(color[0], 31) << 11) |
+                               (quantize(color[1], 63) << 5) |
+                               quantize(color[2], 31));
+}
+
+/// Encode the color block shared by BC1 and BC3 in the four color mode. The
+/// endpoints are the extremes of the texels along their principal axis, and
+/// each texel picks the closest of the four colors.
+/// \param texels The texels to encode.
+/// \param [out] block The 8 byte block.
+void encodeBCColor(const Texels& texels, uint8_t* block) {
+  std::array<float, 3> mean = {0.0f, 0.0f, 0.0f};
+  for (const auto& texel : texels) {
+    for (size_t c = 0; c < 3; ++c) {
+      mean[c] += texel[c] / 16.0f;
+    }
+  }
+
+  // The upper triangle of the covariance matrix.
+  std::array<float, 6> covariance = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  for (const auto& texel : texels) {
+    const float r = texel[0] - mean[0];
+    const float g = texel[1] - mean[1];
+    const float b = texel[2] - mean[2];
+    covariance[0] += r * r;
+    covariance[1] += r * g;
+    covariance[2] += r * b;
+    covariance[3] += g * g;
+    covariance[4] += g * b;
+    covariance[5] += b * b;
+  }
+
+  // A few power iterations are enough to find the principal axis.
+  std::array<float, 3> axis = {1.0f, 1.0f, 1.0f};
+  for (int i = 0; i < 8; ++i) {
+    const std::array<float, 3> next = {
+        covariance[0] * axis[0] + covariance[1] * axis[1] +
+            covariance[2] * axis[2],
+        covariance[1] * axis[0] + covariance[3] * axis[1] +
+            covariance[4] * axis[2],
+        covariance[2] * axis[0] + covariance[4] * axis[1] +
+            covariance[5] * axis[2]};
+    const float length = std::max(
+        {std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+    if (length < 1e-6f) {
+      break;
+    }
+    for (size_t c = 0; c < 3; ++c) {
+      axis[c] = next[c] / length;
+    }
+  }
+  const float axis_length =
+      axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+  float min_projection = 0.0f;
+  float max_projection = 0.0f;
+  for (const auto& texel : texels) {
+    float projection = 0.0f;
+    for (size_t c = 0; c < 3; ++c) {
+      projection += (texel[c] - mean[c]) * axis[c];
+    }
+    min_projection = std::min(min_projection, projection / axis_length);
+    max_projection = std::max(max_projection, projection / axis_length);
+  }
+
+  std::array<float, 3> max_color;
+  std::array<float, 3> min_color;
+  for (size_t c = 0; c < 3; ++c) {
+    max_color[c] = mean[c] + axis[c] * max_projection;
+    min_color[c] = mean[c] + axis[c] * min_projection;
+  }
+  uint16_t color0 = quantize565(max_color);
+  uint16_t color1 = quantize565(min_color);
+  if (color0 < color1) {
+    std::swap(color0, color1);
+  }
+
+  // Equal endpoints select the three color mode, in which index 0 still
+  // decodes to color0.
+  uint32_t indices = 0;
+  if (color0 != color1) {
+    const auto c0 = expand565(color0);
+    const auto c1 = expand565(color1);
+    std::array<std::array<int, 3>, 4> colors;
+    for (size_t c = 0; c < 3; ++c) {
+      colors[0][c] = c0[c];
+      colors[1][c] = c1[c];
+      colors[2][c] = (2 * c0[c] + c1[c]) / 3;
+      colors[3][c] = (c0[c] + 2 * c1[c]) / 3;
+    }
+    for (size_t i = 0; i < 16; ++i) {
+      uint32_t best_index = 0;
+      int best_distance = std::numeric_limits<int>::max();
+      for (uint32_t j = 0; j < 4; ++j) {
+        int distance = 0;
+        for (size_t c = 0; c < 3; ++c) {
+          const int difference = texels[i][c] - colors[j][c];
+          distance += difference * difference;
+        }
+        if (distance < best_distance) {
+          best_distance = distance;
+          best_index = j;
+        }
+      }
+      indices |= best_index << (2 * i);
+    }
+  }
+
+  block[0] = static_cast<uint8_t>(color0);
+  block[1] = static_cast<uint8_t>(color0 >> 8);
+  block[2] = static_cast<uint8_t>(color1);
+  block[3] = static_cast<uint8_t>(color1 >> 8);
+  for (size_t i = 0; i < 4; ++i) {
+    block[4 + i] = static_cast<uint8_t>(indices >> (8 * i));
+  }
+}
+
+/// Encode a single channel block as used by BC3 alpha, in the eight value
+/// mode spanning the range of the texels.
+/// \param texels The texels to encode.
+/// \param channel The channel of texels to encode.
+/// \param [out] block The 8 byte block.
+void encodeBCChannel(const Texels& texels, size_t channel, uint8_t* block) {
+  int a0 = 0;
+  int a1 = 255;
+  for (const auto& texel : texels) {
+    a0 = std::max(a0, static_cast<int>(texel[channel]));
+    a1 = std::min(a1, static_cast<int>(texel[channel]));
+  }
+
+  // Equal values select the six value mode, in which index 0 still decodes
+  // to a0.
+  uint64_t indices = 0;
+  if (a0 > a1) {
+    for (size_t i = 0; i < 16; ++i) {
+      uint64_t best_index = 0;
+      int best_distance = std::numeric_limits<int>::max();
+      for (int j = 0; j < 8; ++j) {
+        const int value =
+            j < 2 ? (j == 0 ? a0 : a1) : ((8 - j) * a0 + (j - 1) * a1) / 7;
+        const int distance = std::abs(texels[i][channel] - value);
+        if (distance < best_distance) {
+          best_distance = distance;
+          best_index = static_cast<uint64_t>(j);
+        }
+      }
+      indices |= best_index << (3 * i);
+    }
+  }
+
+  block[0] = static_cast<uint8_t>(a0);
+  block[1] = static_cast<uint8_t>(a1);
+  for (size_t i = 0; i < 6; ++i) {
+    block[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+  }
+}
+
+/// Encode a block of a format supported by TextureFile::compress().
+/// \param format The vk::Format of the block.
+/// \param texels The texels to encode.
+/// \param [out] block The block.
+void encodeBlock(vk::Format format, const Texels& texels, uint8_t* block) {
+  switch (format) {
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+      encodeBCColor(texels, block);
+      break;
+    default:
+      encodeBCChannel(texels, 3, block);
+      encodeBCColor(texels, block + 8);
+      break;
+  }
+}
+
+/// Create the KTX2 data format descriptor of a format.
+/// \param format The vk::Format to describe.
+/// \return The words of the descriptor, empty if the format isn't supported
+/// by TextureFile::save().
+std::vector<uint32_t> getDataFormatDescriptor(vk::Format format) {
+  // Values of the Khronos Data Format Specification.
+  constexpr uint32_t kModelRGBSDA = 1;
+  constexpr uint32_t kModelBC1A = 128;
+  constexpr uint32_t kModelBC3 = 130;
+  constexpr uint32_t kPrimariesBT709 = 1;
+  constexpr uint32_t kTransferLinear = 1;
+  constexpr uint32_t kTransferSRGB = 2;
+  constexpr uint32_t kChannelAlpha = 15;
+  constexpr uint32_t kQualifierLinear = 0x10;
+
+  // A sample is described by its bit offset, bit length and channel.
+  const auto makeSample = [](uint32_t offset, uint32_t length,
+                             uint32_t channel, uint32_t upper) {
+    return std::array<uint32_t, 4>{
+        offset | ((length - 1) << 16) | (channel << 24), 0, 0, upper};
+  };
+
+  const bool srgb = isSrgb(format);
+  const uint32_t alpha_channel =
+      kChannelAlpha | (srgb ? kQualifierLinear : 0);
+  uint32_t model;
+  uint32_t block_dimensions = 0;
+  uint32_t bytes_plane;
+  std::vector<std::array<uint32_t, 4>> samples;
+  switch (format) {
+    case vk::Format::eR8G8B8A8Unorm:
+    case vk::Format::eR8G8B8A8Srgb:
+      model = kModelRGBSDA;
+      bytes_plane = 4;
+      for (uint32_t c = 0; c < 3; ++c) {
+        samples.push_back(makeSample(c * 8, 8, c, 255));
+      }
+      samples.push_back(makeSample(24, 8, alpha_channel, 255));
+      break;
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+      model = kModelBC1A;
+      block_dimensions = 0x0303;
+      bytes_plane = 8;
+      samples.push_back(makeSample(0, 64, 0, 0xffffffff));
+      break;
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+      model = kModelBC3;
+      block_dimensions = 0x0303;
+      bytes_plane = 16;
+      samples.push_back(makeSample(0, 64, alpha_channel, 0xffffffff));
+      samples.push_back(makeSample(64, 64, 0, 0xffffffff));
+      break;
+    default:
+      return {};
+  }
+
+  const auto block_size = static_cast<uint32_t>(24 + 16 * samples.size());
+  std::vector<uint32_t> words = {
+      4 + block_size,
+      0,
+      2 | (block_size << 16),
+      model | (kPrimariesBT709 << 8) |
+          ((srgb ? kTransferSRGB : kTransferLinear) << 16),
+      block_dimensions,
+      bytes_plane,
+      0};
+  for (const auto& sample : samples) {
+    words.insert(words.end(), sample.begin(), sample.end());
+  }
+  return words;
+}
+
+}  // namespace
+
+VulkanEngine::TextureFile::TextureFile(vk::Format _vk_format,
+                                       std::vector<Level> _levels,
+                                       std::vector<uint8_t> _data)
+    : vk_format(_vk_format),
+      levels(std::move(_levels)),
+      data(std::move(_data)),
+      data_size(0) {
+  for (const auto& level : levels) {
+    data_size += level.size;
+  }
+}
+
+VulkanEngine::TextureFile::~TextureFile() {}
+
+std::shared_ptr<VulkanEngine::TextureFile> VulkanEngine::TextureFile::load(
+    const std::filesystem::path& path) {
+  std::ifstream stream(path, std::ios::binary | std::ios::ate);
+  if (!stream) {
+    throw std::runtime_error("Could not open texture file " + path.string());
+  }
+  std::vector<uint8_t> file(static_cast<size_t>(stream.tellg()));
+  stream.seekg(0);
+  if (!stream.read(reinterpret_cast<char*>(file.data()), file.size())) {
+    throw std::runtime_error("Could not read texture file " + path.string());
+  }
+
+  if (file.size() >= kKTX2Identifier.size() &&
+      std::equal(kKTX2Identifier.begin(), kKTX2Identifier.end(),
+                 file.begin())) {
+    return loadKTX2(std::move(file));
+  }
+  if (file.size() >= 4 && read<uint32_t>(file, 0) == makeFourCC('D', 'D', 'S',
+                                                                 ' ')) {
+    return loadDDS(std::move(file));
+  }
+  throw std::runtime_error(path.string() + " is not a KTX2 or DDS file.");
+}
+
+bool VulkanEngine::TextureFile::isTextureFile(
+    const std::filesystem::path& path) {
+  auto extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return extension == ".ktx2" || extension == ".dds";
+}
+
+std::shared_ptr<VulkanEngine::TextureFile>
+VulkanEngine::TextureFile::createFromImage(const uint8_t* texels,
+                                           uint32_t width, uint32_t height,
+                                           vk::Format format) {
+  if (format != vk::Format::eR8G8B8A8Unorm &&
+      format != vk::Format::eR8G8B8A8Srgb) {
+    throw std::runtime_error("Images must be R8G8B8A8.");
+  }
+  if (width == 0 || height == 0) {
+    throw std::runtime_error("Images must not be empty.");
+  }
+
+  std::vector<Level> levels;
+  size_t size = 0;
+  for (uint32_t i = 0;; ++i) {
+    const uint32_t level_width = std::max(width >> i, 1u);
+    const uint32_t level_height = std::max(height >> i, 1u);
+    const size_t level_size =
+        static_cast<size_t>(level_width) * level_height * 4;
+    levels.push_back({size, level_size, level_width, level_height});
+    size += level_size;
+    if (level_width == 1 && level_height == 1) {
+      break;
+    }
+  }
+
+  std::vector<uint8_t> data(size);
+  std::memcpy(data.data(), texels, levels[0].size);
+  for (size_t i = 1; i < levels.size(); ++i) {
+    const auto& source = levels[i - 1];
+    const auto& level = levels[i];
+    const uint8_t* source_data = data.data() + source.offset;
+    uint8_t* level_data = data.data() + level.offset;
+    for (uint32_t y = 0; y < level.height; ++y) {
+      // Odd sizes repeat the last row or column of the source.
+      const size_t y0 = std::min(2 * y, source.height - 1);
+      const size_t y1 = std::min(2 * y + 1, source.height - 1);
+      for (uint32_t x = 0; x < level.width; ++x) {
+        const size_t x0 = std::min(2 * x, source.width - 1);
+        const size_t x1 = std::min(2 * x + 1, source.width - 1);
+        for (size_t c = 0; c < 4; ++c) {
+          const int sum = source_data[(y0 * source.width + x0) * 4 + c] +
+                          source_data[(y0 * source.width + x1) * 4 + c] +
+                          source_data[(y1 * source.width + x0) * 4 + c] +
+                          source_data[(y1 * source.width + x1) * 4 + c];
+          level_data[(static_cast<size_t>(y) * level.width + x) * 4 + c] =
+              static_cast<uint8_t>((sum + 2) / 4);
+        }
+      }
+    }
+  }
+
+  return std::make_shared<TextureFile>(format, std::move(levels),
+                                       std::move(data));
+}
+
+std::shared_ptr<VulkanEngine::TextureFile> VulkanEngine::TextureFile::compress(
+    vk::Format format) const {
+  if (vk_format != vk::Format::eR8G8B8A8Unorm &&
+      vk_format != vk::Format::eR8G8B8A8Srgb) {
+    throw std::runtime_error("Only R8G8B8A8 textures can be compressed.");
+  }
+  switch (format) {
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+      break;
+    default:
+      throw std::runtime_error("Textures can't be compressed to " +
+                               vk::to_string(format) + ".");
+  }
+
+  uint32_t block_width;
+  uint32_t block_height;
+  uint32_t block_size;
+  getBlockInfo(format, block_width, block_height, block_size);
+
+  std::vector<Level> compressed_levels;
+  size_t compressed_size = 0;
+  for (const auto& level : levels) {
+    const size_t size = getLevelSize(format, level.width, level.height);
+    compressed_levels.push_back(
+        {compressed_size, size, level.width, level.height});
+    compressed_size += size;
+  }
+
+  std::vector<uint8_t> compressed_data(compressed_size);
+  Texels texels;
+  for (size_t i = 0; i < levels.size(); ++i) {
+    const auto& level = levels[i];
+    const uint8_t* level_data = data.data() + level.offset;
+    uint8_t* block = compressed_data.data() + compressed_levels[i].offset;
+    for (uint32_t y = 0; y < level.height; y += block_height) {
+      for (uint32_t x = 0; x < level.width; x += block_width) {
+        readTexels(level_data, level.width, level.height, x, y, texels);
+        encodeBlock(format, texels, block);
+        block += block_size;
+      }
+    }
+  }
+
+  return std::make_shared<TextureFile>(format, std::move(compressed_levels),
+                                       std::move(compressed_data));
+}
+
+bool VulkanEngine::TextureFile::hasAlpha() const {
+  if (vk_format != vk::Format::eR8G8B8A8Unorm &&
+      vk_format != vk::Format::eR8G8B8A8Srgb) {
+    return transcode()->hasAlpha();
+  }
+  for (const auto& level : levels) {
+    for (size_t i = 3; i < level.size; i += 4) {
+      if (data[level.offset + i] != 255) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void VulkanEngine::TextureFile::save(const std::filesystem::path& path) const {
+  const auto data_format_descriptor = getDataFormatDescriptor(vk_format);
+  if (data_format_descriptor.empty()) {
+    throw std::runtime_error("Textures in " + vk::to_string(vk_format) +
+                             " can't be saved.");
+  }
+
+  uint32_t block_width;
+  uint32_t block_height;
+  uint32_t block_size;
+  getBlockInfo(vk_format, block_width, block_height, block_size);
+
+  const size_t level_index_offset = kKTX2HeaderSize;
+  const size_t dfd_offset = level_index_offset + levels.size() * 24;
+  const size_t dfd_size = data_format_descriptor.size() * 4;
+
+  // Levels are stored smallest first, each aligned to the least common
+  // multiple of the block size and 4. Block sizes are powers of two.
+  const size_t alignment = std::max<size_t>(block_size, 4);
+  std::vector<size_t> offsets(levels.size());
+  size_t file_size = dfd_offset + dfd_size;
+  for (size_t i = levels.size(); i-- > 0;) {
+    offsets[i] = (file_size + alignment - 1) / alignment * alignment;
+    file_size = offsets[i] + levels[i].size;
+  }
+
+  std::vector<uint8_t> file(file_size);
+  std::copy(kKTX2Identifier.begin(), kKTX2Identifier.end(), file.begin());
+  write<uint32_t>(file, 12, static_cast<uint32_t>(vk_format));
+  write<uint32_t>(file, 16, 1);
+  write<uint32_t>(file, 20, getWidth());
+  write<uint32_t>(file, 24, getHeight());
+  write<uint32_t>(file, 36, 1);
+  write<uint32_t>(file, 40, static_cast<uint32_t>(levels.size()));
+  write<uint32_t>(file, 48, static_cast<uint32_t>(dfd_offset));
+  write<uint32_t>(file, 52, static_cast<uint32_t>(dfd_size));
+  for (size_t i = 0; i < levels.size(); ++i) {
+    const size_t entry = level_index_offset + i * 24;
+    write<uint64_t>(file, entry, offsets[i]);
+    write<uint64_t>(file, entry + 8, levels[i].size);
+    write<uint64_t>(file, entry + 16, levels[i].size);
+    std::memcpy(file.data() + offsets[i], data.data() + levels[i].offset,
+                levels[i].size);
+  }
+  for (size_t i = 0; i < data_format_descriptor.size(); ++i) {
+    write<uint32_t>(file, dfd_offset + i * 4, data_format_descriptor[i]);
+  }
+
+  std::ofstream stream(path, std::ios::binary);
+  if (!stream ||
+      !stream.write(reinterpret_cast<const char*>(file.data()), file.size())) {
+    throw std::runtime_error("Could not write texture file " + path.string());
+  }
+}
+
+std::shared_ptr<VulkanEngine::TextureFile>
+VulkanEngine::TextureFile::transcode() const {
+  if (!canTranscode(vk_format)) {
+    throw std::runtime_error("Texture format " + vk::to_string(vk_format) +
+                             " can't be transcoded.");
+  }
+
+  uint32_t block_width;
+  uint32_t block_height;
+  uint32_t block_size;
+  getBlockInfo(vk_format, block_width, block_height, block_size);
+
+  const auto format = isSrgb(vk_format) ? vk::Format::eR8G8B8A8Srgb
+                                        : vk::Format::eR8G8B8A8Unorm;
+  std::vector<Level> transcoded_levels;
+  size_t transcoded_size = 0;
+  for (const auto& level : levels) {
+    const size_t size = static_cast<size_t>(level.width) * level.height * 4;
+    transcoded_levels.push_back(
+        {transcoded_size, size, level.width, level.height});
+    transcoded_size += size;
+  }
+
+  std::vector<uint8_t> transcoded_data(transcoded_size);
+  Texels texels;
+  for (size_t i = 0; i < levels.size(); ++i) {
+    const auto& level = levels[i];
+    const uint8_t* block = data.data() + level.offset;
+    uint8_t* level_data = transcoded_data.data() + transcoded_levels[i].offset;
+    for (uint32_t y = 0; y < level.height; y += block_height) {
+      for (uint32_t x = 0; x < level.width; x += block_width) {
+        decodeBlock(vk_format, block, texels);
+        block += block_size;
+
+        // Blocks at the edges may extend past the level.
+        const uint32_t width = std::min(block_width, level.width - x);
+        const uint32_t height = std::min(block_height, level.height - y);
+        for (uint32_t row = 0; row < height; ++row) {
+          std::memcpy(
+              level_data + (static_cast<size_t>(y + row) * level.width + x) * 4,
+              texels[row * block_width].data(), width * 4);
+        }
+      }
+    }
+  }
+
+  return std::make_shared<TextureFile>(format, std::move(transcoded_levels),
+                                       std::move(transcoded_data));
+}
+
+bool VulkanEngine::TextureFile::canTranscode(vk::Format format) {
+  switch (format) {
+    case vk::Format::eR8G8B8A8Unorm:
+    case vk::Format::eR8G8B8A8Srgb:
+    case vk::Format::eB8G8R8A8Unorm:
+    case vk::Format::eB8G8R8A8Srgb:
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+    case vk::Format::eBc1RgbaUnormBlock:
+    case vk::Format::eBc1RgbaSrgbBlock:
+    case vk::Format::eBc2UnormBlock:
+    case vk::Format::eBc2SrgbBlock:
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+    case vk::Format::eBc4UnormBlock:
+    case vk::Format::eBc5UnormBlock:
+    case vk::Format::eEtc2R8G8B8UnormBlock:
+    case vk::Format::eEtc2R8G8B8SrgbBlock:
+    case vk::Format::eEtc2R8G8B8A1UnormBlock:
+    case vk::Format::eEtc2R8G8B8A1SrgbBlock:
+    case vk::Format::eEtc2R8G8B8A8UnormBlock:
+    case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+    case vk::Format::eEacR11UnormBlock:
+    case vk::Format::eEacR11G11UnormBlock:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool VulkanEngine::TextureFile::getBlockInfo(vk::Format format,
+                                             uint32_t& block_width,
+                                             uint32_t& block_height,
+                                             uint32_t& block_size) {
+  block_width = 4;
+  block_height = 4;
+  switch (format) {
+    case vk::Format::eR8G8B8A8Unorm:
+    case vk::Format::eR8G8B8A8Srgb:
+    case vk::Format::eB8G8R8A8Unorm:
+    case vk::Format::eB8G8R8A8Srgb:
+      block_width = 1;
+      block_height = 1;
+      block_size = 4;
+      return true;
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+    case vk::Format::eBc1RgbaUnormBlock:
+    case vk::Format::eBc1RgbaSrgbBlock:
+    case vk::Format::eBc4UnormBlock:
+    case vk::Format::eBc4SnormBlock:
+    case vk::Format::eEtc2R8G8B8UnormBlock:
+    case vk::Format::eEtc2R8G8B8SrgbBlock:
+    case vk::Format::eEtc2R8G8B8A1UnormBlock:
+    case vk::Format::eEtc2R8G8B8A1SrgbBlock:
+    case vk::Format::eEacR11UnormBlock:
+    case vk::Format::eEacR11SnormBlock:
+      block_size = 8;
+      return true;
+    case vk::Format::eBc2UnormBlock:
+    case vk::Format::eBc2SrgbBlock:
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+    case vk::Format::eBc5UnormBlock:
+    case vk::Format::eBc5SnormBlock:
+    case vk::Format::eBc6HUfloatBlock:
+    case vk::Format::eBc6HSfloatBlock:
+    case vk::Format::eBc7UnormBlock:
+    case vk::Format::eBc7SrgbBlock:
+    case vk::Format::eEtc2R8G8B8A8UnormBlock:
+    case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+    case vk::Format::eEacR11G11UnormBlock:
+    case vk::Format::eEacR11G11SnormBlock:
+      block_size = 16;
+      return true;
+    default:
+      break;
+  }
+
+  // ASTC formats are ordered by block size, with a UNORM and an SRGB format
+  // for each size.
+  constexpr std::array<std::array<uint32_t, 2>, 14> kASTCBlockSizes = {
+      {{4, 4},
+       {5, 4},
+       {5, 5},
+       {6, 5},
+       {6, 6},
+       {8, 5},
+       {8, 6},
+       {8, 8},
+       {10, 5},
+       {10, 6},
+       {10, 8},
+       {10, 10},
+       {12, 10},
+       {12, 12}}};
+  const auto value = static_cast<uint32_t>(format);
+  const auto first = static_cast<uint32_t>(vk::Format::eAstc4x4UnormBlock);
+  if (value >= first && value < first + kASTCBlockSizes.size() * 2) {
+    block_width = kASTCBlockSizes[(value - first) / 2][0];
+    block_height = kASTCBlockSizes[(value - first) / 2][1];
+    block_size = 16;
+    return true;
+  }
+  return false;
+}
+
+size_t VulkanEngine::TextureFile::getLevelSize(vk::Format format,
+                                               uint32_t width,
+                                               uint32_t height) {
+  uint32_t block_width;
+  uint32_t block_height;
+  uint32_t block_size;
+  if (!getBlockInfo(format, block_width, block_height, block_size)) {
+    throw std::runtime_error("Unsupported texture format " +
+                             vk::to_string(format));
+  }
+  const size_t blocks_x = (width + block_width - 1) / block_width;
+  const size_t blocks_y = (height + block_height - 1) / block_height;
+  return blocks_x * blocks_y * block_size;
+}
+
+vk::Format VulkanEngine::TextureFile::getVkFormat() const { return vk_format; }
+
+uint32_t VulkanEngine::TextureFile::getWidth() const {
+  return levels.front().width;
+}
+
+uint32_t VulkanEngine::TextureFile::getHeight() const {
+  return levels.front().height;
+}
+
+const std::vector<VulkanEngine::TextureFile::Level>&
+VulkanEngine::TextureFile::getLevels() const {
+  return levels;
+}
+
+const uint8_t* VulkanEngine::TextureFile::getData() const {
+  return data.data();
+}
+
+size_t VulkanEngine::TextureFile::getDataSize() const { return data_size; }
+
+std::shared_ptr<VulkanEngine::TextureFile> VulkanEngine::TextureFile::loadKTX2(
+    std::vector<uint8_t> file) {
+  const auto format = static_cast<vk::Format>(read<uint32_t>(file, 12));
+  const uint32_t width = read<uint32_t>(file, 20);
+  const uint32_t height = read<uint32_t>(file, 24);
+  const uint32_t depth = read<uint32_t>(file, 28);
+  const uint32_t layer_count = read<uint32_t>(file, 32);
+  const uint32_t face_count = read<uint32_t>(file, 36);
+  const uint32_t level_count = std::max(read<uint32_t>(file, 40), 1u);
+  const uint32_t supercompression_scheme = read<uint32_t>(file, 44);
+
+  if (format == vk::Format::eUndefined || supercompression_scheme != 0) {
+    throw std::runtime_error(
+        "Supercompressed KTX2 textures are not supported.");
+  }
+  if (width == 0 || height == 0 || depth > 1 || layer_count > 1 ||
+      face_count != 1) {
+    throw std::runtime_error("Only 2D KTX2 textures are supported.");
+  }
+  if (level_count > getMaxLevelCount(width, height)) {
+    throw std::runtime_error("KTX2 texture has more levels than its size.");
+  }
+
+  // The level index lists the largest level first, even though the levels
+  // are stored smallest first.
+  std::vector<size_t> offsets;
+  for (uint32_t i = 0; i < level_count; ++i) {
+    const size_t entry = kKTX2HeaderSize + i * 24;
+    offsets.push_back(static_cast<size_t>(read<uint64_t>(file, entry)));
+    const auto size = static_cast<size_t>(read<uint64_t>(file, entry + 8));
+    if (size != getLevelSize(format, std::max(width >> i, 1u),
+                             std::max(height >> i, 1u))) {
+      throw std::runtime_error("KTX2 level has an unexpected size.");
+    }
+  }
+  return createFromFile(format, width, height, offsets, std::move(file));
+}
+
+std::shared_ptr<VulkanEngine::TextureFile> VulkanEngine::TextureFile::loadDDS(
+    std::vector<uint8_t> file) {
+  const uint32_t flags = read<uint32_t>(file, 8);
+  const uint32_t height = read<uint32_t>(file, 12);
+  const uint32_t width = read<uint32_t>(file, 16);
+  const uint32_t mip_map_count = read<uint32_t>(file, 28);
+  const uint32_t pixel_format_flags = read<uint32_t>(file, 80);
+  const uint32_t four_cc = read<uint32_t>(file, 84);
+  const uint32_t caps2 = read<uint32_t>(file, 112);
+  if (width == 0 || height == 0 || (caps2 & (kDDSCubemap | kDDSVolume))) {
+    throw std::runtime_error("Only 2D DDS textures are supported.");
+  }
+
+  auto format = vk::Format::eUndefined;
+  size_t data_offset = kDDSHeaderSize;
+  if (pixel_format_flags & kDDSPixelFormatFourCC) {
+    if (four_cc == makeFourCC('D', 'X', '1', '0')) {
+      if (read<uint32_t>(file, 132) != kDDSTexture2D ||
+          read<uint32_t>(file, 140) > 1) {
+        throw std::runtime_error("Only 2D DDS textures are supported.");
+      }
+      format = getDXGIFormat(read<uint32_t>(file, 128));
+      data_offset += kDDSDX10HeaderSize;
+    } else if (four_cc == makeFourCC('D', 'X', 'T', '1')) {
+      format = vk::Format::eBc1RgbaUnormBlock;
+    } else if (four_cc == makeFourCC('D', 'X', 'T', '2') ||
+               four_cc == makeFourCC('D', 'X', 'T', '3')) {
+      format = vk::Format::eBc2UnormBlock;
+    } else if (four_cc == makeFourCC('D', 'X', 'T', '4') ||
+               four_cc == makeFourCC('D', 'X', 'T', '5')) {
+      format = vk::Format::eBc3UnormBlock;
+    } else if (four_cc == makeFourCC('A', 'T', 'I', '1') ||
+               four_cc == makeFourCC('B', 'C', '4', 'U')) {
+      format = vk::Format::eBc4UnormBlock;
+    } else if (four_cc == makeFourCC('A', 'T', 'I', '2') ||
+               four_cc == makeFourCC('B', 'C', '5', 'U')) {
+      format = vk::Format::eBc5UnormBlock;
+    }
+  } else if ((pixel_format_flags & kDDSPixelFormatRGB) &&
+             read<uint32_t>(file, 88) == 32) {
+    const uint32_t red_mask = read<uint32_t>(file, 92);
+    if (red_mask == 0x000000ff) {
+      format = vk::Format::eR8G8B8A8Unorm;
+    } else if (red_mask == 0x00ff0000) {
+      format = vk::Format::eB8G8R8A8Unorm;
+    }
+  }
+  if (format == vk::Format::eUndefined) {
+    throw std::runtime_error("Unsupported DDS pixel format.");
+  }
+
+  const uint32_t level_count =
+      (flags & kDDSMipMapCount) ? std::max(mip_map_count, 1u) : 1;
+  if (level_count > getMaxLevelCount(width, height)) {
+    throw std::runtime_error("DDS texture has more levels than its size.");
+  }
+  std::vector<size_t> offsets;
+  for (uint32_t i = 0; i < level_count; ++i) {
+    offsets.push_back(data_offset);
+    data_offset += getLevelSize(format, std::max(width >> i, 1u),
+                                std::max(height >> i, 1u));
+  }
+  return createFromFile(format, width, height, offsets, std::move(file));
+}
+
+std::shared_ptr<VulkanEngine::TextureFile>
+VulkanEngine::TextureFile::createFromFile(vk::Format format, uint32_t width,
+                                          uint32_t height,
+                                          const std::vector<size_t>& offsets,
+                                          std::vector<uint8_t> file) {
+  std::vector<Level> levels;
+  for (uint32_t i = 0; i < offsets.size(); ++i) {
+    const uint32_t level_width = std::max(width >> i, 1u);
+    const uint32_t level_height = std::max(height >> i, 1u);
+    const size_t size = getLevelSize(format, level_width, level_height);
+    if (offsets[i] > file.size() || file.size() - offsets[i] < size) {
+      throw std::runtime_error("Texture file is truncated.");
+    }
+    levels.push_back({offsets[i], size, level_width, level_height});
+  }
+  return std::make_shared<TextureFile>(format, std::move(levels),
+                                       std::move(file));
+}
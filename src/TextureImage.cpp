@@ -0,0 +1,251 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/Device.h>
+#include <VulkanEngine/TextureImage.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+VulkanEngine::TextureImage::TextureImage(
+    std::shared_ptr<const TextureFile> texture_file, uint32_t binding,
+    vk::ShaderStageFlags shader_stage_flags, uint32_t _first_level)
+    : StagedBufferDestination(),
+      ImageBase(),
+      Descriptor(binding, 1, vk::DescriptorType::eCombinedImageSampler,
+                 shader_stage_flags),
+      vk_format(texture_file->getVkFormat()),
+      first_level(_first_level),
+      data_size(0),
+      vk_image_layout(vk::ImageLayout::eUndefined) {
+  const auto& file_levels = texture_file->getLevels();
+  if (first_level >= file_levels.size()) {
+    throw std::runtime_error("TextureImage level out of range!");
+  }
+  levels.assign(file_levels.begin() + first_level, file_levels.end());
+  for (auto& level : levels) {
+    level.offset = data_size;
+    data_size += level.size;
+  }
+
+  auto& device = *VulkanManager::getInstance().getDevice();
+  const auto num_levels = static_cast<uint32_t>(levels.size());
+
+  auto image_create_info = static_cast<VkImageCreateInfo>(
+      vk::ImageCreateInfo()
+          .setImageType(vk::ImageType::e2D)
+          .setExtent(vk::Extent3D(levels.front().width,
+                                  levels.front().height, 1))
+          .setMipLevels(num_levels)
+          .setArrayLayers(1)
+          .setFormat(vk_format)
+          .setTiling(vk::ImageTiling::eOptimal)
+          .setInitialLayout(vk_image_layout)
+          .setUsage(vk::ImageUsageFlagBits::eTransferDst |
+                    vk::ImageUsageFlagBits::eSampled)
+          .setSharingMode(vk::SharingMode::eExclusive)
+          .setSamples(vk::SampleCountFlagBits::e1));
+
+  VmaAllocationCreateInfo allocate_info = {};
+  allocate_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+  VkImage c_image_handle;
+  if (device.getMemoryPools().createImage(image_create_info, allocate_info,
+                                         &c_image_handle,
+                                         &vma_allocation) != VK_SUCCESS) {
+    throw std::runtime_error("Could not allocate TextureImage memory!");
+  }
+  vk_image = c_image_handle;
+  device.getMemoryTelemetry().recordAllocation(
+      vma_allocation, MemoryTelemetry::Category::eTexture);
+
+  auto subresource_range = vk::ImageSubresourceRange()
+                               .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                               .setBaseMipLevel(0)
+                               .setLevelCount(num_levels)
+                               .setBaseArrayLayer(0)
+                               .setLayerCount(1);
+  vk_image_view = device.getVkDevice().createImageView(
+      vk::ImageViewCreateInfo()
+          .setFormat(vk_format)
+          .setImage(vk_image)
+          .setViewType(vk::ImageViewType::e2D)
+          .setSubresourceRange(subresource_range));
+  if (!vk_image_view) {
+    throw std::runtime_error("Could not create image view for image!");
+  }
+
+  vk_sampler = device.getVkDevice().createSampler(
+      vk::SamplerCreateInfo()
+          .setAddressModeU(vk::SamplerAddressMode::eRepeat)
+          .setAddressModeV(vk::SamplerAddressMode::eRepeat)
+          .setAddressModeW(vk::SamplerAddressMode::eRepeat)
+          .setAnisotropyEnable(VK_TRUE)
+          .setMaxAnisotropy(16.0f)
+          .setBorderColor(vk::BorderColor::eIntOpaqueBlack)
+          .setMagFilter(vk::Filter::eLinear)
+          .setMinFilter(vk::Filter::eLinear)
+          .setUnnormalizedCoordinates(VK_FALSE)
+          .setCompareEnable(VK_FALSE)
+          .setCompareOp(vk::CompareOp::eAlways)
+          .setMipmapMode(vk::SamplerMipmapMode::eLinear)
+          .setMipLodBias(0.0f)
+          .setMinLod(0.0f)
+          .setMaxLod(static_cast<float>(num_levels)));
+  if (!vk_sampler) {
+    throw std::runtime_error("Could not create sampler for image");
+  }
+}
+
+VulkanEngine::TextureImage::~TextureImage() {
+  auto& vulkan_manager = VulkanManager::getInstance();
+  vulkan_manager.getMemoryDefragmenter().unregisterResource(vma_allocation);
+  vulkan_manager.getDeletionQueue().enqueue(
+      [vk_sampler = vk_sampler, vk_image_view = vk_image_view,
+       vk_image = vk_image, vma_allocation = vma_allocation]() {
+        auto& device = *VulkanManager::getInstance().getDevice();
+        device.getVkDevice().destroySampler(vk_sampler);
+        device.getVkDevice().destroyImageView(vk_image_view);
+        device.getMemoryTelemetry().recordFree(vma_allocation);
+        vmaDestroyImage(device.getVmaAllocator(), vk_image, vma_allocation);
+      });
+}
+
+void VulkanEngine::TextureImage::copyLevels(const TextureFile& texture_file,
+                                            void* destination) const {
+  const auto& file_levels = texture_file.getLevels();
+  if (file_levels.size() != first_level + levels.size()) {
+    throw std::runtime_error("Texture file doesn't match TextureImage!");
+  }
+  for (size_t i = 0; i < levels.size(); ++i) {
+    std::memcpy(static_cast<uint8_t*>(destination) + levels[i].offset,
+                texture_file.getData() + file_levels[first_level + i].offset,
+                levels[i].size);
+  }
+}
+
+vk::Format VulkanEngine::TextureImage::getVkFormat() const {
+  return vk_format;
+}
+
+uint32_t VulkanEngine::TextureImage::getNumLevels() const {
+  return static_cast<uint32_t>(levels.size());
+}
+
+uint32_t VulkanEngine::TextureImage::getFirstLevel() const {
+  return first_level;
+}
+
+vk::Image VulkanEngine::TextureImage::getVkImage() const { return vk_image; }
+
+vk::ImageView VulkanEngine::TextureImage::getVkImageView() const {
+  return vk_image_view;
+}
+
+void VulkanEngine::TextureImage::appendVkDescriptorSets(
+    std::shared_ptr<std::vector<vk::WriteDescriptorSet>> write_descriptor_sets,
+    std::shared_ptr<std::vector<vk::CopyDescriptorSet>> copy_descriptor_sets,
+    const vk::DescriptorSet& destination_set) {
+  // The image is only sampled once its transfer has been recorded, which may
+  // happen after the descriptor set has been written.
+  vk_descriptor_image_info =
+      vk::DescriptorImageInfo()
+          .setSampler(vk_sampler)
+          .setImageView(vk_image_view)
+          .setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+  write_descriptor_sets->push_back(
+      vk::WriteDescriptorSet()
+          .setDstBinding(binding)
+          .setDstArrayElement(0)
+          .setDstSet(destination_set)
+          .setDescriptorType(vk_descriptor_type)
+          .setDescriptorCount(1)
+          .setPImageInfo(&vk_descriptor_image_info));
+}
+
+void VulkanEngine::TextureImage::insertTransferCommand(
+    const vk::CommandBuffer& command_buffer, const vk::Buffer& source_buffer) {
+  transitionImageLayout(command_buffer, vk::ImageLayout::eTransferDstOptimal);
+
+  // One copy per level, all recorded with a single command.
+  std::vector<vk::BufferImageCopy> buffer_image_copies;
+  for (size_t i = 0; i < levels.size(); ++i) {
+    buffer_image_copies.push_back(
+        vk::BufferImageCopy()
+            .setBufferOffset(levels[i].offset)
+            .setBufferRowLength(0)
+            .setBufferImageHeight(0)
+            .setImageSubresource(
+                vk::ImageSubresourceLayers()
+                    .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                    .setMipLevel(static_cast<uint32_t>(i))
+                    .setBaseArrayLayer(0)
+                    .setLayerCount(1))
+            .setImageOffset(vk::Offset3D(0, 0, 0))
+            .setImageExtent(
+                vk::Extent3D(levels[i].width, levels[i].height, 1)));
+  }
+  command_buffer.copyBufferToImage(source_buffer, vk_image,
+                                   vk::ImageLayout::eTransferDstOptimal,
+                                   buffer_image_copies);
+
+  transitionImageLayout(command_buffer,
+                        vk::ImageLayout::eShaderReadOnlyOptimal);
+}
+
+size_t VulkanEngine::TextureImage::getStagingBufferSize() const {
+  return data_size;
+}
+
+void VulkanEngine::TextureImage::transitionImageLayout(
+    const vk::CommandBuffer& command_buffer, vk::ImageLayout new_layout) {
+  const bool to_transfer = new_layout == vk::ImageLayout::eTransferDstOptimal;
+  auto image_memory_barrier =
+      vk::ImageMemoryBarrier()
+          .setImage(vk_image)
+          .setOldLayout(vk_image_layout)
+          .setNewLayout(new_layout)
+          .setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+          .setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED)
+          .setSrcAccessMask(to_transfer ? vk::AccessFlags()
+                                        : vk::AccessFlagBits::eTransferWrite)
+          .setDstAccessMask(to_transfer ? vk::AccessFlagBits::eTransferWrite
+                                        : vk::AccessFlagBits::eShaderRead)
+          .setSubresourceRange(
+              vk::ImageSubresourceRange()
+                  .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                  .setBaseMipLevel(0)
+                  .setLevelCount(static_cast<uint32_t>(levels.size()))
+                  .setBaseArrayLayer(0)
+                  .setLayerCount(1));
+
+  command_buffer.pipelineBarrier(
+      to_transfer ? vk::PipelineStageFlagBits::eTopOfPipe
+                  : vk::PipelineStageFlagBits::eTransfer,
+      to_transfer ? vk::PipelineStageFlagBits::eTransfer
+                  : vk::PipelineStageFlagBits::eFragmentShader,
+      vk::DependencyFlags(), nullptr, nullptr, image_memory_barrier);
+
+  vk_image_layout = new_layout;
+}
@@ -0,0 +1,237 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/TextureStreamer.h>
+#include <VulkanEngine/VulkanManager.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+VulkanEngine::TextureStreamer::TextureStreamer()
+    : enabled(false), memory_budget(0), current_memory_budget(0), frame(0) {}
+
+VulkanEngine::TextureStreamer::~TextureStreamer() {}
+
+std::shared_ptr<VulkanEngine::StreamedTexture>
+VulkanEngine::TextureStreamer::createTexture(
+    std::shared_ptr<const TextureFile> texture_file, uint32_t binding,
+    vk::ShaderStageFlags shader_stage_flags) {
+  const auto& levels = texture_file->getLevels();
+  uint32_t resident_level = 0;
+  while (resident_level + 1 < levels.size() &&
+         std::max(levels[resident_level].width,
+                  levels[resident_level].height) > kInitialSize) {
+    ++resident_level;
+  }
+
+  auto texture = std::make_shared<StreamedTexture>(
+      std::move(texture_file), binding, shader_stage_flags, resident_level);
+  std::lock_guard<std::mutex> lock(mutex);
+  textures.push_back(texture);
+  return texture;
+}
+
+void VulkanEngine::TextureStreamer::update() {
+  ++frame;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    update_textures.clear();
+    auto it = textures.begin();
+    while (it != textures.end()) {
+      auto texture = it->lock();
+      if (texture.get() == nullptr) {
+        it = textures.erase(it);
+        continue;
+      }
+      update_textures.push_back(std::move(texture));
+      ++it;
+    }
+  }
+
+  size_t committed_size = 0;
+  size_t streamed_size = 0;
+  for (const auto& texture : update_textures) {
+    // Replaced images are destroyed by the DeletionQueue once the frames
+    // in flight which may sample them have completed.
+    texture->updateLoad();
+
+    if (texture->requested_level < texture->getNumLevels()) {
+      texture->target_level = texture->requested_level;
+      texture->last_request_frame = frame;
+      texture->requested_level = texture->getNumLevels();
+    }
+
+    committed_size += getCommittedSize(*texture);
+    streamed_size += texture->getResidentSize();
+  }
+
+  current_memory_budget =
+      memory_budget != 0 ? memory_budget : queryMemoryBudget(streamed_size);
+
+  // Drop levels of the textures which have been drawn least recently until
+  // the resident levels fit.
+  if (committed_size > current_memory_budget) {
+    candidates.clear();
+    for (const auto& texture : update_textures) {
+      if (!texture->isLoading() &&
+          texture->getResidentLevel() + 1 < texture->getNumLevels()) {
+        candidates.push_back(texture.get());
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const StreamedTexture* a, const StreamedTexture* b) {
+                return a->last_request_frame < b->last_request_frame;
+              });
+
+    for (auto texture : candidates) {
+      if (committed_size <= current_memory_budget) {
+        break;
+      }
+      const uint32_t level = std::min(
+          std::max(texture->getResidentLevel() + 1, texture->target_level),
+          texture->getNumLevels() - 1);
+      committed_size -= texture->getResidentSize();
+      texture->load(level);
+      committed_size += getCommittedSize(*texture);
+    }
+  }
+
+  // Load the levels requested by the textures which have been drawn most
+  // recently, as long as they fit.
+  size_t num_pending_loads = 0;
+  candidates.clear();
+  for (const auto& texture : update_textures) {
+    if (texture->isLoading()) {
+      ++num_pending_loads;
+    } else if (texture->target_level < texture->getResidentLevel()) {
+      candidates.push_back(texture.get());
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const StreamedTexture* a, const StreamedTexture* b) {
+              return a->last_request_frame > b->last_request_frame;
+            });
+
+  for (auto texture : candidates) {
+    if (num_pending_loads >= kMaxPendingLoads) {
+      break;
+    }
+    const size_t loaded_size = committed_size - texture->getResidentSize() +
+                               texture->getImageSize(texture->target_level);
+    if (loaded_size > current_memory_budget) {
+      continue;
+    }
+    committed_size = loaded_size;
+    texture->load(texture->target_level);
+    ++num_pending_loads;
+  }
+
+  // Textures are only kept alive by their owners between updates.
+  update_textures.clear();
+  candidates.clear();
+}
+
+void VulkanEngine::TextureStreamer::setEnabled(bool _enabled) {
+  enabled = _enabled;
+}
+
+bool VulkanEngine::TextureStreamer::isEnabled() const { return enabled; }
+
+void VulkanEngine::TextureStreamer::setMemoryBudget(size_t _memory_budget) {
+  memory_budget = _memory_budget;
+}
+
+size_t VulkanEngine::TextureStreamer::getMemoryBudget() const {
+  return current_memory_budget;
+}
+
+size_t VulkanEngine::TextureStreamer::getResidentSize() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t resident_size = 0;
+  for (const auto& weak_texture : textures) {
+    auto texture = weak_texture.lock();
+    if (texture.get() != nullptr) {
+      resident_size += texture->getResidentSize();
+    }
+  }
+  return resident_size;
+}
+
+size_t VulkanEngine::TextureStreamer::getNumTextures() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return std::count_if(textures.begin(), textures.end(),
+                       [](const std::weak_ptr<StreamedTexture>& texture) {
+                         return !texture.expired();
+                       });
+}
+
+size_t VulkanEngine::TextureStreamer::getNumPendingLoads() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t num_pending_loads = 0;
+  for (const auto& weak_texture : textures) {
+    auto texture = weak_texture.lock();
+    if (texture.get() != nullptr && texture->isLoading()) {
+      ++num_pending_loads;
+    }
+  }
+  return num_pending_loads;
+}
+
+void VulkanEngine::TextureStreamer::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  textures.clear();
+}
+
+size_t VulkanEngine::TextureStreamer::queryMemoryBudget(size_t streamed_size) {
+  auto allocator = VulkanManager::getInstance().getDevice()->getVmaAllocator();
+  const VkPhysicalDeviceMemoryProperties* memory_properties = nullptr;
+  vmaGetMemoryProperties(allocator, &memory_properties);
+  std::vector<VmaBudget> budgets(memory_properties->memoryHeapCount);
+  vmaGetHeapBudgets(allocator, budgets.data());
+
+  VkDeviceSize budget = 0;
+  VkDeviceSize usage = 0;
+  for (uint32_t i = 0; i < memory_properties->memoryHeapCount; ++i) {
+    if (memory_properties->memoryHeaps[i].flags &
+        VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+      budget += budgets[i].budget;
+      usage += budgets[i].usage;
+    }
+  }
+
+  // Keep some headroom since the budget changes with the memory used by
+  // other applications, and everything else allocated by the engine is
+  // more important than the detail of textures.
+  const VkDeviceSize available = budget - budget / 10;
+  const VkDeviceSize other_usage =
+      usage > streamed_size ? usage - streamed_size : 0;
+  return available > other_usage ? static_cast<size_t>(available - other_usage)
+                                 : 0;
+}
+
+size_t VulkanEngine::TextureStreamer::getCommittedSize(
+    const StreamedTexture& texture) {
+  return texture.isLoading() ? texture.getImageSize(texture.pending_level)
+                             : texture.getResidentSize();
+}
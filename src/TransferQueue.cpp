@@ -0,0 +1,137 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/Profiler.h>
+#include <VulkanEngine/SingleUsageCommandBuffer.h>
+#include <VulkanEngine/TransferQueue.h>
+
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+VulkanEngine::TransferQueue::TransferQueue()
+    : next_transfer(1), last_recorded_transfer(0), budget(64 << 20) {}
+
+VulkanEngine::TransferQueue::~TransferQueue() {}
+
+uint64_t VulkanEngine::TransferQueue::enqueue(
+    const std::function<void(const vk::CommandBuffer&)>& record,
+    size_t size) {
+  std::lock_guard<std::mutex> lock(mutex);
+  const uint64_t transfer = next_transfer++;
+  pending_transfers.push_back({transfer, record, size});
+  return transfer;
+}
+
+bool VulkanEngine::TransferQueue::isAvailable(uint64_t transfer) const {
+  return transfer <= last_recorded_transfer.load();
+}
+
+size_t VulkanEngine::TransferQueue::flush(
+    const vk::CommandBuffer& command_buffer) {
+  VULKANENGINE_PROFILE_SCOPE("TransferQueue::flush");
+  take(budget, transfers_scratch);
+  if (transfers_scratch.empty()) {
+    return 0;
+  }
+
+  {
+    VULKANENGINE_PROFILE_GPU_SCOPE(command_buffer, "TransferQueue");
+    record(command_buffer, transfers_scratch);
+  }
+  last_recorded_transfer = transfers_scratch.back().id;
+
+  const size_t num_transfers = transfers_scratch.size();
+  transfers_scratch.clear();
+  return num_transfers;
+}
+
+size_t VulkanEngine::TransferQueue::flush() {
+  VULKANENGINE_PROFILE_SCOPE("TransferQueue::flush");
+  take(std::numeric_limits<size_t>::max(), transfers_scratch);
+  if (transfers_scratch.empty()) {
+    return 0;
+  }
+
+  SingleUsageCommandBuffer command_buffer;
+  command_buffer.beginSingleUsageCommandBuffer();
+  record(command_buffer.single_use_command_buffer, transfers_scratch);
+  command_buffer.endSingleUsageCommandBuffer();
+  last_recorded_transfer = transfers_scratch.back().id;
+
+  const size_t num_transfers = transfers_scratch.size();
+  transfers_scratch.clear();
+  return num_transfers;
+}
+
+void VulkanEngine::TransferQueue::setBudget(size_t _budget) {
+  budget = _budget;
+}
+
+size_t VulkanEngine::TransferQueue::getBudget() const { return budget; }
+
+size_t VulkanEngine::TransferQueue::getNumPendingTransfers() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return pending_transfers.size();
+}
+
+void VulkanEngine::TransferQueue::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  pending_transfers.clear();
+}
+
+void VulkanEngine::TransferQueue::take(size_t max_size,
+                                       std::vector<Transfer>& transfers) {
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t size = 0;
+  while (!pending_transfers.empty() &&
+         (transfers.empty() || size < max_size)) {
+    size += pending_transfers.front().size;
+    transfers.push_back(std::move(pending_transfers.front()));
+    pending_transfers.pop_front();
+  }
+}
+
+void VulkanEngine::TransferQueue::record(
+    const vk::CommandBuffer& command_buffer,
+    const std::vector<Transfer>& transfers) {
+  for (const auto& transfer : transfers) {
+    transfer.record(command_buffer);
+  }
+
+  // Buffer copies don't synchronize with later reads by themselves. Images
+  // are transitioned to their final layout by the transfers already.
+  auto memory_barrier =
+      vk::MemoryBarrier()
+          .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+          .setDstAccessMask(vk::AccessFlagBits::eVertexAttributeRead |
+                            vk::AccessFlagBits::eIndexRead |
+                            vk::AccessFlagBits::eUniformRead |
+                            vk::AccessFlagBits::eShaderRead);
+  const auto dst_stage_mask = vk::PipelineStageFlagBits::eVertexInput |
+                              vk::PipelineStageFlagBits::eVertexShader |
+                              vk::PipelineStageFlagBits::eFragmentShader |
+                              vk::PipelineStageFlagBits::eComputeShader;
+  command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                 dst_stage_mask, vk::DependencyFlags(),
+                                 memory_barrier, nullptr, nullptr);
+}
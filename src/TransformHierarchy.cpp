@@ -0,0 +1,170 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/TransformHierarchy.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+VulkanEngine::TransformHierarchy::TransformHierarchy()
+    : first_dirty_node(0), num_updated_nodes(0) {}
+
+VulkanEngine::TransformHierarchy::~TransformHierarchy() {}
+
+void VulkanEngine::TransformHierarchy::clear() {
+  parents.clear();
+  subtree_ends.clear();
+  local_transforms.clear();
+  world_transforms.clear();
+  dirty.clear();
+  first_dirty_node = 0;
+}
+
+void VulkanEngine::TransformHierarchy::reserve(size_t count) {
+  parents.reserve(count);
+  subtree_ends.reserve(count);
+  local_transforms.reserve(count);
+  world_transforms.reserve(count);
+  dirty.reserve(count);
+}
+
+uint32_t VulkanEngine::TransformHierarchy::addNode(
+    uint32_t parent, const Eigen::Matrix4f& local_transform) {
+  const auto node = static_cast<uint32_t>(parents.size());
+  if (parent != kNoParent && parent >= node) {
+    throw std::runtime_error(
+        "Parent of transform hierarchy node must be added first");
+  }
+
+  parents.push_back(parent);
+  subtree_ends.push_back(node + 1);
+  local_transforms.push_back(local_transform);
+  world_transforms.push_back(Eigen::Matrix4f::Identity());
+  dirty.push_back(1);
+  first_dirty_node = std::min(first_dirty_node, static_cast<size_t>(node));
+
+  for (uint32_t ancestor = parent; ancestor != kNoParent;
+       ancestor = parents[ancestor]) {
+    subtree_ends[ancestor] = std::max(subtree_ends[ancestor], node + 1);
+  }
+
+  return node;
+}
+
+size_t VulkanEngine::TransformHierarchy::size() const { return parents.size(); }
+
+uint32_t VulkanEngine::TransformHierarchy::getParent(uint32_t node) const {
+  return parents[node];
+}
+
+uint32_t VulkanEngine::TransformHierarchy::getSubtreeEnd(uint32_t node) const {
+  return subtree_ends[node];
+}
+
+void VulkanEngine::TransformHierarchy::setLocalTransform(
+    uint32_t node, const Eigen::Matrix4f& local_transform) {
+  local_transforms[node] = local_transform;
+  dirty[node] = 1;
+  first_dirty_node = std::min(first_dirty_node, static_cast<size_t>(node));
+}
+
+const Eigen::Matrix4f& VulkanEngine::TransformHierarchy::getLocalTransform(
+    uint32_t node) const {
+  return local_transforms[node];
+}
+
+const Eigen::Matrix4f& VulkanEngine::TransformHierarchy::getWorldTransform(
+    uint32_t node) const {
+  return world_transforms[node];
+}
+
+void VulkanEngine::TransformHierarchy::update() {
+  num_updated_nodes = 0;
+  const size_t count = parents.size();
+
+  // Parents come before their children, so a single pass propagates the
+  // dirty flags down and nothing before the first dirty node can change.
+  for (size_t i = first_dirty_node; i < count; ++i) {
+    const uint32_t parent = parents[i];
+    if (parent == kNoParent) {
+      if (dirty[i]) {
+        world_transforms[i] = local_transforms[i];
+        ++num_updated_nodes;
+      }
+      continue;
+    }
+
+    dirty[i] |= dirty[parent];
+    if (dirty[i]) {
+      multiply(world_transforms[parent], local_transforms[i],
+               world_transforms[i]);
+      ++num_updated_nodes;
+    }
+  }
+
+  std::fill(dirty.begin() + std::min(first_dirty_node, count), dirty.end(), 0);
+  first_dirty_node = count;
+}
+
+size_t VulkanEngine::TransformHierarchy::getNumUpdatedNodes() const {
+  return num_updated_nodes;
+}
+
+void VulkanEngine::TransformHierarchy::multiply(const Eigen::Matrix4f& a,
+                                                const Eigen::Matrix4f& b,
+                                                Eigen::Matrix4f& result) {
+#if defined(__AVX2__)
+  // Column j of the result is the sum of the columns of a weighted by the
+  // entries of column j of b. Each register holds two columns, and the
+  // in-lane shuffles broadcast the weights of both columns at once.
+  const float* a_data = a.data();
+  const __m256 a0 = _mm256_broadcast_ps(
+      reinterpret_cast<const __m128*>(a_data));
+  const __m256 a1 = _mm256_broadcast_ps(
+      reinterpret_cast<const __m128*>(a_data + 4));
+  const __m256 a2 = _mm256_broadcast_ps(
+      reinterpret_cast<const __m128*>(a_data + 8));
+  const __m256 a3 = _mm256_broadcast_ps(
+      reinterpret_cast<const __m128*>(a_data + 12));
+  for (size_t j = 0; j < 4; j += 2) {
+    const __m256 b_columns = _mm256_loadu_ps(b.data() + 4 * j);
+    __m256 columns = _mm256_mul_ps(
+        a0, _mm256_shuffle_ps(b_columns, b_columns, 0x00));
+    columns = _mm256_add_ps(
+        columns,
+        _mm256_mul_ps(a1, _mm256_shuffle_ps(b_columns, b_columns, 0x55)));
+    columns = _mm256_add_ps(
+        columns,
+        _mm256_mul_ps(a2, _mm256_shuffle_ps(b_columns, b_columns, 0xAA)));
+    columns = _mm256_add_ps(
+        columns,
+        _mm256_mul_ps(a3, _mm256_shuffle_ps(b_columns, b_columns, 0xFF)));
+    _mm256_storeu_ps(result.data() + 4 * j, columns);
+  }
+#else
+  // Eigen vectorizes fixed size 4x4 products with SSE.
+  result.noalias() = a * b;
+#endif
+}
@@ -24,14 +24,15 @@
 #include <VulkanEngine/VertexAttribute.h>
 
 template <typename T>
-VulkanEngine::VertexAttribute<T>::VertexAttribute(const T* data,
-                                                  size_t _num_elements,
-                                                  uint32_t _location,
-                                                  vk::Format _format)
+VulkanEngine::VertexAttribute<T>::VertexAttribute(
+    const T* data, size_t _num_elements, uint32_t _location, vk::Format _format,
+    vk::VertexInputRate _input_rate, uint32_t _num_locations)
     : Attribute(_num_elements, sizeof(T),
                 vk::BufferUsageFlagBits::eVertexBuffer),
       location(_location),
-      format(_format) {
+      format(_format),
+      input_rate(_input_rate),
+      num_locations(_num_locations) {
   updateBuffer(data, sizeof(T) * num_elements);
 }
 
@@ -44,19 +45,24 @@ VulkanEngine::VertexAttribute<T>::getVkVertexInputBindingDescription(
     uint32_t binding_index) const {
   return vk::VertexInputBindingDescription()
       .setBinding(binding_index)
-      .setInputRate(vk::VertexInputRate::eVertex)
+      .setInputRate(input_rate)
       .setStride(sizeof(T));
 }
 
 template <typename T>
-const vk::VertexInputAttributeDescription
+const std::vector<vk::VertexInputAttributeDescription>
 VulkanEngine::VertexAttribute<T>::getVkVertexInputAttributeDescriptions(
     uint32_t binding_index) const {
-  return vk::VertexInputAttributeDescription()
-      .setBinding(binding_index)
-      .setLocation(location)
-      .setFormat(getVkFormat())
-      .setOffset(0);
+  std::vector<vk::VertexInputAttributeDescription> descriptions;
+  for (uint32_t i = 0; i < num_locations; ++i) {
+    descriptions.push_back(
+        vk::VertexInputAttributeDescription()
+            .setBinding(binding_index)
+            .setLocation(location + i)
+            .setFormat(getVkFormat())
+            .setOffset(static_cast<uint32_t>(sizeof(T) / num_locations * i)));
+  }
+  return descriptions;
 }
 
 template <typename T>
@@ -147,12 +147,25 @@ vk::Framebuffer VulkanEngine::VulkanManager::getCurrentSwapchainFramebuffer() {
   return swapchain->getFramebuffer(current_frame);
 }
 
+std::shared_ptr<VulkanEngine::CommandPool>
+VulkanEngine::VulkanManager::getCurrentCommandPool() {
+  return device->getFrameCommandPool(current_frame);
+}
+
 void VulkanEngine::VulkanManager::waitForFence() { swapchain->waitForFence(); }
 
+void VulkanEngine::VulkanManager::beginFrame() {
+  swapchain->waitForFence();
+  profiler.beginFrame(current_frame);
+  device->beginFrame(current_frame);
+  deletion_queue.beginFrame();
+}
+
 void VulkanEngine::VulkanManager::drawImage() {
   // Submit commands to the queue
   if (!swapchain->present()) {
     device->waitIdle();
+    deletion_queue.flush();
     default_render_pass.reset();
     default_render_pass.reset(new RenderPass(window->getFramebufferWidth(),
                                              window->getFramebufferHeight()));
@@ -160,10 +173,14 @@ void VulkanEngine::VulkanManager::drawImage() {
     swapchain.reset(
         new Swapchain(frames_in_flight, window, default_render_pass));
     current_frame = 0;
+    profiler.endFrame();
+    frame_statistics.endFrame();
     return;
   }
 
   current_frame = (current_frame + 1) % frames_in_flight;
+  profiler.endFrame();
+  frame_statistics.endFrame();
 }
 
 void VulkanEngine::VulkanManager::cleanup() {
@@ -171,7 +188,17 @@ void VulkanEngine::VulkanManager::cleanup() {
     return;
   }
 
+  // Background loads use the device, and queued uploads hold resources
+  // allocated from it.
+  asset_registry.waitForBackgroundLoads();
+  transfer_queue.clear();
+
   device->waitIdle();
+  deletion_queue.flush();
+  profiler.clear();
+  memory_defragmenter.clear();
+  texture_streamer.clear();
+  mipmap_generator.clear();
   default_render_pass.reset();
   swapchain.reset();
 
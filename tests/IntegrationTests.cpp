@@ -18,15 +18,42 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <VulkanEngine/AssetRegistry.h>
+#include <VulkanEngine/BoundingVolumeHierarchy.h>
+#include <VulkanEngine/Buffer.h>
+#include <VulkanEngine/Frustum.h>
 #include <VulkanEngine/GLFWWindow.h>
+#include <VulkanEngine/GPUCullingPass.h>
+#include <VulkanEngine/GraphicsPipeline.h>
+#include <VulkanEngine/InstancedMesh.h>
 #include <VulkanEngine/OBJMesh.h>
+#include <VulkanEngine/RenderQueue.h>
 #include <VulkanEngine/Scene.h>
+#include <VulkanEngine/ShaderImage.h>
+#include <VulkanEngine/StagedBuffer.h>
+#include <VulkanEngine/TextureFile.h>
+#include <VulkanEngine/TextureStreamer.h>
+#include <VulkanEngine/UniformBuffer.h>
 #include <VulkanEngine/VulkanManager.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 class EngineIntegrationTests : public ::testing::Test {
  protected:
@@ -78,6 +105,122 @@ TEST_F(EngineIntegrationTests, CreateOBJMeshBunny) {
               std::string::npos);
 }
 
+TEST_F(EngineIntegrationTests, CreateOBJMeshBunnySharesModel) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+  auto& asset_registry = vulkan_manager->getAssetRegistry();
+  const size_t num_assets = asset_registry.getNumAssets();
+  ASSERT_GT(num_assets, 0);
+
+  // The same file through a different path is not loaded again.
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh_2(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/../assets/bunny.obj"),
+      std::filesystem::path("")));
+  ASSERT_EQ(asset_registry.getNumAssets(), num_assets);
+
+  // Assets are released with the last OBJMesh using them.
+  obj_mesh.reset();
+  ASSERT_EQ(asset_registry.getNumAssets(), num_assets);
+  obj_mesh_2.reset();
+  ASSERT_EQ(asset_registry.getNumAssets(), 0);
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshBunnyAsynchronous) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path(""),
+      std::shared_ptr<VulkanEngine::Shader>(),
+      VulkanEngine::OBJMesh::LoadMode::eAsynchronous));
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+
+  scene->addChildren({obj_mesh, camera});
+
+  // Frames keep being rendered while the bunny loads, which only draws once
+  // it has been uploaded.
+  const auto timeout =
+      std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (!obj_mesh->isLoaded() && std::chrono::steady_clock::now() < timeout) {
+    scene->update();
+    vulkan_manager->drawImage();
+    EXPECT_EQ(scene->getRenderStatistics().draws,
+              obj_mesh->isLoaded() ? 1 : 0);
+  }
+  ASSERT_TRUE(obj_mesh->isLoaded());
+  EXPECT_EQ(obj_mesh->getLoadProgress(), 1.0f);
+  EXPECT_EQ(vulkan_manager->getTransferQueue().getNumPendingTransfers(), 0);
+
+  scene->update();
+  vulkan_manager->drawImage();
+  EXPECT_EQ(scene->getRenderStatistics().draws, 1);
+
+  // Waiting uploads textures right away.
+  std::shared_ptr<VulkanEngine::OBJMesh> capsule(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/capsule/capsule.obj"),
+      std::filesystem::path("./assets/capsule/"),
+      std::shared_ptr<VulkanEngine::Shader>(),
+      VulkanEngine::OBJMesh::LoadMode::eAsynchronous));
+  capsule->waitUntilLoaded();
+  EXPECT_TRUE(capsule->isLoaded());
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, AssetRegistryDeduplicatesLoads) {
+  VulkanEngine::AssetRegistry asset_registry;
+  const auto key = VulkanEngine::AssetRegistry::getKey("./assets/bunny.obj");
+  ASSERT_EQ(key, VulkanEngine::AssetRegistry::getKey(
+                     "./assets/../assets/bunny.obj"));
+
+  std::atomic<int> num_loads(0);
+  const std::function<std::shared_ptr<int>()> loader = [&num_loads]() {
+    ++num_loads;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return std::make_shared<int>(42);
+  };
+
+  // Concurrent requests for the same asset wait for a single load.
+  std::vector<std::shared_ptr<int>> assets(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < assets.size(); ++i) {
+    threads.emplace_back(
+        [&, i]() { assets[i] = asset_registry.load(key, loader); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(num_loads, 1);
+  for (const auto& asset : assets) {
+    ASSERT_EQ(asset, assets.front());
+  }
+  ASSERT_EQ(asset_registry.getNumAssets(), 1);
+  ASSERT_EQ(asset_registry.find<int>(key), assets.front());
+  ASSERT_EQ(asset_registry.find<float>(key), nullptr);
+
+  // Unused assets are evicted and loaded again when requested.
+  assets.clear();
+  ASSERT_EQ(asset_registry.getNumAssets(), 0);
+  ASSERT_EQ(asset_registry.find<int>(key), nullptr);
+  asset_registry.load(key, loader);
+  ASSERT_EQ(num_loads, 2);
+
+  // Failed loads are not cached.
+  const std::function<std::shared_ptr<int>()> failing_loader =
+      []() -> std::shared_ptr<int> {
+    throw std::runtime_error("Could not load asset");
+  };
+  ASSERT_THROW(asset_registry.load(std::string("missing"), failing_loader),
+               std::runtime_error);
+  ASSERT_EQ(asset_registry.getNumAssets(), 0);
+}
+
 TEST_F(EngineIntegrationTests, RenderOBJMeshBunny) {
   std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
       std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
@@ -98,6 +241,1573 @@ TEST_F(EngineIntegrationTests, RenderOBJMeshBunny) {
   vulkan_manager->drawImage();
 }
 
+TEST_F(EngineIntegrationTests, MemoryTelemetryNoGrowthAcrossSceneLoads) {
+  auto& memory_telemetry = vulkan_manager->getDevice()->getMemoryTelemetry();
+
+  // Loads the bunny into a new scene, renders a few frames and releases
+  // everything again.
+  const auto load_scene = [this]() {
+    std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+        std::filesystem::path("./assets/bunny.obj"),
+        std::filesystem::path("")));
+    std::shared_ptr<VulkanEngine::Scene> scene(
+        new VulkanEngine::Scene({window}));
+    auto camera = std::make_shared<VulkanEngine::Camera>(
+        Eigen::Vector3f(0.0f, 0.0f, 0.1f),  // look at
+        Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+        0.1f,                               // z-near
+        10.0f,                              // z-far
+        45.0f,                              // fov
+        window->getFramebufferWidth(), window->getFramebufferHeight());
+    scene->addChildren({obj_mesh, camera});
+
+    for (int i = 0; i < 3; ++i) {
+      scene->update();
+      vulkan_manager->drawImage();
+    }
+
+    const auto loaded = vulkan_manager->getDevice()
+                            ->getMemoryTelemetry()
+                            .getSnapshot();
+    const auto vertex = static_cast<size_t>(
+        VulkanEngine::MemoryTelemetry::Category::eVertex);
+    EXPECT_GT(loaded.categories[vertex].allocation_count, 0);
+    EXPECT_GT(loaded.categories[vertex].bytes, 0);
+
+    vulkan_manager->getDevice()->waitIdle();
+  };
+
+  load_scene();
+  const auto first = memory_telemetry.getSnapshot();
+  for (int i = 0; i < 3; ++i) {
+    load_scene();
+  }
+  const auto last = memory_telemetry.getSnapshot();
+
+  EXPECT_EQ(last.allocation_count, first.allocation_count);
+  EXPECT_EQ(last.bytes, first.bytes);
+  for (size_t i = 0; i < VulkanEngine::MemoryTelemetry::kNumCategories; ++i) {
+    EXPECT_EQ(last.categories[i].allocation_count,
+              first.categories[i].allocation_count);
+    EXPECT_EQ(last.categories[i].bytes, first.categories[i].bytes);
+  }
+  EXPECT_GE(last.peak_bytes, last.bytes);
+  EXPECT_FALSE(last.heaps.empty());
+
+  const std::string json = last.toJSON();
+  EXPECT_NE(json.find("\"categories\""), std::string::npos);
+  EXPECT_NE(json.find("\"heaps\""), std::string::npos);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, MemoryPoolsPlaceGeometryAndUniforms) {
+  using Pool = VulkanEngine::MemoryPools::Pool;
+  auto& memory_pools = vulkan_manager->getDevice()->getMemoryPools();
+  ASSERT_TRUE(memory_pools.isEnabled());
+
+  const auto geometry_bytes = memory_pools.getAllocatedBytes(Pool::eGeometry);
+  const auto host_visible_bytes =
+      memory_pools.getAllocatedBytes(Pool::eHostVisible);
+  const auto transient_bytes =
+      memory_pools.getAllocatedBytes(Pool::eTransient);
+  {
+    VulkanEngine::Buffer vertex_buffer(
+        1 << 16,
+        vk::BufferUsageFlagBits::eVertexBuffer |
+            vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eDeviceLocal, VMA_MEMORY_USAGE_GPU_ONLY);
+    VulkanEngine::UniformBuffer<Eigen::Matrix4f> uniform_buffer(0, 4);
+    const Eigen::Matrix4f matrices[4] = {
+        Eigen::Matrix4f::Identity(), Eigen::Matrix4f::Identity(),
+        Eigen::Matrix4f::Identity(), Eigen::Matrix4f::Identity()};
+    uniform_buffer.updateBuffer(matrices, sizeof(matrices));
+
+    EXPECT_GE(memory_pools.getAllocatedBytes(Pool::eGeometry),
+              geometry_bytes + (1 << 16));
+    EXPECT_GE(memory_pools.getAllocatedBytes(Pool::eHostVisible),
+              host_visible_bytes + sizeof(matrices));
+    EXPECT_EQ(memory_pools.getAllocatedBytes(Pool::eTransient),
+              transient_bytes);
+    EXPECT_EQ(memory_pools.getNumFallbacks(), 0);
+  }
+
+  // Freed memory is returned to the pools.
+  EXPECT_EQ(memory_pools.getAllocatedBytes(Pool::eGeometry), geometry_bytes);
+  EXPECT_EQ(memory_pools.getAllocatedBytes(Pool::eHostVisible),
+            host_visible_bytes);
+
+  // Transient buffers freed in order cycle through the linear pool, even
+  // when they add up to more than its size.
+  const auto& settings = vulkan_manager->getMemoryPoolSettings();
+  const size_t transient_size = settings.transient_max_allocation_size;
+  const size_t num_transient_buffers =
+      3 * settings.transient_pool_size / transient_size;
+  std::vector<std::unique_ptr<VulkanEngine::Buffer>> transient_buffers;
+  for (size_t i = 0; i < num_transient_buffers; ++i) {
+    transient_buffers.emplace_back(new VulkanEngine::Buffer(
+        transient_size, vk::BufferUsageFlagBits::eTransferSrc,
+        vk::MemoryPropertyFlagBits::eHostVisible |
+            vk::MemoryPropertyFlagBits::eHostCoherent,
+        VMA_MEMORY_USAGE_CPU_ONLY, true));
+    EXPECT_GE(memory_pools.getAllocatedBytes(Pool::eTransient),
+              transient_bytes + transient_size);
+    if (transient_buffers.size() > 4) {
+      transient_buffers.erase(transient_buffers.begin());
+    }
+  }
+  transient_buffers.clear();
+  EXPECT_EQ(memory_pools.getAllocatedBytes(Pool::eTransient),
+            transient_bytes);
+  EXPECT_EQ(memory_pools.getNumFallbacks(), 0);
+
+  // With the pools disabled nothing is allocated from them.
+  memory_pools.setEnabled(false);
+  {
+    VulkanEngine::Buffer vertex_buffer(
+        1 << 16, vk::BufferUsageFlagBits::eVertexBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal, VMA_MEMORY_USAGE_GPU_ONLY);
+    EXPECT_EQ(memory_pools.getAllocatedBytes(Pool::eGeometry),
+              geometry_bytes);
+  }
+  memory_pools.setEnabled(true);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, MemoryDefragmenterKeepsBufferContents) {
+  auto& defragmenter = vulkan_manager->getMemoryDefragmenter();
+  const size_t num_elements = 1 << 14;
+
+  // Free every other buffer to leave holes between the remaining ones.
+  std::vector<std::shared_ptr<VulkanEngine::VertexAttribute<float>>>
+      attributes;
+  for (size_t i = 0; i < 64; ++i) {
+    const std::vector<float> data(num_elements, static_cast<float>(i));
+    auto attribute = std::make_shared<VulkanEngine::VertexAttribute<float>>(
+        data.data(), num_elements, 0, vk::Format::eR32Sfloat);
+    attribute->transferBuffer();
+    attributes.push_back(attribute);
+  }
+  EXPECT_GE(defragmenter.getNumResources(), attributes.size());
+  for (size_t i = 0; i < attributes.size(); i += 2) {
+    attributes[i].reset();
+  }
+
+  for (size_t pass = 0; pass < 100 && defragmenter.runPass(); ++pass) {
+  }
+
+  for (size_t i = 1; i < attributes.size(); i += 2) {
+    const size_t size = num_elements * sizeof(float);
+    VulkanEngine::Buffer readback(
+        size, vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eHostVisible |
+            vk::MemoryPropertyFlagBits::eHostCoherent,
+        VMA_MEMORY_USAGE_GPU_TO_CPU);
+    VulkanEngine::SingleUsageCommandBuffer command_buffer;
+    command_buffer.beginSingleUsageCommandBuffer();
+    command_buffer.single_use_command_buffer.copyBuffer(
+        attributes[i]->getVkBuffer(), readback.getVkBuffer(),
+        vk::BufferCopy().setSize(size));
+    command_buffer.endSingleUsageCommandBuffer();
+
+    const auto* data = static_cast<const float*>(readback.mapMemory());
+    EXPECT_EQ(data[0], static_cast<float>(i));
+    EXPECT_EQ(data[num_elements - 1], static_cast<float>(i));
+    readback.unmapMemory();
+  }
+
+  // Rendering with passes every frame rewrites the descriptor sets of moved
+  // textures. The capsule's texture is allocated behind the remaining
+  // buffers, which are freed before rendering.
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/capsule/capsule.obj"),
+      std::filesystem::path("./assets/capsule/")));
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f), Eigen::Vector3f(0.0f, 1.0f, 0.0f),
+      0.1f, 10.0f, 45.0f, window->getFramebufferWidth(),
+      window->getFramebufferHeight());
+  scene->addChildren({obj_mesh, camera});
+
+  attributes.clear();
+  const size_t num_moved_allocations = defragmenter.getNumMovedAllocations();
+  defragmenter.setEnabled(true);
+  defragmenter.setPassInterval(1);
+  for (size_t i = 0; i < vulkan_manager->getFramesInFlight() * 2; ++i) {
+    scene->update();
+    vulkan_manager->drawImage();
+  }
+  defragmenter.setEnabled(false);
+  EXPECT_GT(defragmenter.getNumMovedAllocations(), num_moved_allocations);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, DeletionQueueWaitsForFramesInFlight) {
+  auto& deletion_queue = vulkan_manager->getDeletionQueue();
+  auto& memory_telemetry = vulkan_manager->getDevice()->getMemoryTelemetry();
+
+  // Nothing has been recorded yet, so buffers are destroyed immediately.
+  const auto initial_bytes = memory_telemetry.getSnapshot().bytes;
+  {
+    VulkanEngine::Buffer buffer(1 << 16, vk::BufferUsageFlagBits::eVertexBuffer,
+                                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                VMA_MEMORY_USAGE_GPU_ONLY);
+  }
+  EXPECT_EQ(deletion_queue.getNumPending(), 0);
+  EXPECT_EQ(memory_telemetry.getSnapshot().bytes, initial_bytes);
+
+  const auto create_camera = [this]() {
+    return std::make_shared<VulkanEngine::Camera>(
+        Eigen::Vector3f(0.0f, 0.0f, 0.1f), Eigen::Vector3f(0.0f, 1.0f, 0.0f),
+        0.1f, 10.0f, 45.0f, window->getFramebufferWidth(),
+        window->getFramebufferHeight());
+  };
+
+  std::shared_ptr<VulkanEngine::Scene> empty_scene(
+      new VulkanEngine::Scene({window}));
+  empty_scene->addChildren({create_camera()});
+  for (size_t i = 0; i < vulkan_manager->getFramesInFlight(); ++i) {
+    empty_scene->update();
+    vulkan_manager->drawImage();
+  }
+  const auto empty_bytes = memory_telemetry.getSnapshot().bytes;
+
+  // Release a rendered mesh while its frames may still be in flight.
+  {
+    std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+        std::filesystem::path("./assets/bunny.obj"),
+        std::filesystem::path("")));
+    std::shared_ptr<VulkanEngine::Scene> scene(
+        new VulkanEngine::Scene({window}));
+    scene->addChildren({obj_mesh, create_camera()});
+    for (size_t i = 0; i < vulkan_manager->getFramesInFlight(); ++i) {
+      scene->update();
+      vulkan_manager->drawImage();
+    }
+  }
+  EXPECT_GT(deletion_queue.getNumPending(), 0);
+  EXPECT_GT(memory_telemetry.getSnapshot().bytes, empty_bytes);
+
+  // The mesh is destroyed once the frames which drew it have completed.
+  for (size_t i = 0; i < vulkan_manager->getFramesInFlight(); ++i) {
+    empty_scene->update();
+    vulkan_manager->drawImage();
+  }
+  EXPECT_EQ(deletion_queue.getNumPending(), 0);
+  EXPECT_EQ(memory_telemetry.getSnapshot().bytes, empty_bytes);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, ProfilerMeasuresCPUAndGPUScopes) {
+  auto& profiler = vulkan_manager->getProfiler();
+  profiler.setEnabled(true);
+
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f), Eigen::Vector3f(0.0f, 1.0f, 0.0f),
+      0.1f, 10.0f, 45.0f, window->getFramebufferWidth(),
+      window->getFramebufferHeight());
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+  scene->addChildren({obj_mesh, camera});
+
+  const size_t num_frames = vulkan_manager->getFramesInFlight() + 2;
+  for (size_t i = 0; i < num_frames; ++i) {
+    scene->update();
+    vulkan_manager->drawImage();
+  }
+
+  // Frames still in flight are read back once the device is idle.
+  vulkan_manager->getDevice()->waitIdle();
+  profiler.flush();
+  const auto& frames = profiler.getFrames();
+  ASSERT_EQ(frames.size(), num_frames);
+
+  const bool has_timestamps =
+      vulkan_manager->getDevice()->getTimestampPeriod() > 0.0f;
+  for (size_t i = 0; i < frames.size(); ++i) {
+    const auto& frame = frames[i];
+    EXPECT_EQ(frame.index, i);
+    EXPECT_GT(frame.getScopeTimeMs("Scene::update"), 0.0);
+    EXPECT_GT(frame.getScopeTimeMs("Swapchain::present"), 0.0);
+    EXPECT_LE(frame.getScopeTimeMs("Scene::update"), frame.getCPUTimeMs());
+    if (has_timestamps) {
+      EXPECT_FALSE(frame.gpu_events.empty());
+      EXPECT_GE(frame.getGPUTimeMs(), frame.getScopeTimeMs("RenderPass"));
+    }
+  }
+
+  const auto trace_path =
+      std::filesystem::temp_directory_path() / "VulkanEngineProfile.json";
+  ASSERT_TRUE(profiler.writeChromeTrace(trace_path));
+  std::ifstream trace_file(trace_path);
+  const std::string trace((std::istreambuf_iterator<char>(trace_file)),
+                          std::istreambuf_iterator<char>());
+  EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(trace.find("\"Scene::update\""), std::string::npos);
+  trace_file.close();
+  std::filesystem::remove(trace_path);
+
+  // Nothing is measured once disabled.
+  profiler.setEnabled(false);
+  scene->update();
+  vulkan_manager->drawImage();
+  EXPECT_EQ(profiler.getFrames().size(), num_frames);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, ProfilerGathersPipelineStatistics) {
+  using Level = VulkanEngine::Profiler::PipelineStatisticsLevel;
+  auto& profiler = vulkan_manager->getProfiler();
+  profiler.setEnabled(true);
+
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f), Eigen::Vector3f(0.0f, 1.0f, 0.0f),
+      0.1f, 10.0f, 45.0f, window->getFramebufferWidth(),
+      window->getFramebufferHeight());
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+  scene->addChildren({obj_mesh, camera});
+
+  const bool supported = vulkan_manager->getDevice()
+                             ->getEnabledFeatures()
+                             .pipelineStatisticsQuery;
+  for (const auto level : {Level::eRenderPass, Level::eDrawGroup}) {
+    profiler.setPipelineStatisticsLevel(level);
+    const char* scope_name =
+        level == Level::eRenderPass ? "RenderPass" : "Draw group";
+
+    const size_t num_frames = vulkan_manager->getFramesInFlight();
+    for (size_t i = 0; i < num_frames; ++i) {
+      scene->update();
+      vulkan_manager->drawImage();
+    }
+    vulkan_manager->getDevice()->waitIdle();
+    profiler.flush();
+
+    const auto& frame = profiler.getFrames().back();
+    const auto statistics = frame.getPipelineStatistics(scope_name);
+    if (!supported) {
+      EXPECT_TRUE(frame.pipeline_statistics.empty());
+      continue;
+    }
+    ASSERT_FALSE(frame.pipeline_statistics.empty());
+    EXPECT_GT(statistics.input_assembly_vertices, 0u);
+    EXPECT_GT(statistics.input_assembly_primitives, 0u);
+    EXPECT_GT(statistics.vertex_shader_invocations, 0u);
+    EXPECT_GT(statistics.clipping_invocations, 0u);
+    EXPECT_GT(statistics.fragment_shader_invocations, 0u);
+
+    // Only one level is gathered at a time.
+    for (const auto& scope : frame.pipeline_statistics) {
+      EXPECT_STREQ(scope.name, scope_name);
+    }
+  }
+
+  profiler.setPipelineStatisticsLevel(Level::eDisabled);
+  profiler.setEnabled(false);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, FrameStatisticsCountDrawsAndUploads) {
+  using Counter = VulkanEngine::FrameStatistics::Counter;
+  auto& frame_statistics = vulkan_manager->getFrameStatistics();
+  frame_statistics.clear();
+
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f), Eigen::Vector3f(0.0f, 1.0f, 0.0f),
+      0.1f, 10.0f, 45.0f, window->getFramebufferWidth(),
+      window->getFramebufferHeight());
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+  scene->addChildren({obj_mesh, camera});
+
+  const size_t num_frames = 4;
+  for (size_t i = 0; i < num_frames; ++i) {
+    scene->update();
+    vulkan_manager->drawImage();
+  }
+
+  const auto& frames = frame_statistics.getFrames();
+  ASSERT_EQ(frames.size(), num_frames);
+  EXPECT_EQ(frame_statistics.getLastFrame().index, frames.back().index);
+
+  uint64_t bytes_uploaded = 0;
+  for (const auto& frame : frames) {
+    bytes_uploaded += frame.get(Counter::eBytesUploaded);
+  }
+
+#ifdef ENABLE_FRAME_STATISTICS
+  const auto& last_frame = frame_statistics.getLastFrame();
+  EXPECT_GE(last_frame.get(Counter::eDrawCalls), 1u);
+  EXPECT_GE(last_frame.get(Counter::ePipelineBinds), 1u);
+  EXPECT_GE(last_frame.get(Counter::eDescriptorSetBinds), 1u);
+  EXPECT_GT(last_frame.get(Counter::eTriangles), 0u);
+  EXPECT_GE(last_frame.get(Counter::eUniformUpdates), 1u);
+  EXPECT_GT(bytes_uploaded, 0u);
+  EXPECT_GT(frame_statistics.getAverage(Counter::eTriangles), 0.0);
+#else
+  // Counting is compiled out.
+  EXPECT_EQ(bytes_uploaded, 0u);
+  EXPECT_EQ(frame_statistics.getAverage(Counter::eDrawCalls), 0.0);
+#endif
+
+  frame_statistics.setWindowSize(2);
+  EXPECT_EQ(frames.size(), 2u);
+  frame_statistics.setWindowSize(60);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshBunnyMultipleFrames) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+
+  scene->addChildren({obj_mesh, camera});
+
+  // Render enough frames for every per-frame command pool to be reset and
+  // reused several times.
+  const size_t frame_count = vulkan_manager->getFramesInFlight() * 3 + 1;
+  for (size_t i = 0; i < frame_count; ++i) {
+    scene->update();
+    vulkan_manager->drawImage();
+  }
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshBunnyMultithreadedRecording) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+  scene->setRecordingThreadCount(4);
+  ASSERT_EQ(scene->getRecordingThreadCount(), 4);
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+
+  scene->addChildren({obj_mesh, camera});
+
+  const size_t frame_count = vulkan_manager->getFramesInFlight() * 2 + 1;
+  for (size_t i = 0; i < frame_count; ++i) {
+    scene->update();
+    vulkan_manager->drawImage();
+  }
+
+  // The command pools of the frames in flight are destroyed once the frames
+  // have completed, both when changing the thread count and with the scene.
+  auto& deletion_queue = vulkan_manager->getDeletionQueue();
+  const size_t num_pending = deletion_queue.getNumPending();
+  scene->setRecordingThreadCount(2);
+  EXPECT_EQ(deletion_queue.getNumPending(), num_pending + 1);
+  scene->update();
+  vulkan_manager->drawImage();
+  scene.reset();
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshBunnyIndirectDrawing) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+
+  scene->addChildren({obj_mesh, camera});
+
+  // Alternate between indirect and direct drawing so both paths reuse the
+  // buffers of every frame in flight.
+  const size_t frame_count = vulkan_manager->getFramesInFlight() * 2 + 1;
+  for (size_t i = 0; i < frame_count; ++i) {
+    scene->setIndirectDrawingEnabled(i % 2 == 0);
+    scene->update();
+    vulkan_manager->drawImage();
+
+    const auto& statistics = scene->getRenderStatistics();
+    ASSERT_EQ(statistics.draws, 1);
+    ASSERT_EQ(statistics.draw_calls, 1);
+  }
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshBunnyGPUCulling) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+  scene->setGPUCullingEnabled(true);
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+
+  scene->addChildren({obj_mesh, camera});
+
+  const size_t frame_count = vulkan_manager->getFramesInFlight() * 2 + 1;
+  for (size_t i = 0; i < frame_count; ++i) {
+    scene->update();
+    vulkan_manager->drawImage();
+
+    if (scene->isGPUCullingEnabled()) {
+      ASSERT_EQ(scene->getGPUCullingPass()->getNumTestedDraws(), 1);
+    }
+  }
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, GPUCullingPassFrustumPlanes) {
+  VulkanEngine::Camera camera(Eigen::Vector3f(0.0f, 0.0f, -1.0f),
+                              Eigen::Vector3f(0.0f, 1.0f, 0.0f), 0.1f, 10.0f,
+                              45.0f, 1280, 800);
+  const auto planes = VulkanEngine::GPUCullingPass::extractFrustumPlanes(
+      camera.getPerspectiveProjectionMatrix() * camera.getViewMatrix());
+
+  auto is_inside = [&planes](const Eigen::Vector3f& point) {
+    for (const auto& plane : planes) {
+      if (plane.head<3>().dot(point) + plane.w() < 0.0f) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(is_inside(Eigen::Vector3f(0.0f, 0.0f, -1.0f)));
+  EXPECT_FALSE(is_inside(Eigen::Vector3f(0.0f, 0.0f, 1.0f)));
+  EXPECT_FALSE(is_inside(Eigen::Vector3f(0.0f, 0.0f, -20.0f)));
+  EXPECT_FALSE(is_inside(Eigen::Vector3f(10.0f, 0.0f, -1.0f)));
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshBunnyFrustumCulling) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+  scene->setFrustumCullingEnabled(true);
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.0f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+  camera->setTransform(
+      Eigen::Affine3f(Eigen::Translation3f(0.0f, 0.0f, -1.0f)).matrix());
+
+  // Two more instances of the bunny behind the camera.
+  auto behind_camera = std::make_shared<VulkanEngine::SceneObject>();
+  behind_camera->setTransform(
+      Eigen::Affine3f(Eigen::Translation3f(0.0f, 0.0f, -5.0f)).matrix());
+  auto offset = std::make_shared<VulkanEngine::SceneObject>();
+  offset->setTransform(
+      Eigen::Affine3f(Eigen::Translation3f(0.3f, 0.0f, 0.0f)).matrix());
+  offset->addChildren({obj_mesh});
+  behind_camera->addChildren({obj_mesh, offset});
+
+  scene->addChildren({camera, obj_mesh, behind_camera});
+
+  for (size_t i = 0; i < vulkan_manager->getFramesInFlight() + 1; ++i) {
+    scene->update();
+    vulkan_manager->drawImage();
+    ASSERT_EQ(scene->getRenderStatistics().draws, 1);
+  }
+
+  // Turn around to face the other instances. They must be drawn in the very
+  // frame the camera moves, although the camera is traversed after their
+  // subtree is culled, and the first instance is now behind the camera.
+  camera->setLookAt(Eigen::Vector3f(0.0f, 0.0f, -5.0f));
+  scene->update();
+  vulkan_manager->drawImage();
+  ASSERT_EQ(scene->getRenderStatistics().draws, 2);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, FrustumBatchMatchesSingleBoxTest) {
+  VulkanEngine::Camera camera(Eigen::Vector3f(0.0f, 0.0f, -1.0f),
+                              Eigen::Vector3f(0.0f, 1.0f, 0.0f), 0.1f, 50.0f,
+                              45.0f, 1280, 800);
+  const VulkanEngine::Frustum frustum(camera.getPerspectiveProjectionMatrix() *
+                                      camera.getViewMatrix());
+
+  std::mt19937 random_engine(42);
+  std::uniform_real_distribution<float> position_distribution(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> size_distribution(0.0f, 5.0f);
+
+  // Not a multiple of 8 so the scalar tail of the AVX2 path is covered.
+  std::vector<BoundingBox<Eigen::Vector3f>> bounding_boxes(1001);
+  VulkanEngine::BoundingBoxArray bounding_box_array;
+  for (auto& bounding_box : bounding_boxes) {
+    bounding_box.min = {position_distribution(random_engine),
+                        position_distribution(random_engine),
+                        position_distribution(random_engine)};
+    bounding_box.max =
+        bounding_box.min + Eigen::Vector3f(size_distribution(random_engine),
+                                           size_distribution(random_engine),
+                                           size_distribution(random_engine));
+    bounding_box_array.push_back(bounding_box);
+  }
+
+  std::vector<uint8_t> visibility;
+  frustum.intersects(bounding_box_array, visibility);
+  ASSERT_EQ(visibility.size(), bounding_boxes.size());
+
+  size_t visible_count = 0;
+  for (size_t i = 0; i < bounding_boxes.size(); ++i) {
+    EXPECT_EQ(visibility[i] != 0, frustum.intersects(bounding_boxes[i]));
+    visible_count += visibility[i];
+  }
+  EXPECT_GT(visible_count, 0);
+  EXPECT_LT(visible_count, bounding_boxes.size());
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshBunnyFieldHierarchyCulling) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+  scene->setFrustumCullingEnabled(true);
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.0f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+  camera->setTransform(
+      Eigen::Affine3f(Eigen::Translation3f(0.0f, 0.0f, -1.0f)).matrix());
+  scene->addChildren({camera});
+
+  // Enough instances for the scene to cull them through a hierarchy, half of
+  // them in front of the camera and half behind it.
+  std::vector<std::shared_ptr<VulkanEngine::SceneObject>> instances;
+  for (size_t i = 0; i < 100; ++i) {
+    const float x = static_cast<float>(i % 10) * 0.1f - 0.45f;
+    const float z = 2.0f + static_cast<float>((i / 10) % 5) * 0.5f;
+    auto instance = std::make_shared<VulkanEngine::SceneObject>();
+    instance->setTransform(
+        Eigen::Affine3f(Eigen::Translation3f(x, 0.0f, i < 50 ? z : -z - 2.0f))
+            .matrix());
+    instance->addChildren({obj_mesh});
+    instances.push_back(instance);
+  }
+  scene->addChildren(instances);
+
+  for (size_t i = 0; i < vulkan_manager->getFramesInFlight() + 1; ++i) {
+    scene->update();
+    vulkan_manager->drawImage();
+    ASSERT_EQ(scene->getRenderStatistics().draws, 50);
+  }
+
+  // Moving instances refits the hierarchy.
+  for (size_t i = 0; i < 10; ++i) {
+    instances[i]->setTransform(
+        Eigen::Affine3f(Eigen::Translation3f(0.0f, 0.0f, -4.0f)).matrix());
+  }
+  scene->update();
+  vulkan_manager->drawImage();
+  ASSERT_EQ(scene->getRenderStatistics().draws, 40);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshBunnyPick) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.0f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+  camera->setTransform(
+      Eigen::Affine3f(Eigen::Translation3f(0.0f, 0.0f, -1.0f)).matrix());
+  scene->addChildren({camera, obj_mesh});
+
+  // Nothing can be picked before a frame has been drawn.
+  ASSERT_EQ(scene->pick(Eigen::Vector2d(0.0, 0.0)), nullptr);
+
+  scene->update();
+  vulkan_manager->drawImage();
+
+  // Project the center of the bunny's bounds into window coordinates.
+  BoundingBox<Eigen::Vector3f> bounding_box;
+  ASSERT_TRUE(obj_mesh->getLocalBoundingBox(bounding_box));
+  const Eigen::Vector3f center = (bounding_box.min + bounding_box.max) * 0.5f;
+  const Eigen::Vector4f clip = camera->getPerspectiveProjectionMatrix() *
+                               camera->getViewMatrix() *
+                               center.homogeneous();
+  const Eigen::Vector2d window_position(
+      (clip.x() / clip.w() + 1.0) * 0.5 * window->getWidth(),
+      (clip.y() / clip.w() + 1.0) * 0.5 * window->getHeight());
+
+  ASSERT_EQ(scene->pick(window_position), obj_mesh);
+  ASSERT_EQ(scene->pick(Eigen::Vector2d(0.0, 0.0)), nullptr);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, RenderInstancedOBJMeshBunny) {
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
+      std::filesystem::path("./assets/bunny.obj"), std::filesystem::path("")));
+  auto instanced_mesh = std::make_shared<VulkanEngine::InstancedMesh>(obj_mesh);
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.0f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+  camera->setTransform(
+      Eigen::Affine3f(Eigen::Translation3f(0.0f, 0.0f, -1.0f)).matrix());
+  scene->addChildren({camera, instanced_mesh});
+
+  for (size_t i = 0; i < 100; ++i) {
+    const float x = static_cast<float>(i % 10) * 0.1f - 0.45f;
+    const float z = 2.0f + static_cast<float>(i / 10) * 0.5f;
+    instanced_mesh->addInstance(
+        Eigen::Affine3f(Eigen::Translation3f(x, 0.0f, z)).matrix());
+  }
+  ASSERT_EQ(instanced_mesh->getNumInstances(), 100);
+
+  // Every instance is drawn by a single draw per shape, including frames in
+  // which the instance buffer of the frame has to grow.
+  for (size_t i = 0; i < vulkan_manager->getFramesInFlight() * 2 + 1; ++i) {
+    if (i == vulkan_manager->getFramesInFlight()) {
+      instanced_mesh->addInstance(
+          Eigen::Affine3f(Eigen::Translation3f(0.0f, 0.5f, 3.0f)).matrix());
+      instanced_mesh->setInstanceTransform(
+          0, Eigen::Affine3f(Eigen::Translation3f(0.0f, -0.5f, 3.0f)).matrix());
+    }
+    scene->update();
+    vulkan_manager->drawImage();
+    ASSERT_EQ(scene->getRenderStatistics().draws, 1);
+  }
+  ASSERT_TRUE(instanced_mesh->getInstanceTransform(0).isApprox(
+      Eigen::Affine3f(Eigen::Translation3f(0.0f, -0.5f, 3.0f)).matrix()));
+
+  instanced_mesh->clearInstances();
+  scene->update();
+  vulkan_manager->drawImage();
+  ASSERT_EQ(scene->getRenderStatistics().draws, 0);
+
+  // Every instance of every shape is drawn. Each shape has its own material,
+  // which more instances than shapes would read past if the material index
+  // depended on the instance.
+  const auto directory =
+      std::filesystem::temp_directory_path() / "VulkanEngineInstancingTest";
+  std::filesystem::create_directories(directory);
+  std::ofstream(directory / "quads.mtl") << "newmtl red\nKd 1 0 0\n"
+                                         << "newmtl green\nKd 0 1 0\n";
+  std::ofstream(directory / "quads.obj")
+      << "mtllib quads.mtl\n"
+      << "v -0.2 -0.2 0\nv 0 -0.2 0\nv 0 0.2 0\nv -0.2 0.2 0\n"
+      << "v 0 -0.2 0\nv 0.2 -0.2 0\nv 0.2 0.2 0\nv 0 0.2 0\n"
+      << "g red\nusemtl red\nf 1 2 3 4\n"
+      << "g green\nusemtl green\nf 5 6 7 8\n";
+
+  std::shared_ptr<VulkanEngine::OBJMesh> quads(
+      new VulkanEngine::OBJMesh(directory / "quads.obj"));
+  auto instanced_quads = std::make_shared<VulkanEngine::InstancedMesh>(quads);
+  for (size_t i = 0; i < 3; ++i) {
+    const float x = static_cast<float>(i) * 0.5f - 0.5f;
+    instanced_quads->addInstance(
+        Eigen::Affine3f(Eigen::Translation3f(x, 0.0f, 3.0f)).matrix());
+  }
+  scene->addChildren({instanced_quads});
+
+  using Level = VulkanEngine::Profiler::PipelineStatisticsLevel;
+  auto& profiler = vulkan_manager->getProfiler();
+  profiler.setEnabled(true);
+  profiler.setPipelineStatisticsLevel(Level::eRenderPass);
+  for (size_t i = 0; i < vulkan_manager->getFramesInFlight(); ++i) {
+    scene->update();
+    vulkan_manager->drawImage();
+    ASSERT_EQ(scene->getRenderStatistics().draws, 2);
+  }
+  vulkan_manager->getDevice()->waitIdle();
+  profiler.flush();
+
+  // Two shapes of two triangles, three instances each.
+  const bool supported = vulkan_manager->getDevice()
+                             ->getEnabledFeatures()
+                             .pipelineStatisticsQuery;
+  if (supported) {
+    const auto statistics =
+        profiler.getFrames().back().getPipelineStatistics("RenderPass");
+    EXPECT_EQ(statistics.input_assembly_primitives, 12u);
+    EXPECT_GT(statistics.fragment_shader_invocations, 0u);
+  }
+  profiler.setPipelineStatisticsLevel(Level::eDisabled);
+  profiler.setEnabled(false);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, BoundingVolumeHierarchyMatchesBruteForceTest) {
+  VulkanEngine::Camera camera(Eigen::Vector3f(0.0f, 0.0f, -1.0f),
+                              Eigen::Vector3f(0.0f, 1.0f, 0.0f), 0.1f, 50.0f,
+                              45.0f, 1280, 800);
+  const VulkanEngine::Frustum frustum(camera.getPerspectiveProjectionMatrix() *
+                                      camera.getViewMatrix());
+
+  std::mt19937 random_engine(42);
+  std::uniform_real_distribution<float> position_distribution(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> size_distribution(0.0f, 5.0f);
+
+  VulkanEngine::BoundingBoxArray bounding_boxes;
+  for (size_t i = 0; i < 10000; ++i) {
+    BoundingBox<Eigen::Vector3f> bounding_box;
+    bounding_box.min = {position_distribution(random_engine),
+                        position_distribution(random_engine),
+                        position_distribution(random_engine)};
+    bounding_box.max =
+        bounding_box.min + Eigen::Vector3f(size_distribution(random_engine),
+                                           size_distribution(random_engine),
+                                           size_distribution(random_engine));
+    bounding_boxes.push_back(bounding_box);
+  }
+
+  VulkanEngine::BoundingVolumeHierarchy hierarchy;
+  hierarchy.build(bounding_boxes);
+  ASSERT_EQ(hierarchy.size(), bounding_boxes.size());
+
+  const auto check = [&]() {
+    std::vector<uint32_t> primitives;
+    hierarchy.intersectFrustum(frustum, primitives);
+    std::vector<uint8_t> found(bounding_boxes.size(), 0);
+    for (const auto primitive : primitives) {
+      found[primitive] = 1;
+    }
+    std::vector<uint8_t> visibility;
+    frustum.intersects(bounding_boxes, visibility);
+    EXPECT_EQ(found, visibility);
+
+    const Eigen::Vector3f origin(0.0f, 0.0f, -1.0f);
+    const Eigen::Vector3f direction(0.05f, 0.02f, 1.0f);
+    std::vector<VulkanEngine::BoundingVolumeHierarchy::RayHit> hits;
+    hierarchy.intersectRay(origin, direction, 100.0f, hits);
+    size_t hit_count = 0;
+    float distance;
+    for (size_t i = 0; i < bounding_boxes.size(); ++i) {
+      hit_count += VulkanEngine::BoundingVolumeHierarchy::intersectRay(
+          bounding_boxes.get(i), origin, direction.cwiseInverse(), 100.0f,
+          distance);
+    }
+    EXPECT_EQ(hits.size(), hit_count);
+    for (size_t i = 1; i < hits.size(); ++i) {
+      EXPECT_LE(hits[i - 1].distance, hits[i].distance);
+    }
+  };
+  check();
+
+  // Move some of the boxes one at a time, then all of them at once.
+  for (size_t i = 0; i < bounding_boxes.size(); i += 7) {
+    auto bounding_box = bounding_boxes.get(i);
+    bounding_box.min.z() -= 20.0f;
+    bounding_box.max.z() -= 20.0f;
+    bounding_boxes.set(i, bounding_box);
+    hierarchy.setBoundingBox(i, bounding_box);
+  }
+  check();
+
+  for (size_t i = 0; i < bounding_boxes.size(); ++i) {
+    bounding_boxes.min_x[i] += 10.0f;
+    bounding_boxes.max_x[i] += 10.0f;
+  }
+  hierarchy.refit(bounding_boxes);
+  check();
+}
+
+TEST_F(EngineIntegrationTests, RenderQueueSortsByStateThenDepth) {
+  VulkanEngine::GraphicsPipeline pipeline_a;
+  VulkanEngine::GraphicsPipeline pipeline_b;
+  const std::vector<std::shared_ptr<VulkanEngine::ShaderModule>> no_modules;
+  VulkanEngine::Shader shader_a(no_modules);
+  VulkanEngine::Shader shader_b(no_modules);
+
+  VulkanEngine::RenderQueue render_queue;
+  render_queue.submit({&pipeline_b, &shader_a, nullptr, 0, 1.0f});
+  render_queue.submit({&pipeline_a, &shader_b, nullptr, 0, 3.0f});
+  render_queue.submit({&pipeline_a, &shader_a, nullptr, 0, 5.0f});
+  render_queue.submit({&pipeline_a, &shader_b, nullptr, 0, 2.0f});
+  render_queue.submit({&pipeline_a, &shader_a, nullptr, 0, -1.0f});
+  render_queue.sort();
+
+  const auto& draw_packets = render_queue.getDrawPackets();
+  ASSERT_EQ(draw_packets.size(), 5);
+  EXPECT_EQ(draw_packets[0].graphics_pipeline, &pipeline_a);
+  EXPECT_EQ(draw_packets[0].shader, &shader_a);
+  EXPECT_EQ(draw_packets[0].depth, -1.0f);
+  EXPECT_EQ(draw_packets[1].shader, &shader_a);
+  EXPECT_EQ(draw_packets[1].depth, 5.0f);
+  EXPECT_EQ(draw_packets[2].shader, &shader_b);
+  EXPECT_EQ(draw_packets[2].depth, 2.0f);
+  EXPECT_EQ(draw_packets[3].shader, &shader_b);
+  EXPECT_EQ(draw_packets[3].depth, 3.0f);
+  EXPECT_EQ(draw_packets[4].graphics_pipeline, &pipeline_b);
+
+  // The ids are kept whole, so ids beyond 16 bits don't collide.
+  const uint64_t sort_key = draw_packets[4].sort_key;
+  EXPECT_EQ(sort_key >> 32, pipeline_b.getId());
+  EXPECT_EQ(sort_key & 0xFFFFFFFF, shader_a.getId());
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+namespace {
+
+/// The root of a tree whose transform hierarchy is built the way Scene
+/// builds it, without traversing the tree.
+class TransformHierarchyRoot : public VulkanEngine::SceneObject {
+ public:
+  ~TransformHierarchyRoot() override { release(); }
+
+  /// Build the transform hierarchy of the tree.
+  void build() {
+    release();
+    buildTransformHierarchy(hierarchy, objects);
+  }
+
+  /// Unregister the objects of the tree from the hierarchy.
+  void release() {
+    releaseTransformHierarchy(hierarchy, objects);
+    objects.clear();
+  }
+
+  /// \return The world transform of the first node of an object.
+  /// \param object An object of the tree.
+  Eigen::Matrix4f getWorldTransform(const VulkanEngine::SceneObject* object) {
+    hierarchy.update();
+    const auto it = std::find(objects.begin(), objects.end(), object);
+    return hierarchy.getWorldTransform(
+        static_cast<uint32_t>(it - objects.begin() + 1));
+  }
+
+ private:
+  VulkanEngine::TransformHierarchy hierarchy;
+  std::vector<VulkanEngine::SceneObject*> objects;
+};
+
+/// \return A rotation about the y axis followed by a translation.
+Eigen::Matrix4f createTransform(float angle, const Eigen::Vector3f& offset) {
+  return (Eigen::Translation3f(offset) *
+          Eigen::AngleAxisf(angle, Eigen::Vector3f::UnitY()))
+      .matrix();
+}
+
+}  // namespace
+
+TEST_F(EngineIntegrationTests, TransformHierarchyMatchesRecursiveTransforms) {
+  auto parent = std::make_shared<VulkanEngine::SceneObject>();
+  auto other_parent = std::make_shared<VulkanEngine::SceneObject>();
+  auto leaf = std::make_shared<VulkanEngine::SceneObject>();
+  auto child = std::make_shared<VulkanEngine::SceneObject>();
+  auto grandchild = std::make_shared<VulkanEngine::SceneObject>();
+  parent->setTransform(createTransform(0.3f, {1.0f, 2.0f, 3.0f}));
+  other_parent->setTransform(createTransform(0.5f, {-4.0f, 0.0f, 1.0f}));
+  child->setTransform(createTransform(-0.7f, {0.0f, 1.0f, 0.0f}));
+  grandchild->setTransform(createTransform(1.1f, {0.0f, 0.0f, -2.0f}));
+  child->addChildren({grandchild});
+  parent->addChildren({child});
+  other_parent->addChildren({child});
+
+  // The child is part of two trees, with a different node in each.
+  auto root_a = std::make_shared<TransformHierarchyRoot>();
+  root_a->addChildren({parent});
+  auto root_b = std::make_shared<TransformHierarchyRoot>();
+  root_b->addChildren({leaf, other_parent});
+  root_a->build();
+  root_b->build();
+
+  // Compare to multiplying the transforms down each path.
+  const auto expect_world_transforms = [&](bool check_a) {
+    if (check_a) {
+      EXPECT_TRUE(
+          root_a->getWorldTransform(child.get())
+              .isApprox(parent->getTransform() * child->getTransform()));
+      EXPECT_TRUE(root_a->getWorldTransform(grandchild.get())
+                      .isApprox(parent->getTransform() * child->getTransform() *
+                                grandchild->getTransform()));
+    }
+    EXPECT_TRUE(
+        root_b->getWorldTransform(child.get())
+            .isApprox(other_parent->getTransform() * child->getTransform()));
+    EXPECT_TRUE(root_b->getWorldTransform(grandchild.get())
+                    .isApprox(other_parent->getTransform() *
+                              child->getTransform() *
+                              grandchild->getTransform()));
+  };
+  expect_world_transforms(true);
+
+  child->setTransform(createTransform(2.0f, {3.0f, 0.0f, 0.0f}));
+  grandchild->setTransform(createTransform(-1.5f, {0.0f, -1.0f, 0.5f}));
+  expect_world_transforms(true);
+
+  // Releasing one hierarchy leaves the objects registered with the other.
+  root_a->release();
+  child->setTransform(createTransform(0.9f, {0.0f, 0.0f, 4.0f}));
+  expect_world_transforms(false);
+}
+
+namespace {
+
+/// Append a little endian value to a file built in memory.
+template <typename T>
+void append(std::vector<uint8_t>& file, T value) {
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    file.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+/// Append the levels of an 8x8 BC1 texture with 3 levels. Every byte of
+/// level i is i + 1.
+/// \param smallest_first Append the smallest level first, as in KTX2 files.
+void appendBC1Levels(std::vector<uint8_t>& file, bool smallest_first) {
+  const std::vector<size_t> level_sizes = {32, 8, 8};
+  for (size_t i = 0; i < level_sizes.size(); ++i) {
+    const size_t level = smallest_first ? level_sizes.size() - 1 - i : i;
+    file.insert(file.end(), level_sizes[level],
+                static_cast<uint8_t>(level + 1));
+  }
+}
+
+/// \return A KTX2 file holding an 8x8 BC1 texture with 3 levels.
+std::vector<uint8_t> createBC1KTX2() {
+  std::vector<uint8_t> file = {0xAB, 'K',  'T',  'X', ' ',  '2',
+                               '0',  0xBB, '\r', '\n', 0x1A, '\n'};
+  append<uint32_t>(file, static_cast<uint32_t>(
+                             vk::Format::eBc1RgbUnormBlock));  // vkFormat
+  append<uint32_t>(file, 1);  // typeSize
+  append<uint32_t>(file, 8);  // pixelWidth
+  append<uint32_t>(file, 8);  // pixelHeight
+  append<uint32_t>(file, 0);  // pixelDepth
+  append<uint32_t>(file, 0);  // layerCount
+  append<uint32_t>(file, 1);  // faceCount
+  append<uint32_t>(file, 3);  // levelCount
+  append<uint32_t>(file, 0);  // supercompressionScheme
+  file.resize(80, 0);         // Data format descriptor and key/value data.
+
+  // The level index, followed by the levels smallest first.
+  const std::vector<uint64_t> level_offsets = {168, 160, 152};
+  const std::vector<uint64_t> level_sizes = {32, 8, 8};
+  for (size_t i = 0; i < level_offsets.size(); ++i) {
+    append<uint64_t>(file, level_offsets[i]);
+    append<uint64_t>(file, level_sizes[i]);
+    append<uint64_t>(file, level_sizes[i]);
+  }
+  appendBC1Levels(file, true);
+  return file;
+}
+
+/// \return A DDS file holding an 8x8 BC1 texture with 3 levels.
+std::vector<uint8_t> createBC1DDS() {
+  std::vector<uint8_t> file = {'D', 'D', 'S', ' '};
+  append<uint32_t>(file, 124);      // dwSize
+  append<uint32_t>(file, 0x21007);  // dwFlags, including DDSD_MIPMAPCOUNT
+  append<uint32_t>(file, 8);        // dwHeight
+  append<uint32_t>(file, 8);        // dwWidth
+  append<uint32_t>(file, 32);       // dwPitchOrLinearSize
+  append<uint32_t>(file, 0);        // dwDepth
+  append<uint32_t>(file, 3);        // dwMipMapCount
+  file.resize(76, 0);               // dwReserved1
+  append<uint32_t>(file, 32);       // ddspf.dwSize
+  append<uint32_t>(file, 0x4);      // ddspf.dwFlags, DDPF_FOURCC
+  file.insert(file.end(), {'D', 'X', 'T', '1'});
+  file.resize(128, 0);  // Bit masks, caps and dwReserved2.
+  appendBC1Levels(file, false);
+  return file;
+}
+
+/// Write a file built in memory to disk.
+void writeFile(const std::filesystem::path& path,
+               const std::vector<uint8_t>& file) {
+  std::ofstream stream(path, std::ios::binary);
+  stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+}
+
+}  // namespace
+
+TEST_F(EngineIntegrationTests, TextureFileReadsKTX2AndDDS) {
+  const auto directory = std::filesystem::temp_directory_path();
+  writeFile(directory / "VulkanEngineTest.ktx2", createBC1KTX2());
+  writeFile(directory / "VulkanEngineTest.dds", createBC1DDS());
+
+  EXPECT_TRUE(VulkanEngine::TextureFile::isTextureFile("texture.ktx2"));
+  EXPECT_TRUE(VulkanEngine::TextureFile::isTextureFile("texture.DDS"));
+  EXPECT_FALSE(VulkanEngine::TextureFile::isTextureFile("texture.png"));
+
+  const auto ktx2 =
+      VulkanEngine::TextureFile::load(directory / "VulkanEngineTest.ktx2");
+  const auto dds =
+      VulkanEngine::TextureFile::load(directory / "VulkanEngineTest.dds");
+  EXPECT_EQ(ktx2->getVkFormat(), vk::Format::eBc1RgbUnormBlock);
+  EXPECT_EQ(dds->getVkFormat(), vk::Format::eBc1RgbaUnormBlock);
+
+  // Both files hold the same levels, packed largest first.
+  for (const auto& texture_file : {ktx2, dds}) {
+    EXPECT_EQ(texture_file->getWidth(), 8);
+    EXPECT_EQ(texture_file->getHeight(), 8);
+    const auto& levels = texture_file->getLevels();
+    ASSERT_EQ(levels.size(), 3);
+    ASSERT_EQ(texture_file->getDataSize(), 48);
+    for (size_t i = 0; i < levels.size(); ++i) {
+      EXPECT_EQ(levels[i].width, std::max(8u >> i, 1u));
+      EXPECT_EQ(levels[i].height, std::max(8u >> i, 1u));
+      EXPECT_EQ(levels[i].size, i == 0 ? 32 : 8);
+      for (size_t j = 0; j < levels[i].size; ++j) {
+        EXPECT_EQ(texture_file->getData()[levels[i].offset + j], i + 1);
+      }
+    }
+  }
+
+  EXPECT_THROW(
+      VulkanEngine::TextureFile::load(directory / "VulkanEngineMissing.ktx2"),
+      std::runtime_error);
+}
+
+TEST_F(EngineIntegrationTests, TextureFileRejectsMalformedHeaders) {
+  const auto path = std::filesystem::temp_directory_path() /
+                    "VulkanEngineMalformed";
+  const auto set = [](std::vector<uint8_t> file, size_t offset,
+                      uint32_t value) {
+    for (size_t i = 0; i < sizeof(value); ++i) {
+      file[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    return file;
+  };
+
+  // An 8x8 texture has at most 4 levels, and no level can be 0 texels wide
+  // or high. Each file is rejected before its levels are read.
+  const std::vector<std::pair<std::string, std::vector<uint8_t>>> files = {
+      {".ktx2", set(createBC1KTX2(), 40, 5)},
+      {".ktx2", set(createBC1KTX2(), 40, 0xFFFFFFFF)},
+      {".ktx2", set(createBC1KTX2(), 20, 0)},
+      {".dds", set(createBC1DDS(), 28, 5)},
+      {".dds", set(createBC1DDS(), 28, 0xFFFFFFFF)},
+      {".dds", set(createBC1DDS(), 12, 0)}};
+  for (const auto& file : files) {
+    writeFile(path.string() + file.first, file.second);
+    EXPECT_THROW(VulkanEngine::TextureFile::load(path.string() + file.first),
+                 std::runtime_error);
+  }
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, TextureFileTranscodesBC1AndETC2) {
+  // Four color BC1 block from red to blue, texels 1, 2 and 3 of the first row
+  // use the other colors. Also used as a 2x2 level, which only keeps the top
+  // left texels.
+  const std::vector<uint8_t> bc1_block = {0x00, 0xF8, 0x1F, 0x00,
+                                          0xE4, 0x00, 0x00, 0x00};
+  std::vector<uint8_t> bc1_data = bc1_block;
+  bc1_data.insert(bc1_data.end(), bc1_block.begin(), bc1_block.end());
+  VulkanEngine::TextureFile bc1(vk::Format::eBc1RgbUnormBlock,
+                                {{0, 8, 4, 4}, {8, 8, 2, 2}}, bc1_data);
+  const auto bc1_rgba = bc1.transcode();
+  ASSERT_EQ(bc1_rgba->getVkFormat(), vk::Format::eR8G8B8A8Unorm);
+  ASSERT_EQ(bc1_rgba->getDataSize(), (16 + 4) * 4);
+  const auto texel = [](const VulkanEngine::TextureFile& texture_file,
+                        size_t level, size_t x, size_t y) {
+    const auto& levels = texture_file.getLevels();
+    const uint8_t* data = texture_file.getData() + levels[level].offset +
+                          (y * levels[level].width + x) * 4;
+    return std::vector<int>(data, data + 4);
+  };
+  EXPECT_EQ(texel(*bc1_rgba, 0, 0, 0), std::vector<int>({255, 0, 0, 255}));
+  EXPECT_EQ(texel(*bc1_rgba, 0, 1, 0), std::vector<int>({0, 0, 255, 255}));
+  EXPECT_EQ(texel(*bc1_rgba, 0, 2, 0), std::vector<int>({170, 0, 85, 255}));
+  EXPECT_EQ(texel(*bc1_rgba, 0, 3, 0), std::vector<int>({85, 0, 170, 255}));
+  EXPECT_EQ(texel(*bc1_rgba, 0, 3, 3), std::vector<int>({255, 0, 0, 255}));
+  EXPECT_EQ(texel(*bc1_rgba, 1, 1, 0), std::vector<int>({0, 0, 255, 255}));
+  EXPECT_EQ(texel(*bc1_rgba, 1, 1, 1), std::vector<int>({255, 0, 0, 255}));
+
+  // ETC2 block in individual mode with a red left half and green right half,
+  // offset by the smallest modifier.
+  VulkanEngine::TextureFile etc2(
+      vk::Format::eEtc2R8G8B8SrgbBlock, {{0, 8, 4, 4}},
+      {0xF0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+  const auto etc2_rgba = etc2.transcode();
+  ASSERT_EQ(etc2_rgba->getVkFormat(), vk::Format::eR8G8B8A8Srgb);
+  for (size_t y = 0; y < 4; ++y) {
+    EXPECT_EQ(texel(*etc2_rgba, 0, 1, y), std::vector<int>({255, 2, 2, 255}));
+    EXPECT_EQ(texel(*etc2_rgba, 0, 2, y), std::vector<int>({2, 255, 2, 255}));
+  }
+
+  EXPECT_FALSE(
+      VulkanEngine::TextureFile::canTranscode(vk::Format::eBc7UnormBlock));
+  VulkanEngine::TextureFile astc(vk::Format::eAstc4x4UnormBlock,
+                                 {{0, 16, 4, 4}}, std::vector<uint8_t>(16));
+  EXPECT_THROW(astc.transcode(), std::runtime_error);
+}
+
+TEST_F(EngineIntegrationTests, TextureFileCompressesAndSavesKTX2) {
+  // 10x6 horizontal gradient whose right half is translucent, so that levels
+  // have odd sizes and edge blocks extend past the texture.
+  const uint32_t width = 10;
+  const uint32_t height = 6;
+  std::vector<uint8_t> image;
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      image.insert(image.end(), {static_cast<uint8_t>(x * 25),
+                                 static_cast<uint8_t>(255 - x * 20), 128,
+                                 static_cast<uint8_t>(x < 5 ? 255 : 64)});
+    }
+  }
+  const auto texture_file =
+      VulkanEngine::TextureFile::createFromImage(image.data(), width, height);
+  const auto& levels = texture_file->getLevels();
+  ASSERT_EQ(levels.size(), 4);
+  EXPECT_EQ(levels[1].width, 5);
+  EXPECT_EQ(levels[1].height, 3);
+  EXPECT_EQ(levels[3].width, 1);
+  EXPECT_EQ(levels[3].height, 1);
+  EXPECT_TRUE(texture_file->hasAlpha());
+
+  // Each texel of level 1 is the average of 2x2 texels of level 0.
+  const uint8_t* level1 = texture_file->getData() + levels[1].offset;
+  EXPECT_EQ(level1[0], 13);
+  EXPECT_EQ(level1[1], 245);
+  EXPECT_EQ(level1[(1 * 5 + 2) * 4 + 3], 160);
+
+  const auto compressed =
+      texture_file->compress(vk::Format::eBc3UnormBlock);
+  EXPECT_EQ(compressed->getLevels().size(), 4);
+  EXPECT_EQ(compressed->getDataSize(), (6 + 2 + 1 + 1) * 16);
+  EXPECT_THROW(compressed->compress(vk::Format::eBc1RgbUnormBlock),
+               std::runtime_error);
+
+  const auto path =
+      std::filesystem::temp_directory_path() / "VulkanEngineBaked.ktx2";
+  compressed->save(path);
+  const auto loaded = VulkanEngine::TextureFile::load(path);
+  ASSERT_EQ(loaded->getVkFormat(), vk::Format::eBc3UnormBlock);
+  ASSERT_EQ(loaded->getLevels().size(), 4);
+  ASSERT_EQ(loaded->getDataSize(), compressed->getDataSize());
+  for (size_t i = 0; i < levels.size(); ++i) {
+    const auto& level = loaded->getLevels()[i];
+    EXPECT_EQ(level.width, levels[i].width);
+    EXPECT_EQ(level.height, levels[i].height);
+    EXPECT_TRUE(std::equal(
+        loaded->getData() + level.offset,
+        loaded->getData() + level.offset + level.size,
+        compressed->getData() + compressed->getLevels()[i].offset));
+  }
+
+  // Block compression keeps the texels close to the image.
+  const auto decompressed = loaded->transcode();
+  const uint8_t* level0 = decompressed->getData();
+  for (size_t i = 0; i < image.size(); ++i) {
+    EXPECT_NEAR(level0[i], image[i], 12) << "at byte " << i;
+  }
+  EXPECT_TRUE(loaded->hasAlpha());
+  EXPECT_FALSE(texture_file->compress(vk::Format::eBc1RgbUnormBlock)
+                   ->hasAlpha());
+
+  // Only formats with a data format descriptor can be saved.
+  VulkanEngine::TextureFile astc(vk::Format::eAstc4x4UnormBlock,
+                                 {{0, 16, 4, 4}}, std::vector<uint8_t>(16));
+  EXPECT_THROW(astc.save(path), std::runtime_error);
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshDDSTexture) {
+  const auto directory =
+      std::filesystem::temp_directory_path() / "VulkanEngineDDSTest";
+  std::filesystem::create_directories(directory);
+  writeFile(directory / "texture.dds", createBC1DDS());
+  std::ofstream(directory / "quad.mtl") << "newmtl material\n"
+                                        << "map_Kd texture.dds\n";
+  std::ofstream(directory / "quad.obj")
+      << "mtllib quad.mtl\n"
+      << "v -1 -1 0\nv 1 -1 0\nv 1 1 0\nv -1 1 0\n"
+      << "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+      << "usemtl material\n"
+      << "f 1/1 2/2 3/3 4/4\n";
+
+  // The texture is uploaded compressed, or transcoded if the device can't
+  // sample BC1.
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(
+      new VulkanEngine::OBJMesh(directory / "quad.obj"));
+  ASSERT_TRUE(obj_mesh->isLoaded());
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+
+  scene->addChildren({obj_mesh, camera});
+
+  scene->update();
+  vulkan_manager->drawImage();
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+TEST_F(EngineIntegrationTests, RenderOBJMeshStreamedTexture) {
+  auto& texture_streamer = vulkan_manager->getTextureStreamer();
+  texture_streamer.setEnabled(true);
+
+  const auto directory =
+      std::filesystem::temp_directory_path() / "VulkanEngineStreamingTest";
+  std::filesystem::create_directories(directory);
+  const std::vector<uint8_t> texels(256 * 256 * 4, 255);
+  VulkanEngine::TextureFile::createFromImage(texels.data(), 256, 256)
+      ->save(directory / "texture.ktx2");
+  std::ofstream(directory / "quad.mtl") << "newmtl material\n"
+                                        << "map_Kd texture.ktx2\n";
+  std::ofstream(directory / "quad.obj")
+      << "mtllib quad.mtl\n"
+      << "v -1 -1 0\nv 1 -1 0\nv 1 1 0\nv -1 1 0\n"
+      << "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+      << "usemtl material\n"
+      << "f 1/1 2/2 3/3 4/4\n";
+
+  // Only the levels up to 64x64 are resident at first.
+  const size_t level_0_size = 256 * 256 * 4;
+  std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(
+      new VulkanEngine::OBJMesh(directory / "quad.obj"));
+  ASSERT_TRUE(obj_mesh->isLoaded());
+  EXPECT_EQ(texture_streamer.getNumTextures(), 1);
+  EXPECT_LT(obj_mesh->getTextureMemorySize(), level_0_size / 2);
+
+  std::shared_ptr<VulkanEngine::Scene> scene(new VulkanEngine::Scene({window}));
+
+  auto camera = std::make_shared<VulkanEngine::Camera>(
+      Eigen::Vector3f(0.0f, 0.0f, 0.1f),  // look at
+      Eigen::Vector3f(0.0f, 1.0f, 0.0f),  // up vector
+      0.1f,                               // z-near
+      10.0f,                              // z-far
+      45.0f,                              // fov
+      window->getFramebufferWidth(), window->getFramebufferHeight());
+
+  scene->addChildren({obj_mesh, camera});
+
+  // The camera is right in front of the quad, so all levels are streamed in.
+  auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (obj_mesh->getTextureMemorySize() < level_0_size &&
+         std::chrono::steady_clock::now() < timeout) {
+    scene->update();
+    vulkan_manager->drawImage();
+  }
+  EXPECT_GE(obj_mesh->getTextureMemorySize(), level_0_size);
+  EXPECT_EQ(texture_streamer.getResidentSize(),
+            obj_mesh->getTextureMemorySize());
+
+  // Levels are dropped once they no longer fit into the budget.
+  texture_streamer.setMemoryBudget(level_0_size / 2);
+  timeout = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (obj_mesh->getTextureMemorySize() >= level_0_size &&
+         std::chrono::steady_clock::now() < timeout) {
+    scene->update();
+    vulkan_manager->drawImage();
+  }
+  EXPECT_LT(obj_mesh->getTextureMemorySize(), level_0_size / 2);
+  EXPECT_EQ(texture_streamer.getMemoryBudget(), level_0_size / 2);
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
+namespace {
+
+/// Copy every mip level of an RGBA8 image in
+/// vk::ImageLayout::eShaderReadOnlyOptimal to host memory.
+/// \param vk_image The image, which must have transfer source usage.
+/// \param width The width of level 0.
+/// \param height The height of level 0.
+/// \return The texels of each level.
+std::vector<std::vector<uint8_t>> readImageLevels(vk::Image vk_image,
+                                                  uint32_t width,
+                                                  uint32_t height) {
+  std::vector<vk::BufferImageCopy> regions;
+  std::vector<size_t> offsets;
+  size_t size = 0;
+  for (uint32_t level = 0; (width | height) >> level != 0; ++level) {
+    const uint32_t level_width = std::max(width >> level, 1u);
+    const uint32_t level_height = std::max(height >> level, 1u);
+    offsets.push_back(size);
+    regions.push_back(
+        vk::BufferImageCopy()
+            .setBufferOffset(size)
+            .setImageSubresource(vk::ImageSubresourceLayers(
+                vk::ImageAspectFlagBits::eColor, level, 0, 1))
+            .setImageExtent(vk::Extent3D(level_width, level_height, 1)));
+    size += static_cast<size_t>(level_width) * level_height * 4;
+  }
+  offsets.push_back(size);
+
+  VulkanEngine::Buffer readback(size, vk::BufferUsageFlagBits::eTransferDst,
+                                vk::MemoryPropertyFlagBits::eHostVisible |
+                                    vk::MemoryPropertyFlagBits::eHostCoherent,
+                                VMA_MEMORY_USAGE_GPU_TO_CPU);
+  const auto subresource_range = vk::ImageSubresourceRange(
+      vk::ImageAspectFlagBits::eColor, 0, VK_REMAINING_MIP_LEVELS, 0, 1);
+  VulkanEngine::SingleUsageCommandBuffer command_buffer;
+  command_buffer.beginSingleUsageCommandBuffer();
+  command_buffer.single_use_command_buffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eAllCommands,
+      vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr,
+      nullptr,
+      vk::ImageMemoryBarrier()
+          .setSrcAccessMask(vk::AccessFlagBits::eMemoryWrite)
+          .setDstAccessMask(vk::AccessFlagBits::eTransferRead)
+          .setOldLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+          .setNewLayout(vk::ImageLayout::eTransferSrcOptimal)
+          .setImage(vk_image)
+          .setSubresourceRange(subresource_range));
+  command_buffer.single_use_command_buffer.copyImageToBuffer(
+      vk_image, vk::ImageLayout::eTransferSrcOptimal, readback.getVkBuffer(),
+      regions);
+  command_buffer.single_use_command_buffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eTransfer,
+      vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags(), nullptr,
+      nullptr,
+      vk::ImageMemoryBarrier()
+          .setSrcAccessMask(vk::AccessFlagBits::eTransferRead)
+          .setOldLayout(vk::ImageLayout::eTransferSrcOptimal)
+          .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+          .setImage(vk_image)
+          .setSubresourceRange(subresource_range));
+  command_buffer.endSingleUsageCommandBuffer();
+
+  std::vector<std::vector<uint8_t>> levels;
+  const auto* data = static_cast<const uint8_t*>(readback.mapMemory());
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    levels.emplace_back(data + offsets[i], data + offsets[i + 1]);
+  }
+  readback.unmapMemory();
+  return levels;
+}
+
+}  // namespace
+
+TEST_F(EngineIntegrationTests, GenerateMipmapsWithCompute) {
+  using SRGBTexture2D = VulkanEngine::StagedBuffer<VulkanEngine::ShaderImage<
+      vk::Format::eR8G8B8A8Srgb, vk::ImageType::e2D, vk::ImageTiling::eOptimal,
+      vk::SampleCountFlagBits::e1>>;
+
+  // Sizes which aren't powers of two. The second one needs more levels than
+  // a single work group reduces, the others leave a partial last work group
+  // in which only a few texels of level 0 lie inside of the image.
+  const std::vector<std::pair<uint32_t, uint32_t>> sizes = {
+      {300, 200}, {3000, 1000}, {65, 65}, {1, 257}};
+  for (const auto& size : sizes) {
+    // A gentle gradient, which box filtering and linear blits reduce to
+    // nearly the same levels.
+    std::vector<uint8_t> texels(
+        static_cast<size_t>(size.first) * size.second * 4);
+    for (uint32_t y = 0; y < size.second; ++y) {
+      for (uint32_t x = 0; x < size.first; ++x) {
+        uint8_t* texel = &texels[(static_cast<size_t>(y) * size.first + x) * 4];
+        texel[0] = static_cast<uint8_t>(64 + 128 * x / size.first);
+        texel[1] = static_cast<uint8_t>(64 + 128 * y / size.second);
+        texel[2] = 128;
+        texel[3] = 255;
+      }
+    }
+
+    using MipmapMode = VulkanEngine::MipmapMode;
+    std::vector<std::vector<std::vector<uint8_t>>> levels;
+    for (const auto mode : {MipmapMode::eCompute, MipmapMode::eBlit}) {
+      auto image = std::make_shared<SRGBTexture2D>(
+          vk::ImageLayout::eUndefined,
+          vk::ImageUsageFlagBits::eTransferDst |
+              vk::ImageUsageFlagBits::eTransferSrc |
+              vk::ImageUsageFlagBits::eSampled,
+          VMA_MEMORY_USAGE_GPU_ONLY, size.first, size.second, 1, 4, 1, 1,
+          vk::DescriptorType::eCombinedImageSampler,
+          vk::ShaderStageFlagBits::eFragment, mode);
+
+      if (mode == MipmapMode::eCompute) {
+        const bool supported =
+            vulkan_manager->getMipmapGenerator().supports(
+                vk::Format::eR8G8B8A8Srgb, size.first, size.second);
+        EXPECT_EQ(image->getMipmapMode(),
+                  supported ? MipmapMode::eCompute : MipmapMode::eBlit);
+      }
+
+      image->setImageData(texels.data());
+      image->createImageView(vk::ImageViewType::e2D,
+                             vk::ImageAspectFlagBits::eColor);
+      image->createSampler();
+      image->transferBuffer();
+      levels.push_back(
+          readImageLevels(image->getVkImage(), size.first, size.second));
+    }
+
+    // Both paths agree on every level, up to the differences between their
+    // filters.
+    ASSERT_EQ(levels[0].size(), levels[1].size());
+    for (size_t level = 1; level < levels[0].size(); ++level) {
+      ASSERT_EQ(levels[0][level].size(), levels[1][level].size());
+      int max_difference = 0;
+      for (size_t i = 0; i < levels[0][level].size(); ++i) {
+        max_difference =
+            std::max(max_difference, std::abs(levels[0][level][i] -
+                                              levels[1][level][i]));
+      }
+      EXPECT_LE(max_difference, 8)
+          << size.first << "x" << size.second << " level " << level;
+    }
+  }
+
+  // Larger images fall back to blits.
+  EXPECT_FALSE(vulkan_manager->getMipmapGenerator().supports(
+      vk::Format::eR8G8B8A8Srgb, 8192, 8192));
+
+  ASSERT_TRUE(cerr_buffer.str().empty());
+}
+
 TEST_F(EngineIntegrationTests, CreateOBJMeshCapsule) {
   std::shared_ptr<VulkanEngine::OBJMesh> obj_mesh(new VulkanEngine::OBJMesh(
       std::filesystem::path("./assets/capsule/capsule.obj"),
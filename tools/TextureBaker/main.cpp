@@ -0,0 +1,174 @@
+// Copyright (c) 2025 Michael Carlie
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <VulkanEngine/TextureFile.h>
+
+#include <chrono>
+#include <cxxopts.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stb_image.h>
+
+cxxopts::ParseResult setupProgramOptions(int argc, char** argv,
+                                         cxxopts::Options& options) {
+  options.positional_help("<mtl files>");
+  options.add_options()("f,format",
+                        "Texture format: bc1, bc3, rgba8 or auto, which picks "
+                        "bc1 for opaque textures and bc3 otherwise",
+                        cxxopts::value<std::string>()->default_value("auto"))(
+      "force", "Bake textures even if they are up to date")(
+      "help", "Print help")("mtl", "Paths to mtl files",
+                            cxxopts::value<std::vector<std::string>>());
+  options.parse_positional({"mtl"});
+
+  return options.parse(argc, argv);
+}
+
+/// \return The paths of all textures referenced by a mtl file, relative to
+/// the working directory.
+std::set<std::filesystem::path> getTexturePaths(
+    const std::filesystem::path& mtl_path) {
+  std::ifstream stream(mtl_path);
+  if (!stream) {
+    throw std::runtime_error("Could not open " + mtl_path.string());
+  }
+
+  std::set<std::filesystem::path> texture_paths;
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream line_stream(line);
+    std::string keyword;
+    line_stream >> keyword;
+    if (keyword.rfind("map_", 0) != 0 && keyword != "bump" &&
+        keyword != "disp" && keyword != "decal" && keyword != "norm") {
+      continue;
+    }
+
+    // Options come before the file name, which is the last token.
+    std::string token;
+    std::string file_name;
+    while (line_stream >> token) {
+      file_name = token;
+    }
+    if (!file_name.empty()) {
+      texture_paths.insert(mtl_path.parent_path() / file_name);
+    }
+  }
+  return texture_paths;
+}
+
+/// Bake a texture into a KTX2 file next to it.
+/// \param texture_path The path of the image to bake.
+/// \param format_name The format option.
+/// \param force Bake the texture even if the KTX2 file is up to date.
+void bakeTexture(const std::filesystem::path& texture_path,
+                 const std::string& format_name, bool force) {
+  auto baked_path = texture_path;
+  baked_path.replace_extension(".ktx2");
+  if (!force && std::filesystem::exists(baked_path) &&
+      std::filesystem::last_write_time(baked_path) >=
+          std::filesystem::last_write_time(texture_path)) {
+    std::cout << baked_path.string() << " is up to date" << std::endl;
+    return;
+  }
+
+  const auto start_time = std::chrono::steady_clock::now();
+  int width;
+  int height;
+  int channels_in_file;
+  unsigned char* texels = stbi_load(texture_path.string().c_str(), &width,
+                                    &height, &channels_in_file, 4);
+  if (!texels) {
+    throw std::runtime_error("Could not load " + texture_path.string());
+  }
+  const auto image = VulkanEngine::TextureFile::createFromImage(
+      texels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+  stbi_image_free(texels);
+
+  // Textures are sampled as UNORM, like the images the engine loads directly.
+  std::shared_ptr<VulkanEngine::TextureFile> texture_file;
+  if (format_name == "rgba8") {
+    texture_file = image;
+  } else if (format_name == "bc1" ||
+             (format_name == "auto" && !image->hasAlpha())) {
+    texture_file = image->compress(vk::Format::eBc1RgbUnormBlock);
+  } else if (format_name == "bc3" || format_name == "auto") {
+    texture_file = image->compress(vk::Format::eBc3UnormBlock);
+  } else {
+    throw std::runtime_error("Unknown texture format " + format_name);
+  }
+  texture_file->save(baked_path);
+
+  const std::chrono::duration<double, std::milli> bake_time =
+      std::chrono::steady_clock::now() - start_time;
+  std::cout << "Baked " << baked_path.string() << " ("
+            << vk::to_string(texture_file->getVkFormat()) << ", "
+            << texture_file->getLevels().size() << " levels, "
+            << (image->getLevels().front().size >> 10) << " KiB -> "
+            << (texture_file->getDataSize() >> 10) << " KiB, "
+            << bake_time.count() << " ms)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  cxxopts::Options options(
+      "TextureBaker",
+      "Precompute the mip levels of the textures referenced by mtl files and "
+      "compress them into KTX2 files, which OBJMesh loads instead of the "
+      "original images");
+  auto option_result = setupProgramOptions(argc, argv, options);
+  if (option_result.count("help") || !option_result.count("mtl")) {
+    std::cout << options.help() << std::endl;
+    return option_result.count("help") ? 0 : 1;
+  }
+
+  const auto format_name = option_result["format"].as<std::string>();
+  const bool force = option_result.count("force") > 0;
+
+  int result = 0;
+  for (const auto& mtl_path :
+       option_result["mtl"].as<std::vector<std::string>>()) {
+    try {
+      for (const auto& texture_path : getTexturePaths(mtl_path)) {
+        // Textures which are already compressed are loaded as they are.
+        if (VulkanEngine::TextureFile::isTextureFile(texture_path)) {
+          continue;
+        }
+        try {
+          bakeTexture(texture_path, format_name, force);
+        } catch (const std::exception& e) {
+          std::cerr << e.what() << std::endl;
+          result = 1;
+        }
+      }
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      result = 1;
+    }
+  }
+  return result;
+}